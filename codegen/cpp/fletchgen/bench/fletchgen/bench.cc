@@ -0,0 +1,63 @@
+// Copyright 2018-2019 Delft University of Technology
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks for Fletchgen functions that are evaluated for every Arrow field during generation.
+//
+// This uses the same synthetic schemas as the fletcher::common benchmarks.
+
+#include <arrow/api.h>
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <string>
+
+#include "fletcher/common.h"
+#include "fletcher/bench_schemas.h"
+#include "fletcher/bench_allocs.h"
+#include "fletchgen/array.h"
+
+FLETCHER_BENCH_COUNT_ALLOCATIONS()
+
+namespace fletchgen {
+
+using fletcher::AllocationScope;
+using fletcher::ReportPerItem;
+
+static void BM_GenerateConfigString(benchmark::State &state, const std::string &kind) {
+  std::shared_ptr<arrow::Schema> schema;
+  if (kind == "deep") {
+    schema = fletcher::GetDeepSchema(static_cast<size_t>(state.range(0)));
+  } else if (kind == "long_names") {
+    schema = fletcher::GetWideSchema(static_cast<size_t>(state.range(0)), 256);
+  } else {
+    schema = fletcher::GetWideSchema(static_cast<size_t>(state.range(0)));
+  }
+  auto num_fields = fletcher::CountFields(*schema);
+  AllocationScope allocs;
+  for (auto _ : state) {
+    for (const auto &field : schema->fields()) {
+      benchmark::DoNotOptimize(GenerateConfigString(*field));
+    }
+  }
+  allocs.Report(&state, num_fields);
+  ReportPerItem(&state, num_fields);
+}
+
+BENCHMARK_CAPTURE(BM_GenerateConfigString, wide, std::string("wide"))->RangeMultiplier(10)->Range(1, 10000);
+BENCHMARK_CAPTURE(BM_GenerateConfigString, deep, std::string("deep"))->RangeMultiplier(4)->Range(1, 256);
+BENCHMARK_CAPTURE(BM_GenerateConfigString, long_names, std::string("long_names"))->RangeMultiplier(10)->Range(1, 10000);
+
+}  // namespace fletchgen
+
+BENCHMARK_MAIN();
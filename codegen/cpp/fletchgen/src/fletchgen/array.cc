@@ -205,6 +205,39 @@ ConfigType GetConfigType(const arrow::DataType &type) {
   return ConfigType::PRIM;
 }
 
+uint32_t GetAutoEPC(const arrow::Field &field, uint32_t bus_data_width, double utilization) {
+  // Determine the width of the elements that the EPC applies to.
+  uint32_t element_width = 0;
+  switch (GetConfigType(*field.type())) {
+    case ConfigType::PRIM: {
+      auto fwt = std::dynamic_pointer_cast<arrow::FixedWidthType>(field.type());
+      if (fwt != nullptr) {
+        element_width = fwt->bit_width();
+      }
+      break;
+    }
+    case ConfigType::LIST_PRIM: {
+      if ((field.type()->id() == arrow::Type::BINARY) || (field.type()->id() == arrow::Type::STRING)) {
+        element_width = 8;
+      } else {
+        element_width = GetFixedWidthTypeBitWidth(*field.type()->field(0)->type());
+      }
+      break;
+    }
+    default:break;
+  }
+  if (element_width == 0) {
+    return 1;
+  }
+  // Take the largest power of two that fits.
+  auto budget = static_cast<uint32_t>(bus_data_width * utilization);
+  uint32_t epc = 1;
+  while (2 * epc * element_width <= budget) {
+    epc *= 2;
+  }
+  return epc;
+}
+
 std::shared_ptr<Node> GetWidthNode(const arrow::DataType &type) {
   switch (type.id()) {
     // Fixed-width:
@@ -252,27 +285,48 @@ std::shared_ptr<Node> GetWidthNode(const arrow::DataType &type) {
   }
 }
 
+/// @brief Return a list of configuration string parameters, including the leading semicolon, if any.
+static std::string ConfigParams(const std::vector<std::string> &params) {
+  std::string ret;
+  for (size_t i = 0; i < params.size(); i++) {
+    ret += (i == 0 ? ";" : ",") + params[i];
+  }
+  return ret;
+}
+
 std::string GenerateConfigString(const arrow::Field &field, int level) {
   std::string ret;
   ConfigType ct = GetConfigType(*field.type());
 
-  if (field.nullable()) {
-    ret += "null(";
-    level++;
-  }
-
   int epc = fletcher::GetUIntMeta(field, fletcher::meta::VALUE_EPC, 1);
   int lepc = fletcher::GetUIntMeta(field, fletcher::meta::LIST_EPC, 1);
+  auto fifo_depth = fletcher::GetMeta(field, fletcher::meta::BUS_FIFO_DEPTH);
 
-  bool has_children = false;
+  // Parameters of the level of the field itself.
+  std::vector<std::string> params;
+  if (epc > 1) {
+    params.push_back("epc=" + std::to_string(epc));
+  }
+  if (lepc > 1) {
+    params.push_back("lepc=" + std::to_string(lepc));
+  }
+  if (!fifo_depth.empty()) {
+    params.push_back("bus_fifo_depth=" + fifo_depth);
+    // Lists of primitives have a separate buffer reader/writer for the offsets buffer.
+    if (ct == ConfigType::LIST_PRIM) {
+      params.push_back("idx_bus_fifo_depth=" + fifo_depth);
+    }
+  }
+  auto config = fletcher::GetMeta(field, fletcher::meta::CONFIG);
+  if (!config.empty()) {
+    params.push_back(config);
+  }
 
   if (ct == ConfigType::PRIM) {
     auto w = GetWidthNode(*field.type());
     ret += "prim(" + w->ToString();
-    level++;
   } else if (ct == ConfigType::LIST_PRIM) {
     ret += "listprim(";
-    level++;
     // Binary and string have no child, so we can't inspect it for the width, which is always 8.
     if ((field.type()->id() == arrow::Type::BINARY) || (field.type()->id() == arrow::Type::STRING)) {
       ret += "8";
@@ -281,40 +335,48 @@ std::string GenerateConfigString(const arrow::Field &field, int level) {
       ret += std::to_string(GetFixedWidthTypeBitWidth(*field.type()->field(0)->type()));
     }
   } else if (ct == ConfigType::LIST) {
-    has_children = true;
     ret += "list(";
-    level++;
   } else if (ct == ConfigType::STRUCT) {
-    has_children = true;
     ret += "struct(";
-    level++;
-  }
-
-  if (epc > 1 || lepc > 1) {
-    ret += ";";
-  }
-  if (epc > 1) {
-    ret += "epc=" + std::to_string(epc);
-    if (lepc > 1) {
-      ret += ",";
-    }
-  }
-  if (lepc > 1) {
-    ret += "lepc=" + std::to_string(epc);
   }
 
-  if (has_children) {
+  if ((ct == ConfigType::LIST) || (ct == ConfigType::STRUCT)) {
     // Append children
     for (int c = 0; c < field.type()->num_fields(); c++) {
       auto child = field.type()->field(c);
-      ret += GenerateConfigString(*child);
+      ret += GenerateConfigString(*child, level + 1);
       if (c != field.type()->num_fields() - 1)
         ret += ",";
     }
   }
 
-  for (; level > 0; level--)
-    ret += ")";
+  ret += ConfigParams(params) + ")";
+
+  // The validity bitmap buffer gets the same FIFO depth as the other buffers of the field.
+  if (field.nullable()) {
+    std::vector<std::string> null_params;
+    if (!fifo_depth.empty()) {
+      null_params.push_back("bus_fifo_depth=" + fifo_depth);
+    }
+    ret = "null(" + ret + ConfigParams(null_params) + ")";
+  }
+
+  // The ArrayReader/Writer wraps the top-level in a bus arbiter. If any of its parameters are specified, wrap it here,
+  // such that they can be passed to it.
+  if (level == 0) {
+    std::vector<std::string> arb_params;
+    auto max_outstanding = fletcher::GetMeta(field, fletcher::meta::MAX_OUTSTANDING);
+    if (!max_outstanding.empty()) {
+      arb_params.push_back("max_outstanding=" + max_outstanding);
+    }
+    auto method = fletcher::GetMeta(field, fletcher::meta::ARB_METHOD);
+    if (!method.empty()) {
+      arb_params.push_back("method=" + method);
+    }
+    if (!arb_params.empty()) {
+      ret = "arb(" + ret + ConfigParams(arb_params) + ")";
+    }
+  }
 
   return ret;
 }
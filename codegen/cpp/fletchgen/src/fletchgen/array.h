@@ -84,12 +84,30 @@ ConfigType GetConfigType(const arrow::DataType &type);
 
 /**
  * @brief Return the configuration string for a ArrayReader/Writer.
+ *
+ * Besides the elements-per-cycle, the buffering and bus arbiter parameters of the ArrayReader/Writer are taken from
+ * the field metadata. See fletcher/meta/meta.h for the keys.
+ *
  * @param field The arrow::Field to derive the string from.
- * @param level Nesting level for recursive calls to this function.
+ * @param level Nesting level for recursive calls to this function. Arbiter parameters only apply to level 0.
  * @return      The string.
  */
 std::string GenerateConfigString(const arrow::Field &field, int level = 0);
 
+/**
+ * @brief Return the number of elements per cycle of an Arrow field, such that its stream uses a fraction of the bus.
+ *
+ * The result is the largest power of two of which the elements fit in the utilized part of the bus data width. Only
+ * primitive fields and lists of non-nullable primitives (including strings and binaries) support EPC larger than one;
+ * the EPC of any other field is always one. For lists, the EPC applies to the list values.
+ *
+ * @param field           The arrow::Field to derive the EPC for.
+ * @param bus_data_width  The data width of the bus the ArrayReader/Writer of the field is connected to.
+ * @param utilization     The targeted fraction of the bus data width, between 0 and 1.
+ * @return                The number of elements per cycle.
+ */
+uint32_t GetAutoEPC(const arrow::Field &field, uint32_t bus_data_width, double utilization);
+
 /**
  * @brief Get a type mapper for an Arrow::Field-based stream to an ArrayReader/Writer stream.
  *
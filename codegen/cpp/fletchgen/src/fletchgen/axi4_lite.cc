@@ -16,6 +16,7 @@
 
 #include <cerata/api.h>
 
+#include "fletchgen/basic_types.h"
 #include "fletchgen/utils.h"
 
 namespace fletchgen {
@@ -25,6 +26,10 @@ using cerata::field;
 using cerata::stream;
 using cerata::vector;
 using cerata::Object;
+using cerata::component;
+using cerata::parameter;
+using cerata::port;
+using cerata::port_array;
 
 std::shared_ptr<Type> axi4_lite_type(Axi4LiteSpec spec) {
   auto axi_typename = spec.ToAxiTypeName();
@@ -74,4 +79,28 @@ Axi4LitePort::Axi4LitePort(Port::Dir dir, Axi4LiteSpec spec, std::string name, s
 std::shared_ptr<Object> Axi4LitePort::Copy() const {
   return axi4_lite(dir_, domain_, spec_);
 }
+Component *axi4_lite_demux() {
+  // This component model corresponds to a VHDL primitive. Any modifications should be reflected accordingly.
+  auto optional_existing_comp = cerata::default_component_pool()->Get("AxiLiteDemux");
+  if (optional_existing_comp) {
+    return *optional_existing_comp;
+  }
+
+  auto num_mst = parameter("NUM_MASTERS", 0);
+  auto window_width = parameter("WINDOW_WIDTH", 0);
+  auto result = component("AxiLiteDemux", {num_mst,
+                                           window_width,
+                                           port("bcd", cr(), Port::Dir::IN, bus_cd()),
+                                           std::make_shared<Axi4LitePort>(Port::Dir::IN, Axi4LiteSpec(), "slv",
+                                                                          bus_cd()),
+                                           port_array("mst", axi4_lite_type(), num_mst, Port::Dir::OUT, bus_cd())});
+
+  // This component is a primitive as far as Cerata is concerned.
+  result->SetMeta(cerata::vhdl::meta::PRIMITIVE, "true");
+  result->SetMeta(cerata::vhdl::meta::LIBRARY, "work");
+  result->SetMeta(cerata::vhdl::meta::PACKAGE, "Axi_pkg");
+
+  return result.get();
+}
+
 }  // namespace fletchgen
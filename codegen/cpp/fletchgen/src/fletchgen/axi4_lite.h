@@ -24,6 +24,7 @@ namespace fletchgen {
 using cerata::ClockDomain;
 using cerata::Type;
 using cerata::Port;
+using cerata::Component;
 
 /// @brief AXI-lite bus width specification. Address is always 32, but data can also be 64. Modifiable.
 struct Axi4LiteSpec {
@@ -63,4 +64,17 @@ std::shared_ptr<Axi4LitePort> axi4_lite(Port::Dir dir,
                                         const std::shared_ptr<ClockDomain> &domain = cerata::default_domain(),
                                         Axi4LiteSpec spec = Axi4LiteSpec());
 
+/**
+ * @brief Return a Cerata model of an AXI4-lite demultiplexer.
+ *
+ * The demultiplexer connects its "slv" port to one of the ports in its "mst" port array, where every port in the array
+ * occupies an address window of 2^WINDOW_WIDTH bytes.
+ *
+ * This model corresponds to [`hardware/axi/AxiLiteDemux.vhd`]. Changes to the implementation of this component in the
+ * HDL source must be reflected in the implementation of this function.
+ *
+ * @return A Cerata model of the AxiLiteDemux primitive.
+ */
+Component *axi4_lite_demux();
+
 }  // namespace fletchgen
@@ -17,6 +17,7 @@
 #include <cerata/api.h>
 
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "fletchgen/basic_types.h"
@@ -106,7 +107,9 @@ Component *bus_arbiter(BusFunction function) {
                parameter("SLV_REQ_SLICES", true),
                parameter("MST_REQ_SLICE", true),
                parameter("MST_DAT_SLICE", true),
-               parameter("SLV_DAT_SLICES", true)
+               parameter("SLV_DAT_SLICES", true),
+               parameter("SLV_WEIGHTS", std::string("")),
+               parameter("SLV_BUFFER_DEPTHS", std::string(""))
               });
 
   // Clock/reset
@@ -153,10 +156,22 @@ std::shared_ptr<Component> BusReadSerializer() {
   return ret;
 }
 
+std::string ChannelName(size_t channel, const std::string &name) {
+  return channel == 0 ? name : "ch" + std::to_string(channel) + "_" + name;
+}
+
+std::string ChannelParamPrefix(size_t channel) {
+  return channel == 0 ? "" : "CH" + std::to_string(channel);
+}
+
 bool operator==(const BusSpec &lhs, const BusSpec &rhs) {
   return (lhs.dim == rhs.dim) && (lhs.func == rhs.func);
 }
 
+bool BusArbiterSpec::IsValidMethod() const {
+  return (method == "ROUND-ROBIN") || (method == "RR-STICKY") || (method == "FIXED") || (method == "WEIGHTED");
+}
+
 std::shared_ptr<Type> bus(const BusSpecParams &spec) {
   std::shared_ptr<Type> result;
   if (spec.func == BusFunction::READ) {
@@ -113,6 +113,19 @@ struct BusSpec {
 /// @brief Returns true if BusSpecs are equal.
 bool operator==(const BusSpec &lhs, const BusSpec &rhs);
 
+/// Holds the configuration of the bus arbiters of a design.
+struct BusArbiterSpec {
+  /// Arbitration method; "ROUND-ROBIN", "RR-STICKY", "FIXED" or "WEIGHTED".
+  std::string method = "RR-STICKY";
+  /// Maximum number of outstanding requests of every arbiter.
+  uint32_t max_outstanding = 4;
+  /// Default depth of the buffers between bus ports and arbiters. Zero inserts no buffers.
+  uint32_t buffer_depth = 0;
+
+  /// @brief Return true if the arbitration method is valid.
+  [[nodiscard]] bool IsValidMethod() const;
+};
+
 /// @brief Return a Cerata type for a Fletcher bus read interface.
 std::shared_ptr<Type> bus_read(const std::shared_ptr<Node> &addr_width,
                                const std::shared_ptr<Node> &data_width,
@@ -153,6 +166,12 @@ void ConnectBusParam(cerata::Graph *dst,
                      const BusDimParams &src,
                      cerata::NodeMap *rebinding);
 
+/// @brief Return the name of a bus port or instance on some memory channel. Channel 0 keeps the plain name.
+std::string ChannelName(size_t channel, const std::string &name);
+
+/// @brief Return the prefix of the bus parameters of some memory channel. Channel 0 parameters have no prefix.
+std::string ChannelParamPrefix(size_t channel);
+
 /**
  * @brief Return a Cerata model of a BusArbiter.
  * @param function  The function of the bus; either read or write.
@@ -163,6 +182,9 @@ void ConnectBusParam(cerata::Graph *dst,
  * or [`hardware/interconnect/BusWriteArbiterVec.vhd`](https://github.com/johanpel/fletcher/blob/develop/hardware/interconnect/BusWriteArbiterVec.vhd)
  * depending on the function parameter.
  *
+ * The SLV_WEIGHTS and SLV_BUFFER_DEPTHS parameters are comma-separated lists with a value for every slave port. Empty
+ * lists default to a weight of 1 and no buffer for every slave port.
+ *
  * Changes to the implementation of this component in the HDL source must be reflected in the implementation of this
  * function.
  */
@@ -21,11 +21,15 @@
 #include <thread>
 
 #include "fletcher/common.h"
+#include "fletcher/fletcher.h"
 #include "fletchgen/design.h"
 #include "fletchgen/recordbatch.h"
+#include "fletchgen/array.h"
 #include "fletchgen/mmio.h"
 #include "fletchgen/profiler.h"
 #include "fletchgen/bus.h"
+#include "fletchgen/utils.h"
+#include "fletchgen/wrapper.h"
 
 namespace fletchgen {
 
@@ -79,7 +83,7 @@ void Design::AnalyzeRecordBatches() {
   }
 }
 
-static std::vector<MmioReg> GetDefaultRegs() {
+static std::vector<MmioReg> GetDefaultRegs(uint64_t fingerprint, size_t num_replicas) {
   std::vector<MmioReg> result;
   result.emplace_back(MmioFunction::DEFAULT, MmioBehavior::STROBE, "start", "Start the kernel.", 1, 0, 0);
   result.emplace_back(MmioFunction::DEFAULT, MmioBehavior::STROBE, "stop", "Stop the kernel.", 1, 1, 0);
@@ -87,7 +91,17 @@ static std::vector<MmioReg> GetDefaultRegs() {
   result.emplace_back(MmioFunction::DEFAULT, MmioBehavior::STATUS, "idle", "Kernel idle status.", 1, 0, 4);
   result.emplace_back(MmioFunction::DEFAULT, MmioBehavior::STATUS, "busy", "Kernel busy status.", 1, 1, 4);
   result.emplace_back(MmioFunction::DEFAULT, MmioBehavior::STATUS, "done", "Kernel done status.", 1, 2, 4);
+  if (num_replicas > 1) {
+    // The run-time discovers the replicas through these fields. The window size is set after address assignment.
+    result.emplace_back(MmioFunction::DEFAULT, MmioBehavior::CONSTANT, "num_replicas", "Number of kernel replicas.",
+                        8, FLETCHER_REG_STATUS_REPLICAS, 4, num_replicas);
+    result.emplace_back(MmioFunction::DEFAULT, MmioBehavior::CONSTANT, "replica_window",
+                        "Log2 of the register window size of every replica in bytes.",
+                        8, FLETCHER_REG_STATUS_WINDOW, 4, 0);
+  }
   result.emplace_back(MmioFunction::DEFAULT, MmioBehavior::STATUS, "result", "Result.", 64, 0, 8);
+  result.emplace_back(MmioFunction::DEFAULT, MmioBehavior::CONSTANT, "fingerprint", "Schema set fingerprint.",
+                      64, 0, 16, fingerprint);
   return result;
 }
 
@@ -150,6 +164,91 @@ std::vector<MmioReg> Design::GetRecordBatchRegs(const std::vector<fletcher::Reco
       }
     }
   }
+
+  // Get the lengths of all dictionaries, such that the kernel knows how many entries to load.
+  for (const auto &r : batch_desc) {
+    for (const auto &f : r.fields) {
+      if (f.dictionary && !f.buffers.empty()) {
+        auto field_name = f.buffers.front().desc_.front();
+        MmioReg reg(MmioFunction::BATCH,
+                    MmioBehavior::CONTROL,
+                    r.name + "_" + field_name + "_length",
+                    r.name + " " + field_name + " number of dictionary entries.",
+                    32);
+        reg.meta[MMIO_DICTIONARY] = "true";
+        result.push_back(reg);
+      }
+    }
+  }
+  return result;
+}
+
+std::vector<BusDim> Design::GetBusDims(const SchemaSet &schema_set, const std::vector<std::string> &bus_specs) {
+  // The number of channels is determined by the highest channel any schema is assigned to.
+  size_t num_channels = 1;
+  for (const auto &schema : schema_set.schemas()) {
+    num_channels = std::max(num_channels, schema->bus_channel() + 1);
+  }
+
+  // Channels take their dimensions from the bus specifications on the command line, where the last specification
+  // applies to all remaining channels.
+  std::vector<BusDim> result;
+  for (size_t c = 0; c < num_channels; c++) {
+    auto spec = bus_specs.empty() ? "" : bus_specs[std::min(c, bus_specs.size() - 1)];
+    result.push_back(BusDim::FromString(spec, BusDim()));
+  }
+
+  // Schemas may override the dimensions of their channel, but all schemas on a channel must agree.
+  std::vector<std::string> overridden_by(num_channels);
+  for (const auto &schema : schema_set.schemas()) {
+    auto dims = schema->bus_dims();
+    if (!dims) {
+      continue;
+    }
+    auto c = schema->bus_channel();
+    if (overridden_by[c].empty()) {
+      result[c] = *dims;
+      overridden_by[c] = schema->name();
+    } else if (!(result[c] == *dims)) {
+      FLETCHER_LOG(FATAL, "Schemas " + overridden_by[c] + " and " + schema->name() + " are both assigned to memory "
+          "channel " + std::to_string(c) + " but specify different bus dimensions. Assign them to different channels.");
+    }
+  }
+
+  for (size_t c = 0; c < num_channels; c++) {
+    FLETCHER_LOG(DEBUG, "Memory channel " + std::to_string(c) + ": " + result[c].ToString());
+  }
+  return result;
+}
+
+std::shared_ptr<SchemaSet> Design::WithAutoEPC(const SchemaSet &schema_set,
+                                               const std::vector<BusDim> &bus_dims,
+                                               double utilization,
+                                               bool booleans_only) {
+  auto result = SchemaSet::Make(schema_set.name());
+  for (const auto &schema : schema_set.schemas()) {
+    auto dw = bus_dims[schema->bus_channel()].dw;
+    std::vector<std::shared_ptr<arrow::Field>> fields;
+    for (const auto &field : schema->arrow_schema()->fields()) {
+      if (booleans_only && (field->type()->id() != arrow::Type::BOOL)) {
+        fields.push_back(field);
+        continue;
+      }
+      auto meta = field->metadata();
+      if ((meta != nullptr) && (meta->FindKey(fletcher::meta::VALUE_EPC) != -1)) {
+        // Leave explicitly specified EPC untouched.
+        FLETCHER_LOG(INFO, "EPC of " << schema->name() << "." << field->name() << ": "
+            << fletcher::GetUIntMeta(*field, fletcher::meta::VALUE_EPC, 1) << " (from metadata)");
+        fields.push_back(field);
+        continue;
+      }
+      auto epc = GetAutoEPC(*field, dw, utilization);
+      FLETCHER_LOG(INFO, "EPC of " << schema->name() << "." << field->name() << ": " << epc
+          << " (bus data width " << dw << ")");
+      fields.push_back(epc > 1 ? fletcher::WithMetaEPC(*field, static_cast<int>(epc)) : field);
+    }
+    result->AppendSchema(arrow::schema(fields, schema->arrow_schema()->metadata()));
+  }
   return result;
 }
 
@@ -168,25 +267,53 @@ Design::Design(const std::shared_ptr<Options> &opts) {
   // The order in which to do this is from components that sink/source the kernel, to the kernel, and then to the
   // upper layers of the hierarchy.
 
+  // Determine the bus dimensions of every memory channel.
+  bus_dims = GetBusDims(*schema_set, opts->bus_dims);
+
+  // The fingerprint is based on the schemas as supplied, since the run-time compares it to the schemas of the
+  // RecordBatches it has, which do not carry any automatically derived metadata.
+  std::vector<std::shared_ptr<arrow::Schema>> arrow_schemas;
+  for (const auto &schema : schema_set->schemas()) {
+    arrow_schemas.push_back(schema->arrow_schema());
+  }
+
+  // Derive the elements-per-cycle of the fields, if requested. Boolean fields always get a derived EPC when it is not
+  // specified, because streaming a single bit per cycle would leave nearly all of the bus data width unused.
+  schema_set = WithAutoEPC(*schema_set, bus_dims, opts->epc_utilization, !opts->auto_epc);
+
   // Generate a RecordBatchReader/Writer component for every FletcherSchema / RecordBatchDesc.
   for (size_t i = 0; i < batch_desc.size(); i++) {
     auto schema = schema_set->schemas()[i];
     auto rb_desc = batch_desc[i];
-    auto rb = record_batch(opts->kernel_name + "_" + schema->name(), schema, rb_desc);
+    auto rb = record_batch(opts->kernel_name + "_" + schema->name(), schema, rb_desc, bus_dims[schema->bus_channel()]);
     recordbatch_comps.push_back(rb);
   }
 
   // Generate the MMIO component model for this. This is based on four things;
-  // 1. The default registers (like control, status, result).
-  // 2. The RecordBatchDescriptions - for every recordbatch we need a first and last index, and every buffer address.
+  // 1. The default registers (like control, status, result and the schema set fingerprint).
+  // 2. The RecordBatchDescriptions - for every recordbatch we need a first and last index, every buffer address, and
+  //    the length of every dictionary.
   // 3. The custom kernel registers, parsed from the command line arguments.
   // 4. The profiling registers, obtained from inspecting the generated recordbatches.
-  default_regs = GetDefaultRegs();
+  default_regs = GetDefaultRegs(fletcher::GetSchemaSetFingerprint(arrow_schemas), opts->replicas);
   recordbatch_regs = GetRecordBatchRegs(batch_desc);
   kernel_regs = ParseCustomRegs(opts->regs);
-  profiling_regs = GetProfilingRegs(recordbatch_comps);
-
-  auto bus_spec = BusDim::FromString(opts->bus_dims[0], BusDim());
+  profiling_regs = GetProfilingRegs(recordbatch_comps, opts->profile_width);
+  if (opts->bus_profile) {
+    auto bus_profiling_regs = GetBusProfilingRegs(recordbatch_comps, opts->profile_width);
+    profiling_regs.insert(profiling_regs.end(), bus_profiling_regs.begin(), bus_profiling_regs.end());
+  }
+  // Fix the register map, such that all back-ends see the same addresses.
+  auto map_size = AssignMmioAddresses(all_regs);
+  // Every replica gets a register window of the smallest power of two that holds the register map.
+  while ((size_t(1) << replica_window_width) < map_size) {
+    replica_window_width++;
+  }
+  for (auto &r : default_regs) {
+    if (r.name == "replica_window") {
+      r.init = replica_window_width;
+    }
+  }
 
   // Generate the MMIO component.
   mmio_comp = mmio(batch_desc, cerata::Merge({default_regs, recordbatch_regs, kernel_regs, profiling_regs}));
@@ -195,17 +322,41 @@ Design::Design(const std::shared_ptr<Options> &opts) {
   // Generate the nucleus.
   nucleus_comp = nucleus(opts->kernel_name + "_Nucleus", recordbatch_comps, kernel_comp, mmio_comp);
   // Generate the mantle.
-  mantle_comp = mantle(opts->kernel_name + "_Mantle", recordbatch_comps, nucleus_comp, bus_spec);
+  BusArbiterSpec arb_spec;
+  arb_spec.method = opts->arb_method;
+  arb_spec.max_outstanding = opts->arb_max_outstanding;
+  arb_spec.buffer_depth = opts->arb_buffer_depth;
+  mantle_comp = mantle(opts->kernel_name + "_Mantle", recordbatch_comps, nucleus_comp, bus_dims, arb_spec);
+  // Generate the wrapper, if the mantle is replicated.
+  if (opts->replicas > 1) {
+    wrapper_comp = wrapper(opts->kernel_name + "_Wrapper", mantle_comp, opts->replicas, replica_window_width);
+  }
+}
+
+Component *Design::top() const {
+  if (wrapper_comp) {
+    return wrapper_comp.get();
+  }
+  return mantle_comp.get();
 }
 
-void Design::RunVhdmmio(const std::vector<std::vector<MmioReg>*>& regs) {
+void Design::GenerateMmio(const std::vector<std::vector<MmioReg> *> &regs,
+                          const std::string &output_dir,
+                          OutputManifest *manifest) {
+  auto vhdl_dir = output_dir + "/vhdl";
+  manifest->Write(vhdl_dir + "/mmio_pkg.gen.vhd", DEFAULT_NOTICE + GenerateMmioPackage(regs));
+  manifest->Write(vhdl_dir + "/mmio.gen.vhd", DEFAULT_NOTICE + GenerateMmioVhdl(regs));
+}
+
+void Design::RunVhdmmio(const std::vector<std::vector<MmioReg> *> &regs, const std::string &output_dir) {
   // Generate a Yaml file for vhdmmio based on the recordbatch description
-  auto ofs = std::ofstream("fletchgen.mmio.yaml");
+  auto ofs = std::ofstream(output_dir + "/fletchgen.mmio.yaml");
   ofs << GenerateVhdmmioYaml(regs);
   ofs.close();
 
   // Run vhdmmio
-  auto vhdmmio_result = system("python3 -m vhdmmio -V vhdl -H -P vhdl > vhdmmio.log");
+  auto cmd = "cd \"" + output_dir + "\" && python3 -m vhdmmio -V vhdl -H -P vhdl > vhdmmio.log";
+  auto vhdmmio_result = system(cmd.c_str());
   if (vhdmmio_result != 0) {
     FLETCHER_LOG(FATAL, "vhdmmio exited with status " << vhdmmio_result);
   }
@@ -213,7 +364,13 @@ void Design::RunVhdmmio(const std::vector<std::vector<MmioReg>*>& regs) {
 
 std::vector<cerata::OutputSpec> Design::GetOutputSpec() {
   std::vector<OutputSpec> result;
-  OutputSpec mantle, kernel, nucleus;
+  OutputSpec wrapper, mantle, kernel, nucleus;
+
+  // Wrapper
+  if (wrapper_comp) {
+    wrapper.comp = wrapper_comp.get();
+    result.push_back(wrapper);
+  }
 
   // Mantle
   mantle.comp = mantle_comp.get();
@@ -234,12 +391,6 @@ std::vector<cerata::OutputSpec> Design::GetOutputSpec() {
     result.push_back(recordbatch);
   }
 
-  // Set backup mode for VHDL backend
-  std::string backup = options->backup ? "true" : "false";
-  for (auto &o : result) {
-    o.meta[cerata::vhdl::meta::BACKUP_EXISTING] = backup;
-  }
-
   return result;
 }
 
@@ -26,9 +26,11 @@
 #include "fletchgen/options.h"
 #include "fletchgen/kernel.h"
 #include "fletchgen/mantle.h"
+#include "fletchgen/wrapper.h"
 #include "fletchgen/bus.h"
 #include "fletchgen/recordbatch.h"
 #include "fletchgen/mmio.h"
+#include "fletchgen/manifest.h"
 
 namespace fletchgen {
 
@@ -59,6 +61,9 @@ struct Design {
   /// Pointers to all registers vectors.
   std::vector<std::vector<MmioReg> *> all_regs = {&default_regs, &recordbatch_regs, &kernel_regs, &profiling_regs};
 
+  /// The bus dimensions of every memory channel.
+  std::vector<BusDim> bus_dims;
+
   /// The RecordBatchDescriptions to use in SREC generation.
   std::vector<fletcher::RecordBatchDescription> batch_desc;
 
@@ -67,27 +72,67 @@ struct Design {
   /// The Kernel component of this design.
   std::shared_ptr<Kernel> kernel_comp;
 
-  /// The top-level wrapper (mantle) of the design. This is not called wrapper because this is reserved for future top
-  /// levels that instantiate multiple mantles to operate in parallel.
+  /// The Mantle of the design, that wraps the Nucleus and all RecordBatches.
   std::shared_ptr<Mantle> mantle_comp;
 
+  /// The Wrapper that instantiates multiple replicas of the Mantle, if the design is replicated.
+  std::shared_ptr<Wrapper> wrapper_comp;
+
+  /// Log2 of the size of the register window of every replica, in bytes.
+  size_t replica_window_width = 2;
+
   /// The Nucleus component, that wraps the kernel and mmio.
   std::shared_ptr<Nucleus> nucleus_comp;
 
   /// The Nucleus-level component generated by vhdmmio
   std::shared_ptr<Component> mmio_comp;
 
+  /// @brief Return the top-level component of the design; the Wrapper if there is one, otherwise the Mantle.
+  [[nodiscard]] Component *top() const;
+
   /// @brief Obtain a Cerata OutputSpec from this design for Cerata back-ends to generate output.
   std::vector<cerata::OutputSpec> GetOutputSpec();
 
   /// @brief Obtain requited mmio registers based on the RecordBatch descriptions.
   static std::vector<MmioReg> GetRecordBatchRegs(const std::vector<fletcher::RecordBatchDescription> &batch_desc);
 
+  /**
+   * @brief Determine the bus dimensions of every memory channel.
+   *
+   * There are as many channels as required by the highest channel any schema is assigned to through its metadata.
+   * A channel takes its dimensions from the bus specification metadata of the schemas assigned to it, if any.
+   * Otherwise, the bus specification string with the same index is used, or the last one if there are fewer strings
+   * than channels.
+   *
+   * @param schema_set  The schemas of the design.
+   * @param bus_specs   Bus specification strings of the form "aw,dw,lw,bs,bm".
+   * @return            The bus dimensions of every channel.
+   */
+  static std::vector<BusDim> GetBusDims(const SchemaSet &schema_set, const std::vector<std::string> &bus_specs);
+
+  /**
+   * @brief Derive the elements-per-cycle of all fields without EPC metadata from the bus data width of their schema.
+   * @param schema_set     The schemas of the design.
+   * @param bus_dims       The bus dimensions of every memory channel.
+   * @param utilization    The targeted fraction of the bus data width used by every field stream.
+   * @param booleans_only  Whether to only derive the elements-per-cycle of boolean fields.
+   * @return               A copy of the schema set, where fields that can have EPC > 1 carry EPC metadata.
+   */
+  static std::shared_ptr<SchemaSet> WithAutoEPC(const SchemaSet &schema_set,
+                                                const std::vector<BusDim> &bus_dims,
+                                                double utilization,
+                                                bool booleans_only = false);
+
   /// @brief Obtain required custom registers based on a vector of strings.
   static std::vector<MmioReg> ParseCustomRegs(const std::vector<std::string> &regs);
 
-  /// @brief Generate vhdmmio yaml and run it.
-  static void RunVhdmmio(const std::vector<std::vector<MmioReg> *>& regs);
+  /// @brief Generate the MMIO component VHDL sources in the vhdl subfolder of the output directory, if they changed.
+  static void GenerateMmio(const std::vector<std::vector<MmioReg> *> &regs,
+                           const std::string &output_dir,
+                           OutputManifest *manifest);
+
+  /// @brief Generate vhdmmio yaml and run vhdmmio in the output directory.
+  static void RunVhdmmio(const std::vector<std::vector<MmioReg> *> &regs, const std::string &output_dir);
 };
 
 }  // namespace fletchgen
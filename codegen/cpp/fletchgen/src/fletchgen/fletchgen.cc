@@ -17,15 +17,22 @@
 #include <cerata/api.h>
 #include <fletcher/common.h>
 
+#include <algorithm>
 #include <fstream>
+#include <functional>
+#include <sstream>
 #include <thread>
+#include <vector>
 
 #include "fletchgen/options.h"
 #include "fletchgen/design.h"
+#include "fletchgen/manifest.h"
 #include "fletchgen/utils.h"
 #include "fletchgen/srec/recordbatch.h"
 #include "fletchgen/top/sim.h"
 #include "fletchgen/top/axi.h"
+#include "fletchgen/top/cosim.h"
+#include "fletchgen/host/header.h"
 
 namespace fletchgen {
 
@@ -70,40 +77,37 @@ int fletchgen(int argc, char **argv) {
 
   // Generate the whole Cerata design.
   fletchgen::Design design(options);
-  // Run vhdmmio to generate the mmio infrastructure.
-  std::thread vhdmmio(Design::RunVhdmmio, design.all_regs);
-
-
-  // Generate SREC output
-  if (options->MustGenerateSREC()) {
-    FLETCHER_LOG(INFO, "Generating SREC output.");
-    auto srec_out = std::ofstream(options->srec_out_path);
-    fletchgen::srec::GenerateReadSREC(design.batch_desc, &srec_batch_desc, &srec_out, 64);
-    srec_out.close();
+  // Run vhdmmio to generate the mmio infrastructure, if requested. Otherwise it is generated with the VHDL output.
+  std::thread vhdmmio;
+  if (options->vhdmmio) {
+    vhdmmio = std::thread(Design::RunVhdmmio, design.all_regs, options->output_dir);
   }
 
+  // All output files are written through the manifest, which leaves files that did not change untouched.
+  OutputManifest manifest(options->output_dir, options->backup);
+
   auto &l = options->languages;
+  bool gen_srec = options->MustGenerateSREC();
+  bool gen_dot = options->MustGenerate("dot");
+  bool gen_vhdl = options->MustGenerate("vhdl");
+  bool gen_cpp = options->MustGenerate("cpp");
+  bool gen_sim = options->MustGenerateDesign() && options->sim_top;
+  bool gen_axi = options->axi_top;
+  bool gen_cosim = options->cosim_top;
 
-  // Generate DOT output.
-  if (options->MustGenerate("dot")) {
-    FLETCHER_LOG(INFO, "Generating DOT output.");
-    auto dot = cerata::dot::DOTOutputGenerator(options->output_dir, design.GetOutputSpec());
-    dot.Generate();
-    // Remove dot from the list of target languages
-    l.erase(std::remove(l.begin(), l.end(), std::string("dot")), l.end());
+  // The simulation, AXI and co-simulation top-levels only connect a single memory channel.
+  if ((gen_sim || gen_axi || gen_cosim) && (design.bus_dims.size() > 1)) {
+    FLETCHER_LOG(ERROR, "Simulation, AXI and co-simulation top-levels support only a single memory channel, but the "
+                        "design has " << design.bus_dims.size() << " channels. The top-levels will not be generated.");
+    gen_sim = false;
+    gen_axi = false;
+    gen_cosim = false;
   }
 
-  // Generate VHDL output
-  if (options->MustGenerate("vhdl")) {
-    FLETCHER_LOG(INFO, "Generating VHDL output.");
-    auto vhdl = cerata::vhdl::VHDLOutputGenerator(options->output_dir,
-                                                  design.GetOutputSpec(),
-                                                  fletchgen::DEFAULT_NOTICE);
-    vhdl.Generate();
-    // Remove vhdl from the list of target languages
-    l.erase(std::remove(l.begin(), l.end(), std::string("vhdl")), l.end());
+  // Remove the supported languages from the list of target languages.
+  for (const auto &lang : {"dot", "vhdl", "cpp"}) {
+    l.erase(std::remove(l.begin(), l.end(), std::string(lang)), l.end());
   }
-
   // Check if any other languages were requested; they are not supported.
   // Generate warnings.
   if (!l.empty()) {
@@ -113,34 +117,151 @@ int fletchgen(int argc, char **argv) {
     }
   }
 
-  // Generate simulation top level
-  if (options->MustGenerateDesign() && options->sim_top) {
-    std::ofstream sim_file;
-    std::string sim_file_path = options->output_dir + "/vhdl/SimTop_tc.gen.vhd";
-    FLETCHER_LOG(INFO, "Saving simulation top-level design to: " + sim_file_path);
-    sim_file = std::ofstream(sim_file_path);
+  // Output that only requires building strings from the design is generated in parallel, before and after the Cerata
+  // back-ends. Every such task only generates the contents of its output, which are written through the manifest
+  // afterwards in a fixed order, such that the output does not depend on the number of jobs. The Cerata back-ends
+  // share components, types and node pools, and the VHDL back-end transforms the components it generates output for,
+  // so they run serially on the main thread: DOT output before VHDL output, and the top-level designs after that.
+  // The SREC or memory image only reads the RecordBatch descriptions of the design, which the back-ends do not touch,
+  // so it is generated on a worker thread alongside them, and joined before the simulation top-level needs it.
+  auto specs = design.GetOutputSpec();
+  std::vector<std::function<void()>> tasks;
+  auto run_tasks = [&]() {
+    ParallelFor(tasks.size(), options->jobs, [&](size_t i) { tasks[i](); });
+    tasks.clear();
+  };
+
+  // Phase 1: start the SREC or memory image, and generate the C++ host header.
+  // The SREC or memory image can be much larger than the RecordBatches, so it is streamed to a temporary file next to
+  // its output path, and compared with the existing output in chunks before it is committed.
+  std::string srec_tmp_path;
+  std::string image_layout;
+  std::thread srec_worker;
+  bool gen_image = options->sim_format == "bin";
+  if (gen_srec) {
+    FLETCHER_LOG(INFO, "Generating " << (gen_image ? "memory image" : "SREC") << " output.");
+    srec_tmp_path = OutputManifest::TempPath(options->srec_out_path);
+    auto gen_srec_output = [&]() {
+      std::ofstream srec_out(srec_tmp_path, std::ios::binary);
+      if (!srec_out.good()) {
+        FLETCHER_LOG(FATAL, "Could not open " + srec_tmp_path + " for writing.");
+      }
+      if (gen_image) {
+        auto size = fletchgen::srec::GenerateReadImage(design.batch_desc, &srec_batch_desc, &srec_out, 64);
+        image_layout = fletchgen::srec::GenerateImageLayout(srec_batch_desc, size, 64);
+      } else {
+        fletchgen::srec::GenerateReadSREC(design.batch_desc, &srec_batch_desc, &srec_out, 64, options->jobs);
+      }
+      srec_out.close();
+    };
+    if (options->jobs == 1) {
+      gen_srec_output();
+    } else {
+      srec_worker = std::thread(gen_srec_output);
+    }
+  }
+  std::stringstream header;
+  std::string header_path = options->output_dir + "/cpp/" + options->kernel_name + ".h";
+  std::stringstream profile_map;
+  std::string profile_map_path = options->output_dir + "/cpp/" + options->kernel_name + "_profile.json";
+  if (gen_cpp) {
+    FLETCHER_LOG(INFO, "Generating C++ host header.");
+    tasks.emplace_back([&]() { fletchgen::host::GenerateHostHeader(design, {&header}); });
+    tasks.emplace_back([&]() { fletchgen::host::GenerateProfileMap(design, {&profile_map}); });
+  }
+  run_tasks();
+
+  // Phase 2: DOT and VHDL of every component, serially.
+  if (gen_dot) {
+    FLETCHER_LOG(INFO, "Generating DOT output.");
+    auto dot = cerata::dot::DOTOutputGenerator(manifest.staging_dir(), specs);
+    dot.Generate();
+  }
+  if (gen_vhdl) {
+    FLETCHER_LOG(INFO, "Generating VHDL output.");
+    auto vhdl = cerata::vhdl::VHDLOutputGenerator(manifest.staging_dir(), specs, fletchgen::DEFAULT_NOTICE);
+    vhdl.Generate();
+  }
+
+  // The simulation top-level depends on the layout of the SREC or memory image.
+  if (srec_worker.joinable()) {
+    srec_worker.join();
+  }
+
+  // Phase 3: top-level designs.
+  std::stringstream sim_file;
+  std::string sim_file_path = options->output_dir + "/vhdl/SimTop_tc.gen.vhd";
+  if (gen_sim) {
+    FLETCHER_LOG(INFO, "Generating simulation top-level design.");
     // If the srec simulation dump path doesn't exist, it can't be canonicalized later on.
     if (!cerata::FileExists(options->srec_sim_dump)) {
       // Just touch the file.
-      std::ofstream srec_out(options->srec_sim_dump);
-      srec_out.close();
+      std::ofstream srec_dump(options->srec_sim_dump);
+      srec_dump.close();
+    }
+    tasks.emplace_back([&]() {
+      fletchgen::top::GenerateSimTop(design,
+                                     {&sim_file},
+                                     options->srec_out_path,
+                                     options->srec_sim_dump,
+                                     srec_batch_desc,
+                                     options->sim_format);
+    });
+  }
+  std::stringstream axi_file;
+  std::string axi_file_path = options->output_dir + "/vhdl/AxiTop.gen.vhd";
+  if (gen_axi) {
+    FLETCHER_LOG(INFO, "Generating AXI top-level design.");
+    tasks.emplace_back([&]() {
+      fletchgen::top::GenerateAXITop(*design.top(), *design.schema_set, {&axi_file}, design.bus_dims.front());
+    });
+  }
+  std::stringstream cosim_file;
+  std::string cosim_file_path = options->output_dir + "/vhdl/CosimTop.gen.vhd";
+  if (gen_cosim) {
+    FLETCHER_LOG(INFO, "Generating co-simulation top-level design.");
+    tasks.emplace_back([&]() { fletchgen::top::GenerateCosimTop(design, {&cosim_file}); });
+  }
+  run_tasks();
+
+  // Write all output.
+  if (gen_srec) {
+    FLETCHER_LOG(INFO, "Saving " << (gen_image ? "memory image" : "SREC") << " output to: " + options->srec_out_path);
+    manifest.CommitFile(srec_tmp_path, options->srec_out_path);
+    if (gen_image) {
+      manifest.Write(options->srec_out_path + ".json", image_layout);
+    }
+  }
+  if (gen_dot) {
+    for (const auto &o : specs) {
+      manifest.Commit("dot/" + o.comp->name() + ".dot");
+    }
+  }
+  if (gen_vhdl) {
+    for (const auto &o : specs) {
+      manifest.Commit("vhdl/" + o.comp->name() + ".gen.vhd");
     }
-    fletchgen::top::GenerateSimTop(design,
-                                   {&sim_file},
-                                   options->srec_out_path,
-                                   options->srec_sim_dump,
-                                   srec_batch_desc);
-    sim_file.close();
-  }
-
-  // Generate AXI top level
-  if (options->axi_top) {
-    std::ofstream axi_file;
-    std::string axi_file_path = options->output_dir + "/vhdl/AxiTop.gen.vhd";
+    if (!options->vhdmmio) {
+      Design::GenerateMmio(design.all_regs, options->output_dir, &manifest);
+    }
+  }
+  if (gen_cpp) {
+    FLETCHER_LOG(INFO, "Saving C++ host header to: " + header_path);
+    manifest.Write(header_path, header.str());
+    FLETCHER_LOG(INFO, "Saving profile register map to: " + profile_map_path);
+    manifest.Write(profile_map_path, profile_map.str());
+  }
+  if (gen_sim) {
+    FLETCHER_LOG(INFO, "Saving simulation top-level design to: " + sim_file_path);
+    manifest.Write(sim_file_path, sim_file.str());
+  }
+  if (gen_axi) {
     FLETCHER_LOG(INFO, "Saving AXI top-level design to: " + axi_file_path);
-    axi_file = std::ofstream(axi_file_path);
-    fletchgen::top::GenerateAXITop(*design.mantle_comp, *design.schema_set, {&axi_file});
-    axi_file.close();
+    manifest.Write(axi_file_path, axi_file.str());
+  }
+  if (gen_cosim) {
+    FLETCHER_LOG(INFO, "Saving co-simulation top-level design to: " + cosim_file_path);
+    manifest.Write(cosim_file_path, cosim_file.str());
   }
 
   // Generate Vivado HLS template
@@ -156,10 +277,14 @@ int fletchgen(int argc, char **argv) {
   }
 
   // Wait for vhdmmio.
-  if (!vhdmmio.joinable()) {
+  if (vhdmmio.joinable()) {
     FLETCHER_LOG(INFO, "Waiting for vhdmmio to complete...");
+    vhdmmio.join();
   }
-  vhdmmio.join();
+
+  // Clean up and save the manifest, such that build tools can find out which files changed.
+  manifest.RemoveStaging();
+  manifest.Save();
 
   FLETCHER_LOG(INFO, program_name + " completed.");
 
@@ -0,0 +1,547 @@
+// Copyright 2018-2019 Delft University of Technology
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "fletchgen/host/header.h"
+
+#include <fletcher/common.h>
+#include <algorithm>
+#include <cctype>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "fletchgen/profiler.h"
+#include "fletchgen/utils.h"
+
+namespace fletchgen::host {
+
+/// @brief Turn a register or kernel name into a valid C++ identifier.
+static std::string ToIdentifier(const std::string &name) {
+  std::string result;
+  for (auto c : name) {
+    result.push_back(std::isalnum(static_cast<unsigned char>(c)) ? c : '_');
+  }
+  if (result.empty() || std::isdigit(static_cast<unsigned char>(result[0]))) {
+    result.insert(result.begin(), '_');
+  }
+  return result;
+}
+
+/// @brief Return the number of 32-bit MMIO words a register spans.
+static uint32_t NumWords(const MmioReg &reg) {
+  return (reg.index + reg.width + 31) / 32;
+}
+
+/// @brief Return the host-side type to hold the value of a register, and an optional array suffix.
+static std::pair<std::string, std::string> HostType(const MmioReg &reg) {
+  if (reg.width <= 32) {
+    return {"uint32_t", ""};
+  } else if (reg.width <= 64) {
+    return {"uint64_t", ""};
+  } else {
+    return {"uint32_t", "[" + std::to_string(NumWords(reg)) + "]"};
+  }
+}
+
+/// @brief Return the expression to obtain the w-th 32-bit word of an argument value.
+static std::string ArgumentWord(const MmioReg &reg, uint32_t w) {
+  auto field = "args." + ToIdentifier(reg.name);
+  if (reg.width <= 32) {
+    return field;
+  } else if (reg.width <= 64) {
+    return "static_cast<uint32_t>(" + field + (w == 0 ? "" : " >> 32u") + ")";
+  } else {
+    return field + "[" + std::to_string(w) + "]";
+  }
+}
+
+/// @brief Return a register from a list by name, or nullptr if it does not exist.
+static const MmioReg *FindReg(const std::vector<MmioReg> &regs, const std::string &name) {
+  for (const auto &r : regs) {
+    if (r.name == name) {
+      return &r;
+    }
+  }
+  return nullptr;
+}
+
+/// @brief Generate a static assertion that a register lies at the offset the run-time assumes.
+static std::string AssertOffset(const std::string &expected, const std::string &reg, const std::string &what) {
+  return "static_assert(" + expected + " == regs::" + reg + ".offset,\n"
+         "              \"" + what + " offset does not match the Fletcher run-time.\");\n";
+}
+
+/// The profiling registers of a profiled stream.
+struct ProfiledStream {
+  /// Name of the stream.
+  std::string name;
+  /// Bit width of the elements of the stream, or zero if it is not known.
+  uint32_t element_width = 0;
+  /// The counter registers, in the order of PROFILE_COUNTERS.
+  std::vector<const MmioReg *> counters;
+  /// The stall histogram bucket registers, if any.
+  std::vector<const MmioReg *> stall_histogram;
+  /// The starve histogram bucket registers, if any.
+  std::vector<const MmioReg *> starve_histogram;
+};
+
+/// Names of the counters of a stream profiler, as suffixed to the names of the profiling registers.
+static const std::vector<std::string> PROFILE_COUNTERS = {"elements", "valids", "readies", "transfers", "packets",
+                                                          "cycles"};
+
+/// @brief Collect the profiled streams of a design, in register map order.
+static std::vector<ProfiledStream> GetProfiledStreams(const Design &design) {
+  std::vector<ProfiledStream> result;
+  for (const auto &r : design.profiling_regs) {
+    if (r.meta.count(MMIO_PROFILE_STREAM) == 0) {
+      continue;
+    }
+    const auto &name = r.meta.at(MMIO_PROFILE_STREAM);
+    if (result.empty() || (result.back().name != name)) {
+      ProfiledStream stream;
+      stream.name = name;
+      stream.element_width = static_cast<uint32_t>(std::stoul(r.meta.at(MMIO_PROFILE_ELEMENT_WIDTH)));
+      stream.counters.resize(PROFILE_COUNTERS.size(), nullptr);
+      result.push_back(stream);
+    }
+    for (size_t c = 0; c < PROFILE_COUNTERS.size(); c++) {
+      if (r.name == "Profile_" + name + "_" + PROFILE_COUNTERS[c]) {
+        result.back().counters[c] = &r;
+      }
+    }
+    // Histogram buckets follow the counters in bucket order.
+    if (r.name.rfind("Profile_" + name + "_stall_", 0) == 0) {
+      result.back().stall_histogram.push_back(&r);
+    } else if (r.name.rfind("Profile_" + name + "_starve_", 0) == 0) {
+      result.back().starve_histogram.push_back(&r);
+    }
+  }
+  for (const auto &s : result) {
+    if (std::find(s.counters.begin(), s.counters.end(), nullptr) != s.counters.end()) {
+      FLETCHER_LOG(FATAL, "Incomplete set of profiling registers for stream " + s.name + ".");
+    }
+  }
+  return result;
+}
+
+/// The profiling registers of a profiled bus.
+struct ProfiledBus {
+  /// Name of the bus.
+  std::string name;
+  /// Bit width of the data of the bus.
+  uint32_t data_width = 0;
+  /// The counter registers, in the order of BUS_PROFILE_COUNTERS.
+  std::vector<const MmioReg *> counters;
+  /// The register that is high while a snapshot is in progress.
+  const MmioReg *busy = nullptr;
+};
+
+/// Names of the counters of a bus profiler, in the order of BusProfileRegNames.
+static const std::vector<std::string> BUS_PROFILE_COUNTERS = {"req_beats", "dat_beats", "req_stalls",
+                                                              "max_outstanding", "cycles"};
+
+/// @brief Collect the profiled buses of a design, in register map order.
+static std::vector<ProfiledBus> GetProfiledBuses(const Design &design) {
+  std::vector<ProfiledBus> result;
+  for (const auto &r : design.profiling_regs) {
+    if (r.meta.count(MMIO_PROFILE_BUS) == 0) {
+      continue;
+    }
+    const auto &name = r.meta.at(MMIO_PROFILE_BUS);
+    if (result.empty() || (result.back().name != name)) {
+      ProfiledBus bus;
+      bus.name = name;
+      bus.data_width = static_cast<uint32_t>(std::stoul(r.meta.at(MMIO_PROFILE_DATA_WIDTH)));
+      bus.counters.resize(BUS_PROFILE_COUNTERS.size(), nullptr);
+      result.push_back(bus);
+    }
+    auto names = BusProfileRegNames(name);
+    for (size_t c = 0; c < names.size(); c++) {
+      if (r.name == names[c]) {
+        result.back().counters[c] = &r;
+      }
+    }
+    if (r.name == BusProfileBusyRegName(name)) {
+      result.back().busy = &r;
+    }
+  }
+  for (const auto &b : result) {
+    if ((b.busy == nullptr) || (std::find(b.counters.begin(), b.counters.end(), nullptr) != b.counters.end())) {
+      FLETCHER_LOG(FATAL, "Incomplete set of profiling registers for bus " + b.name + ".");
+    }
+  }
+  return result;
+}
+
+std::string GenerateHostHeader(const Design &design, const std::vector<std::ostream *> &outputs) {
+  std::stringstream str;
+
+  // Collect the custom kernel registers and the total size of the register map.
+  std::vector<MmioReg> arguments;
+  std::vector<MmioReg> results;
+  size_t num_buffers = 0;
+  size_t num_dictionaries = 0;
+  uint64_t num_words = 0;
+  for (const auto &regs : design.all_regs) {
+    for (const auto &r : *regs) {
+      if (!r.addr) {
+        FLETCHER_LOG(FATAL, "Register " + r.name + " has no address.");
+      }
+      num_words = std::max<uint64_t>(num_words, *r.addr / 4 + NumWords(r));
+      if (r.function == MmioFunction::BUFFER) {
+        num_buffers++;
+      }
+      if (r.meta.count(MMIO_DICTIONARY) > 0) {
+        num_dictionaries++;
+      }
+    }
+  }
+  for (const auto &r : design.kernel_regs) {
+    if (r.behavior == MmioBehavior::CONTROL) {
+      arguments.push_back(r);
+    } else if (r.behavior == MmioBehavior::STATUS) {
+      results.push_back(r);
+    }
+  }
+  uint64_t fingerprint = 0;
+  if (auto fp = FindReg(design.default_regs, "fingerprint")) {
+    fingerprint = fp->init.value_or(0);
+  }
+
+  auto kernel_name = ToIdentifier(design.options->kernel_name);
+
+  str << "// This file was generated by Fletchgen. Modify this file at your own risk.\n"
+         "//\n"
+         "// Host-side register map of kernel " << design.options->kernel_name << ".\n"
+         "\n"
+         "#pragma once\n"
+         "\n"
+         "#include <fletcher/api.h>\n"
+         "#include <cstddef>\n"
+         "#include <cstdint>\n"
+         "#include <string>\n"
+         "#include <utility>\n"
+         "\n"
+         "namespace " << HOST_NAMESPACE << " {\n"
+         "namespace " << kernel_name << " {\n"
+         "\n"
+         "/// A register in the MMIO register map.\n"
+         "struct Register {\n"
+         "  /// Offset of the (first) 32-bit word of the register, as used by fletcher::Platform::WriteMMIO/ReadMMIO.\n"
+         "  uint64_t offset;\n"
+         "  /// Position of the least significant bit of the register within the word.\n"
+         "  uint32_t index;\n"
+         "  /// Bit width of the register. Registers wider than 32 bits span consecutive words, least significant first.\n"
+         "  uint32_t width;\n"
+         "};\n"
+         "\n"
+         "/// All registers of the kernel.\n"
+         "namespace regs {\n";
+  for (const auto &regs : design.all_regs) {
+    for (const auto &r : *regs) {
+      if (!r.desc.empty()) {
+        str << "/// " << r.desc << "\n";
+      }
+      str << "constexpr Register " << ToIdentifier(r.name) << " = {"
+          << *r.addr / 4 << ", " << r.index << ", " << r.width << "};\n";
+    }
+  }
+  str << "}  // namespace regs\n"
+         "\n"
+         "/// Fingerprint of the schema set this kernel was generated for.\n"
+         "constexpr uint64_t kFingerprint = 0x"
+      << std::hex << std::setw(16) << std::setfill('0') << fingerprint << std::dec << "ULL;\n"
+      << "/// Number of RecordBatches.\n"
+         "constexpr size_t kNumRecordBatches = " << design.batch_desc.size() << ";\n"
+      << "/// Number of buffers of all RecordBatches.\n"
+         "constexpr size_t kNumBuffers = " << num_buffers << ";\n"
+      << "/// Number of dictionary-encoded fields of all RecordBatches.\n"
+         "constexpr size_t kNumDictionaries = " << num_dictionaries << ";\n"
+      << "/// Number of 32-bit words in the register map.\n"
+         "constexpr uint64_t kNumWords = " << num_words << ";\n"
+      << "/// Number of kernel replicas. Replica i occupies the register map at word offset i * kReplicaWindowWords.\n"
+         "constexpr size_t kNumReplicas = " << design.options->replicas << ";\n"
+      << "/// Number of 32-bit words in the register window of every replica.\n"
+         "constexpr uint64_t kReplicaWindowWords = " << ((uint64_t(1) << design.replica_window_width) / 4) << ";\n"
+         "\n";
+
+  // Check the register map against the assumptions of the run-time.
+  str << AssertOffset("FLETCHER_REG_CONTROL", "start", "Control register");
+  str << AssertOffset("FLETCHER_REG_STATUS", "idle", "Status register");
+  str << AssertOffset("FLETCHER_REG_RETURN0", "result", "Return register");
+  str << AssertOffset("FLETCHER_REG_FINGERPRINT", "fingerprint", "Fingerprint register");
+  if (!design.recordbatch_regs.empty()) {
+    str << AssertOffset("FLETCHER_REG_SCHEMA", ToIdentifier(design.recordbatch_regs.front().name),
+                        "First RecordBatch register");
+  }
+  if (!design.kernel_regs.empty()) {
+    str << AssertOffset("FLETCHER_REG_SCHEMA + 2 * kNumRecordBatches + 2 * kNumBuffers + kNumDictionaries",
+                        ToIdentifier(design.kernel_regs.front().name),
+                        "First kernel register");
+  }
+  str << "\n";
+
+  // Kernel arguments.
+  str << "/// Arguments of the kernel, written to the custom control registers.\n"
+         "struct Arguments {\n";
+  for (const auto &r : arguments) {
+    auto type = HostType(r);
+    str << "  /// " << r.desc << "\n"
+        << "  " << type.first << " " << ToIdentifier(r.name) << type.second << ";\n";
+  }
+  str << "};\n"
+         "\n";
+
+  // Kernel results.
+  str << "/// Results of the kernel, read from the custom status registers.\n"
+         "struct Results {\n";
+  for (const auto &r : results) {
+    auto type = HostType(r);
+    str << "  /// " << r.desc << "\n"
+        << "  " << type.first << " " << ToIdentifier(r.name) << type.second << ";\n";
+  }
+  str << "};\n"
+         "\n";
+
+  // Writing the arguments.
+  str << "/// @brief Write the kernel arguments to the MMIO registers of every kernel replica.\n"
+         "inline fletcher::Status WriteArguments(fletcher::Platform *platform, const Arguments &args) {\n";
+  if (arguments.empty()) {
+    str << "  (void) platform;\n"
+           "  (void) args;\n";
+  } else {
+    str << "  const std::pair<uint64_t, uint32_t> writes[] = {\n";
+    for (const auto &r : arguments) {
+      for (uint32_t w = 0; w < NumWords(r); w++) {
+        str << "      {regs::" << ToIdentifier(r.name) << ".offset + " << w << ", " << ArgumentWord(r, w) << "},\n";
+      }
+    }
+    str << "  };\n"
+           "  for (size_t r = 0; r < kNumReplicas; r++) {\n"
+           "    for (const auto &w : writes) {\n"
+           "      auto status = platform->WriteMMIO(w.first + r * kReplicaWindowWords, w.second);\n"
+           "      if (!status.ok()) return status;\n"
+           "    }\n"
+           "  }\n";
+  }
+  str << "  return fletcher::Status::OK();\n"
+         "}\n"
+         "\n";
+
+  // Reading the results.
+  str << "/// @brief Read the kernel results from the MMIO registers of a kernel replica.\n"
+         "inline fletcher::Status ReadResults(fletcher::Platform *platform, Results *results, size_t replica = 0) {\n"
+         "  if (replica >= kNumReplicas) {\n"
+         "    return fletcher::Status::ERROR(\"Kernel has no replica \" + std::to_string(replica) + \".\");\n"
+         "  }\n";
+  if (results.empty()) {
+    str << "  (void) platform;\n"
+           "  (void) results;\n";
+  } else {
+    str << "  uint64_t base = replica * kReplicaWindowWords;\n"
+           "  fletcher::Status status;\n";
+    for (const auto &r : results) {
+      auto name = ToIdentifier(r.name);
+      if (r.width <= 32) {
+        str << "  status = platform->ReadMMIO(base + regs::" << name << ".offset, &results->" << name << ");\n";
+      } else if (r.width <= 64) {
+        str << "  status = platform->ReadMMIO64(base + regs::" << name << ".offset, &results->" << name << ");\n";
+      } else {
+        for (uint32_t w = 0; w < NumWords(r); w++) {
+          str << "  status = platform->ReadMMIO(base + regs::" << name << ".offset + " << w
+              << ", &results->" << name << "[" << w << "]);\n";
+          if (w + 1 < NumWords(r)) {
+            str << "  if (!status.ok()) return status;\n";
+          }
+        }
+      }
+      str << "  if (!status.ok()) return status;\n";
+    }
+  }
+  str << "  return fletcher::Status::OK();\n"
+         "}\n"
+         "\n";
+
+  // Other helpers.
+  str << "/// @brief Return true if the kernel on the platform implements the schema set this header was generated for.\n"
+         "inline bool Matches(fletcher::Platform *platform) {\n"
+         "  uint64_t fingerprint = 0;\n"
+         "  return platform->ReadMMIO64(regs::fingerprint.offset, &fingerprint).ok() && (fingerprint == kFingerprint);\n"
+         "}\n"
+         "\n"
+         "/**\n"
+         " * @brief Write the kernel arguments to every kernel replica and start the kernel.\n"
+         " *\n"
+         " * The RecordBatch ranges and buffer addresses are written by the kernel if this was not done already.\n"
+         " */\n"
+         "inline fletcher::Status Launch(fletcher::Kernel *kernel, const Arguments &args) {\n"
+         "  auto status = WriteArguments(kernel->context()->platform().get(), args);\n"
+         "  if (!status.ok()) return status;\n"
+         "  return kernel->Start();\n"
+         "}\n"
+         "\n";
+
+  // Profiling registers.
+  auto streams = GetProfiledStreams(design);
+  auto enable = FindReg(design.profiling_regs, PROFILE_ENABLE);
+  auto clear = FindReg(design.profiling_regs, PROFILE_CLEAR);
+  auto snapshot = FindReg(design.profiling_regs, PROFILE_SNAPSHOT);
+  auto buses = GetProfiledBuses(design);
+  auto bus_enable = FindReg(design.profiling_regs, BUS_PROFILE_ENABLE);
+  auto bus_clear = FindReg(design.profiling_regs, BUS_PROFILE_CLEAR);
+  auto bus_snapshot = FindReg(design.profiling_regs, BUS_PROFILE_SNAPSHOT);
+  if ((enable != nullptr) && (clear != nullptr)) {
+    str << "/// @brief Return the profiling registers of the kernel, to be used with fletcher::Profiler.\n"
+           "inline fletcher::ProfileMap GetProfileMap() {\n"
+           "  fletcher::ProfileMap map;\n"
+           "  map.enable = regs::" << ToIdentifier(enable->name) << ".offset;\n"
+        << "  map.clear = regs::" << ToIdentifier(clear->name) << ".offset;\n";
+    if (snapshot != nullptr) {
+      str << "  map.snapshot = regs::" << ToIdentifier(snapshot->name) << ".offset;\n"
+             "  map.has_snapshot = true;\n";
+    }
+    if (!streams.empty()) {
+      str << "  map.counter_width = " << streams.front().counters.front()->width << ";\n";
+    } else if (!buses.empty()) {
+      str << "  map.counter_width = " << buses.front().counters.front()->width << ";\n";
+    }
+    for (const auto &s : streams) {
+      str << "  {\n"
+             "    fletcher::ProfileStreamRegs s;\n"
+             "    s.name = " << JsonString(s.name) << ";\n"  // JSON string escapes are valid in C++ too.
+          << "    s.element_width = " << s.element_width << ";\n";
+      for (size_t c = 0; c < PROFILE_COUNTERS.size(); c++) {
+        str << "    s." << PROFILE_COUNTERS[c] << " = regs::" << ToIdentifier(s.counters[c]->name) << ".offset;\n";
+      }
+      for (const auto &h : {std::make_pair("stall_histogram", &s.stall_histogram),
+                            std::make_pair("starve_histogram", &s.starve_histogram)}) {
+        if (!h.second->empty()) {
+          str << "    s." << h.first << " = {";
+          for (size_t b = 0; b < h.second->size(); b++) {
+            str << (b == 0 ? "" : ", ") << "regs::" << ToIdentifier((*h.second)[b]->name) << ".offset";
+          }
+          str << "};\n";
+        }
+      }
+      str << "    map.streams.push_back(s);\n"
+             "  }\n";
+    }
+    if ((bus_enable != nullptr) && (bus_clear != nullptr) && (bus_snapshot != nullptr)) {
+      str << "  map.bus_enable = regs::" << ToIdentifier(bus_enable->name) << ".offset;\n"
+          << "  map.bus_clear = regs::" << ToIdentifier(bus_clear->name) << ".offset;\n"
+          << "  map.bus_snapshot = regs::" << ToIdentifier(bus_snapshot->name) << ".offset;\n";
+      for (const auto &b : buses) {
+        str << "  {\n"
+               "    fletcher::ProfileBusRegs b;\n"
+               "    b.name = " << JsonString(b.name) << ";\n"
+            << "    b.data_width = " << b.data_width << ";\n";
+        for (size_t c = 0; c < BUS_PROFILE_COUNTERS.size(); c++) {
+          str << "    b." << BUS_PROFILE_COUNTERS[c] << " = regs::" << ToIdentifier(b.counters[c]->name)
+              << ".offset;\n";
+        }
+        str << "    b.busy = regs::" << ToIdentifier(b.busy->name) << ".offset;\n"
+               "    map.buses.push_back(b);\n"
+               "  }\n";
+      }
+    }
+    str << "  return map;\n"
+           "}\n"
+           "\n";
+  }
+
+  str << "}  // namespace " << kernel_name << "\n"
+         "}  // namespace " << HOST_NAMESPACE << "\n";
+
+  for (auto &o : outputs) {
+    o->flush();
+    *o << str.str();
+  }
+
+  return str.str();
+}
+
+std::string GenerateProfileMap(const Design &design, const std::vector<std::ostream *> &outputs) {
+  std::stringstream str;
+  auto streams = GetProfiledStreams(design);
+  auto enable = FindReg(design.profiling_regs, PROFILE_ENABLE);
+  auto clear = FindReg(design.profiling_regs, PROFILE_CLEAR);
+  auto snapshot = FindReg(design.profiling_regs, PROFILE_SNAPSHOT);
+  auto buses = GetProfiledBuses(design);
+  auto bus_enable = FindReg(design.profiling_regs, BUS_PROFILE_ENABLE);
+  auto bus_clear = FindReg(design.profiling_regs, BUS_PROFILE_CLEAR);
+  auto bus_snapshot = FindReg(design.profiling_regs, BUS_PROFILE_SNAPSHOT);
+  auto counter_width = !streams.empty() ? streams.front().counters.front()->width
+                                        : !buses.empty() ? buses.front().counters.front()->width
+                                                         : PROFILE_COUNTER_WIDTH;
+
+  str << "{\n"
+         "  \"kernel\": " << JsonString(design.options->kernel_name) << ",\n"
+      << "  \"enable\": " << (enable != nullptr ? *enable->addr / 4 : 0) << ",\n"
+      << "  \"clear\": " << (clear != nullptr ? *clear->addr / 4 : 0) << ",\n"
+      << "  \"snapshot\": " << (snapshot != nullptr ? std::to_string(*snapshot->addr / 4) : "null") << ",\n"
+      << "  \"counter_width\": " << counter_width << ",\n"
+      << "  \"streams\": [";
+  for (size_t i = 0; i < streams.size(); i++) {
+    const auto &s = streams[i];
+    str << (i == 0 ? "" : ",") << "\n"
+        << "    {\"name\": " << JsonString(s.name) << ", \"element_width\": " << s.element_width;
+    for (size_t c = 0; c < PROFILE_COUNTERS.size(); c++) {
+      str << ", \"" << PROFILE_COUNTERS[c] << "\": " << *s.counters[c]->addr / 4;
+    }
+    for (const auto &h : {std::make_pair("stall_histogram", &s.stall_histogram),
+                          std::make_pair("starve_histogram", &s.starve_histogram)}) {
+      if (!h.second->empty()) {
+        str << ", \"" << h.first << "\": [";
+        for (size_t b = 0; b < h.second->size(); b++) {
+          str << (b == 0 ? "" : ", ") << *(*h.second)[b]->addr / 4;
+        }
+        str << "]";
+      }
+    }
+    str << "}";
+  }
+  str << (streams.empty() ? "" : "\n  ") << "]";
+
+  // Bus profilers, if any.
+  if ((bus_enable != nullptr) && (bus_clear != nullptr) && (bus_snapshot != nullptr)) {
+    str << ",\n"
+        << "  \"bus_enable\": " << *bus_enable->addr / 4 << ",\n"
+        << "  \"bus_clear\": " << *bus_clear->addr / 4 << ",\n"
+        << "  \"bus_snapshot\": " << *bus_snapshot->addr / 4 << ",\n"
+        << "  \"buses\": [";
+    for (size_t i = 0; i < buses.size(); i++) {
+      const auto &b = buses[i];
+      str << (i == 0 ? "" : ",") << "\n"
+          << "    {\"name\": " << JsonString(b.name) << ", \"data_width\": " << b.data_width;
+      for (size_t c = 0; c < BUS_PROFILE_COUNTERS.size(); c++) {
+        str << ", \"" << BUS_PROFILE_COUNTERS[c] << "\": " << *b.counters[c]->addr / 4;
+      }
+      str << ", \"busy\": " << *b.busy->addr / 4 << "}";
+    }
+    str << (buses.empty() ? "" : "\n  ") << "]";
+  }
+  str << "\n"
+         "}\n";
+
+  for (auto &o : outputs) {
+    o->flush();
+    *o << str.str();
+  }
+
+  return str.str();
+}
+
+}  // namespace fletchgen::host
@@ -0,0 +1,56 @@
+// Copyright 2018-2019 Delft University of Technology
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+#include "fletchgen/design.h"
+
+namespace fletchgen::host {
+
+/// Namespace in which the generated host code of all kernels is placed.
+constexpr char HOST_NAMESPACE[] = "fletcher_generated";
+
+/**
+ * @brief Generate a C++ header describing the MMIO register map of a design for host software.
+ *
+ * The header contains constexpr offsets for every register in the design, the schema set fingerprint, typed structs
+ * for the custom kernel registers and inline functions to write the kernel arguments and launch the kernel through the
+ * Fletcher run-time. It also statically asserts that the register map matches the one assumed by the run-time.
+ *
+ * All registers of the design must have an address.
+ *
+ * @param design  The design to generate the header for.
+ * @param outputs The output streams to write the header to.
+ * @return The header source.
+ */
+std::string GenerateHostHeader(const Design &design, const std::vector<std::ostream *> &outputs);
+
+/**
+ * @brief Generate a JSON description of the stream profiling registers of a design.
+ *
+ * The description contains the word offsets of the profiler enable and clear registers, and of the counter registers
+ * of every profiled stream, together with the bit width of its elements. It describes the same registers as the
+ * GetProfileMap() function of the generated host header, for tools that do not use the C++ run-time.
+ *
+ * @param design  The design to generate the description for.
+ * @param outputs The output streams to write the description to.
+ * @return The description.
+ */
+std::string GenerateProfileMap(const Design &design, const std::vector<std::ostream *> &outputs);
+
+}  // namespace fletchgen::host
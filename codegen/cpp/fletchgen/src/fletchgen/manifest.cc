@@ -0,0 +1,233 @@
+// Copyright 2018-2019 Delft University of Technology
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "fletchgen/manifest.h"
+
+#include <fletcher/common.h>
+#include <cerata/api.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace fletchgen {
+
+/// @brief Return the contents of a file, or nothing if it could not be opened.
+static std::optional<std::string> ReadFile(const std::string &path) {
+  std::ifstream ifs(path, std::ios::binary);
+  if (!ifs.good()) {
+    return std::nullopt;
+  }
+  std::stringstream str;
+  str << ifs.rdbuf();
+  return str.str();
+}
+
+/// @brief Return the directory part of a path, or an empty string if it has none.
+static std::string DirName(const std::string &path) {
+  auto pos = path.rfind('/');
+  if (pos == std::string::npos) {
+    return "";
+  }
+  return path.substr(0, pos);
+}
+
+OutputManifest::OutputManifest(std::string output_dir, bool backup)
+    : output_dir_(std::move(output_dir)), backup_(backup) {}
+
+/// Offset basis of the 64-bit FNV-1a hash.
+constexpr uint64_t HASH_BASIS = 0xcbf29ce484222325ULL;
+/// Size of the chunks in which files are compared.
+constexpr size_t CHUNK_SIZE = 1 << 20;
+
+uint64_t OutputManifest::Hash(const std::string &contents) {
+  return Hash(HASH_BASIS, contents.data(), contents.size());
+}
+
+uint64_t OutputManifest::Hash(uint64_t hash, const char *data, size_t size) {
+  // 64-bit FNV-1a.
+  for (size_t i = 0; i < size; i++) {
+    hash ^= static_cast<uint8_t>(data[i]);
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+bool OutputManifest::Write(const std::string &path, const std::string &contents) {
+  auto hash = Hash(contents);
+  auto existing = ReadFile(path);
+
+  // Leave the file untouched if nothing changed. The existing contents were read anyway, so compare them directly
+  // rather than trusting the hash.
+  if (existing && (*existing == contents)) {
+    FLETCHER_LOG(DEBUG, "Unchanged: " + path);
+    entries_.push_back({path, hash, false});
+    return false;
+  }
+
+  if (existing && backup_) {
+    FLETCHER_LOG(INFO, "Backing up " + path + " to " + path + ".bak");
+    auto bak = std::ofstream(path + ".bak", std::ios::binary);
+    bak << *existing;
+    bak.close();
+  }
+
+  auto dir = DirName(path);
+  if (!dir.empty()) {
+    cerata::CreateDir(dir);
+  }
+  auto ofs = std::ofstream(path, std::ios::binary);
+  if (!ofs.good()) {
+    FLETCHER_LOG(FATAL, "Could not open " + path + " for writing.");
+  }
+  ofs << contents;
+  ofs.close();
+
+  FLETCHER_LOG(DEBUG, "Written: " + path);
+  entries_.push_back({path, hash, true});
+  return true;
+}
+
+bool OutputManifest::Commit(const std::string &path) {
+  auto staged_path = staging_dir() + "/" + path;
+  auto dir = DirName(staged_path);
+  if (std::find(staged_dirs_.begin(), staged_dirs_.end(), dir) == staged_dirs_.end()) {
+    staged_dirs_.push_back(dir);
+  }
+  auto target = output_dir_ + "/" + path;
+  auto target_dir = DirName(target);
+  if (!target_dir.empty()) {
+    cerata::CreateDir(target_dir);
+  }
+  return CommitFile(staged_path, target);
+}
+
+std::string OutputManifest::TempPath(const std::string &path) {
+  auto dir = DirName(path);
+  if (!dir.empty()) {
+    cerata::CreateDir(dir);
+  }
+  return path + ".fletchgen_tmp";
+}
+
+bool OutputManifest::CommitFile(const std::string &source, const std::string &path) {
+  std::ifstream src(source, std::ios::binary);
+  if (!src.good()) {
+    FLETCHER_LOG(WARNING, "File " + source + " does not exist.");
+    return false;
+  }
+
+  // Hash the new file, and compare it with the existing file while both are equal.
+  std::ifstream existing(path, std::ios::binary);
+  bool equal = existing.good();
+  uint64_t hash = HASH_BASIS;
+  std::vector<char> src_chunk(CHUNK_SIZE);
+  std::vector<char> existing_chunk(CHUNK_SIZE);
+  while (src) {
+    src.read(src_chunk.data(), CHUNK_SIZE);
+    auto size = static_cast<size_t>(src.gcount());
+    hash = Hash(hash, src_chunk.data(), size);
+    if (equal) {
+      existing.read(existing_chunk.data(), static_cast<std::streamsize>(size));
+      equal = (static_cast<size_t>(existing.gcount()) == size)
+          && std::equal(src_chunk.begin(), src_chunk.begin() + size, existing_chunk.begin());
+    }
+  }
+  // The existing file must not be any longer.
+  equal = equal && (existing.peek() == std::ifstream::traits_type::eof());
+  bool existed = existing.is_open();
+  src.close();
+  existing.close();
+
+  if (equal) {
+    FLETCHER_LOG(DEBUG, "Unchanged: " + path);
+    std::remove(source.c_str());
+    entries_.push_back({path, hash, false});
+    return false;
+  }
+
+  if (existed && backup_) {
+    FLETCHER_LOG(INFO, "Backing up " + path + " to " + path + ".bak");
+    std::rename(path.c_str(), (path + ".bak").c_str());
+  }
+  if (std::rename(source.c_str(), path.c_str()) != 0) {
+    // The files may be on different file systems, so copy the new file in chunks instead.
+    std::ifstream in(source, std::ios::binary);
+    std::ofstream out(path, std::ios::binary);
+    if (!out.good()) {
+      FLETCHER_LOG(FATAL, "Could not open " + path + " for writing.");
+    }
+    while (in) {
+      in.read(src_chunk.data(), CHUNK_SIZE);
+      out.write(src_chunk.data(), in.gcount());
+    }
+    in.close();
+    out.close();
+    std::remove(source.c_str());
+  }
+
+  FLETCHER_LOG(DEBUG, "Written: " + path);
+  entries_.push_back({path, hash, true});
+  return true;
+}
+
+void OutputManifest::RemoveStaging() {
+  // Remove the deepest directories first. Directories that still contain files are left alone.
+  std::sort(staged_dirs_.begin(), staged_dirs_.end(), [](const std::string &a, const std::string &b) {
+    return a.size() > b.size();
+  });
+  for (const auto &d : staged_dirs_) {
+    std::remove(d.c_str());
+  }
+  staged_dirs_.clear();
+  std::remove(staging_dir().c_str());
+}
+
+std::string OutputManifest::staging_dir() const {
+  return output_dir_ + "/" + STAGING_DIR;
+}
+
+size_t OutputManifest::num_dirty() const {
+  return std::count_if(entries_.begin(), entries_.end(), [](const Entry &e) { return e.dirty; });
+}
+
+std::string OutputManifest::ToString() const {
+  std::stringstream str;
+  str << "# Files generated by Fletchgen.\n"
+         "# <dirty|clean> <64-bit FNV-1a hash of contents> <path>\n";
+  for (const auto &e : entries_) {
+    str << (e.dirty ? "dirty" : "clean") << " "
+        << std::hex << std::setw(16) << std::setfill('0') << e.hash << std::dec << " "
+        << e.path << "\n";
+  }
+  return str.str();
+}
+
+void OutputManifest::Save() const {
+  auto path = output_dir_ + "/" + MANIFEST_FILE;
+  FLETCHER_LOG(INFO, "Saving output manifest to: " + path + " (" + std::to_string(num_dirty()) + " of "
+      + std::to_string(entries_.size()) + " files changed)");
+  cerata::CreateDir(output_dir_);
+  auto ofs = std::ofstream(path);
+  ofs << ToString();
+  ofs.close();
+}
+
+}  // namespace fletchgen
@@ -0,0 +1,131 @@
+// Copyright 2018-2019 Delft University of Technology
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace fletchgen {
+
+/// Name of the manifest file in the output directory.
+constexpr char MANIFEST_FILE[] = "fletchgen.manifest";
+/// Name of the directory in the output directory where Cerata back-ends generate their output before it is committed.
+constexpr char STAGING_DIR[] = ".fletchgen_staging";
+
+/**
+ * @brief Keeps track of all files generated by Fletchgen, and only rewrites files of which the contents changed.
+ *
+ * Files of which the contents did not change are not touched, such that their timestamps are preserved and downstream
+ * build tools do not have to process them again. A manifest listing every output file, its content hash and whether it
+ * was rewritten can be saved in the output directory, such that build rules can determine exactly which files are
+ * dirty.
+ */
+class OutputManifest {
+ public:
+  /// An output file.
+  struct Entry {
+    /// Path to the file.
+    std::string path;
+    /// Hash of the file contents.
+    uint64_t hash;
+    /// Whether the file was (re)written by this invocation.
+    bool dirty;
+  };
+
+  /**
+   * @brief Construct a new OutputManifest.
+   * @param output_dir  The output directory, where the manifest is saved.
+   * @param backup      Whether to backup existing files to <path>.bak before they are rewritten.
+   */
+  explicit OutputManifest(std::string output_dir, bool backup = false);
+
+  /**
+   * @brief Write a file, unless it already exists with the same contents.
+   * @param path      The path to the file.
+   * @param contents  The contents of the file.
+   * @return True if the file was written, false if it was unchanged.
+   */
+  bool Write(const std::string &path, const std::string &contents);
+
+  /**
+   * @brief Commit a file that was generated in the staging directory to its path in the output directory.
+   *
+   * The staged file is removed afterwards.
+   *
+   * @param path  The path of the file, relative to the output and staging directory.
+   * @return True if the file was written, false if it was unchanged or could not be found.
+   */
+  bool Commit(const std::string &path);
+
+  /**
+   * @brief Return a temporary path next to a file, to stream its new contents into before committing them.
+   *
+   * The directory of the file is created if it does not exist yet.
+   *
+   * @param path  The path to the file.
+   * @return The temporary path, to be passed to CommitFile.
+   */
+  static std::string TempPath(const std::string &path);
+
+  /**
+   * @brief Commit a file that was written elsewhere, unless a file with the same contents already exists at its path.
+   *
+   * The files are compared in fixed-size chunks, such that large files are never held in memory. The new file is
+   * renamed to its path if the contents changed, and removed otherwise.
+   *
+   * @param source  The path to the new file, e.g. from TempPath.
+   * @param path    The path to the file.
+   * @return True if the file was written, false if it was unchanged or the new file could not be found.
+   */
+  bool CommitFile(const std::string &source, const std::string &path);
+
+  /// @brief Remove the staging directory, after all staged files were committed.
+  void RemoveStaging();
+
+  /// @brief Return the staging directory.
+  [[nodiscard]] std::string staging_dir() const;
+
+  /// @brief Return all output files, in the order in which they were written.
+  [[nodiscard]] const std::vector<Entry> &entries() const { return entries_; }
+
+  /// @brief Return the number of files that were rewritten.
+  [[nodiscard]] size_t num_dirty() const;
+
+  /// @brief Return the manifest file contents.
+  [[nodiscard]] std::string ToString() const;
+
+  /// @brief Save the manifest in the output directory.
+  void Save() const;
+
+  /// @brief Return the hash of a file's contents.
+  static uint64_t Hash(const std::string &contents);
+
+  /// @brief Continue a hash of a file's contents with the next chunk of the contents.
+  static uint64_t Hash(uint64_t hash, const char *data, size_t size);
+
+ private:
+  /// The output directory.
+  std::string output_dir_;
+  /// Whether to backup changed files.
+  bool backup_;
+  /// All output files.
+  std::vector<Entry> entries_;
+  /// Sub-directories of the staging directory from which files were committed.
+  std::vector<std::string> staged_dirs_;
+};
+
+}  // namespace fletchgen
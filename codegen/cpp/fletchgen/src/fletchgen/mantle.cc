@@ -17,20 +17,25 @@
 #include <cerata/api.h>
 #include <fletcher/common.h>
 
+#include <algorithm>
+#include <map>
+#include <unordered_map>
 #include <memory>
 #include <vector>
 #include <utility>
 #include <string>
-#include <vector>
 
 #include "fletchgen/basic_types.h"
 #include "fletchgen/bus.h"
 #include "fletchgen/nucleus.h"
+#include "fletchgen/mmio.h"
+#include "fletchgen/profiler.h"
 #include "fletchgen/axi4_lite.h"
 
 namespace fletchgen {
 
 using cerata::intl;
+using cerata::strl;
 
 //static std::string ArbiterMasterName(BusFunction function) {
 //  return std::string(function == BusFunction::READ ? "rd" : "wr") + "_mst";
@@ -39,22 +44,29 @@ using cerata::intl;
 Mantle::Mantle(std::string name,
                const std::vector<std::shared_ptr<RecordBatch>> &recordbatches,
                const std::shared_ptr<Nucleus> &nucleus,
-               BusDim bus_dim)
-    : Component(std::move(name)), bus_dim_(bus_dim) {
+               std::vector<BusDim> bus_dims,
+               BusArbiterSpec arb_spec)
+    : Component(std::move(name)), bus_dims_(std::move(bus_dims)), arb_spec_(std::move(arb_spec)) {
 
   using std::pair;
 
+  if (bus_dims_.empty()) {
+    FLETCHER_LOG(FATAL, "Mantle requires at least one memory channel.");
+  }
+  if (!arb_spec_.IsValidMethod()) {
+    FLETCHER_LOG(FATAL, "Unknown bus arbitration method " + arb_spec_.method + ".");
+  }
+
   // Add some default parameters.
   auto iw = index_width();
   auto tw = tag_width();
   Add({iw, tw});
 
-  // Top level bus parameters.
-  auto bus_params = BusDimParams(this, bus_dim);
-  auto bus_rd_spec = BusSpecParams{bus_params, BusFunction::READ};
-  auto bus_wr_spec = BusSpecParams{bus_params, BusFunction::WRITE};
-  std::shared_ptr<Port> bus_rd = bus_port("rd_mst", Port::OUT, bus_rd_spec);
-  std::shared_ptr<Port> bus_wr = bus_port("wr_mst", Port::OUT, bus_wr_spec);
+  // Top level bus parameters, one set for every memory channel.
+  std::vector<BusDimParams> bus_params;
+  for (size_t c = 0; c < bus_dims_.size(); c++) {
+    bus_params.emplace_back(this, bus_dims_[c], ChannelParamPrefix(c));
+  }
 
   // Add default ports; bus clock/reset, kernel clock/reset and AXI4-lite port.
   auto bcr = port("bcd", cr(), Port::Dir::IN, bus_cd());
@@ -75,12 +87,26 @@ Mantle::Mantle(std::string name,
   // We've instantiated the Nucleus, and now we should feed it with data from the RecordBatch components.
   // We're going to do the following while iterating over the RecordBatch components.
   // 1. Instantiate every RecordBatch component.
-  // 2. Remember the memory interface ports (bus_ports) for bus infrastructure generation later on.
+  // 2. Remember the memory interface ports (bus_ports) and their memory channel for bus infrastructure generation,
+  //    as well as their arbitration weight and buffer depth.
   // 3. Connect all field-derived ports between RecordBatches and Nucleus.
 
-  std::vector<BusPort *> rb_bus_ports;
+  std::vector<pair<BusPort *, size_t>> rb_bus_ports;
+  std::unordered_map<BusPort *, pair<uint32_t, uint32_t>> rb_bus_port_arb;
 
   for (const auto &rb : recordbatches) {
+    // Check the memory channel of the RecordBatch.
+    auto channel = rb->bus_channel();
+    if (channel >= bus_params.size()) {
+      FLETCHER_LOG(FATAL, "RecordBatch " + rb->name() + " is assigned to memory channel " + std::to_string(channel)
+          + ", but the Mantle has only " + std::to_string(bus_params.size()) + " channel(s).");
+    }
+    if (!(rb->bus_dim() == bus_dims_[channel])) {
+      FLETCHER_LOG(FATAL, "Bus dimensions of RecordBatch " + rb->name() + " (" + rb->bus_dim().ToString()
+          + ") do not match those of memory channel " + std::to_string(channel) + " ("
+          + bus_dims_[channel].ToString() + ").");
+    }
+
     // Instantiate the RecordBatch
     auto rbi = Instantiate(rb.get());
     recordbatch_instances_.push_back(rbi);
@@ -93,8 +119,19 @@ Mantle::Mantle(std::string name,
     rbi->par("TAG_WIDTH")->SetValue(tw);
 
     // Look up its bus ports and remember them.
-    auto rbi_bus_ports = rbi->GetAll<BusPort>();
-    rb_bus_ports.insert(rb_bus_ports.end(), rbi_bus_ports.begin(), rbi_bus_ports.end());
+    auto weight = rb->schema()->bus_weight();
+    auto depth = rb->schema()->bus_buffer_depth().value_or(arb_spec_.buffer_depth);
+    // A bus buffer only accepts a burst while it has more room than the burst length, so it must be deeper than the
+    // longest burst, or it would stall forever.
+    if ((depth != 0) && (depth <= bus_dims_[channel].bm)) {
+      FLETCHER_LOG(FATAL, "Bus buffer depth " + std::to_string(depth) + " of RecordBatch " + rb->name()
+          + " must be zero or exceed the burst max length of memory channel " + std::to_string(channel) + " ("
+          + std::to_string(bus_dims_[channel].bm) + ").");
+    }
+    for (const auto &bp : rbi->GetAll<BusPort>()) {
+      rb_bus_ports.emplace_back(bp, channel);
+      rb_bus_port_arb[bp] = {weight, depth};
+    }
 
     // Obtain all the field-derived ports from the RecordBatch Instance.
     auto field_ports = rbi->GetAll<FieldPort>();
@@ -103,10 +140,10 @@ Mantle::Mantle(std::string name,
       if (fp->function_ == FieldPort::Function::ARROW) {
         // Connect the address width parameter on the nucleus.
         auto prefix = rb->schema()->name() + "_" + fp->field_->name();
-        Connect(nucleus_inst_->par(bus_addr_width(0, prefix)), par(bus_addr_width()));
+        Connect(nucleus_inst_->par(bus_addr_width(0, prefix)), par(bus_params[channel].aw->name()));
 
         // Connect the other bus params.
-        ConnectBusParam(rbi, prefix + "_", bus_params, inst_to_comp_map());
+        ConnectBusParam(rbi, prefix + "_", bus_params[channel], inst_to_comp_map());
 
         if (fp->dir() == cerata::Term::Dir::OUT) {
           Connect(nucleus_inst_->prt(fp->name()), fp);
@@ -123,55 +160,118 @@ Mantle::Mantle(std::string name,
 
   // Handle the bus infrastructure.
   // Now that we've instantiated and connected all RecordBatches on the Nucleus side, we need to connect their bus
-  // ports to bus arbiters. We don't have an elaborate interconnection generation step yet, so we just discern between
-  // read and write ports, assuming they will all get the same bus parametrization.
+  // ports to bus arbiters. Every memory channel gets its own read and/or write arbiter, depending on the modes of the
+  // RecordBatches assigned to it, and its own top-level bus master ports. The master ports of channel 0 are named
+  // rd_mst and wr_mst, those of channel N are prefixed with chN_.
   //
-  // Therefore, we only need a read and/or write arbiter, whatever mode RecordBatch is instantiated.
   // We take the following steps.
-  // 1. instantiate them and connect them to the top level ports.
+  // 1. Instantiate the arbiters and connect them to the top level ports.
   // 2. Connect every RecordBatch bus port to the corresponding arbiter.
 
-  // Instantiate and connect arbiters to top level.
-  // Instance *arb_read = nullptr;
-  // Instance *arb_write = nullptr;
-
-  // Gather all unique bus specs from RecordBatch bus interfaces.
-  std::vector<BusSpec> bus_specs;
-  for (const auto &bp : rb_bus_ports) {
-    bus_specs.push_back(BusSpec(bp->spec_));
-  }
-  cerata::FilterDuplicates(&bus_specs);
-
-  // For every required bus, instantiate a bus arbiter.
-  std::unordered_map<BusSpec, Instance *> arb_map;
-  for (const auto &b : bus_specs) {
-    auto prefix = b.ToName();
-    Instance *inst = Instantiate(bus_arbiter(b.func), prefix + "_inst");
-
-    // Connect clock and reset
-    inst->prt("bcd") <<= bcr;
-
-    // TODO(johanpel): for now, we only support one top-level bus spec, so we connect all arbiter generics to it.
-    //  Also we just connect the top-level port directly.
-    ConnectBusParam(inst, "", bus_params, this->inst_to_comp_map());
-    if (b.func == BusFunction::READ) {
-      Connect(bus_rd, inst->Get<Port>("mst"));
-      Add(bus_rd);
-    } else {
-      Connect(bus_wr, inst->Get<Port>("mst"));
-      Add(bus_wr);
+  std::map<pair<size_t, BusFunction>, Instance *> arb_map;
+  for (size_t c = 0; c < bus_params.size(); c++) {
+    for (auto func : {BusFunction::READ, BusFunction::WRITE}) {
+      bool required = std::any_of(rb_bus_ports.begin(), rb_bus_ports.end(), [&](const pair<BusPort *, size_t> &bp) {
+        return (bp.second == c) && (bp.first->spec_.func == func);
+      });
+      if (!required) {
+        continue;
+      }
+      BusSpecParams spec{bus_params[c], func};
+      Instance *inst = Instantiate(bus_arbiter(func), ChannelName(c, spec.ToName() + "_inst"));
+
+      // Connect clock and reset
+      inst->prt("bcd") <<= bcr;
+
+      // Configure the arbitration.
+      inst->par("ARB_METHOD")->SetValue(strl(arb_spec_.method));
+      inst->par("MAX_OUTSTANDING")->SetValue(intl(static_cast<int>(arb_spec_.max_outstanding)));
+
+      // Connect the arbiter generics to the channel bus parameters, and its master port to the top level.
+      ConnectBusParam(inst, "", bus_params[c], this->inst_to_comp_map());
+      auto mst = bus_port(ChannelName(c, func == BusFunction::READ ? "rd_mst" : "wr_mst"), Port::OUT, spec);
+      Connect(mst, inst->Get<Port>("mst"));
+      Add(mst);
+      arb_map[{c, func}] = inst;
     }
-    arb_map[b] = inst;
   }
 
-  // Now we loop over all bus ports again and connect them to the arbiters.
-  for (const auto &bp : rb_bus_ports) {
+  // Now we loop over all bus ports again and connect them to the arbiters. With fixed-priority arbitration, lower
+  // arbiter slave port indices take precedence, so the bus ports are connected in order of descending weight.
+  auto arb_order = rb_bus_ports;
+  if (arb_spec_.method == "FIXED") {
+    std::stable_sort(arb_order.begin(), arb_order.end(), [&](const pair<BusPort *, size_t> &a,
+                                                             const pair<BusPort *, size_t> &b) {
+      return rb_bus_port_arb[a.first].first > rb_bus_port_arb[b.first].first;
+    });
+  }
+  std::map<Instance *, pair<std::string, std::string>> arb_csv;
+  for (const auto &bp : arb_order) {
     // Select the corresponding arbiter.
-    auto arb = arb_map[BusSpec(bp->spec_)];
+    auto arb = arb_map[{bp.second, bp.first->spec_.func}];
     // Get the PortArray.
     auto array = arb->prt_arr("bsv");
     // Append the PortArray and connect.
-    Connect(array->Append(), bp);
+    Connect(array->Append(), bp.first);
+    // Append the weight and buffer depth of the slave port.
+    auto &csv = arb_csv[arb];
+    auto sep = csv.first.empty() ? "" : ",";
+    csv.first += sep + std::to_string(rb_bus_port_arb[bp.first].first);
+    csv.second += sep + std::to_string(rb_bus_port_arb[bp.first].second);
+  }
+  for (const auto &ac : arb_csv) {
+    ac.first->par("SLV_WEIGHTS")->SetValue(strl(ac.second.first));
+    ac.first->par("SLV_BUFFER_DEPTHS")->SetValue(strl(ac.second.second));
+  }
+
+  // Handle bus profiling.
+  // If the Nucleus exposes bus profiling registers, a bus profiler is inserted on every top-level bus master port and
+  // on every RecordBatch bus port. Their counters and busy outputs are connected to the registers of the same name.
+  std::vector<MmioPort *> bus_profile_ports;
+  for (const auto &p : nucleus_inst_->GetAll<MmioPort>()) {
+    if (p->reg.meta.count(MMIO_BUS_PROFILE) > 0) {
+      bus_profile_ports.push_back(p);
+    }
+  }
+  if (!bus_profile_ports.empty()) {
+    // The counters are as wide as their registers. The first status register of every bus is a counter.
+    uint32_t counter_width = PROFILE_COUNTER_WIDTH;
+    for (const auto &p : bus_profile_ports) {
+      if (p->reg.behavior == MmioBehavior::STATUS) {
+        counter_width = p->reg.width;
+        break;
+      }
+    }
+
+    std::vector<pair<Port *, size_t>> profile_ports;
+    for (size_t c = 0; c < bus_params.size(); c++) {
+      for (const auto &mst_name : {ChannelName(c, "rd_mst"), ChannelName(c, "wr_mst")}) {
+        if (Has(mst_name)) {
+          profile_ports.emplace_back(prt(mst_name), c);
+        }
+      }
+    }
+    for (const auto &bp : rb_bus_ports) {
+      profile_ports.emplace_back(bp.first, bp.second);
+    }
+
+    auto enable = nucleus_inst_->prt(BUS_PROFILE_ENABLE);
+    auto clear = nucleus_inst_->prt(BUS_PROFILE_CLEAR);
+    auto snapshot = nucleus_inst_->prt(BUS_PROFILE_SNAPSHOT);
+    for (const auto &pp : profile_ports) {
+      auto bus_name = pp.first->name();
+      // Insert a signal node in between that we can attach the profiler probe onto.
+      auto probe = AttachSignalToNode(this, pp.first, inst_to_comp_map(), "probe_" + bus_name);
+      auto profiler = EnableBusProfiling(this, probe, bus_params[pp.second], counter_width);
+      Connect(profiler.first->prt("enable"), enable);
+      Connect(profiler.first->prt("clear"), clear);
+      Connect(profiler.first->prt("snapshot"), snapshot);
+      auto reg_names = BusProfileRegNames(bus_name);
+      for (size_t i = 0; i < reg_names.size(); i++) {
+        Connect(nucleus_inst_->prt(reg_names[i]), profiler.second[i]);
+      }
+      Connect(nucleus_inst_->prt(BusProfileBusyRegName(bus_name)), profiler.first->prt("busy"));
+    }
   }
 }
 
@@ -179,8 +279,9 @@ Mantle::Mantle(std::string name,
 std::shared_ptr<Mantle> mantle(const std::string &name,
                                const std::vector<std::shared_ptr<RecordBatch>> &recordbatches,
                                const std::shared_ptr<Nucleus> &nucleus,
-                               BusDim bus_spec) {
-  return std::make_shared<Mantle>(name, recordbatches, nucleus, bus_spec);
+                               const std::vector<BusDim> &bus_dims,
+                               const BusArbiterSpec &arb_spec) {
+  return std::make_shared<Mantle>(name, recordbatches, nucleus, bus_dims, arb_spec);
 }
 
 }  // namespace fletchgen
@@ -39,17 +39,26 @@ class Mantle : public Component {
   explicit Mantle(std::string name,
                   const std::vector<std::shared_ptr<RecordBatch>> &recordbatches,
                   const std::shared_ptr<Nucleus> &nucleus,
-                  BusDim bus_dim);
+                  std::vector<BusDim> bus_dims,
+                  BusArbiterSpec arb_spec = BusArbiterSpec());
   /// @brief Return the kernel component of this Mantle.
   std::shared_ptr<Nucleus> nucleus() const { return nucleus_; }
+  /// @brief Return the Nucleus instance of this Mantle.
+  Instance *nucleus_inst() const { return nucleus_inst_; }
   /// @brief Return all RecordBatch(Reader/Writer) instances of this Mantle.
   std::vector<Instance *> recordbatch_instances() const { return recordbatch_instances_; }
   /// @brief Return all RecordBatch(Reader/Writer) components of this Mantle.
   std::vector<std::shared_ptr<RecordBatch>> recordbatch_components() const { return recordbatch_components_; }
+  /// @brief Return the bus dimensions of every memory channel of this Mantle.
+  std::vector<BusDim> bus_dims() const { return bus_dims_; }
+  /// @brief Return the bus arbiter configuration of this Mantle.
+  BusArbiterSpec arb_spec() const { return arb_spec_; }
 
  protected:
-  /// Top-level bus dimensions.
-  BusDim bus_dim_;
+  /// Top-level bus dimensions of every memory channel.
+  std::vector<BusDim> bus_dims_;
+  /// Configuration of the bus arbiters.
+  BusArbiterSpec arb_spec_;
   /// The Nucleus to be instantiated by this Mantle.
   std::shared_ptr<Nucleus> nucleus_;
   /// Shortcut to the instantiated Nucleus.
@@ -67,12 +76,16 @@ class Mantle : public Component {
  * @param name          The name of the mantle.
  * @param recordbatches The RecordBatch components to instantiate.
  * @param nucleus       The Nucleus to instantiate.
- * @param bus_spec      The specification of the top-level bus.
+ * @param bus_dims      The dimensions of the top-level bus of every memory channel. RecordBatches are connected to the
+ *                      channel of their schema, and must have the same bus dimensions as that channel.
+ * @param arb_spec      The configuration of the bus arbiters. The arbitration weight and buffer depth of the bus ports
+ *                      of every RecordBatch can be overridden through the metadata of its schema.
  * @return              A shared pointer to the mantle component.
  */
 std::shared_ptr<Mantle> mantle(const std::string &name,
                                const std::vector<std::shared_ptr<RecordBatch>> &recordbatches,
                                const std::shared_ptr<Nucleus> &nucleus,
-                               BusDim bus_spec);
+                               const std::vector<BusDim> &bus_dims,
+                               const BusArbiterSpec &arb_spec = BusArbiterSpec());
 
 }  // namespace fletchgen
@@ -21,6 +21,9 @@
 #include <string>
 #include <fstream>
 #include <algorithm>
+#include <map>
+#include <sstream>
+#include <vector>
 
 #include "fletchgen/axi4_lite.h"
 #include "fletchgen/basic_types.h"
@@ -34,6 +37,7 @@ static std::string ToString(MmioBehavior behavior) {
   switch (behavior) {
     case MmioBehavior::STATUS: return "status";
     case MmioBehavior::STROBE: return "strobe";
+    case MmioBehavior::CONSTANT: return "constant";
     default: return "control";
   }
 }
@@ -67,6 +71,10 @@ std::shared_ptr<Component> mmio(const std::vector<fletcher::RecordBatchDescripti
   auto comp = component("mmio", {kcd});
   // Generate all ports and add to the component.
   for (const auto &reg : regs) {
+    // Constant registers are internal to the MMIO component.
+    if (reg.behavior == MmioBehavior::CONSTANT) {
+      continue;
+    }
     auto dir = ToDir(reg.behavior);
     auto port = mmio_port(dir, reg, kernel_cd());
     // Change the name to vhdmmio convention.
@@ -89,10 +97,31 @@ static size_t AddrSpaceUsed(uint32_t width) {
   return 4 * (width / 32 + (width % 32 != 0));
 }
 
-std::string GenerateVhdmmioYaml(const std::vector<std::vector<MmioReg> *>& regs, std::optional<size_t *> next_addr) {
-  std::stringstream ss;
+size_t AssignMmioAddresses(const std::vector<std::vector<MmioReg> *> &regs) {
   // The next free byte address.
   size_t next_free_addr = 0;
+  for (auto &sub : regs) {
+    for (auto &r : *sub) {
+      if (r.addr) {
+        // There is a fixed address.
+        // Just take this address plus its space as the next address. This limits how the vector of MmioRegs can be
+        // supplied (fixed addr. must be at the start of the vector and ordered), but we don't currently use this in
+        // any other way.
+        next_free_addr = *r.addr + AddrSpaceUsed(r.width);
+      } else {
+        // There is not a fixed address.
+        r.addr = next_free_addr;
+        next_free_addr += AddrSpaceUsed(r.width);
+      }
+    }
+  }
+  return next_free_addr;
+}
+
+std::string GenerateVhdmmioYaml(const std::vector<std::vector<MmioReg> *> &regs, std::optional<size_t *> next_addr) {
+  std::stringstream ss;
+  // Make sure every register has an address.
+  size_t next_free_addr = AssignMmioAddresses(regs);
   // Header:
   ss << "metadata:\n"
         "  name: mmio\n"
@@ -116,20 +145,7 @@ std::string GenerateVhdmmioYaml(const std::vector<std::vector<MmioReg> *>& regs,
   // Iterate over the registers and generate the appropriate YAML lines.
   for (auto &sub : regs) {
     for (auto &r : *sub) {
-      // Determine the address.
-      if (r.addr) {
-        // There is a fixed address.
-        ss << "  - address: " << *r.addr << "\n";
-        // Just take this address plus its space as the next address. This limits how the vector of MmioRegs can be
-        // supplied (fixed addr. must be at the start of the vector and ordered), but we don't currently use this in
-        // any other way.
-        next_free_addr = *r.addr + AddrSpaceUsed(r.width);
-      } else {
-        // There is not a fixed address.
-        ss << "  - address: " << next_free_addr << "\n";
-        r.addr = next_free_addr;
-        next_free_addr += AddrSpaceUsed(r.width);
-      }
+      ss << "  - address: " << *r.addr << "\n";
       // Set doc, name and other stuff.
       ss << "    name: " << r.name << "\n";
       if (!r.desc.empty()) {
@@ -141,6 +157,9 @@ std::string GenerateVhdmmioYaml(const std::vector<std::vector<MmioReg> *>& regs,
         ss << "    bitrange: " << r.index << "\n";
       }
       ss << "    behavior: " << ToString(r.behavior) << "\n";
+      if (r.behavior == MmioBehavior::CONSTANT) {
+        ss << "    value: " << r.init.value_or(0) << "\n";
+      }
       ss << "\n";
     }
   }
@@ -152,6 +171,294 @@ std::string GenerateVhdmmioYaml(const std::vector<std::vector<MmioReg> *>& regs,
   return ss.str();
 }
 
+/// @brief Return the VHDL type of the data port of a register.
+static std::string PortType(const MmioReg &reg) {
+  if (reg.width == 1) {
+    return "std_logic";
+  }
+  return "std_logic_vector(" + std::to_string(reg.width - 1) + " downto 0)";
+}
+
+/// @brief Return the name of the data port of a register on the MMIO component, according to the vhdmmio convention.
+static std::string PortName(const MmioReg &reg) {
+  return "f_" + reg.name + (reg.behavior == MmioBehavior::STATUS ? "_write_data" : "_data");
+}
+
+/// @brief Return a VHDL range of bits, or a single bit index if the range spans one bit.
+static std::string Range(uint32_t hi, uint32_t lo) {
+  if (hi == lo) {
+    return "(" + std::to_string(hi) + ")";
+  }
+  return "(" + std::to_string(hi) + " downto " + std::to_string(lo) + ")";
+}
+
+/// @brief Return a VHDL bit string literal of bits hi downto lo of some value.
+static std::string BitLiteral(uint64_t value, uint32_t hi, uint32_t lo) {
+  std::string bits;
+  for (uint32_t b = hi + 1; b-- > lo;) {
+    bits.push_back(((b < 64) && ((value >> b) & 1u)) ? '1' : '0');
+  }
+  return hi == lo ? "'" + bits + "'" : "\"" + bits + "\"";
+}
+
+/// @brief The part of a register that lies within a single 32-bit word.
+struct WordSlice {
+  /// The register.
+  const MmioReg *reg;
+  /// The word index in the register map.
+  size_t word;
+  /// Bit range in the register.
+  uint32_t reg_hi, reg_lo;
+  /// Bit range in the word.
+  uint32_t word_hi, word_lo;
+
+  /// @brief Return a VHDL expression selecting this slice from a register signal.
+  [[nodiscard]] std::string Select(const std::string &signal) const {
+    return reg->width == 1 ? signal : signal + Range(reg_hi, reg_lo);
+  }
+};
+
+/// @brief Split all registers into the parts that lie within each 32-bit word, ordered by word.
+static std::map<size_t, std::vector<WordSlice>> GetWordSlices(const std::vector<std::vector<MmioReg> *> &regs) {
+  std::map<size_t, std::vector<WordSlice>> result;
+  for (const auto &sub : regs) {
+    for (const auto &r : *sub) {
+      uint32_t first = r.index;
+      uint32_t last = r.index + r.width - 1;
+      for (uint32_t lo = first; lo <= last; lo = (lo / 32 + 1) * 32) {
+        uint32_t hi = std::min(last, (lo / 32) * 32 + 31);
+        WordSlice slice{&r, *r.addr / 4 + lo / 32, hi - first, lo - first, hi % 32, lo % 32};
+        result[slice.word].push_back(slice);
+      }
+    }
+  }
+  return result;
+}
+
+/// @brief Generate the port list of the MMIO component.
+static std::string GenerateMmioPorts(const std::vector<std::vector<MmioReg> *> &regs, const std::string &indent) {
+  std::stringstream ss;
+  ss << indent << "kcd_clk                     : in  std_logic;\n";
+  ss << indent << "kcd_reset                   : in  std_logic;\n";
+  for (const auto &sub : regs) {
+    for (const auto &r : *sub) {
+      if (r.behavior == MmioBehavior::CONSTANT) continue;
+      auto name = PortName(r);
+      ss << indent << name << std::string(name.length() < 28 ? 28 - name.length() : 1, ' ')
+         << ": " << (r.behavior == MmioBehavior::STATUS ? "in  " : "out ") << PortType(r) << ";\n";
+    }
+  }
+  ss << indent << "mmio_awvalid                : in  std_logic;\n"
+     << indent << "mmio_awready                : out std_logic;\n"
+     << indent << "mmio_awaddr                 : in  std_logic_vector(31 downto 0);\n"
+     << indent << "mmio_wvalid                 : in  std_logic;\n"
+     << indent << "mmio_wready                 : out std_logic;\n"
+     << indent << "mmio_wdata                  : in  std_logic_vector(31 downto 0);\n"
+     << indent << "mmio_wstrb                  : in  std_logic_vector(3 downto 0);\n"
+     << indent << "mmio_bvalid                 : out std_logic;\n"
+     << indent << "mmio_bready                 : in  std_logic;\n"
+     << indent << "mmio_bresp                  : out std_logic_vector(1 downto 0);\n"
+     << indent << "mmio_arvalid                : in  std_logic;\n"
+     << indent << "mmio_arready                : out std_logic;\n"
+     << indent << "mmio_araddr                 : in  std_logic_vector(31 downto 0);\n"
+     << indent << "mmio_rvalid                 : out std_logic;\n"
+     << indent << "mmio_rready                 : in  std_logic;\n"
+     << indent << "mmio_rdata                  : out std_logic_vector(31 downto 0);\n"
+     << indent << "mmio_rresp                  : out std_logic_vector(1 downto 0)\n";
+  return ss.str();
+}
+
+std::string GenerateMmioPackage(const std::vector<std::vector<MmioReg> *> &regs) {
+  AssignMmioAddresses(regs);
+  std::stringstream ss;
+  ss << "library ieee;\n"
+        "use ieee.std_logic_1164.all;\n"
+        "\n"
+        "package mmio_pkg is\n"
+        "\n"
+        "  component mmio is\n"
+        "    port (\n"
+     << GenerateMmioPorts(regs, "      ")
+     << "    );\n"
+        "  end component;\n"
+        "\n"
+        "end package;\n";
+  return ss.str();
+}
+
+std::string GenerateMmioVhdl(const std::vector<std::vector<MmioReg> *> &regs) {
+  AssignMmioAddresses(regs);
+  auto slices = GetWordSlices(regs);
+
+  std::stringstream decl;    // Signal declarations.
+  std::stringstream conn;    // Output port connections.
+  std::stringstream rst;     // Reset values.
+  std::stringstream clr;     // Default values of strobes.
+  std::stringstream wr;      // Write decoder.
+  std::stringstream rd;      // Read multiplexer.
+
+  for (const auto &sub : regs) {
+    for (const auto &r : *sub) {
+      if ((r.behavior == MmioBehavior::CONTROL) || (r.behavior == MmioBehavior::STROBE)) {
+        auto zero = r.width == 1 ? std::string("'0'") : std::string("(others => '0')");
+        decl << "  signal reg_" << r.name << " : " << PortType(r) << ";\n";
+        conn << "  " << PortName(r) << " <= reg_" << r.name << ";\n";
+        rst << "        reg_" << r.name << " <= " << zero << ";\n";
+        if (r.behavior == MmioBehavior::STROBE) {
+          clr << "      reg_" << r.name << " <= " << zero << ";\n";
+        }
+      }
+    }
+  }
+
+  for (const auto &w : slices) {
+    std::stringstream wr_word;
+    std::stringstream rd_word;
+    for (const auto &s : w.second) {
+      auto word_bits = Range(s.word_hi, s.word_lo);
+      switch (s.reg->behavior) {
+        case MmioBehavior::CONTROL: {
+          auto r = s.Select("reg_" + s.reg->name);
+          wr_word << "            " << r << " <= (" << r << " and not wmask" << word_bits << ") or (w_data"
+                  << word_bits << " and wmask" << word_bits << ");\n";
+          rd_word << "            r_data" << word_bits << " <= " << r << ";\n";
+          break;
+        }
+        case MmioBehavior::STROBE: {
+          auto r = s.Select("reg_" + s.reg->name);
+          wr_word << "            " << r << " <= w_data" << word_bits << " and wmask" << word_bits << ";\n";
+          break;
+        }
+        case MmioBehavior::STATUS: {
+          rd_word << "            r_data" << word_bits << " <= " << s.Select(PortName(*s.reg)) << ";\n";
+          break;
+        }
+        case MmioBehavior::CONSTANT: {
+          rd_word << "            r_data" << word_bits << " <= "
+                  << BitLiteral(s.reg->init.value_or(0), s.reg_hi, s.reg_lo) << ";\n";
+          break;
+        }
+      }
+    }
+    wr << "          when " << w.first << " =>\n" << (wr_word.str().empty() ? "            null;\n" : wr_word.str());
+    rd << "          when " << w.first << " =>\n" << (rd_word.str().empty() ? "            null;\n" : rd_word.str());
+  }
+
+  std::stringstream ss;
+  ss << "library ieee;\n"
+        "use ieee.std_logic_1164.all;\n"
+        "use ieee.numeric_std.all;\n"
+        "\n"
+        "-- AXI4-lite register file for the Fletcher MMIO registers.\n"
+        "entity mmio is\n"
+        "  port (\n"
+     << GenerateMmioPorts(regs, "    ")
+     << "  );\n"
+        "end entity;\n"
+        "\n"
+        "architecture Implementation of mmio is\n"
+        "  -- Register contents.\n"
+     << decl.str()
+     << "\n"
+        "  -- Write channel holding registers.\n"
+        "  signal aw_valid : std_logic;\n"
+        "  signal aw_addr  : std_logic_vector(31 downto 0);\n"
+        "  signal w_valid  : std_logic;\n"
+        "  signal w_data   : std_logic_vector(31 downto 0);\n"
+        "  signal w_strb   : std_logic_vector(3 downto 0);\n"
+        "  signal b_valid  : std_logic;\n"
+        "  signal b_resp   : std_logic_vector(1 downto 0);\n"
+        "\n"
+        "  -- Read channel holding registers.\n"
+        "  signal r_valid  : std_logic;\n"
+        "  signal r_data   : std_logic_vector(31 downto 0);\n"
+        "  signal r_resp   : std_logic_vector(1 downto 0);\n"
+        "begin\n"
+        "\n"
+     << conn.str()
+     << "\n"
+        "  mmio_awready <= not aw_valid;\n"
+        "  mmio_wready  <= not w_valid;\n"
+        "  mmio_bvalid  <= b_valid;\n"
+        "  mmio_bresp   <= b_resp;\n"
+        "  mmio_arready <= not r_valid;\n"
+        "  mmio_rvalid  <= r_valid;\n"
+        "  mmio_rdata   <= r_data;\n"
+        "  mmio_rresp   <= r_resp;\n"
+        "\n"
+        "  write_proc: process (kcd_clk) is\n"
+        "    variable wmask : std_logic_vector(31 downto 0);\n"
+        "  begin\n"
+        "    if rising_edge(kcd_clk) then\n"
+     << clr.str()
+     << "\n"
+        "      -- Accept the address and data independently.\n"
+        "      if mmio_awvalid = '1' and aw_valid = '0' then\n"
+        "        aw_valid <= '1';\n"
+        "        aw_addr  <= mmio_awaddr;\n"
+        "      end if;\n"
+        "      if mmio_wvalid = '1' and w_valid = '0' then\n"
+        "        w_valid <= '1';\n"
+        "        w_data  <= mmio_wdata;\n"
+        "        w_strb  <= mmio_wstrb;\n"
+        "      end if;\n"
+        "      if b_valid = '1' and mmio_bready = '1' then\n"
+        "        b_valid <= '0';\n"
+        "      end if;\n"
+        "\n"
+        "      -- Perform the write once both are available and the previous response was accepted.\n"
+        "      if aw_valid = '1' and w_valid = '1' and b_valid = '0' then\n"
+        "        for i in 0 to 3 loop\n"
+        "          wmask(8*i+7 downto 8*i) := (others => w_strb(i));\n"
+        "        end loop;\n"
+        "        aw_valid <= '0';\n"
+        "        w_valid  <= '0';\n"
+        "        b_valid  <= '1';\n"
+        "        b_resp   <= \"00\";\n"
+        "        case to_integer(unsigned(aw_addr(31 downto 2))) is\n"
+     << wr.str()
+     << "          when others =>\n"
+        "            b_resp <= \"11\";\n"
+        "        end case;\n"
+        "      end if;\n"
+        "\n"
+        "      if kcd_reset = '1' then\n"
+     << rst.str()
+     << "        aw_valid <= '0';\n"
+        "        w_valid  <= '0';\n"
+        "        b_valid  <= '0';\n"
+        "      end if;\n"
+        "    end if;\n"
+        "  end process;\n"
+        "\n"
+        "  read_proc: process (kcd_clk) is\n"
+        "  begin\n"
+        "    if rising_edge(kcd_clk) then\n"
+        "      if r_valid = '1' and mmio_rready = '1' then\n"
+        "        r_valid <= '0';\n"
+        "      end if;\n"
+        "\n"
+        "      if mmio_arvalid = '1' and r_valid = '0' then\n"
+        "        r_valid <= '1';\n"
+        "        r_data  <= (others => '0');\n"
+        "        r_resp  <= \"00\";\n"
+        "        case to_integer(unsigned(mmio_araddr(31 downto 2))) is\n"
+     << rd.str()
+     << "          when others =>\n"
+        "            r_resp <= \"11\";\n"
+        "        end case;\n"
+        "      end if;\n"
+        "\n"
+        "      if kcd_reset = '1' then\n"
+        "        r_valid <= '0';\n"
+        "      end if;\n"
+        "    end if;\n"
+        "  end process;\n"
+        "\n"
+        "end architecture;\n";
+  return ss.str();
+}
+
 bool ExposeToKernel(MmioFunction fun) {
   switch (fun) {
     case MmioFunction::DEFAULT: return true;
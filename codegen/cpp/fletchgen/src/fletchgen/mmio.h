@@ -41,10 +41,22 @@ constexpr char MMIO_DEFAULT[] = "fletchgen_mmio_default";
 constexpr char MMIO_BATCH[] = "fletchgen_mmio_batch";
 /// Fletchgen metadata for mmio-controlled buffer address ports.
 constexpr char MMIO_BUFFER[] = "fletchgen_mmio_buffer";
+/// Fletchgen metadata for mmio-controlled dictionary length ports.
+constexpr char MMIO_DICTIONARY[] = "fletchgen_mmio_dictionary";
 /// Fletchgen metadata for mmio-controlled kernel ports.
 constexpr char MMIO_KERNEL[] = "fletchgen_mmio_kernel";
 /// Fletchgen metadata for mmio-controlled profiling ports.
 constexpr char MMIO_PROFILE[] = "fletchgen_mmio_profile";
+/// Fletchgen metadata for mmio-controlled bus profiling ports, which the Nucleus routes to the Mantle.
+constexpr char MMIO_BUS_PROFILE[] = "fletchgen_mmio_bus_profile";
+/// Fletchgen metadata for the name of the stream that a profiling register belongs to.
+constexpr char MMIO_PROFILE_STREAM[] = "fletchgen_mmio_profile_stream";
+/// Fletchgen metadata for the bit width of the elements of the stream that a profiling register belongs to.
+constexpr char MMIO_PROFILE_ELEMENT_WIDTH[] = "fletchgen_mmio_profile_element_width";
+/// Fletchgen metadata for the name of the bus that a bus profiling register belongs to.
+constexpr char MMIO_PROFILE_BUS[] = "fletchgen_mmio_profile_bus";
+/// Fletchgen metadata for the data width of the bus that a bus profiling register belongs to.
+constexpr char MMIO_PROFILE_DATA_WIDTH[] = "fletchgen_mmio_profile_data_width";
 
 /// Register intended use enumeration.
 enum class MmioFunction {
@@ -60,6 +72,7 @@ enum class MmioBehavior {
   CONTROL,   ///< Register contents is controlled by host software.
   STATUS,    ///< Register contents is controlled by hardware kernel.
   STROBE,    ///< Register contents is asserted for one cycle by host software.
+  CONSTANT,  ///< Register contents is fixed at generation time, from the init value.
 };
 
 /// @brief Structure to represent an mmio register
@@ -116,6 +129,16 @@ struct MmioPort : public Port {
 std::shared_ptr<MmioPort> mmio_port(Port::Dir dir, const MmioReg &reg,
                                     const std::shared_ptr<ClockDomain> &domain = cerata::default_domain());
 
+/**
+ * @brief Assign a byte address to every register that does not have one yet.
+ *
+ * Any fixed addresses in the MmioReg.address field can only occur at the start of the vector set and must be ordered.
+ *
+ * @param regs  A vector of pointers to vectors of registers.
+ * @return The byte address offset of the next free register address.
+ */
+size_t AssignMmioAddresses(const std::vector<std::vector<MmioReg> *> &regs);
+
 /**
  * @brief Returns a YAML string for the vhdmmio tool based on a set of registers.
  *
@@ -127,11 +150,34 @@ std::shared_ptr<MmioPort> mmio_port(Port::Dir dir, const MmioReg &reg,
 std::string GenerateVhdmmioYaml(const std::vector<std::vector<MmioReg> *> &regs,
                                 std::optional<size_t *> next_addr = std::nullopt);
 
+/**
+ * @brief Generate the VHDL package declaring the MMIO component.
+ *
+ * The component declaration is identical to the one generated by vhdmmio for the same registers.
+ *
+ * @param regs  A vector of pointers to vectors of registers. Will be modified in case address was not set.
+ * @return The VHDL source of the mmio_pkg package.
+ */
+std::string GenerateMmioPackage(const std::vector<std::vector<MmioReg> *> &regs);
+
+/**
+ * @brief Generate the VHDL implementation of the MMIO component, without the need for vhdmmio.
+ *
+ * The implementation is an AXI4-lite slave with a 32-bit data bus. Control registers are writable and can be read
+ * back, strobe registers are asserted for one cycle after they are written, status registers read the corresponding
+ * input port and constant registers read their init value. Accesses to unmapped addresses result in a DECERR
+ * response.
+ *
+ * @param regs  A vector of pointers to vectors of registers. Will be modified in case address was not set.
+ * @return The VHDL source of the mmio entity and its architecture.
+ */
+std::string GenerateMmioVhdl(const std::vector<std::vector<MmioReg> *> &regs);
+
 /**
  * @brief Generate the MMIO component for the nucleus.
  *
- * Must generate the component in such a way that GenerateVhdmmioYaml in combination with the vhdmmio tool creates
- * an identical component interface.
+ * Must generate the component in such a way that GenerateMmioPackage, or GenerateVhdmmioYaml in combination with
+ * the vhdmmio tool, creates an identical component interface.
  *
  * @param[in]  batches         The RecordBatchDescriptions of the recordbatches in the design.
  * @param[in]  regs             A list of custom 32-bit register names.
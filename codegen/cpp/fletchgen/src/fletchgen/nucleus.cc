@@ -15,6 +15,7 @@
 #include "fletchgen/nucleus.h"
 
 #include <cerata/api.h>
+#include <fletcher/common.h>
 #include <vector>
 #include <string>
 #include <cerata/parameter.h>
@@ -207,6 +208,8 @@ Nucleus::Nucleus(const std::string &name,
 
   // Gather all Field-derived ports that require profiling on this Nucleus.
   ProfileDataStreams(mmio_inst);
+  // Expose the bus profiling registers to the Mantle.
+  ExposeBusProfiling(mmio_inst);
 }
 
 std::shared_ptr<Nucleus> nucleus(const std::string &name,
@@ -233,6 +236,7 @@ void Nucleus::ProfileDataStreams(Instance *mmio_inst) {
   cerata::NodeMap rebinding;
   // Insert a signal in between, and then mark that signal for profiling.
   std::vector<cerata::Signal *> profile_nodes;
+  std::vector<cerata::Signal *> histogram_nodes;
   for (const auto &p : GetFieldPorts(FieldPort::Function::ARROW)) {
     if (p->profile_) {
       // At this point, these ports should only have one edge straight into the kernel.
@@ -242,41 +246,50 @@ void Nucleus::ProfileDataStreams(Instance *mmio_inst) {
       // Insert a signal node in between that we can attach the profiler probe onto.
       auto s = AttachSignalToNode(this, p, &rebinding);
       profile_nodes.push_back(s);
+      if (fletcher::GetBoolMeta(*p->field_, fletcher::meta::PROFILE_HISTOGRAM, false)) {
+        histogram_nodes.push_back(s);
+      }
     }
   }
 
   if (!profile_nodes.empty()) {
-    // Attach stream profilers to the ports that need to be profiled.
-    auto profiler_map = EnableStreamProfiling(this, profile_nodes);
+    // Gather all mmio profile result ports
+    std::vector<MmioPort *> mmio_profile_ports;
+    for (auto &p : mmio_inst->GetAll<MmioPort>()) {
+      if ((p->reg.function == MmioFunction::PROFILE) && (p->reg.behavior == MmioBehavior::STATUS)
+          && (p->reg.meta.count(MMIO_BUS_PROFILE) == 0)) {
+        mmio_profile_ports.push_back(p);
+      }
+    }
+
+    // Attach stream profilers to the ports that need to be profiled, with counters as wide as their registers.
+    auto counter_width = mmio_profile_ports.empty() ? PROFILE_COUNTER_WIDTH : mmio_profile_ports.front()->reg.width;
+    auto profiler_map = EnableStreamProfiling(this, profile_nodes, counter_width, histogram_nodes);
 
     // TODO(johanpel): in the following code it is assumed ordering between profile nodes, streams and mmio ports is
     //  unchanged as well. This assumption might be a bit wild if things get added in the future, so it would be nice
     //  to figure out a better way to keep this synchronized.
 
-    // Get the enable and clear ports.
-    auto enable = signal("Profile_enable", cerata::bit(), kernel_cd());
-    auto clear = signal("Profile_clear", cerata::bit(), kernel_cd());
-    Add({enable, clear});
+    // Get the enable, clear and snapshot ports.
+    auto enable = signal(PROFILE_ENABLE, cerata::bit(), kernel_cd());
+    auto clear = signal(PROFILE_CLEAR, cerata::bit(), kernel_cd());
+    auto snapshot = signal(PROFILE_SNAPSHOT, cerata::bit(), kernel_cd());
+    Add({enable, clear, snapshot});
 
-    enable <<= mmio_inst->prt("f_Profile_enable_data");
-    clear <<= mmio_inst->prt("f_Profile_clear_data");
+    enable <<= mmio_inst->prt(std::string("f_") + PROFILE_ENABLE + "_data");
+    clear <<= mmio_inst->prt(std::string("f_") + PROFILE_CLEAR + "_data");
+    snapshot <<= mmio_inst->prt(std::string("f_") + PROFILE_SNAPSHOT + "_data");
 
-    // Gather all mmio profile result ports
-    std::vector<MmioPort *> mmio_profile_ports;
-    for (auto &p : mmio_inst->GetAll<MmioPort>()) {
-      if ((p->reg.function == MmioFunction::PROFILE) && (p->reg.behavior == MmioBehavior::STATUS)) {
-        mmio_profile_ports.push_back(p);
-      }
-    }
-    // Loop over all profiled nodes and connect them.
+    // Loop over all profiled nodes in the order of their registers and connect them.
     size_t port_idx = 0;
-    for (const auto &pair : profiler_map) {
-      auto instances = pair.second.first;
-      auto ports = pair.second.second;
+    for (const auto &node : profile_nodes) {
+      const auto &instances = profiler_map.at(node).first;
+      const auto &ports = profiler_map.at(node).second;
 
       for (const auto &prof_inst : instances) {
         Connect(prof_inst->prt("enable"), enable.get());
         Connect(prof_inst->prt("clear"), clear.get());
+        Connect(prof_inst->prt("snapshot"), snapshot.get());
       }
 
       for (const auto &prof_port : ports) {
@@ -287,4 +300,20 @@ void Nucleus::ProfileDataStreams(Instance *mmio_inst) {
   }
 }
 
+void Nucleus::ExposeBusProfiling(Instance *mmio_inst) {
+  // The bus profilers are inserted in the Mantle, so the registers are routed through ports of the same name.
+  for (auto &p : mmio_inst->GetAll<MmioPort>()) {
+    if (p->reg.meta.count(MMIO_BUS_PROFILE) > 0) {
+      auto nucleus_port = mmio_port(p->dir(), p->reg, kernel_cd());
+      nucleus_port->SetName(p->reg.name);
+      Add(nucleus_port);
+      if (p->dir() == Port::Dir::OUT) {
+        Connect(nucleus_port, p);
+      } else {
+        Connect(p, nucleus_port);
+      }
+    }
+  }
+}
+
 }  // namespace fletchgen
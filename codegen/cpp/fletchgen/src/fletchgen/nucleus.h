@@ -49,6 +49,8 @@ struct Nucleus : Component {
 
   /// @brief Profile any Arrow data streams that require profiling.
   void ProfileDataStreams(Instance *mmio_inst);
+  /// @brief Expose the bus profiling registers of the mmio instance as ports of this Nucleus.
+  void ExposeBusProfiling(Instance *mmio_inst);
 
   /// The kernel component.
   std::shared_ptr<Kernel> kernel;
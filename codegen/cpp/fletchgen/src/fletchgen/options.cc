@@ -42,6 +42,25 @@ bool Options::Parse(Options *options, int argc, char **argv) {
                  "Memory model contents output file (formatted as SREC).");
   app.add_option("-t,--srec_dump", options->srec_sim_dump,
                  "Path to dump memory model contents to after simulation (formatted as SREC).");
+  app.add_option("--sim_format", options->sim_format,
+                 "Format of the memory model contents files of the -s and -t options. Available formats:\n"
+                 "  srec : Motorola S-record text file (default).\n"
+                 "  bin  : Raw binary memory image. A JSON description of the offsets of all buffers in the image is "
+                 "saved to <recordbatch_output>.json.\n"
+                 "Raw binary images are less than half the size of S-record files and much faster to load and dump "
+                 "in simulation.")
+      ->check(CLI::IsMember({"srec", "bin"}));
+  app.add_option("--sim_mem_latency", options->sim_mem_latency,
+                 "Latency of the simulation memory model in bus clock cycles, from accepting a read request until its "
+                 "first beat is returned. Default: 0");
+  app.add_option("--sim_mem_beat_cycles", options->sim_mem_beat_cycles,
+                 "Number of bus clock cycles per data beat of the simulation memory model. The memory bandwidth is one "
+                 "bus data word per this number of cycles. Default: 1")
+      ->check(CLI::Range(1, 1 << 16));
+  app.add_option("--sim_mem_outstanding", options->sim_mem_outstanding,
+                 "Maximum number of outstanding read bursts of the simulation memory model. Together with "
+                 "--sim_mem_latency, this determines how well the memory latency is hidden. Default: 1")
+      ->check(CLI::Range(1, 1 << 16));
 
   // Output options:
   app.add_option("-o,--output_path", options->output_dir,
@@ -52,12 +71,14 @@ bool Options::Parse(Options *options, int argc, char **argv) {
                  "seperate subfolder (e.g. <output folder>/vhdl/...). \n"
                  "Available languages:\n"
                  "  vhdl : Export as VHDL files (default).\n"
-                 "  dot  : Export as DOT graphs.");
+                 "  dot  : Export as DOT graphs (default).\n"
+                 "  cpp  : Export a C++ header with the register map for host software (default).");
 
   app.add_flag("-b,--backup", options->backup,
-               "Backup generated source code files if they exists already. If this flag is used and the source "
-               "file exists already in the specified path, the output filename will be <filename>.bak. This "
-               "file is always overwritten.");
+               "Backup generated source code files if they exist already and their contents change. If this flag "
+               "is used, the existing file is copied to <filename>.bak before it is rewritten. This file is always "
+               "overwritten. Files of which the contents do not change are never rewritten; all generated files are "
+               "listed in <output folder>/fletchgen.manifest, where the changed files are marked as dirty.");
 
   app.add_option("--regs", options->regs,
                  "Names of custom registers in the following format: \"<behavior>:<width>:<name>:<init>\", "
@@ -77,15 +98,79 @@ bool Options::Parse(Options *options, int argc, char **argv) {
                  "  lw : Bus burst length width.\n"
                  "  bs : Bus minimum burst size.\n"
                  "  bm : Bus maximum burst size.\n"
-                 "Currently supports only one top-level bus specification. Default: \"64,512,64,8,1,16\"");
+                 "Multiple specifications set the bus parameters of successive memory channels, where the last one "
+                 "applies to all remaining channels. RecordBatches are assigned to a channel through the "
+                 "fletcher_bus_channel schema metadata, and may override the channel specification through the "
+                 "fletcher_bus_spec schema metadata. Default: \"64,512,8,1,16\"");
+
+  app.add_option("--arb_method", options->arb_method,
+                 "Arbitration method of the bus arbiters between the RecordBatch bus ports of every memory channel. "
+                 "Available methods:\n"
+                 "  ROUND-ROBIN : Round-robin arbitration.\n"
+                 "  RR-STICKY   : Round-robin arbitration that favors the last granted port (default).\n"
+                 "  FIXED       : Fixed-priority arbitration. RecordBatches with a higher fletcher_bus_weight schema "
+                 "metadata value take precedence.\n"
+                 "  WEIGHTED    : Weighted round-robin arbitration. Every RecordBatch may issue as many requests per "
+                 "round as its fletcher_bus_weight schema metadata value (default 1).")
+      ->check(CLI::IsMember({"ROUND-ROBIN", "RR-STICKY", "FIXED", "WEIGHTED"}));
+  app.add_option("--arb_max_outstanding", options->arb_max_outstanding,
+                 "Maximum number of outstanding requests of every bus arbiter. Default: 4")
+      ->check(CLI::Range(1, 1 << 16));
+  app.add_option("--arb_buffer_depth", options->arb_buffer_depth,
+                 "Depth of the BusReadBuffer or BusWriteBuffer inserted between every RecordBatch bus port and its bus "
+                 "arbiter, in bus beats. A buffer only passes on a request once it can absorb the whole burst, such "
+                 "that a slow RecordBatch cannot stall the other RecordBatches on its memory channel. Can be set per "
+                 "RecordBatch through the fletcher_bus_buffer_depth schema metadata. Zero inserts no buffers. Otherwise, the depth "
+                 "must exceed the burst max length of the memory channel. Default: 0")
+      ->check(CLI::Range(0, 1 << 16));
+
+  app.add_flag("--auto_epc", options->auto_epc,
+               "Derive the elements-per-cycle (EPC) of every primitive, string, binary and list of primitives field "
+               "that has no fletcher_epc metadata from the data width of its bus, such that the field stream uses "
+               "(a fraction of) the full bus bandwidth. The EPC is the largest power of two of which the elements fit "
+               "in the utilized part of the bus data width. The chosen values are reported in the log.");
+  app.add_option("--epc_utilization", options->epc_utilization,
+                 "Targeted fraction of the bus data width used by every field stream with --auto_epc. Default: 1.0")
+      ->check(CLI::Range(0.0, 1.0));
+
+  app.add_flag("--bus_profile", options->bus_profile,
+               "Insert bus profilers on the bus master ports and on every RecordBatch bus port of the Mantle. Every "
+               "profiled bus gets MMIO registers counting requested beats, data beats, request stall cycles, the peak "
+               "number of outstanding bursts and the number of profiled cycles. The bus profilers count in the "
+               "bus clock domain, synchronize their registers with the kernel clock domain, and are enabled and "
+               "cleared through the Profile_bus_enable and Profile_bus_clear registers.");
+
+  app.add_option("--profile_width", options->profile_width,
+                 "Bit width of the stream and bus profiler counters and their MMIO registers. Counters wider than 32 "
+                 "bits span two registers. The counters are copied to their registers on a write to the "
+                 "Profile_snapshot or Profile_bus_snapshot register, such that a single snapshot is read even while "
+                 "the profilers are enabled. Default: 64")
+      ->check(CLI::Range(1, 64));
+
+  app.add_option("--replicas", options->replicas,
+                 "Number of parallel replicas of the Mantle. If larger than one, a Wrapper component is generated that "
+                 "instantiates the Mantle this many times. Every replica gets its own MMIO register window and bus "
+                 "arbiter port, and the host runtime divides the RecordBatch ranges over the replicas. At most 255. "
+                 "Default: 1")
+      ->check(CLI::Range(1, 255));
 
   app.add_flag("--axi", options->axi_top,
                "Generate AXI top-level template (VHDL only).");
   app.add_flag("--sim", options->sim_top,
                "Generate simulation top-level template (VHDL only).");
+  app.add_flag("--cosim", options->cosim_top,
+               "Generate a co-simulation top-level (VHDL only) that connects the design to the SimHost model of the "
+               "Sim platform, such that host programs using the \"sim\" platform drive the simulated design.");
+  app.add_flag("--vhdmmio", options->vhdmmio,
+               "Generate the MMIO component using the external vhdmmio tool instead of the built-in generator. "
+               "Requires a Python environment with vhdmmio, but also generates register documentation.");
   app.add_flag("--vivado_hls", options->vivado_hls,
                "Generate a Vivado HLS kernel template.");
 
+  app.add_option("-j,--jobs", options->jobs,
+                 "Number of threads used to generate independent output files concurrently. The output does not "
+                 "depend on the number of threads. Default: 0, which uses one thread per hardware thread.");
+
   // Other options:
   app.add_flag("-v,--version", options->version,
                "Show version.");
@@ -35,24 +35,54 @@ struct Options {
   /// Output directory.
   std::string output_dir = ".";
   /// Output languages.
-  std::vector<std::string> languages = {"vhdl", "dot"};
+  std::vector<std::string> languages = {"vhdl", "dot", "cpp"};
   /// SREC output path. This is the path where an SREC file based on input RecordBatches will be placed.
   std::string srec_out_path;
   /// SREC simulation output path, where the simulation should dump the memory contents of written RecordBatches.
   std::string srec_sim_dump;
+  /// Format of the simulation memory contents files, either "srec" or "bin" (raw binary image).
+  std::string sim_format = "srec";
+  /// Latency of the simulation memory model in bus clock cycles, from accepting a read request to its first beat.
+  uint32_t sim_mem_latency = 0;
+  /// Number of bus clock cycles per beat of the simulation memory model, limiting its bandwidth.
+  uint32_t sim_mem_beat_cycles = 1;
+  /// Maximum number of outstanding read bursts of the simulation memory model.
+  uint32_t sim_mem_outstanding = 1;
   /// Name of the Kernel.
   std::string kernel_name = "Kernel";
   /// Custom 32-bit registers.
   std::vector<std::string> regs;
   /// Bus dimensions strings.
   std::vector<std::string> bus_dims = {"64,512,8,1,16"};
+  /// Arbitration method of the bus arbiters.
+  std::string arb_method = "RR-STICKY";
+  /// Maximum number of outstanding requests of every bus arbiter.
+  uint32_t arb_max_outstanding = 4;
+  /// Depth of the buffers between RecordBatch bus ports and bus arbiters, unless set through schema metadata.
+  uint32_t arb_buffer_depth = 0;
+  /// Number of parallel replicas of the Mantle in the design.
+  size_t replicas = 1;
+  /// Whether to derive the elements-per-cycle of fields without EPC metadata from the bus data width.
+  bool auto_epc = false;
+  /// Targeted fraction of the bus data width used by every field stream when deriving EPC automatically.
+  double epc_utilization = 1.0;
+  /// Whether to insert bus profilers on the bus master ports and RecordBatch bus ports of the Mantle.
+  bool bus_profile = false;
+  /// Bit width of the stream and bus profiler counters.
+  uint32_t profile_width = 64;
 
   /// Whether to generate an AXI top level.
   bool axi_top = false;
   /// Whether to simulate an AXI top level.
   bool sim_top = false;
+  /// Whether to generate a co-simulation top level for the Sim platform.
+  bool cosim_top = false;
   /// Whether to backup any existing generated files.
   bool backup = false;
+  /// Whether to generate the MMIO component using the external vhdmmio tool instead of the built-in generator.
+  bool vhdmmio = false;
+  /// Number of threads used to generate output. Zero means one per hardware thread.
+  size_t jobs = 0;
 
   /// Vivado HLS template. TODO(johanpel): not yet implemented.
   bool vivado_hls = false;
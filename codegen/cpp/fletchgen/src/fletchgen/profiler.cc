@@ -15,12 +15,18 @@
 #include "fletchgen/profiler.h"
 
 #include <cerata/api.h>
+#include <fletcher/common.h>
+#include <algorithm>
 #include <cmath>
 #include <memory>
 #include <vector>
 #include <tuple>
+#include <string>
+#include <utility>
 
+#include "fletchgen/array.h"
 #include "fletchgen/basic_types.h"
+#include "fletchgen/bus.h"
 #include "fletchgen/nucleus.h"
 
 namespace fletchgen {
@@ -35,8 +41,6 @@ using cerata::field;
 using cerata::integer;
 using cerata::bit;
 
-static constexpr uint32_t COUNT_WIDTH = 32;
-
 // Vhdmmio documentation strings for profiling:
 namespace doc {
 static constexpr char e[] = "Element count. Accumulates the number of elements transferred on the stream. "
@@ -53,6 +57,14 @@ static constexpr char p[] = "Packet count. Increments each time the last signal
 static constexpr char c[] = "Cycle count. Increments each clock cycle while profiler is enabled.";
 }  // namespace doc
 
+// Vhdmmio documentation strings for stall-length histograms:
+namespace hist_doc {
+static constexpr char s[] = "Stall histogram bucket. Increments each time the stream was valid but not ready for a "
+                            "number of consecutive cycles within the range of the bucket.";
+static constexpr char w[] = "Starve histogram bucket. Increments each time the stream was ready but not valid for a "
+                            "number of consecutive cycles within the range of the bucket.";
+}  // namespace hist_doc
+
 namespace name {
 static constexpr char e[] = "elements";
 static constexpr char v[] = "valids";
@@ -60,25 +72,70 @@ static constexpr char r[] = "readies";
 static constexpr char t[] = "transfers";
 static constexpr char p[] = "packets";
 static constexpr char c[] = "cycles";
+static constexpr char s[] = "stall";
+static constexpr char w[] = "starve";
 }  // namespace name
 
-std::vector<MmioReg> GetProfilingRegs(const std::vector<std::shared_ptr<RecordBatch>> &recordbatches) {
+// Vhdmmio documentation strings for bus profiling:
+namespace bus_doc {
+static constexpr char q[] = "Requested beats. Accumulates the burst length of every request accepted on the bus.";
+static constexpr char d[] = "Data beats. Increments for each beat transferred on the data channel of the bus.";
+static constexpr char s[] = "Request stall count. Increments each cycle that a request is valid, but not accepted.";
+static constexpr char o[] = "Peak number of outstanding bursts, i.e. bursts that were requested, but of which the last "
+                            "beat was not transferred yet.";
+static constexpr char c[] = "Cycle count. Increments each bus clock cycle while the bus profilers are enabled.";
+static constexpr char b[] = "Busy. High from a snapshot until the counter registers of the bus hold it.";
+}  // namespace bus_doc
+
+namespace bus_name {
+static constexpr char q[] = "req_beats";
+static constexpr char d[] = "dat_beats";
+static constexpr char s[] = "req_stalls";
+static constexpr char o[] = "max_outstanding";
+static constexpr char c[] = "cycles";
+}  // namespace bus_name
+
+/// @brief Return the bit width of the elements of the s-th stream of an Arrow field, or zero if it is not known.
+static uint32_t StreamElementWidth(const arrow::Field &field, int s) {
+  auto fixed_width = [](const arrow::DataType &type) -> uint32_t {
+    auto fwt = dynamic_cast<const arrow::FixedWidthType *>(&type);
+    return fwt == nullptr ? 0 : fwt->bit_width();
+  };
+  switch (GetConfigType(*field.type())) {
+    case ConfigType::PRIM: return s == 0 ? fixed_width(*field.type()) : 0;
+    case ConfigType::LIST_PRIM:
+      // A length stream of offsets, followed by a stream of values. Strings and binaries have byte values.
+      if (s == 0) return 32;
+      if (s == 1) return field.type()->id() == arrow::Type::LIST ? fixed_width(*field.type()->field(0)->type()) : 8;
+      return 0;
+    default: return 0;
+  }
+}
+
+std::vector<MmioReg> GetProfilingRegs(const std::vector<std::shared_ptr<RecordBatch>> &recordbatches,
+                                      uint32_t counter_width) {
   std::vector<MmioReg> profile_regs;
   using MF = MmioFunction;
   using MB = MmioBehavior;
 
   profile_regs.emplace_back(MF::PROFILE,
                             MB::CONTROL,
-                            "Profile_enable",
+                            PROFILE_ENABLE,
                             "Activates profiler counting when this bit is high.",
                             1);
 
   profile_regs.emplace_back(MF::PROFILE,
                             MB::STROBE,
-                            "Profile_clear",
+                            PROFILE_CLEAR,
                             "Resets profiler counters when this bit is asserted.",
                             1);
 
+  profile_regs.emplace_back(MF::PROFILE,
+                            MB::STROBE,
+                            PROFILE_SNAPSHOT,
+                            "Latches all profiler counters into their registers when this bit is asserted.",
+                            1);
+
   for (const auto &rb : recordbatches) {
     auto fps = rb->GetFieldPorts();
     for (const auto &fp : fps) {
@@ -90,13 +147,32 @@ std::vector<MmioReg> GetProfilingRegs(const std::vector<std::shared_ptr<RecordBa
           if (dynamic_cast<cerata::Stream *>(fti.type_) != nullptr) {
             const auto pre = "Profile_" + fti.name(cerata::NamePart(fp->name()));  // prefix
             const auto sis = "_" + std::to_string(si) + "_";  // stream index string
-            MmioReg e(MF::PROFILE, MB::STATUS, pre + sis + name::e, doc::e, COUNT_WIDTH);
-            MmioReg v(MF::PROFILE, MB::STATUS, pre + sis + name::v, doc::v, COUNT_WIDTH);
-            MmioReg r(MF::PROFILE, MB::STATUS, pre + sis + name::r, doc::r, COUNT_WIDTH);
-            MmioReg t(MF::PROFILE, MB::STATUS, pre + sis + name::t, doc::t, COUNT_WIDTH);
-            MmioReg p(MF::PROFILE, MB::STATUS, pre + sis + name::p, doc::p, COUNT_WIDTH);
-            MmioReg c(MF::PROFILE, MB::STATUS, pre + sis + name::c, doc::c, COUNT_WIDTH);
+            MmioReg e(MF::PROFILE, MB::STATUS, pre + sis + name::e, doc::e, counter_width);
+            MmioReg v(MF::PROFILE, MB::STATUS, pre + sis + name::v, doc::v, counter_width);
+            MmioReg r(MF::PROFILE, MB::STATUS, pre + sis + name::r, doc::r, counter_width);
+            MmioReg t(MF::PROFILE, MB::STATUS, pre + sis + name::t, doc::t, counter_width);
+            MmioReg p(MF::PROFILE, MB::STATUS, pre + sis + name::p, doc::p, counter_width);
+            MmioReg c(MF::PROFILE, MB::STATUS, pre + sis + name::c, doc::c, counter_width);
+            // Remember the stream that the registers belong to, for the profile register map.
+            auto stream_name = fti.name(cerata::NamePart(fp->name())) + "_" + std::to_string(si);
+            auto element_width = std::to_string(StreamElementWidth(*fp->field_, si));
+            for (auto reg : {&e, &v, &r, &t, &p, &c}) {
+              reg->meta[MMIO_PROFILE_STREAM] = stream_name;
+              reg->meta[MMIO_PROFILE_ELEMENT_WIDTH] = element_width;
+            }
             profile_regs.insert(profile_regs.end(), {e, v, r, t, p, c});
+            // Stall and starve histogram buckets, in the order of the StallHistogram ports.
+            if (fletcher::GetBoolMeta(*fp->field_, fletcher::meta::PROFILE_HISTOGRAM, false)) {
+              for (const auto &h : {std::make_pair(name::s, hist_doc::s), std::make_pair(name::w, hist_doc::w)}) {
+                for (size_t b = 0; b < PROFILE_HISTOGRAM_BUCKETS; b++) {
+                  MmioReg hr(MF::PROFILE, MB::STATUS, pre + sis + h.first + "_" + std::to_string(b), h.second,
+                             counter_width);
+                  hr.meta[MMIO_PROFILE_STREAM] = stream_name;
+                  hr.meta[MMIO_PROFILE_ELEMENT_WIDTH] = element_width;
+                  profile_regs.push_back(hr);
+                }
+              }
+            }
             si++;
           }
         }
@@ -106,6 +182,91 @@ std::vector<MmioReg> GetProfilingRegs(const std::vector<std::shared_ptr<RecordBa
   return profile_regs;
 }
 
+std::vector<std::string> BusProfileRegNames(const std::string &bus_name) {
+  std::vector<std::string> result;
+  for (const auto &counter : {bus_name::q, bus_name::d, bus_name::s, bus_name::o, bus_name::c}) {
+    result.push_back("Profile_" + bus_name + "_" + counter);
+  }
+  return result;
+}
+
+std::string BusProfileBusyRegName(const std::string &bus_name) {
+  return "Profile_" + bus_name + "_busy";
+}
+
+std::vector<MmioReg> GetBusProfilingRegs(const std::vector<std::shared_ptr<RecordBatch>> &recordbatches,
+                                         uint32_t counter_width) {
+  std::vector<MmioReg> profile_regs;
+  using MF = MmioFunction;
+  using MB = MmioBehavior;
+
+  profile_regs.emplace_back(MF::PROFILE,
+                            MB::CONTROL,
+                            BUS_PROFILE_ENABLE,
+                            "Activates bus profiler counting when this bit is high.",
+                            1);
+
+  profile_regs.emplace_back(MF::PROFILE,
+                            MB::STROBE,
+                            BUS_PROFILE_CLEAR,
+                            "Resets bus profiler counters when this bit is asserted.",
+                            1);
+
+  profile_regs.emplace_back(MF::PROFILE,
+                            MB::STROBE,
+                            BUS_PROFILE_SNAPSHOT,
+                            "Latches all bus profiler counters into their registers when this bit is asserted.",
+                            1);
+
+  // Every bus arbiter master port, named like the Mantle port it drives, and every RecordBatch bus port is profiled.
+  std::vector<std::pair<std::string, uint32_t>> masters;  // name and data width
+  std::vector<std::pair<std::string, uint32_t>> slaves;
+  for (const auto &rb : recordbatches) {
+    for (const auto &bp : rb->GetAll<BusPort>()) {
+      auto mst = ChannelName(rb->bus_channel(), bp->spec_.func == BusFunction::READ ? "rd_mst" : "wr_mst");
+      auto dw = bp->spec_.dim.plain.dw;
+      if (std::find_if(masters.begin(), masters.end(), [&](const auto &m) { return m.first == mst; })
+          == masters.end()) {
+        masters.emplace_back(mst, dw);
+      }
+      slaves.emplace_back(bp->name(), dw);
+    }
+  }
+  masters.insert(masters.end(), slaves.begin(), slaves.end());
+  for (const auto &bus : masters) {
+    auto names = BusProfileRegNames(bus.first);
+    MmioReg q(MF::PROFILE, MB::STATUS, names[0], bus_doc::q, counter_width);
+    MmioReg d(MF::PROFILE, MB::STATUS, names[1], bus_doc::d, counter_width);
+    MmioReg s(MF::PROFILE, MB::STATUS, names[2], bus_doc::s, counter_width);
+    MmioReg o(MF::PROFILE, MB::STATUS, names[3], bus_doc::o, counter_width);
+    MmioReg c(MF::PROFILE, MB::STATUS, names[4], bus_doc::c, counter_width);
+    MmioReg b(MF::PROFILE, MB::STATUS, BusProfileBusyRegName(bus.first), bus_doc::b, 1);
+    // Remember the bus that the registers belong to, for the profile register map.
+    for (auto reg : {&q, &d, &s, &o, &c, &b}) {
+      reg->meta[MMIO_PROFILE_BUS] = bus.first;
+      reg->meta[MMIO_PROFILE_DATA_WIDTH] = std::to_string(bus.second);
+    }
+    profile_regs.insert(profile_regs.end(), {q, d, s, o, c, b});
+  }
+
+  // Mark the registers, such that the Mantle can connect their ports to the bus profilers.
+  for (auto &r : profile_regs) {
+    r.meta[MMIO_BUS_PROFILE] = "true";
+  }
+  return profile_regs;
+}
+
+std::shared_ptr<cerata::Type> bus_probe(const std::shared_ptr<Node> &len_width) {
+  // All fields of the probe travel in the same direction.
+  auto result = record("bus_probe", {field("req_valid", bit()),
+                                     field("req_ready", bit()),
+                                     field("req_len", vector(len_width)),
+                                     field("dat_valid", bit()),
+                                     field("dat_ready", bit()),
+                                     field("dat_last", bit())});
+  return result;
+}
+
 std::shared_ptr<cerata::Type> stream_probe(const std::shared_ptr<Node> &count_width) {
   // We require a probe stream where the valid and ready are control fields that travel in the same direction.
   // flat type indices:
@@ -126,13 +287,14 @@ static Component *profiler() {
 
   // Parameters
   auto icw = parameter("PROBE_COUNT_WIDTH", integer(), cerata::intl(1));
-  auto ocw = parameter("OUT_COUNT_WIDTH", integer(), cerata::intl(32));
+  auto ocw = parameter("OUT_COUNT_WIDTH", integer(), cerata::intl(PROFILE_COUNTER_WIDTH));
   auto oct = vector("out_count_type", ocw);
 
   auto pcr = port("pcd", cr(), Port::Dir::IN);
   auto probe = port("probe", stream_probe(icw), Port::Dir::IN);
   auto enable = port("enable", bit(), Port::Dir::IN);
   auto clear = port("clear", bit(), Port::Dir::IN);
+  auto snapshot = port("snapshot", bit(), Port::Dir::IN);
   auto e = port(std::string("count_") + name::e, oct, Port::Dir::OUT);
   auto v = port(std::string("count_") + name::v, oct, Port::Dir::OUT);
   auto r = port(std::string("count_") + name::r, oct, Port::Dir::OUT);
@@ -141,7 +303,7 @@ static Component *profiler() {
   auto c = port(std::string("count_") + name::c, oct, Port::Dir::OUT);
 
   // Component & ports
-  auto ret = component("Profiler", {icw, ocw, pcr, probe, enable, clear, e, v, r, t, p, c});
+  auto ret = component("Profiler", {icw, ocw, pcr, probe, enable, clear, snapshot, e, v, r, t, p, c});
 
   // VHDL metadata
   ret->SetMeta(cerata::vhdl::meta::PRIMITIVE, "true");
@@ -151,12 +313,168 @@ static Component *profiler() {
   return ret.get();
 }
 
+static Component *stall_histogram() {
+  // Check if the StallHistogram component was already created.
+  auto opt_comp = cerata::default_component_pool()->Get("StallHistogram");
+  if (opt_comp) {
+    return *opt_comp;
+  }
+
+  // Parameters
+  auto icw = parameter("PROBE_COUNT_WIDTH", integer(), cerata::intl(1));
+  auto ocw = parameter("OUT_COUNT_WIDTH", integer(), cerata::intl(PROFILE_COUNTER_WIDTH));
+  auto oct = vector("out_count_type", ocw);
+
+  auto pcr = port("pcd", cr(), Port::Dir::IN);
+  auto probe = port("probe", stream_probe(icw), Port::Dir::IN);
+  auto enable = port("enable", bit(), Port::Dir::IN);
+  auto clear = port("clear", bit(), Port::Dir::IN);
+  auto snapshot = port("snapshot", bit(), Port::Dir::IN);
+
+  // Component & ports
+  auto ret = component("StallHistogram", {icw, ocw, pcr, probe, enable, clear, snapshot});
+  for (const auto &h : {name::s, name::w}) {
+    for (size_t b = 0; b < PROFILE_HISTOGRAM_BUCKETS; b++) {
+      ret->Add(port(std::string("count_") + h + "_" + std::to_string(b), oct, Port::Dir::OUT));
+    }
+  }
+
+  // VHDL metadata
+  ret->SetMeta(cerata::vhdl::meta::PRIMITIVE, "true");
+  ret->SetMeta(cerata::vhdl::meta::LIBRARY, "work");
+  ret->SetMeta(cerata::vhdl::meta::PACKAGE, "Profile_pkg");
+
+  return ret.get();
+}
+
+static Component *bus_profiler() {
+  // Check if the BusProfiler component was already created.
+  auto opt_comp = cerata::default_component_pool()->Get("BusProfiler");
+  if (opt_comp) {
+    return *opt_comp;
+  }
+
+  // Parameters
+  auto lw = bus_len_width();
+  auto ocw = parameter("OUT_COUNT_WIDTH", integer(), cerata::intl(PROFILE_COUNTER_WIDTH));
+  auto oct = vector("out_count_type", ocw);
+
+  // The profiler counts in the bus clock domain, and synchronizes its control and counters with the kernel domain.
+  auto pcr = port("pcd", cr(), Port::Dir::IN, bus_cd());
+  auto kcr = port("kcd", cr(), Port::Dir::IN, kernel_cd());
+  auto probe = port("probe", bus_probe(lw), Port::Dir::IN, bus_cd());
+  auto enable = port("enable", bit(), Port::Dir::IN, kernel_cd());
+  auto clear = port("clear", bit(), Port::Dir::IN, kernel_cd());
+  auto snapshot = port("snapshot", bit(), Port::Dir::IN, kernel_cd());
+  auto q = port(std::string("count_") + bus_name::q, oct, Port::Dir::OUT, kernel_cd());
+  auto d = port(std::string("count_") + bus_name::d, oct, Port::Dir::OUT, kernel_cd());
+  auto s = port(std::string("count_") + bus_name::s, oct, Port::Dir::OUT, kernel_cd());
+  auto o = port(std::string("count_") + bus_name::o, oct, Port::Dir::OUT, kernel_cd());
+  auto c = port(std::string("count_") + bus_name::c, oct, Port::Dir::OUT, kernel_cd());
+  auto busy = port("busy", bit(), Port::Dir::OUT, kernel_cd());
+
+  // Component & ports
+  auto ret = component("BusProfiler", {lw, ocw, pcr, kcr, probe, enable, clear, snapshot, q, d, s, o, c, busy});
+
+  // VHDL metadata
+  ret->SetMeta(cerata::vhdl::meta::PRIMITIVE, "true");
+  ret->SetMeta(cerata::vhdl::meta::LIBRARY, "work");
+  ret->SetMeta(cerata::vhdl::meta::PACKAGE, "Profile_pkg");
+
+  return ret.get();
+}
+
+/**
+ * @brief Return the index of a flattened type with a name that starts with a group name and ends with a leaf name.
+ *
+ * Any nested names in between are ignored, such that e.g. the burst length of a bus read request stream is found with
+ * group "rreq" and leaf "len", regardless of how the stream element is named. Returns -1 if there is no such type.
+ */
+static int FlatIndex(const std::vector<cerata::FlatType> &flat_types,
+                     const std::string &group,
+                     const std::string &leaf) {
+  auto head = "x_" + group + "_";
+  auto tail = "_" + leaf;
+  for (size_t i = 0; i < flat_types.size(); i++) {
+    auto name = flat_types[i].name(cerata::NamePart("x", true));
+    if ((name.size() >= head.size() + leaf.size()) && (name.compare(0, head.size(), head) == 0)
+        && (name.compare(name.size() - tail.size(), tail.size(), tail) == 0)) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+std::pair<Instance *, std::vector<Port *>> EnableBusProfiling(cerata::Component *comp,
+                                                              cerata::Signal *node,
+                                                              const BusDimParams &params,
+                                                              uint32_t counter_width) {
+  FLETCHER_LOG(DEBUG, "Inserting bus profiler for bus node " + node->name() + ".");
+  auto domain = *GetDomain(*node);
+  auto cr_node = GetClockResetPort(comp, *domain);
+  if (!cr_node) {
+    throw std::runtime_error("No clock/reset port present on component [" + comp->name()
+                                 + "] for clock domain [" + domain->name()
+                                 + "] of bus node [" + node->name() + "].");
+  }
+  auto kcr_node = GetClockResetPort(comp, *kernel_cd());
+  if (!kcr_node) {
+    throw std::runtime_error("No clock/reset port present on component [" + comp->name()
+                                 + "] for the kernel clock domain of the bus profiler of node [" + node->name() + "].");
+  }
+
+  // Instantiate a bus profiler and connect its bus parameters.
+  auto profiler_inst = comp->Instantiate(bus_profiler(), bus_profiler()->name() + "_" + node->name() + "_inst");
+  ConnectBusParam(profiler_inst, "", params, comp->inst_to_comp_map());
+  profiler_inst->par("OUT_COUNT_WIDTH") <<= intl(static_cast<int>(counter_width));
+  auto p_probe = profiler_inst->prt("probe");
+
+  // Map the handshake signals, burst length and last flag of the bus onto the probe.
+  auto mapper = TypeMapper::Make(node->type(), p_probe->type());
+  auto matrix = mapper->map_matrix().Empty();
+  std::string req = FlatIndex(mapper->flat_a(), "rreq", "valid") >= 0 ? "rreq" : "wreq";
+  std::string dat = req == "rreq" ? "rdat" : "wdat";
+  // Group and leaf names of the bus signals, and of the probe signals they map onto.
+  const std::vector<std::tuple<std::string, std::string, std::string>> map = {{req, "valid", "req"},
+                                                                              {req, "ready", "req"},
+                                                                              {req, "len", "req"},
+                                                                              {dat, "valid", "dat"},
+                                                                              {dat, "ready", "dat"},
+                                                                              {dat, "last", "dat"}};
+  for (const auto &m : map) {
+    auto a = FlatIndex(mapper->flat_a(), std::get<0>(m), std::get<1>(m));
+    auto b = FlatIndex(mapper->flat_b(), std::get<2>(m), std::get<1>(m));
+    if ((a < 0) || (b < 0)) {
+      throw std::runtime_error("Cannot profile node [" + node->name() + "] of type [" + node->type()->name()
+                                   + "], since it is not a bus.");
+    }
+    matrix(a, b) = 1;
+  }
+  mapper->SetMappingMatrix(matrix);
+  node->type()->AddMapper(mapper);
+
+  // Connect the clock/reset and probe.
+  Connect(profiler_inst->prt("pcd"), *cr_node);
+  Connect(profiler_inst->prt("kcd"), *kcr_node);
+  Connect(p_probe, node);
+
+  auto counters = std::vector<Port *>({profiler_inst->prt(std::string("count_") + bus_name::q),
+                                       profiler_inst->prt(std::string("count_") + bus_name::d),
+                                       profiler_inst->prt(std::string("count_") + bus_name::s),
+                                       profiler_inst->prt(std::string("count_") + bus_name::o),
+                                       profiler_inst->prt(std::string("count_") + bus_name::c)});
+  return {profiler_inst, counters};
+}
+
 NodeProfilerPorts EnableStreamProfiling(cerata::Component *comp,
-                                        const std::vector<cerata::Signal *> &profile_nodes) {
+                                        const std::vector<cerata::Signal *> &profile_nodes,
+                                        uint32_t counter_width,
+                                        const std::vector<cerata::Signal *> &histogram_nodes) {
   cerata::NodeMap rebinding;
   NodeProfilerPorts result;
   // Get all nodes and check if their type contains a stream, then check if they should be profiled.
   for (auto node : profile_nodes) {
+    bool histogram = std::find(histogram_nodes.begin(), histogram_nodes.end(), node) != histogram_nodes.end();
     // Flatten the type
     auto flat_types = Flatten(node->type());
     int s = 0;
@@ -189,10 +507,12 @@ NodeProfilerPorts EnableStreamProfiling(cerata::Component *comp,
         auto p_probe = profiler_inst->prt("probe");
         auto p_cr = profiler_inst->prt("pcd");
         auto p_in_count_width = profiler_inst->par("PROBE_COUNT_WIDTH");
+        profiler_inst->par("OUT_COUNT_WIDTH") <<= intl(static_cast<int>(counter_width));
 
         // Set up a type mapper.
         auto mapper = TypeMapper::Make(node->type(), p_probe->type());
         auto matrix = mapper->map_matrix().Empty();
+        int count_width = 0;
         matrix(fti, 0) = 1;    // Connect the stream record.
         matrix(++fti, 1) = 1;  // Connect the stream valid.
         matrix(++fti, 2) = 1;  // Connect the stream ready.
@@ -208,7 +528,8 @@ NodeProfilerPorts EnableStreamProfiling(cerata::Component *comp,
           auto ft = flat_types[fti];
           if (ft.type_->meta.count(meta::COUNT) > 0) {
             auto width = std::strtol(flat_types[fti].type_->meta.at(meta::COUNT).c_str(), nullptr, 10);
-            p_in_count_width <<= intl(static_cast<int>(width));
+            count_width = static_cast<int>(width);
+            p_in_count_width <<= intl(count_width);
             // We've found the count field.
             matrix(fti, 4) = 1;  // Connect the count.
           }
@@ -232,15 +553,41 @@ NodeProfilerPorts EnableStreamProfiling(cerata::Component *comp,
                                               profiler_inst->prt(std::string("count_") + name::t),
                                               profiler_inst->prt(std::string("count_") + name::p),
                                               profiler_inst->prt(std::string("count_") + name::c)});
+        auto new_instances = std::vector<Instance *>({profiler_inst});
+
+        if (histogram) {
+          // Attach a stall histogram to the same probe signals.
+          auto hist_inst = comp->Instantiate(stall_histogram(), stall_histogram()->name() + "_" + name + "_inst");
+          for (auto &p : hist_inst->GetAll<Port>()) {
+            p->SetDomain(domain);
+          }
+          auto h_probe = hist_inst->prt("probe");
+          hist_inst->par("OUT_COUNT_WIDTH") <<= intl(static_cast<int>(counter_width));
+          if (count_width > 0) {
+            hist_inst->par("PROBE_COUNT_WIDTH") <<= intl(count_width);
+          }
+          auto hist_mapper = TypeMapper::Make(node->type(), h_probe->type());
+          hist_mapper->SetMappingMatrix(matrix);
+          node->type()->AddMapper(hist_mapper);
+          Connect(hist_inst->prt("pcd"), *cr_node);
+          Connect(h_probe, node);
+
+          for (const auto &h : {name::s, name::w}) {
+            for (size_t b = 0; b < PROFILE_HISTOGRAM_BUCKETS; b++) {
+              new_ports.push_back(hist_inst->prt(std::string("count_") + h + "_" + std::to_string(b)));
+            }
+          }
+          new_instances.push_back(hist_inst);
+        }
 
         if (result.count(node) == 0) {
           // We need to create a new entry.
-          result[node] = {{profiler_inst}, new_ports};
+          result[node] = {new_instances, new_ports};
         } else {
-          // Insert the ports into the old entry.
-          result[node].first.push_back(profiler_inst);
-          auto vec = result[node].second;
-          vec.insert(vec.end(), new_ports.begin(), new_ports.end());
+          // Insert the instances and ports into the old entry.
+          auto &entry = result[node];
+          entry.first.insert(entry.first.end(), new_instances.begin(), new_instances.end());
+          entry.second.insert(entry.second.end(), new_ports.begin(), new_ports.end());
         }
         // Increase the s-th stream index in the flattened type.
         s++;
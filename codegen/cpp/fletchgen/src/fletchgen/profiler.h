@@ -22,6 +22,7 @@
 #include <map>
 
 #include "fletchgen/basic_types.h"
+#include "fletchgen/bus.h"
 #include "fletchgen/nucleus.h"
 
 namespace fletchgen {
@@ -29,8 +30,53 @@ namespace fletchgen {
 /// A mapping from nodes to profiler instances and ports.
 using NodeProfilerPorts = std::map<Node *, std::pair<std::vector<Instance *>, std::vector<Port *>>>;
 
-/// @brief Obtain the registers that should be reserved in the mmio component for profiling.
-std::vector<MmioReg> GetProfilingRegs(const std::vector<std::shared_ptr<RecordBatch>> &recordbatches);
+/// Default bit width of the profiling counters.
+constexpr uint32_t PROFILE_COUNTER_WIDTH = 64;
+
+/// Number of logarithmic buckets of the stall-length histograms of a profiled stream.
+constexpr size_t PROFILE_HISTOGRAM_BUCKETS = 8;
+
+/// Name of the register that enables the stream profilers.
+constexpr char PROFILE_ENABLE[] = "Profile_enable";
+/// Name of the register that clears the stream profilers.
+constexpr char PROFILE_CLEAR[] = "Profile_clear";
+/// Name of the register that latches the counters of all stream profilers at the same time.
+constexpr char PROFILE_SNAPSHOT[] = "Profile_snapshot";
+/// Name of the register that enables the bus profilers.
+constexpr char BUS_PROFILE_ENABLE[] = "Profile_bus_enable";
+/// Name of the register that clears the bus profilers.
+constexpr char BUS_PROFILE_CLEAR[] = "Profile_bus_clear";
+/// Name of the register that latches the counters of all bus profilers at the same time.
+constexpr char BUS_PROFILE_SNAPSHOT[] = "Profile_bus_snapshot";
+
+/**
+ * @brief Obtain the registers that should be reserved in the mmio component for profiling.
+ * @param recordbatches The RecordBatch components of which the field-derived ports may be profiled.
+ * @param counter_width The bit width of the counters.
+ * @return              The enable, clear and snapshot registers, followed by the counters of every profiled stream and,
+ *                      for fields with histogram metadata, their stall and starve histogram buckets.
+ */
+std::vector<MmioReg> GetProfilingRegs(const std::vector<std::shared_ptr<RecordBatch>> &recordbatches,
+                                      uint32_t counter_width = PROFILE_COUNTER_WIDTH);
+
+/**
+ * @brief Obtain the registers that should be reserved in the mmio component for bus profiling.
+ *
+ * Every bus arbiter master port and every RecordBatch bus port connected to a bus arbiter gets a set of counters. The
+ * bus profilers count in the bus clock domain and have their own enable, clear and snapshot registers. Since a snapshot
+ * crosses clock domains, every profiled bus also gets a busy register to poll for its completion.
+ */
+std::vector<MmioReg> GetBusProfilingRegs(const std::vector<std::shared_ptr<RecordBatch>> &recordbatches,
+                                         uint32_t counter_width = PROFILE_COUNTER_WIDTH);
+
+/// @brief Return the names of the counter registers of a profiled bus, in the order of the bus profiler ports.
+std::vector<std::string> BusProfileRegNames(const std::string &bus_name);
+
+/// @brief Return the name of the register that is high while a snapshot of a profiled bus is in progress.
+std::string BusProfileBusyRegName(const std::string &bus_name);
+
+/// @brief Returns a bus probe type based on the burst length width of the bus.
+std::shared_ptr<cerata::Type> bus_probe(const std::shared_ptr<Node> &len_width);
 
 /// @brief Returns a stream probe type based on a count width for multi-epc streams.
 std::shared_ptr<cerata::Type> stream_probe(const std::shared_ptr<Node> &count_width);
@@ -48,10 +94,35 @@ std::unique_ptr<cerata::Instance> profiler(const std::string &name,
  *
  * Currently doesn't make a deep copy, so it modifies the existing structure irreversibly.
  *
+ * Every stream of a node in histogram_nodes also gets a StallHistogram, of which the stall and starve buckets follow
+ * the profiler counters of that stream in the result port nodes.
+ *
+ * @param comp            The component to apply the transformation to.
+ * @param profile_nodes   The signal nodes that should be profiled.
+ * @param counter_width   The bit width of the counters.
+ * @param histogram_nodes The subset of profile_nodes of which stall-length histograms should be made.
+ * @return                A mapping from each input node to the instantiated profilers and their result port nodes.
+ */
+NodeProfilerPorts EnableStreamProfiling(cerata::Component *comp,
+                                        const std::vector<cerata::Signal *> &profile_nodes,
+                                        uint32_t counter_width = PROFILE_COUNTER_WIDTH,
+                                        const std::vector<cerata::Signal *> &histogram_nodes = {});
+
+/**
+ * @brief Transforms a Cerata component graph to include a bus profiler for a bus read or write node.
+ *
+ * The profiler counts in the clock domain of the node. Its control inputs and counter outputs are in the kernel clock
+ * domain, so the component must have clock/reset ports for both domains.
+ *
  * @param comp          The component to apply the transformation to.
- * @param profile_nodes The signal nodes that should be profiled.
- * @return              A mapping from each input node to the instantiated profiler and its relevant result port nodes.
+ * @param node          The bus signal node to profile.
+ * @param params        The bus parameters of the node.
+ * @param counter_width The bit width of the counters.
+ * @return              The instantiated bus profiler and its counter ports, in the order of BusProfileRegNames.
  */
-NodeProfilerPorts EnableStreamProfiling(cerata::Component *comp, const std::vector<cerata::Signal *> &profile_nodes);
+std::pair<Instance *, std::vector<Port *>> EnableBusProfiling(cerata::Component *comp,
+                                                              cerata::Signal *node,
+                                                              const BusDimParams &params,
+                                                              uint32_t counter_width = PROFILE_COUNTER_WIDTH);
 
 }  // namespace fletchgen
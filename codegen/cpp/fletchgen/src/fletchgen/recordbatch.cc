@@ -34,11 +34,13 @@ using cerata::Term;
 
 RecordBatch::RecordBatch(const std::string &name,
                          const std::shared_ptr<FletcherSchema> &fletcher_schema,
-                         fletcher::RecordBatchDescription batch_desc)
+                         fletcher::RecordBatchDescription batch_desc,
+                         BusDim bus_dim)
     : Component(name),
       fletcher_schema_(fletcher_schema),
       mode_(fletcher_schema->mode()),
-      batch_desc_(std::move(batch_desc)) {
+      batch_desc_(std::move(batch_desc)),
+      bus_dim_(bus_dim) {
   // Get Arrow Schema
   auto as = fletcher_schema_->arrow_schema();
 
@@ -174,7 +176,7 @@ void RecordBatch::ConnectBusPorts(Instance *array, const std::string &prefix, ce
     auto rb_port_prefix = prefix + "_bus";
     auto a_bus_spec = a_bus_port->spec_;
     // Create new bus parameters to bind to and prefix it with the bus name.
-    auto rb_bus_params = BusDimParams(this, a_bus_spec.dim.plain, prefix);
+    auto rb_bus_params = BusDimParams(this, bus_dim_, prefix);
     auto rb_bus_spec = BusSpecParams{rb_bus_params, a_bus_spec.func};
     // Copy over the ArrayReader/Writer's bus port
     auto rb_bus_port = bus_port(rb_port_prefix, a_bus_port->dir(), rb_bus_spec);
@@ -189,8 +191,9 @@ void RecordBatch::ConnectBusPorts(Instance *array, const std::string &prefix, ce
 
 std::shared_ptr<RecordBatch> record_batch(const std::string &name,
                                           const std::shared_ptr<FletcherSchema> &fletcher_schema,
-                                          const fletcher::RecordBatchDescription &batch_desc) {
-  auto rb = new RecordBatch(name, fletcher_schema, batch_desc);
+                                          const fletcher::RecordBatchDescription &batch_desc,
+                                          BusDim bus_dim) {
+  auto rb = new RecordBatch(name, fletcher_schema, batch_desc, bus_dim);
   auto shared_rb = std::shared_ptr<RecordBatch>(rb);
   cerata::default_component_pool()->Add(shared_rb);
   return shared_rb;
@@ -209,8 +212,9 @@ std::shared_ptr<FieldPort> arrow_port(const std::shared_ptr<FletcherSchema> &fle
     dir = mode2dir(fletcher_schema->mode());
   }
   // Check if the Arrow data stream should be profiled. This is disabled by default but can be conveyed through
-  // the schema.
-  bool profile = fletcher::GetBoolMeta(*field, fletcher::meta::PROFILE, false);
+  // the schema. Profiling is implied by a request for stall histograms.
+  bool profile = fletcher::GetBoolMeta(*field, fletcher::meta::PROFILE, false)
+      || fletcher::GetBoolMeta(*field, fletcher::meta::PROFILE_HISTOGRAM, false);
 
   return std::make_shared<FieldPort>(name, FieldPort::ARROW, field, fletcher_schema, type, dir, domain, profile);
 }
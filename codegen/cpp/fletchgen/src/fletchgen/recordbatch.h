@@ -152,7 +152,8 @@ struct RecordBatch : public Component {
   /// @brief RecordBatch constructor.
   RecordBatch(const std::string &name,
               const std::shared_ptr<FletcherSchema> &fletcher_schema,
-              fletcher::RecordBatchDescription batch_desc);
+              fletcher::RecordBatchDescription batch_desc,
+              BusDim bus_dim = BusDim());
   /// @brief Obtain all ports derived from an Arrow field with a specific function.
   std::vector<std::shared_ptr<FieldPort>> GetFieldPorts(const std::optional<FieldPort::Function> &function = {}) const;
   /// @brief Return the description of the RecordBatch this component is based on.
@@ -161,6 +162,10 @@ struct RecordBatch : public Component {
   FletcherSchema *schema() { return fletcher_schema_.get(); }
   /// @brief Return the mode (read or write) of this RecordBatch.
   Mode mode() const { return mode_; }
+  /// @brief Return the dimensions of the bus ports of this RecordBatch.
+  BusDim bus_dim() const { return bus_dim_; }
+  /// @brief Return the memory channel this RecordBatch is connected to.
+  size_t bus_channel() const { return fletcher_schema_->bus_channel(); }
 
  protected:
   /**
@@ -180,6 +185,8 @@ struct RecordBatch : public Component {
   Mode mode_ = Mode::READ;
   /// The RecordBatch description.
   fletcher::RecordBatchDescription batch_desc_;
+  /// The dimensions of the bus ports.
+  BusDim bus_dim_;
 
  private:
   void ConnectBusPorts(Instance *array, const std::string &prefix, cerata::NodeMap *rebinding);
@@ -188,6 +195,7 @@ struct RecordBatch : public Component {
 /// @brief Make a new RecordBatch(Reader/Writer) component, based on a Fletcher schema.
 std::shared_ptr<RecordBatch> record_batch(const std::string &name,
                                           const std::shared_ptr<FletcherSchema> &fletcher_schema,
-                                          const fletcher::RecordBatchDescription &batch_desc);
+                                          const fletcher::RecordBatchDescription &batch_desc,
+                                          BusDim bus_dim = BusDim());
 
 }  // namespace fletchgen
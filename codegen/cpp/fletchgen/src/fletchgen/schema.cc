@@ -137,8 +137,36 @@ void SchemaSet::Sort() {
   std::stable_sort(schemas_.begin(), schemas_.end(), ModeSort);
 }
 
+/// Highest memory channel a schema can be assigned to.
+constexpr uint32_t MAX_BUS_CHANNEL = 255;
+/// Highest bus arbitration weight of a schema.
+constexpr uint32_t MAX_BUS_WEIGHT = 1u << 16u;
+/// Highest bus buffer depth of a schema.
+constexpr uint32_t MAX_BUS_BUFFER_DEPTH = 1u << 16u;
+
+/**
+ * @brief Parse the value of an unsigned integer metadata key of a schema.
+ *
+ * The whole value must be a decimal integer within [min, max], otherwise a fatal error is logged.
+ */
+static uint32_t ParseUIntMeta(const std::string &schema_name,
+                              const std::string &key,
+                              const std::string &value,
+                              uint32_t min,
+                              uint32_t max) {
+  // At most ten digits, such that the value fits in 64 bits before checking its range.
+  bool valid = !value.empty() && (value.size() <= 10)
+      && std::all_of(value.begin(), value.end(), [](char c) { return (c >= '0') && (c <= '9'); });
+  uint64_t result = valid ? std::stoull(value) : 0;
+  if (!valid || (result < min) || (result > max)) {
+    FLETCHER_LOG(FATAL, "Schema " + schema_name + " has invalid " + key + " metadata \"" + value
+        + "\". Expected an integer from " + std::to_string(min) + " to " + std::to_string(max) + ".");
+  }
+  return static_cast<uint32_t>(result);
+}
+
 FletcherSchema::FletcherSchema(const std::shared_ptr<arrow::Schema> &arrow_schema, const std::string &schema_name)
-    : arrow_schema_(arrow_schema), mode_(fletcher::GetMode(*arrow_schema)) {
+    : arrow_schema_(fletcher::ExpandDictionaries(arrow_schema)), mode_(fletcher::GetMode(*arrow_schema)) {
 
   // Get name from metadata, if available
   name_ = fletcher::GetMeta(*arrow_schema_, fletcher::meta::NAME);
@@ -146,11 +174,33 @@ FletcherSchema::FletcherSchema(const std::shared_ptr<arrow::Schema> &arrow_schem
     FLETCHER_LOG(FATAL, "Schema has no name. Append {'fletcher_name' : '<name>'} kv-metadata to the schema. "
                         "Schema: " + arrow_schema->ToString());
   }
+  // Dictionary-encoded fields are split into their indices and dictionary. The kernel can only read them.
+  if ((arrow_schema_ != arrow_schema) && (mode_ == fletcher::Mode::WRITE)) {
+    FLETCHER_LOG(FATAL, "Schema " + name() + " has dictionary-encoded fields, which are only supported for reading.");
+  }
   auto bus_spec_val = fletcher::GetMeta(*arrow_schema_, fletcher::meta::BUS_SPEC);
-  bus_dims_ = BusDim::FromString(bus_spec_val, BusDim());
+  if (!bus_spec_val.empty()) {
+    bus_dims_ = BusDim::FromString(bus_spec_val, BusDim());
+  }
+  auto bus_channel_val = fletcher::GetMeta(*arrow_schema_, fletcher::meta::BUS_CHANNEL);
+  if (!bus_channel_val.empty()) {
+    bus_channel_ = ParseUIntMeta(name(), fletcher::meta::BUS_CHANNEL, bus_channel_val, 0, MAX_BUS_CHANNEL);
+  }
+  auto bus_weight_val = fletcher::GetMeta(*arrow_schema_, fletcher::meta::BUS_WEIGHT);
+  if (!bus_weight_val.empty()) {
+    bus_weight_ = ParseUIntMeta(name(), fletcher::meta::BUS_WEIGHT, bus_weight_val, 1, MAX_BUS_WEIGHT);
+  }
+  auto bus_buffer_depth_val = fletcher::GetMeta(*arrow_schema_, fletcher::meta::BUS_BUFFER_DEPTH);
+  if (!bus_buffer_depth_val.empty()) {
+    bus_buffer_depth_ =
+        ParseUIntMeta(name(), fletcher::meta::BUS_BUFFER_DEPTH, bus_buffer_depth_val, 0, MAX_BUS_BUFFER_DEPTH);
+  }
   FLETCHER_LOG(DEBUG, "Schema " + name() + ":");
   FLETCHER_LOG(DEBUG, "  Direction : " + cerata::Term::str(mode2dir(mode_)));
-  FLETCHER_LOG(DEBUG, "  Bus spec  : " + bus_dims_.ToString());
+  FLETCHER_LOG(DEBUG, "  Bus spec  : " + (bus_dims_ ? bus_dims_->ToString() : "default"));
+  FLETCHER_LOG(DEBUG, "  Channel   : " + std::to_string(bus_channel_));
+  FLETCHER_LOG(DEBUG, "  Weight    : " + std::to_string(bus_weight_));
+  FLETCHER_LOG(DEBUG, "  Buffer    : " + (bus_buffer_depth_ ? std::to_string(*bus_buffer_depth_) : "default"));
 }
 
 std::shared_ptr<FletcherSchema> FletcherSchema::Make(const std::shared_ptr<arrow::Schema> &arrow_schema,
@@ -46,13 +46,21 @@ class FletcherSchema {
   static std::shared_ptr<FletcherSchema> Make(const std::shared_ptr<arrow::Schema> &arrow_schema,
                                               const std::string &schema_name = "");
 
-  /// @brief Return the Arrow schema that this FletcherSchema was based on.
+  /// @brief Return the Arrow schema that this FletcherSchema was based on, with its dictionaries expanded.
   [[nodiscard]] std::shared_ptr<arrow::Schema> arrow_schema() const { return arrow_schema_; }
 
   /// @brief Return the access mode of the RecordBatch this schema represents.
   [[nodiscard]] Mode mode() const { return mode_; }
   /// @brief Return the name of this FletcherSchema.
   [[nodiscard]] std::string name() const { return name_; }
+  /// @brief Return the bus dimensions from the schema metadata, if the schema specifies them.
+  [[nodiscard]] std::optional<BusDim> bus_dims() const { return bus_dims_; }
+  /// @brief Return the memory channel of the RecordBatch this schema represents.
+  [[nodiscard]] size_t bus_channel() const { return bus_channel_; }
+  /// @brief Return the bus arbitration weight of the RecordBatch this schema represents.
+  [[nodiscard]] uint32_t bus_weight() const { return bus_weight_; }
+  /// @brief Return the bus buffer depth from the schema metadata, if the schema specifies it.
+  [[nodiscard]] std::optional<uint32_t> bus_buffer_depth() const { return bus_buffer_depth_; }
 
  private:
   /// The Arrow schema this FletcherSchema is based on.
@@ -61,8 +69,14 @@ class FletcherSchema {
   Mode mode_;
   /// The name of this schema used to identify the components generated from it.
   std::string name_;
-  /// The bus dimensions for the RecordBatch resulting from this schema.
-  BusDim bus_dims_;
+  /// The bus dimensions for the RecordBatch resulting from this schema, if specified.
+  std::optional<BusDim> bus_dims_;
+  /// The memory channel of the RecordBatch resulting from this schema.
+  size_t bus_channel_ = 0;
+  /// The bus arbitration weight of the RecordBatch resulting from this schema.
+  uint32_t bus_weight_ = 1;
+  /// The bus buffer depth of the RecordBatch resulting from this schema, if specified.
+  std::optional<uint32_t> bus_buffer_depth_;
 };
 
 /**
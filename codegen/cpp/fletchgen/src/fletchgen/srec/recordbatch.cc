@@ -17,12 +17,22 @@
 #include <arrow/api.h>
 #include <fletcher/common.h>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
 #include <vector>
 #include <memory>
 #include <ostream>
 #include <fstream>
+#include <sstream>
+#include <string>
 
 #include "fletchgen/srec/srec.h"
+#include "fletchgen/utils.h"
 
 namespace fletchgen::srec {
 
@@ -30,31 +40,45 @@ static inline size_t PaddedLength(size_t size, size_t alignment) {
   return ((size + alignment - 1) / alignment) * alignment;
 }
 
-void GenerateReadSREC(const std::vector<fletcher::RecordBatchDescription> &meta_in,
-                      std::vector<fletcher::RecordBatchDescription> *meta_out,
-                      std::ofstream *out,
-                      int64_t buffer_align) {
-  // We need to align each buffer into the SREC stream.
+/**
+ * @brief Determine the place of every buffer of a set of RecordBatches in a memory image.
+ * @param meta_in       The RecordBatches.
+ * @param meta_out      Output for the RecordBatches, with the buffer addresses replaced by their offsets in the image.
+ * @param buffer_align  Alignment in bytes for every buffer.
+ * @param segments      Output for the segments of the image holding the buffers.
+ * @return The size of the image in bytes.
+ */
+static size_t LayoutImage(const std::vector<fletcher::RecordBatchDescription> &meta_in,
+                          std::vector<fletcher::RecordBatchDescription> *meta_out,
+                          int64_t buffer_align,
+                          std::vector<Segment> *segments) {
+  // We need to align each buffer into the image.
   // We start at offset 0.
   uint64_t offset = 0;
   for (const auto &desc_in : meta_in) {
     fletcher::RecordBatchDescription desc_out = desc_in;
-    // We can only copy data from physically existing recordbatches into the SREC
+    // We can only copy data from physically existing recordbatches into the image
     if (!desc_in.is_virtual) {
       desc_out.fields.clear();
       for (const auto &f : desc_in.fields) {
         desc_out.fields.emplace_back(f.type_, f.length, f.null_count);
+        desc_out.fields.back().dictionary = f.dictionary;
         FLETCHER_LOG(DEBUG, "RecordBatch " + desc_in.name + " buffers: \n" + desc_in.ToString());
         for (const auto &buf : f.buffers) {
           // May the force be with us
           auto srec_buf_address = reinterpret_cast<uint8_t *>(offset);
-          // Determine the place of the buffer in the SREC output
-          desc_out.fields.back().buffers.emplace_back(srec_buf_address, buf.size_, buf.desc_, buf.level_);
+          // Determine the place of the buffer in the image
+          desc_out.fields.back().buffers.emplace_back(srec_buf_address, buf.size_, buf.desc_, buf.level_, buf.implicit_);
+          // Every buffer is a segment of the image, which is written from the buffer in place.
+          // Empty buffers (typically implicit validity buffers) are zero-filled.
+          segments->push_back({offset, buf.raw_buffer_, static_cast<size_t>(buf.size_)});
 
+#ifndef NDEBUG
           // Print some debug info
           auto hv = fletcher::HexView(offset);
           hv.AddData(buf.raw_buffer_, buf.size_);
           FLETCHER_LOG(DEBUG, fletcher::ToString(buf.desc_) + "\n" + hv.ToString());
+#endif
 
           // Calculate the padded length and calculate the next offset.
           auto padded_size = PaddedLength(buf.size_, buffer_align);
@@ -64,48 +88,387 @@ void GenerateReadSREC(const std::vector<fletcher::RecordBatchDescription> &meta_
     }
     meta_out->push_back(desc_out);
   }
-  // We have now determined the location of every buffer in the SREC file and we know the total size of the resulting
-  // file in bytes. We must now create the actual SREC file. Calloc some space to serialize the Arrow buffers into.
-  auto srec_buffer = static_cast<uint8_t *>(calloc(1, offset));
-
-  // Copy over every buffer.
-  for (size_t r = 0; r < meta_in.size(); r++) {
-    if (!meta_in[r].is_virtual) {
-      for (size_t f = 0; f < meta_in[r].fields.size(); f++) {
-        for (size_t b = 0; b < meta_in[r].fields[f].buffers.size(); b++) {
-          auto srec_off = reinterpret_cast<size_t>(meta_out->at(r).fields[f].buffers[b].raw_buffer_);
-          auto dest = srec_buffer + srec_off;
-          auto src = meta_in[r].fields[f].buffers[b].raw_buffer_;
-          auto size = meta_in[r].fields[f].buffers[b].size_;
-          // skip empty buffers (typically implicit validity buffers)
-          if (src != nullptr) {
-            memcpy(dest, src, size);
-          }
+  return offset;
+}
+
+void GenerateReadSREC(const std::vector<fletcher::RecordBatchDescription> &meta_in,
+                      std::vector<fletcher::RecordBatchDescription> *meta_out,
+                      std::ostream *out,
+                      int64_t buffer_align,
+                      size_t num_jobs) {
+  std::vector<Segment> segments;
+  auto size = LayoutImage(meta_in, meta_out, buffer_align, &segments);
+
+  // Write the SREC file, start at 0
+  if (out->good()) {
+    WriteImage(out, segments, size, 0, num_jobs);
+  } else {
+    FLETCHER_LOG(ERROR, "Output stream unavailable. SREC was not written.");
+  }
+}
+
+size_t GenerateReadImage(const std::vector<fletcher::RecordBatchDescription> &meta_in,
+                         std::vector<fletcher::RecordBatchDescription> *meta_out,
+                         std::ostream *out,
+                         int64_t buffer_align) {
+  std::vector<Segment> segments;
+  auto size = LayoutImage(meta_in, meta_out, buffer_align, &segments);
+
+  if (!out->good()) {
+    FLETCHER_LOG(ERROR, "Output stream unavailable. Memory image was not written.");
+    return size;
+  }
+  // Write every segment in place, and the padding in between as zeros.
+  static const char zeros[4096] = {};
+  size_t pos = 0;
+  auto pad = [&](size_t until) {
+    while (pos < until) {
+      auto n = std::min(sizeof(zeros), until - pos);
+      out->write(zeros, n);
+      pos += n;
+    }
+  };
+  for (const auto &seg : segments) {
+    pad(seg.offset);
+    if (seg.data != nullptr) {
+      out->write(reinterpret_cast<const char *>(seg.data), seg.size);
+      pos += seg.size;
+    }
+  }
+  pad(size);
+  return size;
+}
+
+std::string GenerateImageLayout(const std::vector<fletcher::RecordBatchDescription> &meta,
+                                size_t size,
+                                int64_t buffer_align) {
+  std::stringstream str;
+  str << "{\n"
+         "  \"size\": " << size << ",\n"
+         "  \"alignment\": " << buffer_align << ",\n"
+         "  \"recordbatches\": [";
+  for (size_t r = 0; r < meta.size(); r++) {
+    const auto &rb = meta[r];
+    str << (r == 0 ? "" : ",") << "\n"
+        << "    {\n"
+           "      \"name\": " << JsonString(rb.name) << ",\n"
+        << "      \"rows\": " << rb.rows << ",\n"
+        << "      \"mode\": \"" << (rb.mode == fletcher::Mode::READ ? "read" : "write") << "\",\n"
+        << "      \"buffers\": [";
+    bool first = true;
+    for (const auto &f : rb.fields) {
+      for (const auto &b : f.buffers) {
+        str << (first ? "" : ",") << "\n"
+            << "        {\"desc\": " << JsonString(fletcher::ToString(b.desc_)) << ", "
+            << "\"offset\": " << reinterpret_cast<uint64_t>(b.raw_buffer_) << ", "
+            << "\"size\": " << b.size_ << ", "
+            << "\"implicit\": " << (b.implicit_ ? "true" : "false") << "}";
+        first = false;
+      }
+    }
+    str << (first ? "" : "\n      ") << "]\n"
+        << "    }";
+  }
+  str << (meta.empty() ? "" : "\n  ") << "]\n"
+      << "}\n";
+  return str.str();
+}
+
+/**
+ * @brief Reconstructs Arrow arrays from a memory image, given the description of their buffers in the image.
+ *
+ * The buffers are expected in the same order as produced by the fletcher::RecordBatchAnalyzer, with their offset in the
+ * image in place of their address. Every buffer is checked against the bounds of the image before it is copied.
+ */
+class ImageReader {
+ public:
+  /// @brief Construct a new ImageReader for the buffers of a RecordBatch.
+  ImageReader(const uint8_t *image, size_t size, const fletcher::RecordBatchDescription &desc)
+      : image_(image), size_(size) {
+    for (const auto &f : desc.fields) {
+      for (const auto &b : f.buffers) {
+        buffers_.push_back(&b);
+      }
+    }
+  }
+
+  /// @brief Reconstruct the data of an array of some field with some length.
+  bool Read(const arrow::Field &field, int64_t length, std::shared_ptr<arrow::ArrayData> *out) {
+    std::vector<std::shared_ptr<arrow::Buffer>> buffers;
+    std::vector<std::shared_ptr<arrow::ArrayData>> children;
+    const auto &type = field.type();
+
+    if (length < 0) {
+      FLETCHER_LOG(ERROR, "Field " + field.name() + " has a negative length.");
+      return false;
+    }
+
+    // Validity bitmap. A nullable field without nulls has an implicit bitmap that takes no space in the image.
+    int64_t null_count = 0;
+    std::shared_ptr<arrow::Buffer> validity;
+    if (field.nullable()) {
+      const fletcher::BufferMetadata *buf;
+      if (!NextBuffer(&buf)) return false;
+      if (!buf->implicit_) {
+        if (!Copy(*buf, BytesFor(length, 1), &validity)) return false;
+        null_count = arrow::kUnknownNullCount;
+      }
+    }
+    buffers.push_back(validity);
+
+    switch (type->id()) {
+      case arrow::Type::STRING:
+      case arrow::Type::BINARY: {
+        std::shared_ptr<arrow::Buffer> offsets;
+        int32_t num_values;
+        if (!ReadOffsets(length, &offsets, &num_values)) return false;
+        const fletcher::BufferMetadata *buf;
+        if (!NextBuffer(&buf)) return false;
+        std::shared_ptr<arrow::Buffer> values;
+        if (!Copy(*buf, num_values, &values)) return false;
+        buffers.push_back(offsets);
+        buffers.push_back(values);
+        break;
+      }
+      case arrow::Type::LIST: {
+        std::shared_ptr<arrow::Buffer> offsets;
+        int32_t num_values;
+        if (!ReadOffsets(length, &offsets, &num_values)) return false;
+        buffers.push_back(offsets);
+        std::shared_ptr<arrow::ArrayData> values;
+        if (!Read(*type->field(0), num_values, &values)) return false;
+        children.push_back(values);
+        break;
+      }
+      case arrow::Type::STRUCT: {
+        for (int i = 0; i < type->num_fields(); i++) {
+          std::shared_ptr<arrow::ArrayData> child;
+          if (!Read(*type->field(i), length, &child)) return false;
+          children.push_back(child);
+        }
+        break;
+      }
+      default: {
+        auto fixed_width = std::dynamic_pointer_cast<arrow::FixedWidthType>(type);
+        if ((fixed_width == nullptr) || (type->id() == arrow::Type::DICTIONARY)) {
+          FLETCHER_LOG(ERROR, "Cannot read field " + field.name() + " of type " + type->ToString() + " from SREC.");
+          return false;
         }
+        const fletcher::BufferMetadata *buf;
+        if (!NextBuffer(&buf)) return false;
+        std::shared_ptr<arrow::Buffer> values;
+        if (!Copy(*buf, BytesFor(length, fixed_width->bit_width()), &values)) return false;
+        buffers.push_back(values);
+        break;
       }
     }
+
+    *out = arrow::ArrayData::Make(type, length, buffers, children, null_count);
+    return true;
   }
 
-  // Create the SREC file, start at 0
-  srec::File sr(0, srec_buffer, offset);
-  if (out->good()) {
-    sr.write(out);
-  } else {
-    FLETCHER_LOG(ERROR, "Output stream unavailable. SREC was not written.");
+  /// @brief Return the number of buffers that were not consumed.
+  [[nodiscard]] size_t remaining() const { return buffers_.size() - next_; }
+
+ private:
+  /// @brief Obtain the description of the next buffer.
+  bool NextBuffer(const fletcher::BufferMetadata **buf) {
+    if (next_ >= buffers_.size()) {
+      FLETCHER_LOG(ERROR, "Not enough buffers described to read RecordBatches from SREC.");
+      return false;
+    }
+    *buf = buffers_[next_++];
+    return true;
+  }
+
+  /// @brief Return the number of bytes of \p length elements of \p bits bits, or -1 if they cannot fit in the image.
+  [[nodiscard]] int64_t BytesFor(int64_t length, int64_t bits) const {
+    if ((bits <= 0) || (static_cast<uint64_t>(length) > 8 * static_cast<uint64_t>(size_) / bits)) {
+      return -1;
+    }
+    return (length * bits + 7) / 8;
+  }
+
+  /**
+   * @brief Read the 32-bit offsets buffer of an array.
+   *
+   * The offsets must be non-negative and non-decreasing, such that they can be used to find the values.
+   *
+   * @param length      The length of the array.
+   * @param out         Output for the offsets buffer.
+   * @param num_values  Output for the last offset, which is the number of values the array spans.
+   * @return            True if successful.
+   */
+  bool ReadOffsets(int64_t length, std::shared_ptr<arrow::Buffer> *out, int32_t *num_values) {
+    const fletcher::BufferMetadata *buf;
+    if (!NextBuffer(&buf)) return false;
+    auto size = BytesFor(length, 32);
+    if (!Copy(*buf, size < 0 ? size : size + static_cast<int64_t>(sizeof(int32_t)), out)) return false;
+    auto offsets = reinterpret_cast<const int32_t *>((*out)->data());
+    for (int64_t i = 0; i < length; i++) {
+      if ((offsets[i] < 0) || (offsets[i + 1] < offsets[i])) {
+        FLETCHER_LOG(ERROR, "Offsets buffer " + fletcher::ToString(buf->desc_) + " in SREC image is invalid.");
+        return false;
+      }
+    }
+    *num_values = offsets[length];
+    if (*num_values < 0) {
+      FLETCHER_LOG(ERROR, "Offsets buffer " + fletcher::ToString(buf->desc_) + " in SREC image is invalid.");
+      return false;
+    }
+    return true;
+  }
+
+  /// @brief Copy a buffer of some size from the image. The buffer must lie within the image.
+  bool Copy(const fletcher::BufferMetadata &buf, int64_t size, std::shared_ptr<arrow::Buffer> *out) {
+    auto offset = reinterpret_cast<uint64_t>(buf.raw_buffer_);
+    if ((size < 0) || (offset > size_) || (static_cast<uint64_t>(size) > size_ - offset)) {
+      FLETCHER_LOG(ERROR, "Buffer " + fletcher::ToString(buf.desc_) + " at offset " + std::to_string(offset)
+          + " does not fit in the SREC image of " + std::to_string(size_) + " bytes.");
+      return false;
+    }
+    auto result = arrow::AllocateBuffer(size);
+    if (!result.ok()) {
+      FLETCHER_LOG(ERROR, "Could not allocate buffer: " + result.status().ToString());
+      return false;
+    }
+    *out = std::move(result).ValueOrDie();
+    if (size > 0) {
+      std::memcpy((*out)->mutable_data(), image_ + offset, size);
+    }
+    return true;
   }
 
-  free(srec_buffer);
+  const uint8_t *image_;
+  size_t size_;
+  std::vector<const fletcher::BufferMetadata *> buffers_;
+  size_t next_ = 0;
+};
+
+/// @brief Reconstruct RecordBatches from a memory image.
+static std::vector<std::shared_ptr<arrow::RecordBatch>>
+RecordBatchesFromImage(const uint8_t *image,
+                       size_t size,
+                       const std::vector<std::shared_ptr<arrow::Schema>> &schemas,
+                       const std::vector<fletcher::RecordBatchDescription> &layout) {
+  std::vector<std::shared_ptr<arrow::RecordBatch>> ret;
+  if (layout.size() != schemas.size()) {
+    FLETCHER_LOG(ERROR, "Number of RecordBatch descriptions does not match number of schemas.");
+    return ret;
+  }
+  for (size_t s = 0; s < schemas.size(); s++) {
+    ImageReader reader(image, size, layout[s]);
+    auto length = layout[s].rows;
+    std::vector<std::shared_ptr<arrow::ArrayData>> columns;
+    for (const auto &field : schemas[s]->fields()) {
+      std::shared_ptr<arrow::ArrayData> column;
+      if (!reader.Read(*field, length, &column)) {
+        return {};
+      }
+      columns.push_back(column);
+    }
+    if (reader.remaining() != 0) {
+      FLETCHER_LOG(ERROR, "RecordBatch description " + layout[s].name + " does not match its schema.");
+      return {};
+    }
+    ret.push_back(arrow::RecordBatch::Make(schemas[s], length, columns));
+  }
+  return ret;
 }
 
 std::vector<std::shared_ptr<arrow::RecordBatch>>
 ReadRecordBatchesFromSREC(std::istream *input,
                           const std::vector<std::shared_ptr<arrow::Schema>> &schemas,
-                          const std::vector<uint64_t> &num_rows,
-                          const std::vector<uint64_t> &buf_offsets) {
-  std::vector<std::shared_ptr<arrow::RecordBatch>> ret;
-  // TODO(johanpel): implement this
-  FLETCHER_LOG(ERROR, "SREC to RecordBatch not yet implemented.");
-  return ret;
+                          const std::vector<fletcher::RecordBatchDescription> &layout) {
+  std::stringstream contents;
+  contents << input->rdbuf();
+  auto str = contents.str();
+  std::vector<uint8_t> image;
+  if (!ParseImage(str.data(), str.size(), &image)) {
+    return {};
+  }
+  return RecordBatchesFromImage(image.data(), image.size(), schemas, layout);
+}
+
+/**
+ * @brief A read-only memory mapping of a file.
+ */
+class MappedFile {
+ public:
+  /// @brief Map a file. Check ok() to see if this was successful.
+  explicit MappedFile(const std::string &path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      FLETCHER_LOG(ERROR, "Could not open " + path);
+      return;
+    }
+    struct stat st{};
+    if (fstat(fd, &st) != 0) {
+      FLETCHER_LOG(ERROR, "Could not determine size of " + path);
+      close(fd);
+      return;
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ > 0) {
+      void *map = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (map == MAP_FAILED) {
+        FLETCHER_LOG(ERROR, "Could not map " + path);
+        close(fd);
+        return;
+      }
+      // The file is read front to back.
+      madvise(map, size_, MADV_SEQUENTIAL);
+      data_ = static_cast<const uint8_t *>(map);
+    }
+    close(fd);
+    ok_ = true;
+  }
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  ~MappedFile() {
+    if (data_ != nullptr) {
+      munmap(const_cast<uint8_t *>(data_), size_);
+    }
+  }
+  /// @brief Return true if the file was mapped successfully.
+  [[nodiscard]] bool ok() const { return ok_; }
+  /// @brief Return the contents of the file.
+  [[nodiscard]] const uint8_t *data() const { return data_; }
+  /// @brief Return the size of the file.
+  [[nodiscard]] size_t size() const { return size_; }
+
+ private:
+  bool ok_ = false;
+  const uint8_t *data_ = nullptr;
+  size_t size_ = 0;
+};
+
+std::vector<std::shared_ptr<arrow::RecordBatch>>
+ReadRecordBatchesFromSREC(const std::string &path,
+                          const std::vector<std::shared_ptr<arrow::Schema>> &schemas,
+                          const std::vector<fletcher::RecordBatchDescription> &layout) {
+  // Map the file, such that it is parsed straight from the page cache.
+  MappedFile file(path);
+  if (!file.ok()) {
+    return {};
+  }
+  std::vector<uint8_t> image;
+  if (!ParseImage(reinterpret_cast<const char *>(file.data()), file.size(), &image)) {
+    return {};
+  }
+  return RecordBatchesFromImage(image.data(), image.size(), schemas, layout);
+}
+
+std::vector<std::shared_ptr<arrow::RecordBatch>>
+ReadRecordBatchesFromImage(const std::string &path,
+                           const std::vector<std::shared_ptr<arrow::Schema>> &schemas,
+                           const std::vector<fletcher::RecordBatchDescription> &layout) {
+  // The buffers are copied straight out of the mapping.
+  MappedFile file(path);
+  if (!file.ok()) {
+    return {};
+  }
+  return RecordBatchesFromImage(file.data(), file.size(), schemas, layout);
 }
 
 }  // namespace fletchgen::srec
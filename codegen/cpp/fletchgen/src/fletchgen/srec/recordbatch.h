@@ -21,6 +21,7 @@
 
 #include <vector>
 #include <memory>
+#include <string>
 
 #include "fletchgen/options.h"
 
@@ -28,16 +29,53 @@ namespace fletchgen::srec {
 
 /**
  * @brief Generate and save an SREC file from a bunch of RecordBatches and Schemas.
+ *
+ * The buffers are read in place and streamed to the output, without copying them into one contiguous image first.
+ *
  * @param schemas       The Schemas.
  * @param recordbatches The RecordBatches.
  * @param meta_out      Metadata output about saved RecordBatches.
  * @param out           Output stream to write the SREC file to.
  * @param buffer_align  Alignment in bytes for every RecordBatch buffer.
+ * @param num_jobs      Maximum number of threads to format the SREC records with. Zero means one per hardware thread.
 */
 void GenerateReadSREC(const std::vector<fletcher::RecordBatchDescription> &meta_in,
                       std::vector<fletcher::RecordBatchDescription> *meta_out,
-                      std::ofstream *out,
-                      int64_t buffer_align);
+                      std::ostream *out,
+                      int64_t buffer_align,
+                      size_t num_jobs = 1);
+
+/**
+ * @brief Generate and save a raw binary memory image from a bunch of RecordBatches.
+ *
+ * The buffers are placed at the same offsets as in the SREC file generated by GenerateReadSREC, and the bytes in
+ * between are zero, so the image is exactly what the simulation memory model holds after loading the SREC file.
+ *
+ * @param meta_in       The RecordBatches.
+ * @param meta_out      Metadata output about saved RecordBatches.
+ * @param out           Output stream to write the image to.
+ * @param buffer_align  Alignment in bytes for every RecordBatch buffer.
+ * @return              The size of the image in bytes.
+ */
+size_t GenerateReadImage(const std::vector<fletcher::RecordBatchDescription> &meta_in,
+                         std::vector<fletcher::RecordBatchDescription> *meta_out,
+                         std::ostream *out,
+                         int64_t buffer_align);
+
+/**
+ * @brief Generate a JSON description of the layout of a memory image.
+ *
+ * The description holds the name, number of rows and mode of every RecordBatch, and the description, offset and size
+ * of every buffer, such that tools can find the buffers in the image without parsing the schemas.
+ *
+ * @param meta          The metadata output of GenerateReadImage or GenerateReadSREC.
+ * @param size          The size of the image in bytes.
+ * @param buffer_align  Alignment in bytes for every RecordBatch buffer.
+ * @return              The JSON source.
+ */
+std::string GenerateImageLayout(const std::vector<fletcher::RecordBatchDescription> &meta,
+                                size_t size,
+                                int64_t buffer_align);
 
 /**
  * Write SREC formatted RecordBatches to an output stream.
@@ -49,20 +87,57 @@ std::vector<uint64_t> WriteRecordBatchesToSREC(std::ostream *output,
                                                const std::vector<std::shared_ptr<arrow::RecordBatch>> &recordbatches);
 
 /**
- * @brief Read an SREC formatted input stream and turn it into a RecordBatch
+ * @brief Read an SREC formatted input stream and turn it into RecordBatches.
  *
- * Buffer offsets should follow
+ * The SREC file is parsed into a memory image, after which the buffers of every RecordBatch are copied out of the
+ * image. Every RecordBatch is described by a RecordBatchDescription holding its number of rows and, for every buffer
+ * in the order produced by the fletcher::RecordBatchAnalyzer, its offset in the image in place of its address, like
+ * the descriptions returned by GenerateReadSREC. The validity bitmap of a nullable field is absent if its buffer is
+ * marked implicit. Every buffer, as well as the values the offsets of a list point to, must lie within the image.
  *
  * @param input         The input stream to read from.
  * @param schemas       A vector of Arrow Schemas.
- * @param num_rows      Number of rows for each RecordBatch.
- * @param buf_offsets   The offsets of the flattened buffer.
- * @return              A vector of Arrow RecordBatches filled with contents from the SREC input stream.
+ * @param layout        A description of the buffers in the image of every RecordBatch.
+ * @return              A vector of Arrow RecordBatches filled with contents from the SREC input stream, or an empty
+ *                      vector if the SREC file is malformed or does not match the schemas.
  */
 std::vector<std::shared_ptr<arrow::RecordBatch>>
 ReadRecordBatchesFromSREC(std::istream *input,
                           const std::vector<std::shared_ptr<arrow::Schema>> &schemas,
-                          const std::vector<uint64_t> &num_rows,
-                          const std::vector<uint64_t> &buf_offsets);
+                          const std::vector<fletcher::RecordBatchDescription> &layout);
+
+/**
+ * @brief Read an SREC file and turn it into RecordBatches.
+ *
+ * The file is memory-mapped and parsed in a single pass, which makes this the fastest way to read large simulation
+ * dumps. See the stream version for the requirements on the layout.
+ *
+ * @param path          The path to the SREC file.
+ * @param schemas       A vector of Arrow Schemas.
+ * @param layout        A description of the buffers in the image of every RecordBatch.
+ * @return              A vector of Arrow RecordBatches filled with contents from the SREC file, or an empty vector if
+ *                      the file could not be read, is malformed or does not match the schemas.
+ */
+std::vector<std::shared_ptr<arrow::RecordBatch>>
+ReadRecordBatchesFromSREC(const std::string &path,
+                          const std::vector<std::shared_ptr<arrow::Schema>> &schemas,
+                          const std::vector<fletcher::RecordBatchDescription> &layout);
+
+/**
+ * @brief Read a raw binary memory image file and turn it into RecordBatches.
+ *
+ * The file is memory-mapped and the buffers are copied straight out of the mapping. See ReadRecordBatchesFromSREC for
+ * the requirements on the layout.
+ *
+ * @param path          The path to the image file.
+ * @param schemas       A vector of Arrow Schemas.
+ * @param layout        A description of the buffers in the image of every RecordBatch.
+ * @return              A vector of Arrow RecordBatches filled with contents from the image, or an empty vector if the
+ *                      file could not be read, is malformed or does not match the schemas.
+ */
+std::vector<std::shared_ptr<arrow::RecordBatch>>
+ReadRecordBatchesFromImage(const std::string &path,
+                           const std::vector<std::shared_ptr<arrow::Schema>> &schemas,
+                           const std::vector<fletcher::RecordBatchDescription> &layout);
 
 }  // namespace fletchgen::srec
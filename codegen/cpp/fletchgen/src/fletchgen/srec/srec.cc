@@ -18,9 +18,169 @@
 #include <sstream>
 #include <string>
 #include <algorithm>
+#include <thread>
+
+#include "fletchgen/utils.h"
 
 namespace fletchgen::srec {
 
+/// Maximum number of characters of a formatted Record, including the line feed.
+constexpr size_t MAX_RECORD_CHARS = 2 + 2 + 8 + 2 * Record::MAX_DATA_BYTES + 2 + 1;
+
+/// Number of data records formatted by a single task when writing an image.
+constexpr size_t RECORDS_PER_TASK = 16384;
+
+/// Lookup table with the upper case hexadecimal characters of every byte value.
+struct HexTable {
+  /// The two characters of every byte value.
+  char chars[256][2];
+  constexpr HexTable() : chars() {
+    constexpr char digits[] = "0123456789ABCDEF";
+    for (int i = 0; i < 256; i++) {
+      chars[i][0] = digits[i >> 4];
+      chars[i][1] = digits[i & 0xF];
+    }
+  }
+};
+
+static constexpr HexTable HEX_TABLE;
+
+/// Lookup table with the value of every hexadecimal character, or -1 for any other character.
+struct HexValueTable {
+  /// The value of every character.
+  int8_t values[256];
+  constexpr HexValueTable() : values() {
+    for (int i = 0; i < 256; i++) {
+      values[i] = -1;
+    }
+    for (int i = 0; i < 10; i++) {
+      values['0' + i] = static_cast<int8_t>(i);
+    }
+    for (int i = 0; i < 6; i++) {
+      values['A' + i] = static_cast<int8_t>(10 + i);
+      values['a' + i] = static_cast<int8_t>(10 + i);
+    }
+  }
+};
+
+static constexpr HexValueTable HEX_VALUE_TABLE;
+
+/// @brief Decode the byte at two hexadecimal characters. Return false if they are not hexadecimal.
+static inline bool GetByte(const char *in, uint8_t *byte) {
+  auto hi = HEX_VALUE_TABLE.values[static_cast<uint8_t>(in[0])];
+  auto lo = HEX_VALUE_TABLE.values[static_cast<uint8_t>(in[1])];
+  if ((hi | lo) < 0) {
+    return false;
+  }
+  *byte = static_cast<uint8_t>((hi << 4) | lo);
+  return true;
+}
+
+/// @brief Return the number of bytes of the address field of a record type.
+static inline int AddressWidth(int type) {
+  switch (type) {
+    case Record::DATA24:
+    case Record::COUNT24:
+    case Record::TERM24: return 3;
+    case Record::DATA32:
+    case Record::TERM32: return 4;
+    default: return 2;
+  }
+}
+
+/**
+ * @brief Parse a single SREC record.
+ * @param line      The characters of the record, without line ending.
+ * @param length    The number of characters.
+ * @param type      Output for the record type.
+ * @param address   Output for the record address.
+ * @param data      Output buffer for the data, of at least 255 bytes.
+ * @param size      Output for the number of data bytes.
+ * @return True if the record is valid, false otherwise.
+ */
+static bool ParseRecord(const char *line, size_t length, int *type, uint32_t *address, uint8_t *data, size_t *size) {
+  if ((length < 4) || (line[0] != 'S') || (line[1] < '0') || (line[1] > '9')) {
+    return false;
+  }
+  *type = line[1] - '0';
+  uint8_t count;
+  if (!GetByte(line + 2, &count)) {
+    return false;
+  }
+  // The byte count covers the address, data and checksum.
+  int aw = AddressWidth(*type);
+  if ((count < aw + 1) || (length != 4 + 2 * static_cast<size_t>(count))) {
+    return false;
+  }
+  uint32_t sum = count;
+  const char *pos = line + 4;
+  uint32_t addr = 0;
+  for (int i = 0; i < aw; i++, pos += 2) {
+    uint8_t byte;
+    if (!GetByte(pos, &byte)) return false;
+    addr = (addr << 8u) | byte;
+    sum += byte;
+  }
+  *size = count - aw - 1;
+  for (size_t i = 0; i < *size; i++, pos += 2) {
+    if (!GetByte(pos, &data[i])) return false;
+    sum += data[i];
+  }
+  uint8_t checksum;
+  if (!GetByte(pos, &checksum)) {
+    return false;
+  }
+  *address = addr;
+  return static_cast<uint8_t>(~sum) == checksum;
+}
+
+/// @brief Put the hexadecimal characters of a byte in a character buffer, and add it to a checksum.
+static inline char *PutByte(char *out, uint8_t byte, uint32_t *sum) {
+  out[0] = HEX_TABLE.chars[byte][0];
+  out[1] = HEX_TABLE.chars[byte][1];
+  *sum += byte;
+  return out + 2;
+}
+
+/**
+ * @brief Format an SREC Record into a character buffer.
+ * @param out           The buffer, which must hold at least MAX_RECORD_CHARS characters.
+ * @param type          The type of the record.
+ * @param address_width The number of bytes of the address field.
+ * @param address       The address.
+ * @param data          The data.
+ * @param size          The number of data bytes, at most Record::MAX_DATA_BYTES.
+ * @param line_feed     Whether to terminate the record with a line feed.
+ * @return The number of characters written.
+ */
+static size_t FormatRecord(char *out,
+                           int type,
+                           int address_width,
+                           uint32_t address,
+                           const uint8_t *data,
+                           size_t size,
+                           bool line_feed) {
+  char *pos = out;
+  uint32_t sum = 0;
+  *pos++ = 'S';
+  *pos++ = static_cast<char>('0' + type);
+  pos = PutByte(pos, static_cast<uint8_t>(address_width + size + 1), &sum);
+  for (int i = address_width - 1; i >= 0; i--) {
+    pos = PutByte(pos, static_cast<uint8_t>(address >> (8u * i)), &sum);
+  }
+  for (size_t i = 0; i < size; i++) {
+    pos = PutByte(pos, data[i], &sum);
+  }
+  // The checksum is the one's complement of the least significant byte of the sum.
+  auto checksum = static_cast<uint8_t>(~sum);
+  *pos++ = HEX_TABLE.chars[checksum][0];
+  *pos++ = HEX_TABLE.chars[checksum][1];
+  if (line_feed) {
+    *pos++ = '\n';
+  }
+  return pos - out;
+}
+
 Record::Record(Type type, uint32_t address, const uint8_t *data, size_t size)
     : type_(type), size_(size), address_(address) {
   // Throw if size is too large.
@@ -51,14 +211,7 @@ uint8_t Record::byte_count() {
 }
 
 int Record::address_width() {
-  switch (type_) {
-    case DATA24: return 3;
-    case COUNT24: return 3;
-    case TERM24: return 3;
-    case DATA32: return 4;
-    case TERM32: return 4;
-    default:return 2;
-  }
+  return AddressWidth(type_);
 }
 
 uint8_t Record::checksum() {
@@ -82,79 +235,25 @@ uint8_t Record::checksum() {
 }
 
 std::string Record::ToString(bool line_feed) {
-  // String stream to build output
-  std::stringstream output;
-  // Record type
-  output << 'S' << std::to_string(type_);
-  // Byte count
-  PutHex(output, byte_count());
-  // Address
-  PutHex(output, address_, 2 * address_width());
-  // Data
-  for (size_t i = 0; i < size_; i++) {
-    PutHex(output, data_[i]);
-  }
-  // Checksum
-  PutHex(output, checksum());
-  // Line feed
-  if (line_feed) {
-    output << std::endl;
-  }
-  return output.str();
+  char buf[MAX_RECORD_CHARS];
+  auto len = FormatRecord(buf, type_, address_width(), address_, data_, size_, line_feed);
+  return std::string(buf, len);
 }
 
 std::optional<Record> Record::FromString(const std::string &line) {
-  // TODO(johanpel): make this function not break on big endian systems
-  size_t offset = 0;
-  Record ret(RESERVED, 0, nullptr, 0);
-
-  // Check if line starts with S (1 character)
-  if (line.substr(offset, 1) != "S") {
-    return std::nullopt;
-  }
-  offset++;
-
-  // Get type (1 character)
-  uint64_t t = std::stoul(line.substr(offset, 1), nullptr, 16);
-  if (t > 9) {
-    return std::nullopt;
-  }
-  ret.type_ = static_cast<Type>(t);
-  offset++;
-
-  // Get size (2 characters, 1 byte), subtract address width and checksum
-  ret.size_ = std::stoul(line.substr(offset, 2), nullptr, 16) - ret.address_width() - 1;
-  if (ret.size_ > MAX_DATA_BYTES) {
-    return std::nullopt;
-  }
-  offset += 2;
-
-  // Obtain the address (addr. width * (2 chars or 1 byte))
-  uint32_t addr = 0;
-  for (int i = ret.address_width() - 1; i >= 0; i--) {
-    uint8_t byte = static_cast<uint8_t>(std::stoul(line.substr(offset, 2), nullptr, 16));
-    addr |= static_cast<uint32_t>(byte) << (8u * i);
-    offset += 2;
-  }
-  ret.address_ = addr;
-
-  // Reserve a data buffer
-  ret.data_ = static_cast<uint8_t *>(calloc(ret.size_, sizeof(uint8_t)));
-
-  // Obtain the data (2 chars or 1 byte)
-  for (size_t i = 0; i < ret.size_; i++) {
-    auto byte = static_cast<uint8_t>(std::stoul(line.substr(offset, 2), nullptr, 16));
-    ret.data_[i] = byte;
-    offset += 2;
+  // Ignore the carriage return of CRLF line endings.
+  size_t length = line.size();
+  if ((length > 0) && (line[length - 1] == '\r')) {
+    length--;
   }
-
-  // Validate checksum
-  uint8_t sum = static_cast<uint8_t>(std::stoul(line.substr(offset, 2), nullptr, 16));
-  if (ret.checksum() != sum) {
+  int type;
+  uint32_t address;
+  uint8_t data[255];
+  size_t size;
+  if (!ParseRecord(line.data(), length, &type, &address, data, &size) || (size > MAX_DATA_BYTES)) {
     return std::nullopt;
   }
-
-  return ret;
+  return Record(static_cast<Type>(type), address, data, size);
 }
 
 File::File(uint32_t start_address, const uint8_t *data, size_t size, const std::string &header_str) {
@@ -226,4 +325,127 @@ void File::ToBuffer(uint8_t **buf, size_t *size) {
   }
 }
 
+/**
+ * @brief Format a range of data records of an image.
+ * @param out       The string to append the records to.
+ * @param segments  The segments of the image.
+ * @param size      The size of the image.
+ * @param start     The address of the start of the image.
+ * @param first     The index of the first record.
+ * @param last      The index of the record after the last record.
+ */
+static void FormatImageRecords(std::string *out,
+                               const std::vector<Segment> &segments,
+                               size_t size,
+                               uint32_t start,
+                               size_t first,
+                               size_t last) {
+  out->resize((last - first) * MAX_RECORD_CHARS);
+  char *pos = out->data();
+
+  // Find the first segment that does not end before the first record.
+  auto seg = std::partition_point(segments.begin(), segments.end(), [&](const Segment &s) {
+    return s.offset + s.size <= first * Record::MAX_DATA_BYTES;
+  });
+
+  uint8_t gathered[Record::MAX_DATA_BYTES];
+  for (size_t r = first; r < last; r++) {
+    size_t rec_offset = r * Record::MAX_DATA_BYTES;
+    size_t rec_size = std::min(Record::MAX_DATA_BYTES, size - rec_offset);
+    size_t rec_end = rec_offset + rec_size;
+    while ((seg != segments.end()) && (seg->offset + seg->size <= rec_offset)) {
+      seg++;
+    }
+    const uint8_t *data;
+    if ((seg != segments.end()) && (seg->data != nullptr) && (seg->offset <= rec_offset)
+        && (rec_end <= seg->offset + seg->size)) {
+      // The record lies within a single segment; format it in place.
+      data = seg->data + (rec_offset - seg->offset);
+    } else {
+      // The record spans multiple segments, padding or zero-filled segments; gather its bytes.
+      std::memset(gathered, 0, sizeof(gathered));
+      for (auto s = seg; (s != segments.end()) && (s->offset < rec_end); s++) {
+        if (s->data != nullptr) {
+          size_t lo = std::max(s->offset, rec_offset);
+          size_t hi = std::min(s->offset + s->size, rec_end);
+          std::memcpy(gathered + (lo - rec_offset), s->data + (lo - s->offset), hi - lo);
+        }
+      }
+      data = gathered;
+    }
+    pos += FormatRecord(pos, Record::DATA32, 4, static_cast<uint32_t>(start + rec_offset), data, rec_size, true);
+  }
+  out->resize(pos - out->data());
+}
+
+bool ParseImage(const char *data, size_t size, std::vector<uint8_t> *image) {
+  uint8_t rec_data[255];
+  const char *pos = data;
+  const char *end = data + size;
+  while (pos < end) {
+    // Find the end of the line.
+    auto eol = static_cast<const char *>(std::memchr(pos, '\n', end - pos));
+    if (eol == nullptr) {
+      eol = end;
+    }
+    size_t length = eol - pos;
+    if ((length > 0) && (pos[length - 1] == '\r')) {
+      length--;
+    }
+    // Skip empty lines, such as a trailing line feed.
+    if (length > 0) {
+      int type;
+      uint32_t address;
+      size_t rec_size;
+      if (!ParseRecord(pos, length, &type, &address, rec_data, &rec_size)) {
+        FLETCHER_LOG(ERROR, "Malformed SREC record at byte " + std::to_string(pos - data) + ".");
+        return false;
+      }
+      if ((type == Record::DATA16) || (type == Record::DATA24) || (type == Record::DATA32)) {
+        size_t rec_end = static_cast<size_t>(address) + rec_size;
+        if (rec_end > image->size()) {
+          image->resize(rec_end, 0);
+        }
+        std::memcpy(image->data() + address, rec_data, rec_size);
+      }
+    }
+    pos = eol + 1;
+  }
+  return true;
+}
+
+void WriteImage(std::ostream *output,
+                const std::vector<Segment> &segments,
+                size_t size,
+                uint32_t start_address,
+                size_t num_jobs,
+                const std::string &header_str) {
+  if (!output->good()) {
+    FLETCHER_LOG(ERROR, "Could not write SREC file to output stream.");
+    return;
+  }
+
+  (*output) << Record::Header(header_str).ToString(true);
+
+  size_t num_records = (size + Record::MAX_DATA_BYTES - 1) / Record::MAX_DATA_BYTES;
+  size_t num_tasks = (num_records + RECORDS_PER_TASK - 1) / RECORDS_PER_TASK;
+  if (num_jobs == 0) {
+    num_jobs = std::max<size_t>(1, std::thread::hardware_concurrency());
+  }
+
+  // Format the records in batches of tasks, such that the memory used does not depend on the size of the image.
+  std::vector<std::string> formatted(std::min(num_jobs, num_tasks));
+  for (size_t batch_start = 0; batch_start < num_tasks; batch_start += formatted.size()) {
+    size_t batch_size = std::min(formatted.size(), num_tasks - batch_start);
+    ParallelFor(batch_size, num_jobs, [&](size_t i) {
+      size_t first = (batch_start + i) * RECORDS_PER_TASK;
+      size_t last = std::min(first + RECORDS_PER_TASK, num_records);
+      FormatImageRecords(&formatted[i], segments, size, start_address, first, last);
+    });
+    for (size_t i = 0; i < batch_size; i++) {
+      output->write(formatted[i].data(), formatted[i].size());
+    }
+  }
+}
+
 }  // namespace fletchgen::srec
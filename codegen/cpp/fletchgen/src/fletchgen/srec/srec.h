@@ -172,4 +172,53 @@ struct File {
   std::vector<Record> records;
 };
 
+/// @brief A region of an SREC memory image. A region without data is filled with zeros.
+struct Segment {
+  /// Offset of the region from the start of the image, in bytes.
+  size_t offset = 0;
+  /// Source of the data, or nullptr for zeros.
+  const uint8_t *data = nullptr;
+  /// Size of the region in bytes.
+  size_t size = 0;
+};
+
+/**
+ * @brief Parse an SREC file into a memory image.
+ *
+ * The file is parsed in a single pass without any allocations other than growing the image. Data records of any
+ * address width are placed in the image at their address; any bytes not covered by a record are zero. Header, count
+ * and termination records are validated but otherwise ignored. Both LF and CRLF line endings are accepted.
+ *
+ * @param data  The SREC file contents.
+ * @param size  The size of the SREC file contents in bytes.
+ * @param image The image to place the data in. It is grown if necessary, but never shrunk.
+ * @return True if successful, false if the file contains malformed records or records with a bad checksum.
+ */
+bool ParseImage(const char *data, size_t size, std::vector<uint8_t> *image);
+
+/**
+ * @brief Write an SREC file of a memory image directly to an output stream.
+ *
+ * The image consists of segments that are read in place, so the image is never materialized in memory and no Record
+ * objects are created. Any bytes of the image not covered by a segment are zero. Data records are formatted in the
+ * same way as those of a File constructed from one contiguous buffer holding the whole image, so the output is
+ * identical.
+ *
+ * Formatting of the records can be split across multiple threads by address range. The output does not depend on the
+ * number of threads.
+ *
+ * @param output        The output stream to write to.
+ * @param segments      The segments of the image, ordered by offset and not overlapping.
+ * @param size          The total size of the image in bytes.
+ * @param start_address The address of the first byte of the image.
+ * @param num_jobs      The maximum number of threads to use. Zero means one thread per hardware thread.
+ * @param header_str    The header string. Default is commonly used "HDR".
+ */
+void WriteImage(std::ostream *output,
+                const std::vector<Segment> &segments,
+                size_t size,
+                uint32_t start_address = 0,
+                size_t num_jobs = 1,
+                const std::string &header_str = "HDR");
+
 }  // namespace fletchgen::srec
@@ -24,26 +24,27 @@ namespace fletchgen::top {
 
 using cerata::vhdl::Template;
 
-std::string GenerateAXITop(const Mantle &mantle,
+std::string GenerateAXITop(const cerata::Component &top,
                            const SchemaSet &schema_set,
-                           const std::vector<std::ostream *> &outputs) {
+                           const std::vector<std::ostream *> &outputs,
+                           const BusDim &bus_dim) {
   // Template for AXI top level
   auto t = Template::FromString(axi_source);
 
   // Bus properties
-  t.Replace("BUS_ADDR_WIDTH", 64);
-  t.Replace("BUS_DATA_WIDTH", 512);
-  t.Replace("BUS_LEN_WIDTH", 8);
-  t.Replace("BUS_BURST_STEP_LEN", 1);
-  t.Replace("BUS_BURST_MAX_LEN", 64);
+  t.Replace("BUS_ADDR_WIDTH", static_cast<int>(bus_dim.aw));
+  t.Replace("BUS_DATA_WIDTH", static_cast<int>(bus_dim.dw));
+  t.Replace("BUS_LEN_WIDTH", static_cast<int>(bus_dim.lw));
+  t.Replace("BUS_BURST_STEP_LEN", static_cast<int>(bus_dim.bs));
+  t.Replace("BUS_BURST_MAX_LEN", static_cast<int>(bus_dim.bm));
 
   // MMIO properties
   t.Replace("MMIO_ADDR_WIDTH", 32);
   t.Replace("MMIO_DATA_WIDTH", 32);
 
   // Do not change this order, TODO: fix this in replacement code
-  t.Replace("FLETCHER_WRAPPER_NAME", mantle.name());
-  t.Replace("FLETCHER_WRAPPER_INST_NAME", mantle.name() + "_inst");
+  t.Replace("FLETCHER_WRAPPER_NAME", top.name());
+  t.Replace("FLETCHER_WRAPPER_INST_NAME", top.name() + "_inst");
 
   if (schema_set.RequiresReading()) {
     t.Replace("MST_RREQ_DECLARE",
@@ -19,12 +19,21 @@
 #include <memory>
 
 #include "fletchgen/mantle.h"
+#include "fletchgen/schema.h"
 
 namespace fletchgen::top {
 
-/// @brief Generate an AXI top level on supplied output streams from a ColumnWrapper
-std::string GenerateAXITop(const Mantle &mantle,
+/**
+ * @brief Generate an AXI top level on supplied output streams.
+ * @param top        The top-level component to wrap, i.e. the Mantle or the multi-instance Wrapper.
+ * @param schema_set The schemas of the design, to determine whether read and/or write interfaces are required.
+ * @param outputs    The output streams to write the top level to.
+ * @param bus_dim    The dimensions of the memory bus of the top-level component.
+ * @return           The AXI top level.
+ */
+std::string GenerateAXITop(const cerata::Component &top,
                            const SchemaSet &schema_set,
-                           const std::vector<std::ostream *> &outputs);
+                           const std::vector<std::ostream *> &outputs,
+                           const BusDim &bus_dim = BusDim{});
 
 }  // namespace fletchgen::top
@@ -218,7 +218,7 @@ static char axi_source[] =
     "      BUS_ADDR_WIDTH            => BUS_ADDR_WIDTH,\n"
     "      BUS_DATA_WIDTH            => BUS_DATA_WIDTH,\n"
     "      BUS_BURST_STEP_LEN        => BUS_BURST_STEP_LEN,\n"
-    "      BUS_BURST_MAX_LEN         => BUS_ADDR_WIDTH,\n"
+    "      BUS_BURST_MAX_LEN         => BUS_BURST_MAX_LEN,\n"
     "      BUS_LEN_WIDTH             => BUS_LEN_WIDTH,\n"
     "      INDEX_WIDTH               => INDEX_WIDTH,\n"
     "      TAG_WIDTH                 => TAG_WIDTH\n"
@@ -0,0 +1,124 @@
+// Copyright 2018-2019 Delft University of Technology
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "fletchgen/top/cosim.h"
+
+#include <cerata/api.h>
+#include <string>
+
+#include "fletchgen/top/cosim_template.h"
+
+namespace fletchgen::top {
+
+using cerata::vhdl::Template;
+
+std::string GenerateCosimTop(const Design &design, const std::vector<std::ostream *> &outputs) {
+  // Template file for co-simulation top-level
+  auto t = Template::FromString(cosim_source);
+
+  // Bus properties, of the only memory channel that the co-simulation top-level supports.
+  auto bus_dim = design.bus_dims.empty() ? BusDim{} : design.bus_dims.front();
+  t.Replace("BUS_ADDR_WIDTH", static_cast<int>(bus_dim.aw));
+  t.Replace("BUS_DATA_WIDTH", static_cast<int>(bus_dim.dw));
+  t.Replace("BUS_LEN_WIDTH", static_cast<int>(bus_dim.lw));
+  t.Replace("BUS_BURST_STEP_LEN", static_cast<int>(bus_dim.bs));
+  t.Replace("BUS_BURST_MAX_LEN", static_cast<int>(bus_dim.bm));
+
+  // Do not change this order, TODO: fix this in replacement code
+  t.Replace("FLETCHER_WRAPPER_NAME", design.top()->name());
+  t.Replace("FLETCHER_WRAPPER_INST_NAME", design.top()->name() + "_inst");
+
+  if (design.schema_set->RequiresReading()) {
+    t.Replace("HOST_READ_PORTS",
+              "      rreq_valid                => bus_rreq_valid,\n"
+              "      rreq_ready                => bus_rreq_ready,\n"
+              "      rreq_addr                 => bus_rreq_addr,\n"
+              "      rreq_len                  => bus_rreq_len,\n"
+              "      rdat_valid                => bus_rdat_valid,\n"
+              "      rdat_ready                => bus_rdat_ready,\n"
+              "      rdat_data                 => bus_rdat_data,\n"
+              "      rdat_last                 => bus_rdat_last,");
+
+    t.Replace("MST_RREQ_DECLARE",
+              "      rd_mst_rreq_valid         : out std_logic;\n"
+              "      rd_mst_rreq_ready         : in  std_logic;\n"
+              "      rd_mst_rreq_addr          : out std_logic_vector(BUS_ADDR_WIDTH-1 downto 0);\n"
+              "      rd_mst_rreq_len           : out std_logic_vector(BUS_LEN_WIDTH-1 downto 0);\n"
+              "      rd_mst_rdat_valid         : in  std_logic;\n"
+              "      rd_mst_rdat_ready         : out std_logic;\n"
+              "      rd_mst_rdat_data          : in  std_logic_vector(BUS_DATA_WIDTH-1 downto 0);\n"
+              "      rd_mst_rdat_last          : in  std_logic;");
+
+    t.Replace("MST_RREQ_INSTANTIATE",
+              "      rd_mst_rreq_valid         => bus_rreq_valid,\n"
+              "      rd_mst_rreq_ready         => bus_rreq_ready,\n"
+              "      rd_mst_rreq_addr          => bus_rreq_addr,\n"
+              "      rd_mst_rreq_len           => bus_rreq_len,\n"
+              "      rd_mst_rdat_valid         => bus_rdat_valid,\n"
+              "      rd_mst_rdat_ready         => bus_rdat_ready,\n"
+              "      rd_mst_rdat_data          => bus_rdat_data,\n"
+              "      rd_mst_rdat_last          => bus_rdat_last,");
+  } else {
+    t.Replace("HOST_READ_PORTS", "");
+    t.Replace("MST_RREQ_DECLARE", "");
+    t.Replace("MST_RREQ_INSTANTIATE", "");
+  }
+  if (design.schema_set->RequiresWriting()) {
+    t.Replace("HOST_WRITE_PORTS",
+              "      wreq_valid                => bus_wreq_valid,\n"
+              "      wreq_ready                => bus_wreq_ready,\n"
+              "      wreq_addr                 => bus_wreq_addr,\n"
+              "      wreq_len                  => bus_wreq_len,\n"
+              "      wdat_valid                => bus_wdat_valid,\n"
+              "      wdat_ready                => bus_wdat_ready,\n"
+              "      wdat_data                 => bus_wdat_data,\n"
+              "      wdat_strobe               => bus_wdat_strobe,\n"
+              "      wdat_last                 => bus_wdat_last,");
+
+    t.Replace("MST_WREQ_DECLARE",
+              "      wr_mst_wreq_valid         : out std_logic;\n"
+              "      wr_mst_wreq_ready         : in  std_logic;\n"
+              "      wr_mst_wreq_addr          : out std_logic_vector(BUS_ADDR_WIDTH-1 downto 0);\n"
+              "      wr_mst_wreq_len           : out std_logic_vector(BUS_LEN_WIDTH-1 downto 0);\n"
+              "      wr_mst_wdat_valid         : out std_logic;\n"
+              "      wr_mst_wdat_ready         : in  std_logic;\n"
+              "      wr_mst_wdat_data          : out std_logic_vector(BUS_DATA_WIDTH-1 downto 0);\n"
+              "      wr_mst_wdat_strobe        : out std_logic_vector(BUS_DATA_WIDTH/8-1 downto 0);\n"
+              "      wr_mst_wdat_last          : out std_logic;");
+
+    t.Replace("MST_WREQ_INSTANTIATE",
+              "      wr_mst_wreq_valid         => bus_wreq_valid,\n"
+              "      wr_mst_wreq_ready         => bus_wreq_ready,\n"
+              "      wr_mst_wreq_addr          => bus_wreq_addr,\n"
+              "      wr_mst_wreq_len           => bus_wreq_len,\n"
+              "      wr_mst_wdat_valid         => bus_wdat_valid,\n"
+              "      wr_mst_wdat_ready         => bus_wdat_ready,\n"
+              "      wr_mst_wdat_data          => bus_wdat_data,\n"
+              "      wr_mst_wdat_strobe        => bus_wdat_strobe,\n"
+              "      wr_mst_wdat_last          => bus_wdat_last,");
+  } else {
+    t.Replace("HOST_WRITE_PORTS", "");
+    t.Replace("MST_WREQ_DECLARE", "");
+    t.Replace("MST_WREQ_INSTANTIATE", "");
+  }
+
+  for (auto &o : outputs) {
+    o->flush();
+    *o << t.ToString();
+  }
+
+  return t.ToString();
+}
+
+}  // namespace fletchgen::top
@@ -0,0 +1,36 @@
+// Copyright 2018-2019 Delft University of Technology
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "fletchgen/design.h"
+
+namespace fletchgen::top {
+
+/**
+ * @brief Generate a co-simulation top level on supplied output streams.
+ *
+ * The co-simulation top level connects the top-level component of a design to the SimHost model of the Sim platform,
+ * such that an unmodified host program using the Sim platform drives the simulated design.
+ *
+ * @param design  The design to generate the co-simulation top level for.
+ * @param outputs The output streams to write the top level to.
+ * @return        The co-simulation top level.
+ */
+std::string GenerateCosimTop(const Design &design, const std::vector<std::ostream *> &outputs);
+
+}  // namespace fletchgen::top
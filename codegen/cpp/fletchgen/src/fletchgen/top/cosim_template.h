@@ -0,0 +1,253 @@
+// Copyright 2018-2019 Delft University of Technology
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+namespace fletchgen::top {
+
+/// Co-simulation top level template source.
+static char cosim_source[] =
+    "-- Copyright 2018-2019 Delft University of Technology\n"
+    "--\n"
+    "-- Licensed under the Apache License, Version 2.0 (the \"License\");\n"
+    "-- you may not use this file except in compliance with the License.\n"
+    "-- You may obtain a copy of the License at\n"
+    "--\n"
+    "--     http://www.apache.org/licenses/LICENSE-2.0\n"
+    "--\n"
+    "-- Unless required by applicable law or agreed to in writing, software\n"
+    "-- distributed under the License is distributed on an \"AS IS\" BASIS,\n"
+    "-- WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.\n"
+    "-- See the License for the specific language governing permissions and\n"
+    "-- limitations under the License.\n"
+    "\n"
+    "library ieee;\n"
+    "use ieee.std_logic_1164.all;\n"
+    "use ieee.numeric_std.all;\n"
+    "\n"
+    "library work;\n"
+    "\n"
+    "-- Co-simulation top level. The SimHost model performs the MMIO requests of a\n"
+    "-- host program that uses the Sim platform, and serves the bus requests of the\n"
+    "-- design from the device memory of that platform.\n"
+    "entity CosimTop is\n"
+    "  generic (\n"
+    "    -- Accelerator properties\n"
+    "    INDEX_WIDTH                 : natural := 32;\n"
+    "    TAG_WIDTH                   : natural := 1;\n"
+    "\n"
+    "    -- Host bus properties\n"
+    "    BUS_ADDR_WIDTH              : natural := ${BUS_ADDR_WIDTH};\n"
+    "    BUS_DATA_WIDTH              : natural := ${BUS_DATA_WIDTH};\n"
+    "    BUS_LEN_WIDTH               : natural := ${BUS_LEN_WIDTH};\n"
+    "    BUS_BURST_MAX_LEN           : natural := ${BUS_BURST_MAX_LEN};\n"
+    "    BUS_BURST_STEP_LEN          : natural := ${BUS_BURST_STEP_LEN}\n"
+    "  );\n"
+    "end CosimTop;\n"
+    "\n"
+    "architecture Behavorial of CosimTop is\n"
+    "\n"
+    "  -----------------------------------------------------------------------------\n"
+    "  -- Default wrapper component.\n"
+    "  -----------------------------------------------------------------------------\n"
+    "  component ${FLETCHER_WRAPPER_NAME} is\n"
+    "    generic(\n"
+    "      BUS_ADDR_WIDTH     : integer;\n"
+    "      BUS_DATA_WIDTH     : integer;\n"
+    "      BUS_BURST_STEP_LEN : integer;\n"
+    "      BUS_BURST_MAX_LEN  : integer;\n"
+    "      BUS_LEN_WIDTH      : integer;\n"
+    "      INDEX_WIDTH        : integer;\n"
+    "      TAG_WIDTH          : integer\n"
+    "    );\n"
+    "    port(\n"
+    "      bcd_clk                   : in  std_logic;\n"
+    "      bcd_reset                 : in  std_logic;\n"
+    "      kcd_clk                   : in  std_logic;\n"
+    "      kcd_reset                 : in  std_logic;\n"
+    "${MST_RREQ_DECLARE}\n"
+    "${MST_WREQ_DECLARE}\n"
+    "      mmio_awvalid              : in  std_logic;\n"
+    "      mmio_awready              : out std_logic;\n"
+    "      mmio_awaddr               : in  std_logic_vector(31 downto 0);\n"
+    "      mmio_wvalid               : in  std_logic;\n"
+    "      mmio_wready               : out std_logic;\n"
+    "      mmio_wdata                : in  std_logic_vector(31 downto 0);\n"
+    "      mmio_wstrb                : in  std_logic_vector(3 downto 0);\n"
+    "      mmio_bvalid               : out std_logic;\n"
+    "      mmio_bready               : in  std_logic;\n"
+    "      mmio_bresp                : out std_logic_vector(1 downto 0);\n"
+    "      mmio_arvalid              : in  std_logic;\n"
+    "      mmio_arready              : out std_logic;\n"
+    "      mmio_araddr               : in  std_logic_vector(31 downto 0);\n"
+    "      mmio_rvalid               : out std_logic;\n"
+    "      mmio_rready               : in  std_logic;\n"
+    "      mmio_rdata                : out std_logic_vector(31 downto 0);\n"
+    "      mmio_rresp                : out std_logic_vector(1 downto 0)\n"
+    "    );\n"
+    "  end component;\n"
+    "  -----------------------------------------------------------------------------\n"
+    "\n"
+    "  -- Sim signals\n"
+    "  signal clock_stop             : std_logic := '0';\n"
+    "\n"
+    "  -- Accelerator signals\n"
+    "  signal kcd_clk                : std_logic;\n"
+    "  signal kcd_reset              : std_logic;\n"
+    "\n"
+    "  -- Fletcher bus signals\n"
+    "  signal bcd_clk                : std_logic;\n"
+    "  signal bcd_reset              : std_logic;\n"
+    "\n"
+    "  -- MMIO signals\n"
+    "  signal mmio_awvalid           : std_logic;\n"
+    "  signal mmio_awready           : std_logic;\n"
+    "  signal mmio_awaddr            : std_logic_vector(31 downto 0);\n"
+    "  signal mmio_wvalid            : std_logic;\n"
+    "  signal mmio_wready            : std_logic;\n"
+    "  signal mmio_wdata             : std_logic_vector(31 downto 0);\n"
+    "  signal mmio_wstrb             : std_logic_vector(3 downto 0);\n"
+    "  signal mmio_bvalid            : std_logic;\n"
+    "  signal mmio_bready            : std_logic;\n"
+    "  signal mmio_bresp             : std_logic_vector(1 downto 0);\n"
+    "  signal mmio_arvalid           : std_logic;\n"
+    "  signal mmio_arready           : std_logic;\n"
+    "  signal mmio_araddr            : std_logic_vector(31 downto 0);\n"
+    "  signal mmio_rvalid            : std_logic;\n"
+    "  signal mmio_rready            : std_logic;\n"
+    "  signal mmio_rdata             : std_logic_vector(31 downto 0);\n"
+    "  signal mmio_rresp             : std_logic_vector(1 downto 0);\n"
+    "\n"
+    "  -- Memory interface signals\n"
+    "  signal bus_rreq_addr          : std_logic_vector(BUS_ADDR_WIDTH-1 downto 0);\n"
+    "  signal bus_rreq_len           : std_logic_vector(BUS_LEN_WIDTH-1 downto 0);\n"
+    "  signal bus_rreq_valid         : std_logic;\n"
+    "  signal bus_rreq_ready         : std_logic;\n"
+    "  signal bus_rdat_data          : std_logic_vector(BUS_DATA_WIDTH-1 downto 0);\n"
+    "  signal bus_rdat_last          : std_logic;\n"
+    "  signal bus_rdat_valid         : std_logic;\n"
+    "  signal bus_rdat_ready         : std_logic;\n"
+    "  signal bus_wreq_addr          : std_logic_vector(BUS_ADDR_WIDTH-1 downto 0);\n"
+    "  signal bus_wreq_len           : std_logic_vector(BUS_LEN_WIDTH-1 downto 0);\n"
+    "  signal bus_wreq_valid         : std_logic;\n"
+    "  signal bus_wreq_ready         : std_logic;\n"
+    "  signal bus_wdat_data          : std_logic_vector(BUS_DATA_WIDTH-1 downto 0);\n"
+    "  signal bus_wdat_strobe        : std_logic_vector(BUS_DATA_WIDTH/8-1 downto 0);\n"
+    "  signal bus_wdat_last          : std_logic;\n"
+    "  signal bus_wdat_valid         : std_logic;\n"
+    "  signal bus_wdat_ready         : std_logic;\n"
+    "\n"
+    "begin\n"
+    "\n"
+    "  clk_proc: process is\n"
+    "  begin\n"
+    "    if clock_stop = '0' then\n"
+    "      kcd_clk <= '1';\n"
+    "      bcd_clk <= '1';\n"
+    "      wait for 5 ns;\n"
+    "      kcd_clk <= '0';\n"
+    "      bcd_clk <= '0';\n"
+    "      wait for 5 ns;\n"
+    "    else\n"
+    "      wait;\n"
+    "    end if;\n"
+    "  end process;\n"
+    "\n"
+    "  reset_proc: process is\n"
+    "  begin\n"
+    "    kcd_reset <= '1';\n"
+    "    bcd_reset <= '1';\n"
+    "    wait for 50 ns;\n"
+    "    wait until rising_edge(kcd_clk);\n"
+    "    kcd_reset <= '0';\n"
+    "    bcd_reset <= '0';\n"
+    "    wait;\n"
+    "  end process;\n"
+    "\n"
+    "  -----------------------------------------------------------------------------\n"
+    "  -- Sim platform host model\n"
+    "  -----------------------------------------------------------------------------\n"
+    "  host_inst: entity work.SimHost\n"
+    "    generic map (\n"
+    "      BUS_ADDR_WIDTH            => BUS_ADDR_WIDTH,\n"
+    "      BUS_LEN_WIDTH             => BUS_LEN_WIDTH,\n"
+    "      BUS_DATA_WIDTH            => BUS_DATA_WIDTH\n"
+    "    )\n"
+    "    port map (\n"
+    "      clk                       => bcd_clk,\n"
+    "      reset                     => bcd_reset,\n"
+    "      stop                      => clock_stop,\n"
+    "${HOST_READ_PORTS}\n"
+    "${HOST_WRITE_PORTS}\n"
+    "      mmio_awvalid              => mmio_awvalid,\n"
+    "      mmio_awready              => mmio_awready,\n"
+    "      mmio_awaddr               => mmio_awaddr,\n"
+    "      mmio_wvalid               => mmio_wvalid,\n"
+    "      mmio_wready               => mmio_wready,\n"
+    "      mmio_wdata                => mmio_wdata,\n"
+    "      mmio_wstrb                => mmio_wstrb,\n"
+    "      mmio_bvalid               => mmio_bvalid,\n"
+    "      mmio_bready               => mmio_bready,\n"
+    "      mmio_bresp                => mmio_bresp,\n"
+    "      mmio_arvalid              => mmio_arvalid,\n"
+    "      mmio_arready              => mmio_arready,\n"
+    "      mmio_araddr               => mmio_araddr,\n"
+    "      mmio_rvalid               => mmio_rvalid,\n"
+    "      mmio_rready               => mmio_rready,\n"
+    "      mmio_rdata                => mmio_rdata,\n"
+    "      mmio_rresp                => mmio_rresp\n"
+    "    );\n"
+    "\n"
+    "  -----------------------------------------------------------------------------\n"
+    "  -- Fletcher generated wrapper\n"
+    "  -----------------------------------------------------------------------------\n"
+    "  ${FLETCHER_WRAPPER_INST_NAME} : ${FLETCHER_WRAPPER_NAME}\n"
+    "    generic map (\n"
+    "      BUS_ADDR_WIDTH            => BUS_ADDR_WIDTH,\n"
+    "      BUS_DATA_WIDTH            => BUS_DATA_WIDTH,\n"
+    "      BUS_BURST_STEP_LEN        => BUS_BURST_STEP_LEN,\n"
+    "      BUS_BURST_MAX_LEN         => BUS_BURST_MAX_LEN,\n"
+    "      BUS_LEN_WIDTH             => BUS_LEN_WIDTH,\n"
+    "      INDEX_WIDTH               => INDEX_WIDTH,\n"
+    "      TAG_WIDTH                 => TAG_WIDTH\n"
+    "    )\n"
+    "    port map (\n"
+    "      kcd_clk                   => kcd_clk,\n"
+    "      kcd_reset                 => kcd_reset,\n"
+    "      bcd_clk                   => bcd_clk,\n"
+    "      bcd_reset                 => bcd_reset,\n"
+    "${MST_RREQ_INSTANTIATE}\n"
+    "${MST_WREQ_INSTANTIATE}\n"
+    "      mmio_awvalid              => mmio_awvalid,\n"
+    "      mmio_awready              => mmio_awready,\n"
+    "      mmio_awaddr               => mmio_awaddr,\n"
+    "      mmio_wvalid               => mmio_wvalid,\n"
+    "      mmio_wready               => mmio_wready,\n"
+    "      mmio_wdata                => mmio_wdata,\n"
+    "      mmio_wstrb                => mmio_wstrb,\n"
+    "      mmio_bvalid               => mmio_bvalid,\n"
+    "      mmio_bready               => mmio_bready,\n"
+    "      mmio_bresp                => mmio_bresp,\n"
+    "      mmio_arvalid              => mmio_arvalid,\n"
+    "      mmio_arready              => mmio_arready,\n"
+    "      mmio_araddr               => mmio_araddr,\n"
+    "      mmio_rvalid               => mmio_rvalid,\n"
+    "      mmio_rready               => mmio_rready,\n"
+    "      mmio_rdata                => mmio_rdata,\n"
+    "      mmio_rresp                => mmio_rresp\n"
+    "    );\n"
+    "\n"
+    "end architecture;\n";
+
+}  // namespace fletchgen::top
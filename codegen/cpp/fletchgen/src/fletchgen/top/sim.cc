@@ -22,6 +22,7 @@
 
 #include "fletchgen/top/sim_template.h"
 #include "fletchgen/mantle.h"
+#include "fletchgen/profiler.h"
 
 namespace fletchgen::top {
 
@@ -80,7 +81,8 @@ std::string GenerateSimTop(const Design &design,
                            const std::vector<std::ostream *> &outputs,
                            const std::string &read_srec_path,
                            const std::string &write_srec_path,
-                           const std::vector<RecordBatchDescription> &recordbatches) {
+                           const std::vector<RecordBatchDescription> &recordbatches,
+                           const std::string &mem_format) {
   // Template file for simulation top-level
   auto t = Template::FromString(sim_source);
 
@@ -94,16 +96,17 @@ std::string GenerateSimTop(const Design &design,
   // Total number of RecordBatches
   size_t num_rbs = read_schemas.size() + write_schemas.size();
 
-  // Bus properties
-  t.Replace("BUS_ADDR_WIDTH", 64);
-  t.Replace("BUS_DATA_WIDTH", 512);
-  t.Replace("BUS_LEN_WIDTH", 8);
-  t.Replace("BUS_BURST_STEP_LEN", 1);
-  t.Replace("BUS_BURST_MAX_LEN", 64);
+  // Bus properties, of the only memory channel that the simulation top-level supports.
+  auto bus_dim = design.bus_dims.empty() ? BusDim{} : design.bus_dims.front();
+  t.Replace("BUS_ADDR_WIDTH", static_cast<int>(bus_dim.aw));
+  t.Replace("BUS_DATA_WIDTH", static_cast<int>(bus_dim.dw));
+  t.Replace("BUS_LEN_WIDTH", static_cast<int>(bus_dim.lw));
+  t.Replace("BUS_BURST_STEP_LEN", static_cast<int>(bus_dim.bs));
+  t.Replace("BUS_BURST_MAX_LEN", static_cast<int>(bus_dim.bm));
 
   // Do not change this order, TODO: fix this in replacement code
-  t.Replace("FLETCHER_WRAPPER_NAME", design.mantle_comp->name());
-  t.Replace("FLETCHER_WRAPPER_INST_NAME", design.mantle_comp->name() + "_inst");
+  t.Replace("FLETCHER_WRAPPER_NAME", design.top()->name());
+  t.Replace("FLETCHER_WRAPPER_INST_NAME", design.top()->name() + "_inst");
 
   t.Replace("READ_SREC_PATH", read_srec_path);
   t.Replace("WRITE_SREC_PATH", write_srec_path);
@@ -138,6 +141,19 @@ std::string GenerateSimTop(const Design &design,
     rb_meta << GenMMIOWrite(rb_idx + 1, rb.rows, rb.name + " last index.");
     rb_offset++;
   }
+  // The dictionary lengths follow the buffer addresses.
+  size_t dict_offset = 0;
+  for (const auto &rb : recordbatches) {
+    for (const auto &f : rb.fields) {
+      if (f.dictionary && !f.buffers.empty()) {
+        uint32_t dict_idx = dict_offset + 2 * buffer_offset + (ndefault + 2 * num_rbs);
+        buffer_meta << GenMMIOWrite(dict_idx,
+                                    f.length,
+                                    rb.name + " " + f.buffers.front().desc_.front() + " dictionary length.");
+        dict_offset++;
+      }
+    }
+  }
   t.Replace("SREC_BUFFER_ADDRESSES", buffer_meta.str());
   t.Replace("SREC_FIRSTLAST_INDICES", rb_meta.str());
 
@@ -157,24 +173,42 @@ std::string GenerateSimTop(const Design &design,
 
   if (!design.profiling_regs.empty()) {
     std::stringstream profile_reads;
-    uint32_t addr = 0;
-    int i = 0;
+    std::stringstream profile_start;
+    std::stringstream profile_stop;
+    std::stringstream profile_snapshot;
     for (const auto &pr : design.profiling_regs) {
-      if (pr.name == "Profile_enable") {
-        // Profiling register should have an address now.
-        addr = pr.addr.value();
-      } else if (pr.name == "Profile_clear") {
-        // do nothing
-      } else if (pr.function == MmioFunction::PROFILE) {
-        i++;
-        std::stringstream profile_prefix;
-        profile_prefix << std::setw(42) << ("Profile " + pr.name);
-        profile_reads << GenMMIORead(pr.addr.value() / 4, profile_prefix.str(), false);
+      if (pr.function != MmioFunction::PROFILE) {
+        continue;
+      }
+      // Profiling registers should have an address now.
+      if (pr.behavior == MmioBehavior::CONTROL) {
+        // Enable registers of the stream and bus profilers.
+        profile_start << GenMMIOWrite(pr.addr.value() / 4, 1, "Start profiling (" + pr.name + ").");
+        profile_stop << GenMMIOWrite(pr.addr.value() / 4, 0, "Stop profiling (" + pr.name + ").");
+      } else if ((pr.name == PROFILE_SNAPSHOT) || (pr.name == BUS_PROFILE_SNAPSHOT)) {
+        // Copy all counters to their registers before reading them.
+        profile_snapshot << GenMMIOWrite(pr.addr.value() / 4, 1, "Snapshot profiling counters (" + pr.name + ").");
+      } else if ((pr.meta.count(MMIO_PROFILE_BUS) > 0)
+          && (pr.name == BusProfileBusyRegName(pr.meta.at(MMIO_PROFILE_BUS)))) {
+        // The bus profilers hand their snapshot over from the bus to the kernel clock domain. Wait until it arrived.
+        profile_snapshot << "    loop\n"
+                            "      mmio_read(" << pr.addr.value() / 4
+                         << ", read_data, mmio_source, mmio_sink, bcd_clk, bcd_reset);\n"
+                            "      exit when read_data(" << pr.index << ") = '0';\n"
+                            "    end loop;\n";
+      } else if (pr.behavior == MmioBehavior::STATUS) {
+        // Counters wider than 32 bits span multiple words, least significant first.
+        auto words = (pr.width + 31) / 32;
+        for (uint32_t w = 0; w < words; w++) {
+          std::stringstream profile_prefix;
+          profile_prefix << std::setw(42) << ("Profile " + pr.name + (words > 1 ? " [" + std::to_string(w) + "]" : ""));
+          profile_reads << GenMMIORead(pr.addr.value() / 4 + w, profile_prefix.str(), false);
+        }
       }
     }
-    t.Replace("PROFILE_START", GenMMIOWrite(addr / 4, 1, "Start profiling."));
-    t.Replace("PROFILE_STOP", GenMMIOWrite(addr / 4, 0, "Stop profiling."));
-    t.Replace("PROFILE_READ", profile_reads.str());
+    t.Replace("PROFILE_START", profile_start.str());
+    t.Replace("PROFILE_STOP", profile_stop.str());
+    t.Replace("PROFILE_READ", profile_snapshot.str() + profile_reads.str());
   } else {
     t.Replace("PROFILE_START", "");
     t.Replace("PROFILE_STOP", "");
@@ -193,6 +227,10 @@ std::string GenerateSimTop(const Design &design,
               "    SEED                        => 1337,\n"
               "    RANDOM_REQUEST_TIMING       => false,\n"
               "    RANDOM_RESPONSE_TIMING      => false,\n"
+              "    MEM_FORMAT                  => \"" + mem_format + "\",\n"
+              "    LATENCY                     => " + std::to_string(design.options->sim_mem_latency) + ",\n"
+              "    BEAT_CYCLES                 => " + std::to_string(design.options->sim_mem_beat_cycles) + ",\n"
+              "    MAX_OUTSTANDING             => " + std::to_string(design.options->sim_mem_outstanding) + ",\n"
               "    SREC_FILE                   => \"" +
                   abs_path
                   + "\"\n"
@@ -245,6 +283,8 @@ std::string GenerateSimTop(const Design &design,
               "    SEED                        => 1337,\n"
               "    RANDOM_REQUEST_TIMING       => false,\n"
               "    RANDOM_RESPONSE_TIMING      => false,\n"
+              "    MEM_FORMAT                  => \"" + mem_format + "\",\n"
+              "    BEAT_CYCLES                 => " + std::to_string(design.options->sim_mem_beat_cycles) + ",\n"
               "    SREC_FILE                   => \""
                   + CanonicalizePath(write_srec_path)
                   + "\"\n"
@@ -260,7 +300,8 @@ std::string GenerateSimTop(const Design &design,
                     "    wdat_ready                  => bus_wdat_ready,\n"
                     "    wdat_data                   => bus_wdat_data,\n"
                     "    wdat_strobe                 => bus_wdat_strobe,\n"
-                    "    wdat_last                   => bus_wdat_last\n"
+                    "    wdat_last                   => bus_wdat_last,\n"
+                    "    dump                        => mem_dump\n"
                     "  );");
 
     t.Replace("MST_WREQ_DECLARE",
@@ -21,11 +21,17 @@
 
 namespace fletchgen::top {
 
-/// @brief Generate a simulation top level on supplied output streams from a ColumnWrapper
+/**
+ * @brief Generate a simulation top level on supplied output streams from a ColumnWrapper
+ *
+ * The memory models load the read memory contents from read_srec_path and dump the written memory contents to
+ * write_srec_path, in the format selected by mem_format: "srec" for S-record files or "bin" for raw binary images.
+ */
 std::string GenerateSimTop(const Design &design,
                            const std::vector<std::ostream *> &outputs,
                            const std::string &read_srec_path,
                            const std::string &write_srec_path,
-                           const std::vector<fletcher::RecordBatchDescription> &recordbatches);
+                           const std::vector<fletcher::RecordBatchDescription> &recordbatches,
+                           const std::string &mem_format = "srec");
 
 }
@@ -119,6 +119,7 @@ static char sim_source[] =
     "\n"
     "  -- Sim signals\n"
     "  signal clock_stop             : boolean := false;\n"
+    "  signal mem_dump               : std_logic := '0';\n"
     "\n"
     "  -- Accelerator signals\n"
     "  signal kcd_clk                : std_logic;\n"
@@ -350,7 +351,10 @@ static char sim_source[] =
     "\n"
     "    -- 8. Read profile registers.\n"
     "${PROFILE_READ}\n"
-    "    -- 9. Finish and stop simulation.\n"
+    "    -- 9. Dump the memory written by the kernel, finish and stop simulation.\n"
+    "    mem_dump <= '1';\n"
+    "    wait until rising_edge(bcd_clk);\n"
+    "    wait until rising_edge(bcd_clk);\n"
     "    report \"Stimuli done.\";\n"
     "    clock_stop <= true;\n"
     "\n"
@@ -394,7 +398,7 @@ static char sim_source[] =
     "      BUS_ADDR_WIDTH            => BUS_ADDR_WIDTH,\n"
     "      BUS_DATA_WIDTH            => BUS_DATA_WIDTH,\n"
     "      BUS_BURST_STEP_LEN        => BUS_BURST_STEP_LEN,\n"
-    "      BUS_BURST_MAX_LEN         => BUS_ADDR_WIDTH,\n"
+    "      BUS_BURST_MAX_LEN         => BUS_BURST_MAX_LEN,\n"
     "      BUS_LEN_WIDTH             => BUS_LEN_WIDTH,\n"
     "      INDEX_WIDTH               => INDEX_WIDTH,\n"
     "      TAG_WIDTH                 => TAG_WIDTH\n"
@@ -16,7 +16,12 @@
 
 #include <fletcher/common.h>
 #include <cerata/api.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
 #include <cstdlib>
+#include <thread>
+#include <vector>
 
 #include "fletchgen_config/config.h"
 
@@ -69,6 +74,63 @@ void LogCerata(cerata::LogLevel level,
   }
 }
 
+void ParallelFor(size_t num_tasks, size_t num_jobs, const std::function<void(size_t)> &task) {
+  if (num_jobs == 0) {
+    num_jobs = std::max<size_t>(1, std::thread::hardware_concurrency());
+  }
+  num_jobs = std::min(num_jobs, num_tasks);
+
+  // Run on the calling thread if there is nothing to gain from spawning threads.
+  if (num_jobs <= 1) {
+    for (size_t i = 0; i < num_tasks; i++) {
+      task(i);
+    }
+    return;
+  }
+
+  std::atomic<size_t> next(0);
+  auto worker = [&]() {
+    for (size_t i = next++; i < num_tasks; i = next++) {
+      task(i);
+    }
+  };
+  std::vector<std::thread> threads;
+  threads.reserve(num_jobs - 1);
+  for (size_t t = 0; t < num_jobs - 1; t++) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto &t : threads) {
+    t.join();
+  }
+}
+
+std::string JsonString(const std::string &str) {
+  std::string result = "\"";
+  for (auto c : str) {
+    switch (c) {
+      case '"': result += "\\\""; break;
+      case '\\': result += "\\\\"; break;
+      case '\b': result += "\\b"; break;
+      case '\f': result += "\\f"; break;
+      case '\n': result += "\\n"; break;
+      case '\r': result += "\\r"; break;
+      case '\t': result += "\\t"; break;
+      default: {
+        if (static_cast<uint8_t>(c) < 0x20) {
+          // Other control characters must be escaped as code points.
+          char escaped[7];
+          std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+          result += escaped;
+        } else {
+          result.push_back(c);
+        }
+      }
+    }
+  }
+  return result + "\"";
+}
+
 std::string version() {
   return "fletchgen " + std::to_string(FLETCHGEN_VERSION_MAJOR)
       + "." + std::to_string(FLETCHGEN_VERSION_MINOR)
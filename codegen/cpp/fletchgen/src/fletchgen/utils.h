@@ -17,6 +17,8 @@
 #include <fletcher/common.h>
 #include <cerata/api.h>
 
+#include <cstddef>
+#include <functional>
 #include <string>
 
 /// Contains all classes and functions related to Fletchgen.
@@ -42,6 +44,21 @@ void LogCerata(cerata::LogLevel level,
                char const *source_file,
                int line_number);
 
+/**
+ * @brief Run a number of independent tasks on a pool of threads, and wait for all of them to complete.
+ *
+ * Tasks are started in order of their index, but may complete in any order. Tasks should write their results to a
+ * slot reserved for their index, such that the result does not depend on the number of threads.
+ *
+ * @param num_tasks The number of tasks.
+ * @param num_jobs  The maximum number of threads to use. Zero means one thread per hardware thread.
+ * @param task      The function to run for every task index in [0, num_tasks).
+ */
+void ParallelFor(size_t num_tasks, size_t num_jobs, const std::function<void(size_t)> &task);
+
+/// @brief Return a string as a JSON string literal, with quotes, backslashes and control characters escaped.
+std::string JsonString(const std::string &str);
+
 /// Default copyright notice.
 constexpr char DEFAULT_NOTICE[] = "-- Copyright 2018-2019 Delft University of Technology\n"
                                   "--\n"
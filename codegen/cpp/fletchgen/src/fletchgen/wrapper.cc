@@ -0,0 +1,111 @@
+// Copyright 2018-2019 Delft University of Technology
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "fletchgen/wrapper.h"
+
+#include <cerata/api.h>
+#include <fletcher/common.h>
+
+#include <memory>
+#include <vector>
+#include <utility>
+#include <string>
+
+#include "fletchgen/basic_types.h"
+#include "fletchgen/array.h"
+#include "fletchgen/bus.h"
+#include "fletchgen/axi4_lite.h"
+
+namespace fletchgen {
+
+using cerata::intl;
+using cerata::strl;
+
+Wrapper::Wrapper(std::string name, const std::shared_ptr<Mantle> &mantle, size_t num_replicas, size_t window_width)
+    : Component(std::move(name)), mantle_(mantle), window_width_(window_width) {
+  if (num_replicas == 0) {
+    FLETCHER_LOG(FATAL, "Wrapper requires at least one Mantle replica.");
+  }
+
+  // Add the same parameters as the Mantle.
+  auto iw = index_width();
+  auto tw = tag_width();
+  Add({iw, tw});
+
+  auto bus_dims = mantle_->bus_dims();
+  std::vector<BusDimParams> bus_params;
+  for (size_t c = 0; c < bus_dims.size(); c++) {
+    bus_params.emplace_back(this, bus_dims[c], ChannelParamPrefix(c));
+  }
+
+  // Add the same default ports as the Mantle.
+  auto bcr = port("bcd", cr(), Port::Dir::IN, bus_cd());
+  auto kcr = port("kcd", cr(), Port::Dir::IN, kernel_cd());
+  auto axi = axi4_lite(Port::Dir::IN, bus_cd());
+  Add({bcr, kcr, axi});
+
+  // Divide the MMIO address space over the replicas.
+  auto demux = Instantiate(axi4_lite_demux(), "mmio_demux_inst");
+  demux->prt("bcd") <<= bcr;
+  demux->prt("slv") <<= axi;
+  demux->par("WINDOW_WIDTH")->SetValue(intl(static_cast<int>(window_width_)));
+  auto demux_mst = demux->prt_arr("mst");
+
+  // Instantiate the replicas.
+  for (size_t r = 0; r < num_replicas; r++) {
+    auto inst = Instantiate(mantle_.get(), mantle_->name() + "_" + std::to_string(r) + "_inst");
+    mantle_instances_.push_back(inst);
+    inst->prt("bcd") <<= bcr;
+    inst->prt("kcd") <<= kcr;
+    Connect(inst->prt("mmio"), demux_mst->Append());
+    inst->par("INDEX_WIDTH")->SetValue(iw);
+    inst->par("TAG_WIDTH")->SetValue(tw);
+    for (size_t c = 0; c < bus_params.size(); c++) {
+      auto prefix = ChannelParamPrefix(c);
+      ConnectBusParam(inst, prefix.empty() ? "" : prefix + "_", bus_params[c], inst_to_comp_map());
+    }
+  }
+
+  // Arbitrate the bus master ports of all replicas onto the bus master ports of every memory channel.
+  for (size_t c = 0; c < bus_params.size(); c++) {
+    for (auto func : {BusFunction::READ, BusFunction::WRITE}) {
+      auto mst_name = ChannelName(c, func == BusFunction::READ ? "rd_mst" : "wr_mst");
+      if (!mantle_->Has(mst_name)) {
+        continue;
+      }
+      BusSpecParams spec{bus_params[c], func};
+      Instance *arb = Instantiate(bus_arbiter(func), ChannelName(c, spec.ToName() + "_inst"));
+      arb->prt("bcd") <<= bcr;
+      arb->par("ARB_METHOD")->SetValue(strl(mantle_->arb_spec().method));
+      arb->par("MAX_OUTSTANDING")->SetValue(intl(static_cast<int>(mantle_->arb_spec().max_outstanding)));
+      ConnectBusParam(arb, "", bus_params[c], inst_to_comp_map());
+      auto mst = bus_port(mst_name, Port::OUT, spec);
+      Connect(mst, arb->Get<Port>("mst"));
+      Add(mst);
+      auto bsv = arb->prt_arr("bsv");
+      for (auto inst : mantle_instances_) {
+        Connect(bsv->Append(), inst->prt(mst_name));
+      }
+    }
+  }
+}
+
+std::shared_ptr<Wrapper> wrapper(const std::string &name,
+                                 const std::shared_ptr<Mantle> &mantle,
+                                 size_t num_replicas,
+                                 size_t window_width) {
+  return std::make_shared<Wrapper>(name, mantle, num_replicas, window_width);
+}
+
+}  // namespace fletchgen
@@ -0,0 +1,72 @@
+// Copyright 2018-2019 Delft University of Technology
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cerata/api.h>
+
+#include <string>
+#include <memory>
+#include <vector>
+
+#include "fletchgen/bus.h"
+#include "fletchgen/mantle.h"
+
+namespace fletchgen {
+
+using cerata::Instance;
+
+/**
+ * @brief A component that instantiates multiple replicas of a Mantle to operate in parallel.
+ *
+ * The Wrapper has the same interface as the Mantle it replicates. The MMIO address space is divided into equally sized
+ * windows, one for every replica, through an AxiLiteDemux. The bus master ports of all replicas on the same memory
+ * channel are arbitrated onto the bus master port of that channel.
+ */
+class Wrapper : public Component {
+ public:
+  /// @brief Construct a Wrapper that instantiates a Mantle a number of times.
+  Wrapper(std::string name, const std::shared_ptr<Mantle> &mantle, size_t num_replicas, size_t window_width);
+  /// @brief Return the Mantle component of this Wrapper.
+  std::shared_ptr<Mantle> mantle() const { return mantle_; }
+  /// @brief Return all Mantle instances of this Wrapper.
+  std::vector<Instance *> mantle_instances() const { return mantle_instances_; }
+  /// @brief Return the number of Mantle replicas.
+  size_t num_replicas() const { return mantle_instances_.size(); }
+  /// @brief Return log2 of the size of the MMIO address window of every replica, in bytes.
+  size_t window_width() const { return window_width_; }
+
+ protected:
+  /// The Mantle to replicate.
+  std::shared_ptr<Mantle> mantle_;
+  /// The Mantle instances.
+  std::vector<Instance *> mantle_instances_;
+  /// Log2 of the MMIO window size of every replica.
+  size_t window_width_;
+};
+
+/**
+ * @brief Construct a Wrapper component and return a shared pointer to it.
+ * @param name          The name of the wrapper.
+ * @param mantle        The Mantle to replicate.
+ * @param num_replicas  The number of Mantle instances.
+ * @param window_width  Log2 of the size of the MMIO address window of every replica, in bytes.
+ * @return              A shared pointer to the wrapper component.
+ */
+std::shared_ptr<Wrapper> wrapper(const std::string &name,
+                                 const std::shared_ptr<Mantle> &mantle,
+                                 size_t num_replicas,
+                                 size_t window_width);
+
+}  // namespace fletchgen
@@ -21,6 +21,7 @@
 #include <vector>
 #include <memory>
 #include <fstream>
+#include <sstream>
 
 #include "fletchgen/srec/srec.h"
 #include "fletchgen/srec/recordbatch.h"
@@ -82,6 +83,218 @@ TEST(SREC, File) {
   free(result);
 }
 
+TEST(SREC, WriteImage) {
+  // Segments with padding in between, a zero-filled segment and records spanning multiple segments.
+  std::vector<uint8_t> a(100), b(13), c(40);
+  for (size_t i = 0; i < a.size(); i++) a[i] = static_cast<uint8_t>(i);
+  for (size_t i = 0; i < b.size(); i++) b[i] = static_cast<uint8_t>(0xA0 + i);
+  for (size_t i = 0; i < c.size(); i++) c[i] = static_cast<uint8_t>(0xF0 - i);
+  std::vector<Segment> segments = {{0, a.data(), a.size()},
+                                   {104, b.data(), b.size()},
+                                   {120, nullptr, 8},
+                                   {128, c.data(), c.size()}};
+  size_t size = 176;
+
+  // The same image in one contiguous buffer.
+  std::vector<uint8_t> image(size, 0);
+  for (const auto &s : segments) {
+    if (s.data != nullptr) {
+      memcpy(image.data() + s.offset, s.data, s.size);
+    }
+  }
+  std::stringstream expected;
+  File(0, image.data(), image.size()).write(&expected);
+
+  for (size_t jobs : {1, 4}) {
+    std::stringstream result;
+    WriteImage(&result, segments, size, 0, jobs);
+    ASSERT_EQ(result.str(), expected.str());
+  }
+}
+
+TEST(SREC, WriteImageMultipleTasks) {
+  // An image of several tasks of 16384 records, with segments that cross task boundaries.
+  constexpr size_t task_size = 16384 * Record::MAX_DATA_BYTES;
+  std::vector<uint8_t> a(task_size + 1000), b(2 * task_size - 7);
+  for (size_t i = 0; i < a.size(); i++) a[i] = static_cast<uint8_t>(i * 7);
+  for (size_t i = 0; i < b.size(); i++) b[i] = static_cast<uint8_t>(i ^ (i >> 8));
+  std::vector<Segment> segments = {{0, a.data(), a.size()},
+                                   {a.size() + 24, nullptr, 40},
+                                   {a.size() + 64, b.data(), b.size()}};
+  size_t size = a.size() + 64 + b.size() + 100;
+
+  // The multi-threaded output must equal the single-threaded output, also when there are fewer jobs than tasks.
+  std::stringstream expected;
+  WriteImage(&expected, segments, size, 0, 1);
+  for (size_t jobs : {2, 3, 8}) {
+    std::stringstream result;
+    WriteImage(&result, segments, size, 0, jobs);
+    ASSERT_EQ(result.str(), expected.str()) << jobs << " jobs";
+  }
+
+  // Both must equal the image written as a whole.
+  std::vector<uint8_t> image(size, 0);
+  for (const auto &s : segments) {
+    if (s.data != nullptr) {
+      memcpy(image.data() + s.offset, s.data, s.size);
+    }
+  }
+  std::stringstream whole;
+  File(0, image.data(), image.size()).write(&whole);
+  ASSERT_EQ(expected.str(), whole.str());
+}
+
+/// @brief Return a RecordBatch with a nullable string column that has nulls and empty strings only.
+static std::shared_ptr<arrow::RecordBatch> GetEmptyStringsRB() {
+  arrow::StringBuilder builder;
+  THROW_NOT_OK(builder.AppendNull());
+  THROW_NOT_OK(builder.Append(""));
+  THROW_NOT_OK(builder.Append(""));
+  std::shared_ptr<arrow::Array> array;
+  THROW_NOT_OK(builder.Finish(&array));
+  auto schema = fletcher::WithMetaRequired(*arrow::schema({arrow::field("Empty", arrow::utf8(), true)}),
+                                           "EmptyStrings",
+                                           fletcher::Mode::READ);
+  return arrow::RecordBatch::Make(schema, array->length(), {array});
+}
+
+TEST(SREC, ReadRecordBatches) {
+  std::vector<std::shared_ptr<arrow::RecordBatch>> batches = {fletcher::GetStringRB(),
+                                                             fletcher::GetListUint8RB(),
+                                                             GetEmptyStringsRB(),
+                                                             fletcher::GetStructRB()};
+  std::vector<fletcher::RecordBatchDescription> desc_in(batches.size());
+  std::vector<std::shared_ptr<arrow::Schema>> schemas;
+  for (size_t i = 0; i < batches.size(); i++) {
+    fletcher::RecordBatchAnalyzer rba(&desc_in[i]);
+    ASSERT_TRUE(rba.Analyze(*batches[i]));
+    schemas.push_back(batches[i]->schema());
+  }
+
+  // Write the SREC file and obtain the buffer offsets in the SREC image.
+  std::vector<fletcher::RecordBatchDescription> desc_out;
+  std::stringstream srec;
+  GenerateReadSREC(desc_in, &desc_out, &srec, 64);
+
+  // Read it back, from a stream and from a file.
+  auto ofs = std::ofstream("srec_read_test.srec");
+  ofs << srec.str();
+  ofs.close();
+  auto from_stream = ReadRecordBatchesFromSREC(&srec, schemas, desc_out);
+  auto from_file = ReadRecordBatchesFromSREC(std::string("srec_read_test.srec"), schemas, desc_out);
+  ASSERT_EQ(from_stream.size(), batches.size());
+  ASSERT_EQ(from_file.size(), batches.size());
+  for (size_t i = 0; i < batches.size(); i++) {
+    ASSERT_TRUE(from_stream[i]->Equals(*batches[i]));
+    ASSERT_TRUE(from_file[i]->Equals(*batches[i]));
+  }
+}
+
+TEST(SREC, MemoryImage) {
+  std::vector<std::shared_ptr<arrow::RecordBatch>> batches = {fletcher::GetStringRB(), fletcher::GetStructRB()};
+  std::vector<fletcher::RecordBatchDescription> desc_in(batches.size());
+  std::vector<std::shared_ptr<arrow::Schema>> schemas;
+  for (size_t i = 0; i < batches.size(); i++) {
+    fletcher::RecordBatchAnalyzer rba(&desc_in[i]);
+    ASSERT_TRUE(rba.Analyze(*batches[i]));
+    schemas.push_back(batches[i]->schema());
+  }
+
+  // The image must hold the same buffers at the same offsets as the SREC file.
+  std::vector<fletcher::RecordBatchDescription> srec_desc;
+  std::vector<fletcher::RecordBatchDescription> image_desc;
+  std::stringstream srec;
+  std::stringstream image;
+  GenerateReadSREC(desc_in, &srec_desc, &srec, 64);
+  auto size = GenerateReadImage(desc_in, &image_desc, &image, 64);
+  ASSERT_EQ(image.str().size(), size);
+  ASSERT_EQ(size % 64, 0);
+
+  std::vector<uint8_t> srec_image;
+  ASSERT_TRUE(ParseImage(srec.str().data(), srec.str().size(), &srec_image));
+  ASSERT_LE(srec_image.size(), size);
+  ASSERT_EQ(std::string(srec_image.begin(), srec_image.end()), image.str().substr(0, srec_image.size()));
+
+  std::vector<uint64_t> offsets;
+  for (const auto &d : image_desc) {
+    for (const auto &f : d.fields) {
+      for (const auto &b : f.buffers) {
+        offsets.push_back(reinterpret_cast<uint64_t>(b.raw_buffer_));
+      }
+    }
+  }
+
+  // The layout must list every buffer offset.
+  auto layout = GenerateImageLayout(image_desc, size, 64);
+  ASSERT_NE(layout.find("\"size\": " + std::to_string(size)), std::string::npos);
+  for (auto o : offsets) {
+    ASSERT_NE(layout.find("\"offset\": " + std::to_string(o)), std::string::npos);
+  }
+
+  // Read it back.
+  auto ofs = std::ofstream("image_read_test.bin", std::ios::binary);
+  ofs << image.str();
+  ofs.close();
+  auto from_file = ReadRecordBatchesFromImage("image_read_test.bin", schemas, image_desc);
+  ASSERT_EQ(from_file.size(), batches.size());
+  for (size_t i = 0; i < batches.size(); i++) {
+    ASSERT_TRUE(from_file[i]->Equals(*batches[i]));
+  }
+}
+
+TEST(SREC, ImageLayoutEscaping) {
+  fletcher::RecordBatchDescription desc;
+  desc.name = std::string("a\"b\\c\nd\x01", 8);
+  desc.rows = 0;
+  auto layout = GenerateImageLayout({desc}, 0, 64);
+  ASSERT_NE(layout.find("\"name\": \"a\\\"b\\\\c\\nd\\u0001\""), std::string::npos);
+}
+
+TEST(SREC, MalformedImage) {
+  auto batch = fletcher::GetStringRB();
+  std::vector<fletcher::RecordBatchDescription> desc_in(1);
+  fletcher::RecordBatchAnalyzer rba(&desc_in[0]);
+  ASSERT_TRUE(rba.Analyze(*batch));
+  std::vector<fletcher::RecordBatchDescription> desc;
+  std::stringstream image;
+  GenerateReadImage(desc_in, &desc, &image, 64);
+  const auto &offsets = desc[0].fields[0].buffers[0];
+  const auto &values = desc[0].fields[0].buffers[1];
+  auto last_offset = reinterpret_cast<uint64_t>(offsets.raw_buffer_) + batch->num_rows() * sizeof(int32_t);
+
+  auto read = [&](const std::string &contents, const std::vector<fletcher::RecordBatchDescription> &layout) {
+    auto ofs = std::ofstream("image_malformed_test.bin", std::ios::binary);
+    ofs << contents;
+    ofs.close();
+    return ReadRecordBatchesFromImage("image_malformed_test.bin", {batch->schema()}, layout);
+  };
+  ASSERT_EQ(read(image.str(), desc).size(), 1);
+
+  // A truncated image.
+  auto truncated = image.str().substr(0, reinterpret_cast<uint64_t>(values.raw_buffer_) + 1);
+  ASSERT_TRUE(read(truncated, desc).empty());
+
+  // A last offset that points far beyond the image.
+  auto huge = image.str();
+  int32_t huge_offset = 0x7FFFFFFF;
+  memcpy(&huge[last_offset], &huge_offset, sizeof(int32_t));
+  ASSERT_TRUE(read(huge, desc).empty());
+
+  // Decreasing offsets.
+  auto decreasing = image.str();
+  int32_t negative_step = -1;
+  memcpy(&decreasing[last_offset], &negative_step, sizeof(int32_t));
+  ASSERT_TRUE(read(decreasing, desc).empty());
+
+  // A buffer offset beyond the image, and more rows than the image can hold.
+  auto beyond = desc;
+  beyond[0].fields[0].buffers[1].raw_buffer_ = reinterpret_cast<const uint8_t *>(uint64_t(1) << 40u);
+  ASSERT_TRUE(read(image.str(), beyond).empty());
+  auto rows = desc;
+  rows[0].rows = int64_t(1) << 60;
+  ASSERT_TRUE(read(image.str(), rows).empty());
+}
+
 TEST(SREC, RecordBatchRoundTrip) {
   // Get a recordbatch with some integers
   auto rb = fletcher::GetStringRB();
@@ -30,7 +30,7 @@ TEST(Array, TypeMapper) {
   using std::pair;
   using fletcher::WithMetaEPC;
 
-  constexpr int n_tests = 8;
+  constexpr int n_tests = 9;
 
   std::vector<std::shared_ptr<arrow::Field>> fields(n_tests);
   std::vector<pair<int, int>> specs(n_tests);
@@ -49,6 +49,7 @@ TEST(Array, TypeMapper) {
                         field("inner", arrow::utf8(), false)), false);       // 3, 32+32+8 + 1+1   +   0
   fields[6] = WithMetaEPC(*field("test", arrow::utf8(), false), 64);         // 2, 32+512  + 1+7   +   0
   fields[7] = WithMetaEPC(*field("test", arrow::float16(), false), 2);       // 1, 32      + 2     +   0
+  fields[8] = WithMetaEPC(*field("test", arrow::boolean(), true), 64);       // 1, 64      + 7     +  64
 
   // Array data spec must return correct pair.
   for (int i = 0; i < n_tests; i++) {
@@ -64,6 +65,7 @@ TEST(Array, TypeMapper) {
   ASSERT_EQ(specs[5], pair(3, 32 + 32 + 8 + 1 + 1));
   ASSERT_EQ(specs[6], pair(2, 32 + 512 + 1 + 7));
   ASSERT_EQ(specs[7], pair(1, 32 + 2 + 0));
+  ASSERT_EQ(specs[8], pair(1, 64 + 7 + 64));
 
   // Generate types as seen by array(reader/writer) and kernel, and auto-generate mappers.
   for (int i = 0; i < n_tests; i++) {
@@ -87,4 +89,44 @@ TEST(Array, Writer) {
   GenerateTestDecl(top);
 }
 
+TEST(Array, ConfigString) {
+  using arrow::field;
+  auto prim = field("a", arrow::uint32(), false);
+  ASSERT_EQ(GenerateConfigString(*prim), "prim(32)");
+  ASSERT_EQ(GenerateConfigString(*fletcher::WithMetaEPC(*prim, 4)), "prim(32;epc=4)");
+  ASSERT_EQ(GenerateConfigString(*fletcher::WithMetaBusFifoDepth(*fletcher::WithMetaEPC(*prim, 4), 64)),
+            "prim(32;epc=4,bus_fifo_depth=64)");
+  // Booleans are bit-packed.
+  ASSERT_EQ(GenerateConfigString(*fletcher::WithMetaEPC(*field("f", arrow::boolean(), false), 64)), "prim(1;epc=64)");
+  ASSERT_EQ(GenerateConfigString(*fletcher::WithMetaArbiter(*prim, 8)),
+            "arb(prim(32);max_outstanding=8,method=ROUND-ROBIN)");
+
+  // The validity bitmap and offsets buffers get the same FIFO depth.
+  auto str = fletcher::WithMetaBusFifoDepth(*field("b", arrow::utf8(), true), 128);
+  ASSERT_EQ(GenerateConfigString(*str),
+            "null(listprim(8;bus_fifo_depth=128,idx_bus_fifo_depth=128);bus_fifo_depth=128)");
+
+  // Parameters of lists and structs follow their children, and arbiter parameters only apply to the top level.
+  auto child = fletcher::WithMetaArbiter(*field("item", arrow::uint8(), true), 4, fletcher::meta::FIXED);
+  auto list = fletcher::WithMetaConfig(*field("c", arrow::list(child), false), "len_out_slice=false");
+  ASSERT_EQ(GenerateConfigString(*fletcher::WithMetaArbiter(*list, 16, fletcher::meta::FIXED)),
+            "arb(list(null(prim(8));len_out_slice=false);max_outstanding=16,method=FIXED)");
+}
+
+TEST(Array, AutoEPC) {
+  using arrow::field;
+  // Primitives fill the bus with a power of two elements.
+  ASSERT_EQ(GetAutoEPC(*field("a", arrow::uint32(), false), 512, 1.0), 16);
+  ASSERT_EQ(GetAutoEPC(*field("b", arrow::float64(), true), 512, 0.5), 4);
+  ASSERT_EQ(GetAutoEPC(*field("c", arrow::int16(), false), 96, 1.0), 4);
+  ASSERT_EQ(GetAutoEPC(*field("d", arrow::uint64(), false), 32, 1.0), 1);
+  ASSERT_EQ(GetAutoEPC(*field("i", arrow::boolean(), false), 512, 1.0), 512);
+  // The EPC of strings and lists of primitives applies to their values.
+  ASSERT_EQ(GetAutoEPC(*field("e", arrow::utf8(), false), 512, 1.0), 64);
+  ASSERT_EQ(GetAutoEPC(*field("f", arrow::list(field("item", arrow::uint32(), false)), false), 256, 1.0), 8);
+  // Other fields do not support EPC > 1.
+  ASSERT_EQ(GetAutoEPC(*field("g", arrow::list(field("item", arrow::uint32(), true)), false), 512, 1.0), 1);
+  ASSERT_EQ(GetAutoEPC(*field("h", arrow::struct_({field("x", arrow::uint8(), false)}), false), 512, 1.0), 1);
+}
+
 }  // namespace fletchgen
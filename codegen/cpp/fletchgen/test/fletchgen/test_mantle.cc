@@ -42,7 +42,7 @@ static void TestReadMantle(const std::shared_ptr<arrow::Schema> &schema) {
   auto m = mmio({rbd}, regs);
   auto k = kernel("Test_Kernel", {r}, m);
   auto n = nucleus("Test_Nucleus", {r}, k, m);
-  auto man = mantle("Test_Mantle", {r}, n, BusDim());
+  auto man = mantle("Test_Mantle", {r}, n, {BusDim()});
   GenerateTestAll(man);
 }
 
@@ -58,4 +58,122 @@ TEST(Mantle, NullablePrim) {
   TestReadMantle(fletcher::GetNullablePrimReadSchema());
 }
 
+TEST(Mantle, MultiChannel) {
+  cerata::default_component_pool()->Clear();
+  auto schema_set = SchemaSet::Make("MultiChannel");
+  schema_set->AppendSchema(fletcher::GetTwoPrimReadSchema());
+  schema_set->AppendSchema(fletcher::GetTwoPrimWriteChannelSchema());
+  schema_set->Sort();
+
+  // Channel 0 takes the default dimensions, channel 1 those of the schema metadata.
+  auto bus_dims = Design::GetBusDims(*schema_set, {"64,512,8,1,16"});
+  ASSERT_EQ(bus_dims.size(), 2);
+  ASSERT_EQ(bus_dims[0].dw, 512);
+  ASSERT_EQ(bus_dims[1].dw, 256);
+
+  std::vector<fletcher::RecordBatchDescription> rbds;
+  std::vector<std::shared_ptr<RecordBatch>> rbs;
+  for (const auto &fs : schema_set->schemas()) {
+    fletcher::RecordBatchDescription rbd;
+    fletcher::SchemaAnalyzer sa(&rbd);
+    sa.Analyze(*fs->arrow_schema());
+    rbds.push_back(rbd);
+    rbs.push_back(record_batch("Test_" + rbd.name, fs, rbd, bus_dims[fs->bus_channel()]));
+  }
+  auto m = mmio(rbds, Design::GetRecordBatchRegs(rbds));
+  auto k = kernel("Test_Kernel", rbs, m);
+  auto n = nucleus("Test_Nucleus", rbs, k, m);
+  auto man = mantle("Test_Mantle", rbs, n, bus_dims);
+
+  // Every channel must have its own master port and bus parameters.
+  ASSERT_TRUE(man->Has("rd_mst"));
+  ASSERT_FALSE(man->Has("wr_mst"));
+  ASSERT_TRUE(man->Has("ch1_wr_mst"));
+  ASSERT_FALSE(man->Has("ch1_rd_mst"));
+  ASSERT_TRUE(man->Has("BUS_DATA_WIDTH"));
+  ASSERT_TRUE(man->Has("CH1_BUS_DATA_WIDTH"));
+  GenerateTestAll(man);
+}
+
+TEST(Mantle, BusArbiter) {
+  cerata::default_component_pool()->Clear();
+  // The StringRead RecordBatch takes the default weight and buffer depth, TwoPrimRead those of its metadata.
+  auto weighted = fletcher::WithMetaBusWeight(*fletcher::GetTwoPrimReadSchema(), 4);
+  weighted = fletcher::WithMetaBusBufferDepth(*weighted, 64);
+  std::vector<std::shared_ptr<arrow::Schema>> schemas = {fletcher::GetStringReadSchema(), weighted};
+
+  std::vector<fletcher::RecordBatchDescription> rbds;
+  std::vector<std::shared_ptr<RecordBatch>> rbs;
+  for (const auto &schema : schemas) {
+    auto fs = FletcherSchema::Make(schema);
+    ASSERT_EQ(fs->bus_weight(), schema == weighted ? 4u : 1u);
+    fletcher::RecordBatchDescription rbd;
+    fletcher::SchemaAnalyzer sa(&rbd);
+    sa.Analyze(*schema);
+    rbds.push_back(rbd);
+    rbs.push_back(record_batch("Test_" + rbd.name, fs, rbd));
+  }
+  auto m = mmio(rbds, Design::GetRecordBatchRegs(rbds));
+  auto k = kernel("Test_Kernel", rbs, m);
+  auto n = nucleus("Test_Nucleus", rbs, k, m);
+
+  BusArbiterSpec arb_spec;
+  arb_spec.method = "FIXED";
+  arb_spec.max_outstanding = 8;
+  arb_spec.buffer_depth = 32;
+  auto man = mantle("Test_Mantle", rbs, n, {BusDim()}, arb_spec);
+  auto src = GenerateTestAll(man);
+
+  // With fixed-priority arbitration, the bus ports of the RecordBatch with the highest weight come first.
+  ASSERT_NE(src.find("\"FIXED\""), std::string::npos);
+  ASSERT_NE(src.find("\"4,4,1\""), std::string::npos);
+  ASSERT_NE(src.find("\"64,64,32\""), std::string::npos);
+}
+
+TEST(Mantle, BusProfile) {
+  cerata::default_component_pool()->Clear();
+  auto schema_set = SchemaSet::Make("BusProfile");
+  schema_set->AppendSchema(fletcher::GetTwoPrimReadSchema());
+  schema_set->AppendSchema(fletcher::GetTwoPrimWriteChannelSchema());
+  schema_set->Sort();
+  auto bus_dims = Design::GetBusDims(*schema_set, {"64,512,8,1,16"});
+
+  std::vector<fletcher::RecordBatchDescription> rbds;
+  std::vector<std::shared_ptr<RecordBatch>> rbs;
+  for (const auto &fs : schema_set->schemas()) {
+    fletcher::RecordBatchDescription rbd;
+    fletcher::SchemaAnalyzer sa(&rbd);
+    sa.Analyze(*fs->arrow_schema());
+    rbds.push_back(rbd);
+    rbs.push_back(record_batch("Test_" + rbd.name, fs, rbd, bus_dims[fs->bus_channel()]));
+  }
+  auto regs = Design::GetRecordBatchRegs(rbds);
+  auto bus_regs = GetBusProfilingRegs(rbs);
+  regs.insert(regs.end(), bus_regs.begin(), bus_regs.end());
+  auto m = mmio(rbds, regs);
+  auto k = kernel("Test_Kernel", rbs, m);
+  auto n = nucleus("Test_Nucleus", rbs, k, m);
+  auto man = mantle("Test_Mantle", rbs, n, bus_dims);
+
+  // Every master port and every RecordBatch bus port must have its counters and busy register connected.
+  std::vector<std::string> buses = {"rd_mst", "ch1_wr_mst"};
+  for (const auto &rbi : man->recordbatch_instances()) {
+    for (const auto &bp : rbi->GetAll<BusPort>()) {
+      buses.push_back(bp->name());
+    }
+  }
+  ASSERT_EQ(bus_regs.size(), 3 + 6 * buses.size());
+  for (const auto &bus : buses) {
+    auto names = BusProfileRegNames(bus);
+    names.push_back(BusProfileBusyRegName(bus));
+    for (const auto &reg : names) {
+      ASSERT_TRUE(n->Has(reg)) << reg;
+      // The bus profilers synchronize their registers with the kernel clock domain.
+      ASSERT_EQ(n->prt(reg)->domain(), kernel_cd()) << reg;
+      ASSERT_EQ(man->nucleus_inst()->prt(reg)->edges().size(), 1) << reg;
+    }
+  }
+  GenerateTestAll(man);
+}
+
 }  // namespace fletchgen
@@ -17,8 +17,18 @@
 #include <gtest/gtest.h>
 #include <vector>
 #include <memory>
+#include <string>
+#include <cstdio>
+#include <fstream>
 
 #include "fletchgen/design.h"
+#include "fletchgen/host/header.h"
+#include "fletchgen/top/axi.h"
+#include "fletchgen/top/cosim.h"
+#include "fletchgen/top/sim.h"
+#include "fletchgen/manifest.h"
+#include "fletchgen/utils.h"
+#include "fletcher/test_schemas.h"
 
 namespace fletchgen {
 
@@ -27,4 +37,246 @@ TEST(Misc, ParseCustomRegs) {
                                          "s:32:my_kernel_to_host_signaling_reg"});
 }
 
+TEST(Misc, MmioVhdl) {
+  std::vector<MmioReg> regs;
+  regs.emplace_back(MmioFunction::DEFAULT, MmioBehavior::STROBE, "start", "Start the kernel.", 1, 0, 0);
+  regs.emplace_back(MmioFunction::DEFAULT, MmioBehavior::STATUS, "result", "Result.", 64, 0, 8);
+  regs.emplace_back(MmioFunction::DEFAULT, MmioBehavior::CONSTANT, "fingerprint", "Fingerprint.", 64, 0, 16, 0x2A);
+  regs.emplace_back(MmioFunction::KERNEL, MmioBehavior::CONTROL, "arg", "Argument.", 48);
+  auto pkg = GenerateMmioPackage({&regs});
+  auto impl = GenerateMmioVhdl({&regs});
+  ASSERT_EQ(pkg.find("${"), std::string::npos);
+  ASSERT_EQ(impl.find("${"), std::string::npos);
+  // Ports must follow the vhdmmio naming convention, and constants must not have a port.
+  ASSERT_NE(pkg.find("f_start_data                : out std_logic;"), std::string::npos);
+  ASSERT_NE(pkg.find("f_result_write_data         : in  std_logic_vector(63 downto 0);"), std::string::npos);
+  ASSERT_NE(pkg.find("f_arg_data                  : out std_logic_vector(47 downto 0);"), std::string::npos);
+  ASSERT_EQ(pkg.find("f_fingerprint"), std::string::npos);
+  // The control register follows the fixed registers, and spans two words.
+  ASSERT_EQ(*regs[3].addr, 24);
+  ASSERT_NE(impl.find("reg_arg(47 downto 32) <="), std::string::npos);
+  // Constants are read as literals.
+  ASSERT_NE(impl.find("r_data(31 downto 0) <= \"00000000000000000000000000101010\";"), std::string::npos);
+  // Strobes are cleared every cycle, and status registers are not writable.
+  ASSERT_NE(impl.find("f_start_data <= reg_start;"), std::string::npos);
+  ASSERT_NE(impl.find("      reg_start <= '0';"), std::string::npos);
+  ASSERT_EQ(impl.find("reg_result("), std::string::npos);
+}
+
+TEST(Misc, HostHeader) {
+  cerata::default_component_pool()->Clear();
+  auto options = std::make_shared<Options>();
+  options->kernel_name = "Test";
+  options->schemas = {fletcher::GetStringReadSchema()};
+  options->regs = {"c:64:seed", "s:32:count"};
+  Design design(options);
+  auto header = host::GenerateHostHeader(design, {});
+  ASSERT_NE(header.find("namespace Test {"), std::string::npos);
+  // Default registers must be at the offsets the run-time assumes.
+  ASSERT_NE(header.find("constexpr Register start = {0, 0, 1};"), std::string::npos);
+  ASSERT_NE(header.find("constexpr Register fingerprint = {4, 0, 64};"), std::string::npos);
+  ASSERT_NE(header.find("constexpr Register StringRead_firstidx = {6, 0, 32};"), std::string::npos);
+  // One RecordBatch with an offsets and a values buffer.
+  ASSERT_NE(header.find("constexpr size_t kNumRecordBatches = 1;"), std::string::npos);
+  ASSERT_NE(header.find("constexpr size_t kNumBuffers = 2;"), std::string::npos);
+  ASSERT_NE(header.find("constexpr size_t kNumDictionaries = 0;"), std::string::npos);
+  // The custom registers follow the buffer addresses, which the header checks at compile time.
+  ASSERT_NE(header.find("constexpr Register seed = {12, 0, 64};"), std::string::npos);
+  ASSERT_NE(header.find("static_assert(FLETCHER_REG_SCHEMA + 2 * kNumRecordBatches + 2 * kNumBuffers + kNumDictionaries"
+                        " == regs::seed.offset,"), std::string::npos);
+  ASSERT_NE(header.find("  uint64_t seed;"), std::string::npos);
+  ASSERT_NE(header.find("  uint32_t count;"), std::string::npos);
+  // 64-bit arguments are written least significant word first.
+  ASSERT_NE(header.find("{regs::seed.offset + 0, static_cast<uint32_t>(args.seed)},"), std::string::npos);
+  ASSERT_NE(header.find("{regs::seed.offset + 1, static_cast<uint32_t>(args.seed >> 32u)},"), std::string::npos);
+  ASSERT_NE(header.find("constexpr size_t kNumReplicas = 1;"), std::string::npos);
+}
+
+TEST(Misc, HostHeaderReplicas) {
+  cerata::default_component_pool()->Clear();
+  auto options = std::make_shared<Options>();
+  options->kernel_name = "Test";
+  options->schemas = {fletcher::GetStringReadSchema()};
+  options->regs = {"c:64:seed", "s:32:count"};
+  options->replicas = 3;
+  Design design(options);
+  auto header = host::GenerateHostHeader(design, {});
+  ASSERT_NE(header.find("constexpr size_t kNumReplicas = 3;"), std::string::npos);
+  ASSERT_NE(header.find("constexpr uint64_t kReplicaWindowWords = "), std::string::npos);
+  ASSERT_EQ(header.find("constexpr uint64_t kReplicaWindowWords = 0;"), std::string::npos);
+  // The arguments are written to every replica, and the results are read from a single one.
+  ASSERT_NE(header.find("  for (size_t r = 0; r < kNumReplicas; r++) {\n"
+                        "    for (const auto &w : writes) {\n"
+                        "      auto status = platform->WriteMMIO(w.first + r * kReplicaWindowWords, w.second);"),
+            std::string::npos);
+  ASSERT_NE(header.find("ReadResults(fletcher::Platform *platform, Results *results, size_t replica = 0)"),
+            std::string::npos);
+  ASSERT_NE(header.find("  uint64_t base = replica * kReplicaWindowWords;"), std::string::npos);
+  ASSERT_NE(header.find("platform->ReadMMIO(base + regs::count.offset, &results->count);"), std::string::npos);
+}
+
+TEST(Misc, HostHeaderDictionary) {
+  cerata::default_component_pool()->Clear();
+  auto options = std::make_shared<Options>();
+  options->kernel_name = "Test";
+  options->schemas = {fletcher::GetDictionaryReadSchema()};
+  options->regs = {"c:32:arg"};
+  Design design(options);
+  auto header = host::GenerateHostHeader(design, {});
+  // The indices and the dictionary have their own buffers.
+  ASSERT_NE(header.find("constexpr size_t kNumBuffers = 3;"), std::string::npos);
+  ASSERT_NE(header.find("constexpr size_t kNumDictionaries = 1;"), std::string::npos);
+  // The dictionary length follows the buffer addresses, and precedes the custom registers.
+  ASSERT_NE(header.find("constexpr Register DictionaryRead_Name_dict_length = {14, 0, 32};"), std::string::npos);
+  ASSERT_NE(header.find("constexpr Register arg = {15, 0, 32};"), std::string::npos);
+}
+
+TEST(Misc, TopLevelBusDims) {
+  cerata::default_component_pool()->Clear();
+  auto options = std::make_shared<Options>();
+  options->kernel_name = "Test";
+  options->schemas = {fletcher::GetPrimReadSchema()};
+  options->bus_dims = {"32,128,8,1,32"};
+  options->sim_mem_latency = 10;
+  Design design(options);
+  auto axi = top::GenerateAXITop(*design.top(), *design.schema_set, {}, design.bus_dims.front());
+  auto sim = top::GenerateSimTop(design, {}, "", "", {});
+  // Both top-levels must use the bus dimensions of the design.
+  for (const auto &vhdl : {axi, sim}) {
+    ASSERT_NE(vhdl.find("BUS_ADDR_WIDTH              : natural := 32;"), std::string::npos);
+    ASSERT_NE(vhdl.find("BUS_DATA_WIDTH              : natural := 128;"), std::string::npos);
+    ASSERT_NE(vhdl.find("BUS_BURST_MAX_LEN           : natural := 32;"), std::string::npos);
+    ASSERT_NE(vhdl.find("BUS_BURST_MAX_LEN         => BUS_BURST_MAX_LEN,"), std::string::npos);
+  }
+  ASSERT_NE(sim.find("LATENCY                     => 10,"), std::string::npos);
+}
+
+TEST(Misc, CosimTop) {
+  cerata::default_component_pool()->Clear();
+  auto options = std::make_shared<Options>();
+  options->kernel_name = "Test";
+  options->schemas = {fletcher::GetPrimReadSchema()};
+  Design design(options);
+  auto cosim = top::GenerateCosimTop(design, {});
+  // The design must be driven by the host model, which serves its read requests.
+  ASSERT_NE(cosim.find("host_inst: entity work.SimHost"), std::string::npos);
+  ASSERT_NE(cosim.find("rreq_valid                => bus_rreq_valid,"), std::string::npos);
+  ASSERT_NE(cosim.find("rd_mst_rreq_valid         => bus_rreq_valid,"), std::string::npos);
+  ASSERT_EQ(cosim.find("wreq_valid"), std::string::npos);
+  ASSERT_EQ(cosim.find("${"), std::string::npos);
+}
+
+TEST(Misc, ProfileMap) {
+  cerata::default_component_pool()->Clear();
+  auto name = fletcher::WithMetaProfile(*arrow::field("Name", arrow::utf8(), false));
+  auto schema = fletcher::WithMetaRequired(*arrow::schema({name}), "Profiled", fletcher::Mode::READ);
+  auto options = std::make_shared<Options>();
+  options->kernel_name = "Test";
+  options->schemas = {schema};
+  Design design(options);
+  auto header = host::GenerateHostHeader(design, {});
+  auto json = host::GenerateProfileMap(design, {});
+  // A string field has a length stream of offsets and a stream of characters, each with six counters.
+  ASSERT_NE(header.find("inline fletcher::ProfileMap GetProfileMap()"), std::string::npos);
+  ASSERT_EQ(json.find("\"element_width\": 32"), json.rfind("\"element_width\": 32"));
+  ASSERT_NE(json.find("\"element_width\": 32"), std::string::npos);
+  ASSERT_NE(json.find("\"element_width\": 8"), std::string::npos);
+  ASSERT_NE(json.find("\"counter_width\": 64"), std::string::npos);
+  ASSERT_NE(header.find("map.has_snapshot = true;"), std::string::npos);
+  ASSERT_EQ(json.find("\"snapshot\": null"), std::string::npos);
+  for (const auto &reg : design.profiling_regs) {
+    if (reg.meta.count(MMIO_PROFILE_STREAM) > 0) {
+      ASSERT_NE(json.find(std::to_string(*reg.addr / 4)), std::string::npos) << reg.name;
+      ASSERT_NE(header.find("regs::" + reg.name + ".offset"), std::string::npos) << reg.name;
+    }
+  }
+}
+
+TEST(Misc, BusProfileMap) {
+  cerata::default_component_pool()->Clear();
+  auto number = arrow::field("Number", arrow::int64(), false);
+  auto schema = fletcher::WithMetaRequired(*arrow::schema({number}), "Profiled", fletcher::Mode::READ);
+  auto options = std::make_shared<Options>();
+  options->kernel_name = "Test";
+  options->schemas = {schema};
+  options->bus_profile = true;
+  Design design(options);
+  auto header = host::GenerateHostHeader(design, {});
+  auto json = host::GenerateProfileMap(design, {});
+  // Without profiled fields, only the bus arbiter master and the RecordBatch bus port are profiled.
+  ASSERT_NE(header.find("map.bus_snapshot = regs::Profile_bus_snapshot.offset;"), std::string::npos);
+  ASSERT_NE(header.find("b.name = \"rd_mst\";"), std::string::npos);
+  ASSERT_NE(json.find("\"buses\": ["), std::string::npos);
+  ASSERT_NE(json.find("\"data_width\": 512"), std::string::npos);
+  ASSERT_NE(json.find("\"counter_width\": 64"), std::string::npos);
+  ASSERT_NE(json.find("\"streams\": []"), std::string::npos);
+  size_t num_regs = 0;
+  for (const auto &reg : design.profiling_regs) {
+    if (reg.meta.count(MMIO_PROFILE_BUS) > 0) {
+      ASSERT_NE(json.find(std::to_string(*reg.addr / 4)), std::string::npos) << reg.name;
+      ASSERT_NE(header.find("regs::" + reg.name + ".offset"), std::string::npos) << reg.name;
+      num_regs++;
+    }
+  }
+  ASSERT_EQ(num_regs, 2 * 6);
+  ASSERT_NE(header.find("b.busy = regs::Profile_rd_mst_busy.offset;"), std::string::npos);
+}
+
+TEST(Misc, JsonString) {
+  ASSERT_EQ(JsonString("Name"), "\"Name\"");
+  ASSERT_EQ(JsonString(std::string("a\"b\\c\nd\x01", 8)), "\"a\\\"b\\\\c\\nd\\u0001\"");
+}
+
+TEST(Misc, OutputManifest) {
+  std::string path = "manifest_test.gen.vhd";
+  std::remove(path.c_str());
+
+  OutputManifest first(".");
+  ASSERT_TRUE(first.Write(path, "entity a is end;\n"));
+  ASSERT_EQ(first.num_dirty(), 1);
+
+  // Same contents must not be rewritten, changed contents must be.
+  OutputManifest second(".");
+  ASSERT_FALSE(second.Write(path, "entity a is end;\n"));
+  ASSERT_TRUE(second.Write(path, "entity b is end;\n"));
+  ASSERT_EQ(second.entries().size(), 2);
+  ASSERT_EQ(second.num_dirty(), 1);
+  ASSERT_NE(second.ToString().find("clean "), std::string::npos);
+  ASSERT_NE(second.ToString().find("dirty "), std::string::npos);
+  ASSERT_NE(OutputManifest::Hash("entity a is end;\n"), OutputManifest::Hash("entity b is end;\n"));
+
+  // Files written elsewhere are committed by comparing them with the existing file.
+  auto commit = [&](OutputManifest *manifest, const std::string &contents) {
+    auto tmp = OutputManifest::TempPath(path);
+    std::ofstream(tmp, std::ios::binary) << contents;
+    auto written = manifest->CommitFile(tmp, path);
+    EXPECT_FALSE(cerata::FileExists(tmp));
+    return written;
+  };
+  OutputManifest third(".");
+  ASSERT_FALSE(commit(&third, "entity b is end;\n"));
+  ASSERT_TRUE(commit(&third, "entity b is end;\n--"));
+  ASSERT_TRUE(commit(&third, "entity b is end;\n"));
+  ASSERT_TRUE(commit(&third, ""));
+  ASSERT_EQ(third.num_dirty(), 3);
+  ASSERT_EQ(third.entries()[0].hash, OutputManifest::Hash("entity b is end;\n"));
+  ASSERT_EQ(third.entries()[3].hash, OutputManifest::Hash(""));
+  std::ifstream result(path, std::ios::binary);
+  ASSERT_EQ(result.peek(), std::ifstream::traits_type::eof());
+
+  std::remove(path.c_str());
+}
+
+TEST(Misc, ParallelFor) {
+  for (size_t jobs : {0, 1, 4, 64}) {
+    std::vector<size_t> result(100, 0);
+    ParallelFor(result.size(), jobs, [&](size_t i) { result[i] = i * i; });
+    for (size_t i = 0; i < result.size(); i++) {
+      ASSERT_EQ(result[i], i * i);
+    }
+  }
+  // No tasks must not spawn or run anything.
+  ParallelFor(0, 4, [](size_t) { FAIL(); });
+}
+
 }  // namespace fletchgen
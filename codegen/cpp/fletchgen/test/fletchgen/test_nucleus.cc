@@ -55,4 +55,10 @@ TEST(Nucleus, TwoPrimRead) {
   TestNucleus("TestNucleus", fletcher::GetTwoPrimReadSchema());
 }
 
+TEST(Nucleus, ProfileHistogram) {
+  auto number = fletcher::WithMetaProfile(*arrow::field("number", arrow::int64(), false), true);
+  auto schema = fletcher::WithMetaRequired(*arrow::schema({number}), "Histogram", fletcher::Mode::READ);
+  TestNucleus("TestNucleus", schema);
+}
+
 }  // namespace fletchgen
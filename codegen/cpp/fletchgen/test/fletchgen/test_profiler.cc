@@ -40,4 +40,26 @@ TEST(Profiler, Connect) {
   GenerateTestAll(top);
 }
 
+TEST(Profiler, Histogram) {
+  cerata::logger().enable(fletchgen::LogCerata);
+  cerata::default_component_pool()->Clear();
+
+  auto stream_type = cerata::stream("test_stream", "data", cerata::vector(8));
+  auto stream_port_in = port("input", stream_type, Port::IN);
+  auto stream_port_out = port("output", stream_type, Port::OUT);
+  auto crp = port("bcd", cr(), Port::IN);
+  auto top = cerata::component("top", {crp, stream_port_in, stream_port_out});
+  auto stream_sig =
+      cerata::AttachSignalToNode(top.get(), stream_port_out.get(), top->inst_to_comp_map(), "Pr_" + stream_port_out->name());
+
+  auto result = EnableStreamProfiling(top.get(), {stream_sig}, 32, {stream_sig});
+
+  // A profiler and a stall histogram, with the histogram buckets following the profiler counters.
+  ASSERT_EQ(result.at(stream_sig).first.size(), 2);
+  ASSERT_EQ(result.at(stream_sig).second.size(), 6 + 2 * PROFILE_HISTOGRAM_BUCKETS);
+  ASSERT_EQ(result.at(stream_sig).second.back()->name(), "count_starve_7");
+
+  GenerateTestAll(top);
+}
+
 }  // namespace fletchgen
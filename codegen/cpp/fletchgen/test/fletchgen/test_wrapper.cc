@@ -0,0 +1,72 @@
+// Copyright 2018-2019 Delft University of Technology
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <arrow/api.h>
+#include <cerata/api.h>
+#include <gtest/gtest.h>
+#include <vector>
+#include <memory>
+
+#include "fletchgen/design.h"
+#include "fletchgen/mantle.h"
+#include "fletchgen/wrapper.h"
+#include "fletchgen/test_utils.h"
+#include "fletcher/test_schemas.h"
+
+namespace fletchgen {
+
+TEST(Wrapper, Replicas) {
+  cerata::default_component_pool()->Clear();
+  auto schema_set = SchemaSet::Make("Replicas");
+  schema_set->AppendSchema(fletcher::GetTwoPrimReadSchema());
+  schema_set->AppendSchema(fletcher::GetTwoPrimWriteChannelSchema());
+  schema_set->Sort();
+  auto bus_dims = Design::GetBusDims(*schema_set, {"64,512,8,1,16"});
+
+  std::vector<fletcher::RecordBatchDescription> rbds;
+  std::vector<std::shared_ptr<RecordBatch>> rbs;
+  for (const auto &fs : schema_set->schemas()) {
+    fletcher::RecordBatchDescription rbd;
+    fletcher::SchemaAnalyzer sa(&rbd);
+    sa.Analyze(*fs->arrow_schema());
+    rbds.push_back(rbd);
+    rbs.push_back(record_batch("Test_" + rbd.name, fs, rbd, bus_dims[fs->bus_channel()]));
+  }
+  auto m = mmio(rbds, Design::GetRecordBatchRegs(rbds));
+  auto k = kernel("Test_Kernel", rbs, m);
+  auto n = nucleus("Test_Nucleus", rbs, k, m);
+  auto man = mantle("Test_Mantle", rbs, n, bus_dims);
+  auto wrp = wrapper("Test_Wrapper", man, 3, 7);
+
+  ASSERT_EQ(wrp->num_replicas(), 3);
+  ASSERT_EQ(wrp->window_width(), 7);
+
+  // The wrapper must have the same interface as the mantle.
+  for (const auto &name : {"bcd", "kcd", "mmio", "rd_mst", "ch1_wr_mst", "BUS_DATA_WIDTH", "CH1_BUS_DATA_WIDTH"}) {
+    ASSERT_TRUE(wrp->Has(name)) << name;
+  }
+  ASSERT_FALSE(wrp->Has("wr_mst"));
+  ASSERT_FALSE(wrp->Has("ch1_rd_mst"));
+
+  // Every replica must be connected to the MMIO demultiplexer and the arbiters.
+  ASSERT_EQ(wrp->mantle_instances().size(), 3);
+  for (const auto &inst : wrp->mantle_instances()) {
+    for (const auto &name : {"mmio", "rd_mst", "ch1_wr_mst"}) {
+      ASSERT_EQ(inst->prt(name)->edges().size(), 1) << inst->name() << " " << name;
+    }
+  }
+  GenerateTestAll(wrp);
+}
+
+}  // namespace fletchgen
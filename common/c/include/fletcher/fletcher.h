@@ -58,9 +58,11 @@ typedef union {
 #define FLETCHER_REG_STATUS         1
 #define FLETCHER_REG_RETURN0        2
 #define FLETCHER_REG_RETURN1        3
+/// Read-only 64-bit fingerprint of the schema set the kernel was generated for (low and high word)
+#define FLETCHER_REG_FINGERPRINT    4
 
 /// Offset for schema derived registers
-#define FLETCHER_REG_SCHEMA         4
+#define FLETCHER_REG_SCHEMA         6
 
 #define FLETCHER_REG_CONTROL_START  0x0u
 #define FLETCHER_REG_CONTROL_STOP   0x1u
@@ -69,3 +71,7 @@ typedef union {
 #define FLETCHER_REG_STATUS_IDLE    0x0u
 #define FLETCHER_REG_STATUS_BUSY    0x1u
 #define FLETCHER_REG_STATUS_DONE    0x2u
+/// Status register field (bits 23..16) holding the number of kernel replicas. Zero if the kernel is not replicated.
+#define FLETCHER_REG_STATUS_REPLICAS  16u
+/// Status register field (bits 31..24) holding log2 of the register window size of every replica, in bytes.
+#define FLETCHER_REG_STATUS_WINDOW    24u
@@ -0,0 +1,122 @@
+// Copyright 2018 Delft University of Technology
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks for the Arrow analyzers and metadata helpers in fletcher::common.
+//
+// Every benchmark reports the time and number of heap allocations per (possibly nested) Arrow field.
+
+#include <arrow/api.h>
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <string>
+
+#include "fletcher/common.h"
+#include "fletcher/bench_schemas.h"
+#include "fletcher/bench_allocs.h"
+
+FLETCHER_BENCH_COUNT_ALLOCATIONS()
+
+namespace fletcher {
+
+/// Number of rows in the RecordBatches that are analyzed.
+constexpr int64_t kNumRows = 1024;
+
+/// Length of the field names in the long name benchmarks.
+constexpr int64_t kLongNameLength = 256;
+
+/// @brief Return the schema for a benchmark, based on its kind and size argument.
+static std::shared_ptr<arrow::Schema> GetBenchSchema(const std::string &kind, int64_t size) {
+  if (kind == "deep") {
+    return GetDeepSchema(static_cast<size_t>(size));
+  } else if (kind == "long_names") {
+    return GetWideSchema(static_cast<size_t>(size), kLongNameLength);
+  } else {
+    return GetWideSchema(static_cast<size_t>(size));
+  }
+}
+
+static void BM_RecordBatchAnalyzer(benchmark::State &state, const std::string &kind) {
+  auto schema = GetBenchSchema(kind, state.range(0));
+  auto batch = GetNullRecordBatch(schema, kNumRows);
+  auto num_fields = CountFields(*schema);
+  AllocationScope allocs;
+  for (auto _ : state) {
+    RecordBatchDescription rbd;
+    RecordBatchAnalyzer rba(&rbd);
+    benchmark::DoNotOptimize(rba.Analyze(*batch));
+  }
+  allocs.Report(&state, num_fields);
+  ReportPerItem(&state, num_fields);
+}
+
+static void BM_SchemaAnalyzer(benchmark::State &state, const std::string &kind) {
+  auto schema = GetBenchSchema(kind, state.range(0));
+  auto num_fields = CountFields(*schema);
+  AllocationScope allocs;
+  for (auto _ : state) {
+    RecordBatchDescription rbd;
+    SchemaAnalyzer sa(&rbd);
+    benchmark::DoNotOptimize(sa.Analyze(*schema));
+  }
+  allocs.Report(&state, num_fields);
+  ReportPerItem(&state, num_fields);
+}
+
+static void BM_FieldAnalyzer(benchmark::State &state, const std::string &kind) {
+  auto schema = GetBenchSchema(kind, state.range(0));
+  auto num_fields = CountFields(*schema);
+  AllocationScope allocs;
+  for (auto _ : state) {
+    for (const auto &field : schema->fields()) {
+      FieldMetadata fm;
+      FieldAnalyzer fa(&fm);
+      benchmark::DoNotOptimize(fa.Analyze(*field));
+    }
+  }
+  allocs.Report(&state, num_fields);
+  ReportPerItem(&state, num_fields);
+}
+
+static void BM_GetMeta(benchmark::State &state, const std::string &kind) {
+  auto schema = GetBenchSchema(kind, state.range(0));
+  auto num_fields = schema->num_fields();
+  AllocationScope allocs;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(GetMode(*schema));
+    for (const auto &field : schema->fields()) {
+      benchmark::DoNotOptimize(GetUIntMeta(*field, meta::VALUE_EPC, 1));
+      benchmark::DoNotOptimize(GetUIntMeta(*field, meta::LIST_EPC, 1));
+      benchmark::DoNotOptimize(GetBoolMeta(*field, meta::PROFILE, false));
+    }
+  }
+  allocs.Report(&state, num_fields);
+  ReportPerItem(&state, num_fields);
+}
+
+#define FLETCHER_COMMON_BENCH(NAME)                                                         \
+  BENCHMARK_CAPTURE(NAME, wide, std::string("wide"))->RangeMultiplier(10)->Range(1, 10000); \
+  BENCHMARK_CAPTURE(NAME, deep, std::string("deep"))->RangeMultiplier(4)->Range(1, 256);    \
+  BENCHMARK_CAPTURE(NAME, long_names, std::string("long_names"))->RangeMultiplier(10)->Range(1, 10000)
+
+FLETCHER_COMMON_BENCH(BM_RecordBatchAnalyzer);
+FLETCHER_COMMON_BENCH(BM_SchemaAnalyzer);
+FLETCHER_COMMON_BENCH(BM_FieldAnalyzer);
+FLETCHER_COMMON_BENCH(BM_GetMeta);
+
+#undef FLETCHER_COMMON_BENCH
+
+}  // namespace fletcher
+
+BENCHMARK_MAIN();
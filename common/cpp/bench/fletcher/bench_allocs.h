@@ -0,0 +1,75 @@
+// Copyright 2018 Delft University of Technology
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+namespace fletcher {
+
+/// @brief Return the global counter of heap allocations made through operator new.
+inline std::atomic<uint64_t> &AllocationCounter() {
+  static std::atomic<uint64_t> counter{0};
+  return counter;
+}
+
+/**
+ * @brief Measure the number of heap allocations between construction and Report().
+ *
+ * Requires FLETCHER_BENCH_COUNT_ALLOCATIONS() to be placed in exactly one translation unit of the benchmark executable.
+ */
+class AllocationScope {
+ public:
+  AllocationScope() : start_(AllocationCounter().load()) {}
+
+  /// @brief Report the number of allocations per item as a benchmark counter.
+  void Report(benchmark::State *state, size_t items_per_iteration, const std::string &name = "allocs_per_field") {
+    auto allocs = static_cast<double>(AllocationCounter().load() - start_);
+    auto items = static_cast<double>(state->iterations()) * static_cast<double>(items_per_iteration);
+    state->counters[name] = items > 0 ? allocs / items : 0.0;
+  }
+
+ private:
+  uint64_t start_;
+};
+
+/// @brief Report the time per item, and the number of items, as benchmark counters.
+inline void ReportPerItem(benchmark::State *state, size_t items_per_iteration, const std::string &name = "field") {
+  auto items = static_cast<double>(items_per_iteration);
+  state->counters[name + "s"] = items;
+  state->counters["time_per_" + name] =
+      benchmark::Counter(items, benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+}
+
+}  // namespace fletcher
+
+/// Replace the global allocation functions with ones that count the number of allocations.
+#define FLETCHER_BENCH_COUNT_ALLOCATIONS()                                                    \
+  void *operator new(std::size_t size) {                                                      \
+    fletcher::AllocationCounter().fetch_add(1, std::memory_order_relaxed);                    \
+    void *p = std::malloc(size == 0 ? 1 : size);                                              \
+    if (p == nullptr) throw std::bad_alloc();                                                 \
+    return p;                                                                                 \
+  }                                                                                           \
+  void *operator new[](std::size_t size) { return operator new(size); }                       \
+  void operator delete(void *p) noexcept { std::free(p); }                                    \
+  void operator delete[](void *p) noexcept { std::free(p); }                                  \
+  void operator delete(void *p, std::size_t) noexcept { std::free(p); }                       \
+  void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
@@ -0,0 +1,116 @@
+// Copyright 2018 Delft University of Technology
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <fletcher/common.h>
+
+#include <arrow/api.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <string>
+
+namespace fletcher {
+
+/// @brief Return field metadata that resembles what a typical Fletcher schema carries, with a few keys to look up.
+inline std::shared_ptr<arrow::KeyValueMetadata> GetBenchFieldMeta(size_t i) {
+  return std::make_shared<arrow::KeyValueMetadata>(
+      std::vector<std::string>({meta::VALUE_EPC, meta::LIST_EPC, meta::PROFILE}),
+      std::vector<std::string>({std::to_string(1 << (i % 4)), "1", (i % 2 == 0) ? "true" : "false"}));
+}
+
+/**
+ * @brief Return a wide schema with many columns of a mix of primitive, nullable and string types.
+ * @param num_fields  The number of top-level fields.
+ * @param name_length The minimum length of each field name.
+ * @return The schema.
+ */
+inline std::shared_ptr<arrow::Schema> GetWideSchema(size_t num_fields, size_t name_length = 0) {
+  std::vector<std::shared_ptr<arrow::Field>> fields;
+  for (size_t i = 0; i < num_fields; i++) {
+    auto name = "field_" + std::to_string(i);
+    if (name.length() < name_length) {
+      name.append(name_length - name.length(), 'x');
+    }
+    std::shared_ptr<arrow::DataType> type;
+    switch (i % 3) {
+      default:type = arrow::uint64();
+        break;
+      case 1:type = arrow::int32();
+        break;
+      case 2:type = arrow::utf8();
+        break;
+    }
+    fields.push_back(arrow::field(name, type, i % 3 == 1, GetBenchFieldMeta(i)));
+  }
+  auto schema = std::make_shared<arrow::Schema>(fields);
+  return WithMetaRequired(*schema, "Wide", Mode::READ);
+}
+
+/**
+ * @brief Return a schema with a single, deeply nested field of alternating struct and list types.
+ * @param depth The nesting depth.
+ * @return The schema.
+ */
+inline std::shared_ptr<arrow::Schema> GetDeepSchema(size_t depth) {
+  auto field = arrow::field("leaf", arrow::uint8(), true);
+  for (size_t d = 0; d < depth; d++) {
+    auto name = "level_" + std::to_string(depth - d - 1);
+    if (d % 2 == 0) {
+      // Give the struct a sibling primitive field, such that it has more than one child.
+      auto sibling = arrow::field(name + "_sibling", arrow::int64(), false);
+      field = arrow::field(name, arrow::struct_({field, sibling}), true, GetBenchFieldMeta(d));
+    } else {
+      field = arrow::field(name, arrow::list(field), false, GetBenchFieldMeta(d));
+    }
+  }
+  auto schema = std::make_shared<arrow::Schema>(std::vector<std::shared_ptr<arrow::Field>>({field}));
+  return WithMetaRequired(*schema, "Deep", Mode::READ);
+}
+
+/// @brief Return the total number of fields, including all nested fields, in a type.
+inline size_t CountFields(const arrow::DataType &type) {
+  size_t result = 0;
+  for (const auto &child : type.children()) {
+    result += 1 + CountFields(*child->type());
+  }
+  return result;
+}
+
+/// @brief Return the total number of fields, including all nested fields, in a schema.
+inline size_t CountFields(const arrow::Schema &schema) {
+  size_t result = 0;
+  for (const auto &field : schema.fields()) {
+    result += 1 + CountFields(*field->type());
+  }
+  return result;
+}
+
+/**
+ * @brief Return a RecordBatch with \p num_rows rows of which all values are null, according to some schema.
+ *
+ * Non-nullable fields still get a validity bitmap from Arrow, but as far as Fletcher is concerned the buffer layout is
+ * that of the schema, which is what matters for benchmarking the analyzers.
+ */
+inline std::shared_ptr<arrow::RecordBatch> GetNullRecordBatch(const std::shared_ptr<arrow::Schema> &schema,
+                                                              int64_t num_rows) {
+  std::vector<std::shared_ptr<arrow::Array>> columns;
+  for (const auto &field : schema->fields()) {
+    columns.push_back(arrow::MakeArrayOfNull(field->type(), num_rows).ValueOrDie());
+  }
+  return arrow::RecordBatch::Make(schema, num_rows, columns);
+}
+
+}  // namespace fletcher
@@ -0,0 +1,188 @@
+// Copyright 2018 Delft University of Technology
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <arrow/api.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <string>
+
+#include "fletcher/arrow-utils.h"
+
+namespace fletcher {
+
+/// @brief The function of a buffer within an Arrow array.
+enum class BufferRole : uint8_t {
+  VALIDITY,  ///< Validity bitmap
+  OFFSETS,   ///< Offsets buffer of lists and variable-length binary data
+  VALUES     ///< Values buffer
+};
+
+/// @brief Return the name of a buffer role, as it appears in buffer descriptions.
+std::string ToString(BufferRole role);
+
+/// @brief Location and size of a physical buffer of a RecordBatch.
+struct BufferRef {
+  /// Address of the buffer in host memory.
+  const uint8_t *raw_buffer_ = nullptr;
+  /// Size of the buffer in bytes.
+  int64_t size_ = 0;
+  /// Whether the buffer is not required logically, e.g. the validity bitmap of a nullable field without nulls.
+  bool implicit_ = false;
+};
+
+/**
+ * @brief A compact description of the buffers of a RecordBatch, derived from its schema only.
+ *
+ * Every (nested) field name is stored only once, and every buffer refers to the field it belongs to by index. The
+ * buffers are in the same order as those produced by the RecordBatchAnalyzer.
+ *
+ * A dictionary-encoded field is described by its indices, followed by a top-level field holding its dictionary, named
+ * after the field with DICTIONARY_SUFFIX appended.
+ *
+ * Because the layout does not depend on the contents of a RecordBatch, it can be shared by all RecordBatches with the
+ * same schema. For every such RecordBatch, only the buffer addresses and sizes have to be obtained through Refresh(),
+ * which does not allocate.
+ */
+struct RecordBatchLayout {
+  /// A (nested) field in the schema.
+  struct Field {
+    /// The name of the field as it appears in buffer descriptions. Empty for the child field of a list.
+    std::string name;
+    /// Index of the parent field, or -1 for top-level fields.
+    int32_t parent;
+    /// Nesting level.
+    int32_t level;
+  };
+
+  /// A buffer of some field.
+  struct Buffer {
+    /// Index of the field this buffer belongs to.
+    int32_t field;
+    /// The function of this buffer.
+    BufferRole role;
+  };
+
+  /// The name of the RecordBatch, taken from the schema metadata.
+  std::string name;
+  /// The access mode of the RecordBatch, taken from the schema metadata.
+  Mode mode = Mode::READ;
+  /// All (nested) fields, parents before children.
+  std::vector<Field> fields;
+  /// All buffers, in depth-first order.
+  std::vector<Buffer> buffers;
+  /// Column indices of the dictionary-encoded fields, in schema order.
+  std::vector<int32_t> dictionaries;
+
+  /**
+   * @brief Create the layout of RecordBatches with some schema.
+   * @param[in]  schema The schema.
+   * @param[out] out    The layout.
+   * @return True if successful, false if the schema contains unsupported types.
+   */
+  static bool Make(const arrow::Schema &schema, RecordBatchLayout *out);
+
+  /**
+   * @brief Obtain the address and size of every buffer of a RecordBatch, without allocating.
+   * @param[in]  batch  The RecordBatch, which must have the schema this layout was made from.
+   * @param[out] out    Pointer to an array of at least buffers.size() elements.
+   * @return True if successful, false if the RecordBatch does not match this layout.
+   */
+  bool Refresh(const arrow::RecordBatch &batch, BufferRef *out) const;
+
+  /**
+   * @brief Return the number of entries in the dictionary of the i-th dictionary-encoded field of a RecordBatch.
+   * @param[in] batch The RecordBatch, which must have been refreshed successfully with this layout.
+   * @param[in] i     The index of the dictionary-encoded field in dictionaries.
+   * @return The length of the dictionary.
+   */
+  int64_t DictionaryLength(const arrow::RecordBatch &batch, size_t i) const;
+
+  /// @brief Return the description of the i-th buffer, e.g. {"struct", "child", "values"}.
+  std::vector<std::string> BufferDesc(size_t i) const;
+
+  /// @brief Return the nesting level of the i-th buffer.
+  int BufferLevel(size_t i) const { return fields[buffers[i].field].level; }
+
+  /// @brief Return a human-readable representation of this layout.
+  std::string ToString() const;
+};
+
+/**
+ * @brief Return a fingerprint of everything in a schema that determines its RecordBatchLayout.
+ *
+ * This includes the types, nesting, nullability and names of all fields, and the Fletcher name and mode of the schema.
+ * It does not allocate.
+ */
+uint64_t GetLayoutFingerprint(const arrow::Schema &schema);
+
+/**
+ * @brief Return a fingerprint of everything in a set of schemas that determines the hardware generated for it.
+ *
+ * The schemas are ordered by Fletcher name and then by mode, like fletchgen orders them, after which their modes and the
+ * types, nesting and nullability of all fields are hashed, together with the field metadata that affects the hardware
+ * (elements per cycle, profiling and ignoring). Schema and field names are not taken into account, such that a kernel
+ * can be matched against schemas that only differ in naming. Dictionary-encoded fields are hashed as their indices and
+ * dictionary fields, see ExpandDictionaries().
+ *
+ * fletchgen places this fingerprint in a read-only MMIO register, such that the run-time can check whether a kernel
+ * implements some set of schemas.
+ */
+uint64_t GetSchemaSetFingerprint(const std::vector<std::shared_ptr<arrow::Schema>> &schema_set);
+
+/**
+ * @brief A thread-safe cache of RecordBatchLayouts, keyed by schema layout fingerprint.
+ *
+ * This allows the layout of a schema to be created only once, even when every RecordBatch of some stream has its own
+ * arrow::Schema object. Because fingerprints may collide, a cached layout is only returned for a schema that is
+ * structurally equal to the schema it was made for.
+ */
+class RecordBatchLayoutCache {
+ public:
+  /**
+   * @brief Return the layout for a schema, creating and caching it if the schema has not been seen before.
+   * @param schema  The schema.
+   * @return The layout, or nullptr if no layout can be made for the schema.
+   */
+  std::shared_ptr<const RecordBatchLayout> Get(const arrow::Schema &schema);
+
+  /// @brief Remove all layouts from the cache.
+  void Clear();
+
+  /// @brief Return the number of cached layouts.
+  size_t size() const;
+
+ private:
+  /// A cached layout and the schema it was made for.
+  struct Entry {
+    std::shared_ptr<arrow::Schema> schema;
+    std::shared_ptr<const RecordBatchLayout> layout;
+  };
+
+  /// @brief Return whether a cache entry was made for a schema with the same layout as \p schema.
+  static bool Matches(const Entry &entry, const arrow::Schema &schema);
+
+  mutable std::mutex mutex_;
+  std::unordered_multimap<uint64_t, Entry> layouts_;
+};
+
+/// @brief Return the process-wide RecordBatchLayoutCache.
+RecordBatchLayoutCache *DefaultLayoutCache();
+
+}  // namespace fletcher
@@ -53,9 +53,11 @@ class RecordBatchAnalyzer : public arrow::ArrayVisitor {
   arrow::Status Visit(const arrow::BinaryArray &array) override { return VisitBinary(array); }
   arrow::Status Visit(const arrow::ListArray &array) override;
   arrow::Status Visit(const arrow::StructArray &array) override;
+  arrow::Status Visit(const arrow::DictionaryArray &array) override;
 
 #define VISIT_FIXED_WIDTH(TYPE) \
   arrow::Status Visit(const TYPE& array) override { return VisitFixedWidth<TYPE>(array); }
+  VISIT_FIXED_WIDTH(arrow::BooleanArray)
   VISIT_FIXED_WIDTH(arrow::Int8Array)
   VISIT_FIXED_WIDTH(arrow::Int16Array)
   VISIT_FIXED_WIDTH(arrow::Int32Array)
@@ -77,10 +79,8 @@ class RecordBatchAnalyzer : public arrow::ArrayVisitor {
 #undef VISIT_FIXED_WIDTH
 
   // TODO(johanpel): Not implemented yet:
-  //arrow::Status Visit(const arrow::BooleanArray &array) override {}
   //arrow::Status Visit(const arrow::NullArray &array) override {}
   //arrow::Status Visit(const UnionArray& array) override {}
-  //arrow::Status Visit(const DictionaryArray& array) override {}
   //arrow::Status Visit(const ExtensionArray& array) override {}
 
   std::vector<std::string> buf_name;
@@ -50,9 +50,11 @@ class FieldAnalyzer : public arrow::TypeVisitor {
   arrow::Status Visit(const arrow::BinaryType &type) override { return VisitBinary(type); }
   arrow::Status Visit(const arrow::ListType &type) override;
   arrow::Status Visit(const arrow::StructType &type) override;
+  arrow::Status Visit(const arrow::DictionaryType &type) override;
 
 #define VISIT_FIXED_WIDTH(TYPE) \
   arrow::Status Visit(const TYPE& type) override { return VisitFixedWidth<TYPE>(type); }
+  VISIT_FIXED_WIDTH(arrow::BooleanType)
   VISIT_FIXED_WIDTH(arrow::Int8Type)
   VISIT_FIXED_WIDTH(arrow::Int16Type)
   VISIT_FIXED_WIDTH(arrow::Int32Type)
@@ -74,10 +76,8 @@ class FieldAnalyzer : public arrow::TypeVisitor {
 #undef VISIT_FIXED_WIDTH
 
   // TODO(johanpel): Not implemented yet:
-  // arrow::Status Visit(const arrow::BooleanType &type) override {}
   // arrow::Status Visit(const arrow::NullType &type) override {}
   // arrow::Status Visit(const UnionType& type) override {}
-  // arrow::Status Visit(const DictionaryType& type) override {}
   // arrow::Status Visit(const ExtensionType& type) override {}
 
   int level = 0;
@@ -99,6 +99,8 @@ class SchemaAnalyzer : public arrow::TypeVisitor {
   ~SchemaAnalyzer() override = default;
   bool Analyze(const arrow::Schema &schema);
  protected:
+  /// @brief Analyze a field and append its description to the output.
+  void AnalyzeField(const arrow::Field &field);
   RecordBatchDescription *out_{};
 };
 
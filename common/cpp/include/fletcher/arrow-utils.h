@@ -21,6 +21,8 @@
 #include <string>
 #include <utility>
 
+#include "fletcher/meta/meta.h"
+
 namespace fletcher {
 
 /// @brief Access mode for reads / writes to recordbatches, arrays, buffers, etc. as seen from accelerator kernel.
@@ -55,6 +57,9 @@ struct FieldMetadata {
   FieldMetadata(std::shared_ptr<arrow::DataType> type, int64_t length, int64_t null_count)
       : type_(std::move(type)), length(length), null_count(null_count) {}
   std::vector<BufferMetadata> buffers;
+  /// Whether this field holds the dictionary of the dictionary-encoded field before it. Its length is the number of
+  /// dictionary entries.
+  bool dictionary = false;
 };
 
 struct RecordBatchDescription {
@@ -131,6 +136,31 @@ std::shared_ptr<arrow::Schema> WithMetaBusSpec(const arrow::Schema &schema,
                                                int lw = 8,
                                                int bs = 1,
                                                int bm = 16);
+
+/**
+ * @brief Append memory channel metadata for the resulting RecordBatch(Reader/Writer) to use.
+ * @param schema   The schema.
+ * @param channel  The memory channel.
+ * @return         A copy of the Schema with metadata appended.
+ */
+std::shared_ptr<arrow::Schema> WithMetaBusChannel(const arrow::Schema &schema, int channel);
+
+/**
+ * @brief Append bus arbitration weight metadata for the resulting RecordBatch(Reader/Writer) to use.
+ * @param schema   The schema.
+ * @param weight   The arbitration weight of the bus ports of the RecordBatch.
+ * @return         A copy of the Schema with metadata appended.
+ */
+std::shared_ptr<arrow::Schema> WithMetaBusWeight(const arrow::Schema &schema, int weight);
+
+/**
+ * @brief Append bus buffer depth metadata for the resulting RecordBatch(Reader/Writer) to use.
+ * @param schema   The schema.
+ * @param depth    The depth of the buffers between the bus ports of the RecordBatch and the bus arbiter.
+ * @return         A copy of the Schema with metadata appended.
+ */
+std::shared_ptr<arrow::Schema> WithMetaBusBufferDepth(const arrow::Schema &schema, int depth);
+
 /**
  * @brief Append Elements-Per-Cycle metadata to a field. Returns a copy of the field.
  *
@@ -142,6 +172,33 @@ std::shared_ptr<arrow::Schema> WithMetaBusSpec(const arrow::Schema &schema,
  */
 std::shared_ptr<arrow::Field> WithMetaEPC(const arrow::Field &field, int epc);
 
+/**
+ * @brief Append bus FIFO depth metadata to a field. Returns a copy of the field.
+ * @param field   The field to append to.
+ * @param depth   The depth of the bus response FIFO of every buffer of the field.
+ * @return        A copy of the field with metadata appended.
+ */
+std::shared_ptr<arrow::Field> WithMetaBusFifoDepth(const arrow::Field &field, int depth);
+
+/**
+ * @brief Append bus arbiter metadata to a field. Returns a copy of the field.
+ * @param field           The field to append to.
+ * @param max_outstanding The maximum number of outstanding requests of the arbiter.
+ * @param method          The arbitration method, either meta::ROUND_ROBIN or meta::FIXED.
+ * @return                A copy of the field with metadata appended.
+ */
+std::shared_ptr<arrow::Field> WithMetaArbiter(const arrow::Field &field,
+                                              int max_outstanding,
+                                              const std::string &method = meta::ROUND_ROBIN);
+
+/**
+ * @brief Append ArrayReader/Writer configuration parameters to a field. Returns a copy of the field.
+ * @param field   The field to append to.
+ * @param params  A comma-separated list of parameters, e.g. "out_slice=false,fifo_size=128".
+ * @return        A copy of the field with metadata appended.
+ */
+std::shared_ptr<arrow::Field> WithMetaConfig(const arrow::Field &field, const std::string &params);
+
 /**
  * @brief Append metadata to a field to signify Fletcher should ignore this field. Returns a copy of the field.
  * @param field   The field to append to.
@@ -151,10 +208,47 @@ std::shared_ptr<arrow::Field> WithMetaIgnore(const arrow::Field &field);
 
 /**
 * @brief Append metadata to a field to signify Fletcher should profile the streams resulting from this field. Returns a copy.
-* @param field   The field to append to.
-* @return        A copy of the field with metadata appended.
+* @param field     The field to append to.
+* @param histogram Whether to also build stall-length histograms of the streams.
+* @return          A copy of the field with metadata appended.
 */
-std::shared_ptr<arrow::Field> WithMetaProfile(const arrow::Field &field);
+std::shared_ptr<arrow::Field> WithMetaProfile(const arrow::Field &field, bool histogram = false);
+
+/// Suffix of the name of the field holding the dictionary of a dictionary-encoded field.
+constexpr char DICTIONARY_SUFFIX[] = "_dict";
+
+/**
+ * @brief Return the field holding the indices of a dictionary-encoded field.
+ *
+ * This is a copy of the field, including its metadata, with the index type of the dictionary as its type.
+ *
+ * @param field   The dictionary-encoded field.
+ * @return        The indices field.
+ */
+std::shared_ptr<arrow::Field> GetDictionaryIndicesField(const arrow::Field &field);
+
+/**
+ * @brief Return the field holding the dictionary of a dictionary-encoded field.
+ *
+ * The field is named after the dictionary-encoded field with DICTIONARY_SUFFIX appended, has the value type of the
+ * dictionary as its type and is not nullable. It inherits the metadata of the dictionary-encoded field, except for the
+ * elements-per-cycle and configuration keys, which apply to the indices.
+ *
+ * @param field   The dictionary-encoded field.
+ * @return        The dictionary field.
+ */
+std::shared_ptr<arrow::Field> GetDictionaryValuesField(const arrow::Field &field);
+
+/**
+ * @brief Return a schema where every dictionary-encoded field is replaced by its indices and dictionary fields.
+ *
+ * This is how the hardware sees a schema: the kernel receives the indices of a dictionary-encoded field as a separate
+ * stream from its dictionary. Only top-level fields may be dictionary-encoded.
+ *
+ * @param schema  The schema to expand.
+ * @return        The expanded schema, or the schema itself if it has no dictionary-encoded fields.
+ */
+std::shared_ptr<arrow::Schema> ExpandDictionaries(const std::shared_ptr<arrow::Schema> &schema);
 
 /**
  * Write a schema to a Flatbuffer file
@@ -19,5 +19,6 @@
 #include "fletcher/logging.h"
 #include "fletcher/arrow-utils.h"
 #include "fletcher/arrow-recordbatch.h"
+#include "fletcher/arrow-layout.h"
 #include "fletcher/arrow-schema.h"
 #include "fletcher/meta/meta.h"
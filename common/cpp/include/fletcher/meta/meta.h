@@ -46,12 +46,46 @@ constexpr char WRITE[] = "write";
 /// All values should be supplied as a decimal ASCII string.
 constexpr char BUS_SPEC[] = "fletcher_bus_spec";
 
+/// Key to set the memory channel of a schema.
+///
+/// RecordBatches on different channels are connected to different bus master ports of the Mantle, each with their own
+/// bus arbiters. All RecordBatches on the same channel must have the same bus specification.
+///
+/// Value must be a natural number up to 255 as a decimal ASCII string, e.g. "0", "1", "2", ...
+/// Default is "0".
+constexpr char BUS_CHANNEL[] = "fletcher_bus_channel";
+
+/// Key to set the arbitration weight of the bus ports of the RecordBatch of a schema.
+///
+/// With the "WEIGHTED" bus arbitration method of fletchgen, a bus port with weight W may issue up to W requests for
+/// every request of a bus port with weight 1. With the "FIXED" method, bus ports with a higher weight take precedence.
+/// The weight has no effect for other methods.
+///
+/// Value must be a positive natural number up to 65536 as a decimal ASCII string, e.g. "1", "2", "4", ...
+/// Default is "1".
+constexpr char BUS_WEIGHT[] = "fletcher_bus_weight";
+
+/// Key to insert a bus buffer between the bus ports of the RecordBatch of a schema and the bus arbiter.
+///
+/// The buffer can absorb a number of bus beats equal to its depth, such that a slow RecordBatch does not stall the
+/// bus arbiter, and other RecordBatches on the same memory channel.
+///
+/// Value must be a natural number up to 65536 as a decimal ASCII string, e.g. "0", "32", "64", ...
+/// A non-zero depth must exceed the burst max length of the bus of the RecordBatch.
+/// Default is "0", in which case no buffer is inserted.
+constexpr char BUS_BUFFER_DEPTH[] = "fletcher_bus_buffer_depth";
+
 // Field metadata:
 
 /// Key to enable profiling of data streams.
 /// Setting value to "true" enables profiling. Any other value disables profiling.
 constexpr char PROFILE[] = "fletcher_profile";
 
+/// Key to add stall-length histograms to the profilers of a field.
+/// Setting value to "true" counts, for every stream of the field, how many times the stream was valid but not ready,
+/// and ready but not valid, for a number of cycles in each of eight logarithmic buckets. Implies profiling.
+constexpr char PROFILE_HISTOGRAM[] = "fletcher_profile_histogram";
+
 /// Key to ignore a schema field.
 /// Setting value to "true" ignores this field in generation / run-time.
 constexpr char IGNORE[] = "fletcher_ignore";
@@ -68,5 +102,28 @@ constexpr char LIST_EPC[] = "fletcher_lepc";
 /// Values can by any positive, e.g. "1", "2", "3", ...
 constexpr char TAG_WIDTH[] = "fletcher_tag_width";
 
+/// Key to set the depth of the bus response FIFO of every buffer reader or writer of a field.
+/// The maximum number of outstanding bus requests of a buffer is approximately this depth divided by the burst length.
+/// Values can be any natural number, e.g. "16", "64", "256", ...
+/// Default is "16".
+constexpr char BUS_FIFO_DEPTH[] = "fletcher_bus_fifo_depth";
+
+/// Key to set the maximum number of outstanding requests of the bus arbiter of an ArrayReader/Writer.
+/// The arbiter is only instantiated for fields that use more than one buffer, e.g. nullable fields and lists.
+/// Values can be any positive natural number, e.g. "2", "8", "16", ...
+/// Default is "2".
+constexpr char MAX_OUTSTANDING[] = "fletcher_max_outstanding";
+
+/// Key to set the arbitration method of the bus arbiter of an ArrayReader/Writer.
+/// Can be either "ROUND-ROBIN" or "FIXED". Default is "ROUND-ROBIN".
+constexpr char ARB_METHOD[] = "fletcher_arb_method";
+constexpr char ROUND_ROBIN[] = "ROUND-ROBIN";
+constexpr char FIXED[] = "FIXED";
+
+/// Key to append parameters to the configuration string of an ArrayReader/Writer, e.g. to enable or disable register
+/// slices. The parameters apply to the level of the field itself, see hardware/arrays/ArrayConfig_pkg.vhd.
+/// Value must be a comma-separated list of the form "name=value,...", e.g. "out_slice=false,fifo_size=128".
+constexpr char CONFIG[] = "fletcher_config";
+
 }
 }
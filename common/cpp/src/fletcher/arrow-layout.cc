@@ -0,0 +1,404 @@
+// Copyright 2018 Delft University of Technology
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <arrow/api.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "fletcher/arrow-layout.h"
+#include "fletcher/logging.h"
+#include "fletcher/meta/meta.h"
+
+namespace fletcher {
+
+std::string ToString(BufferRole role) {
+  switch (role) {
+    case BufferRole::VALIDITY: return "validity";
+    case BufferRole::OFFSETS: return "offsets";
+    default: return "values";
+  }
+}
+
+/// @brief Return true if buffers of arrays of this type are supported as a single values buffer.
+static bool IsFixedWidth(arrow::Type::type id) {
+  switch (id) {
+    case arrow::Type::BOOL:
+    case arrow::Type::INT8:
+    case arrow::Type::INT16:
+    case arrow::Type::INT32:
+    case arrow::Type::INT64:
+    case arrow::Type::UINT8:
+    case arrow::Type::UINT16:
+    case arrow::Type::UINT32:
+    case arrow::Type::UINT64:
+    case arrow::Type::HALF_FLOAT:
+    case arrow::Type::FLOAT:
+    case arrow::Type::DOUBLE:
+    case arrow::Type::DATE32:
+    case arrow::Type::DATE64:
+    case arrow::Type::TIMESTAMP:
+    case arrow::Type::TIME32:
+    case arrow::Type::TIME64:
+    case arrow::Type::FIXED_SIZE_BINARY:
+    case arrow::Type::DECIMAL:return true;
+    default:return false;
+  }
+}
+
+/// @brief Add a field and all its buffers to a layout, recursively.
+static bool AddField(const arrow::Field &field, const std::string &name, int32_t parent, RecordBatchLayout *out) {
+  auto index = static_cast<int32_t>(out->fields.size());
+  int32_t level = parent < 0 ? 0 : out->fields[parent].level + 1;
+  out->fields.push_back({name, parent, level});
+
+  if (field.nullable()) {
+    out->buffers.push_back({index, BufferRole::VALIDITY});
+  }
+
+  const auto &type = *field.type();
+  switch (type.id()) {
+    case arrow::Type::BINARY:
+    case arrow::Type::STRING: {
+      out->buffers.push_back({index, BufferRole::OFFSETS});
+      out->buffers.push_back({index, BufferRole::VALUES});
+      return true;
+    }
+    case arrow::Type::LIST: {
+      if (type.num_fields() != 1) {
+        FLETCHER_LOG(ERROR, "List type does not have exactly one child.");
+        return false;
+      }
+      out->buffers.push_back({index, BufferRole::OFFSETS});
+      // The name of the child of a list does not appear in buffer descriptions.
+      return AddField(*type.field(0), "", index, out);
+    }
+    case arrow::Type::STRUCT: {
+      for (int i = 0; i < type.num_fields(); i++) {
+        if (!AddField(*type.field(i), type.field(i)->name(), index, out)) {
+          return false;
+        }
+      }
+      return true;
+    }
+    case arrow::Type::DICTIONARY: {
+      if (parent >= 0) {
+        FLETCHER_LOG(ERROR, "Dictionary-encoded field " + field.name() + " is not at the top level of the schema.");
+        return false;
+      }
+      // The indices are the values of this field. The dictionary follows as a separate top-level field.
+      out->buffers.push_back({index, BufferRole::VALUES});
+      auto dict_field = GetDictionaryValuesField(field);
+      return AddField(*dict_field, dict_field->name(), -1, out);
+    }
+    default: {
+      if (IsFixedWidth(type.id())) {
+        out->buffers.push_back({index, BufferRole::VALUES});
+        return true;
+      }
+      FLETCHER_LOG(ERROR, "Type " + type.ToString() + " of field " + field.name() + " is not supported.");
+      return false;
+    }
+  }
+}
+
+bool RecordBatchLayout::Make(const arrow::Schema &schema, RecordBatchLayout *out) {
+  out->name = GetMeta(schema, meta::NAME);
+  out->mode = GetMode(schema);
+  out->fields.clear();
+  out->buffers.clear();
+  out->dictionaries.clear();
+  for (int i = 0; i < schema.num_fields(); i++) {
+    const auto &field = schema.field(i);
+    if (!AddField(*field, field->name(), -1, out)) {
+      return false;
+    }
+    if (field->type()->id() == arrow::Type::DICTIONARY) {
+      out->dictionaries.push_back(i);
+    }
+  }
+  return true;
+}
+
+/// @brief Return a reference to a buffer, or an empty reference if the buffer does not exist.
+static inline BufferRef MakeRef(const std::vector<std::shared_ptr<arrow::Buffer>> &buffers, size_t i) {
+  BufferRef ref;
+  if ((i < buffers.size()) && (buffers[i] != nullptr)) {
+    ref.raw_buffer_ = buffers[i]->data();
+    ref.size_ = buffers[i]->size();
+  }
+  return ref;
+}
+
+/// @brief Return the data of a dictionary. Arrow versions differ in whether ArrayData holds it as Array or ArrayData.
+static inline const arrow::ArrayData &DictionaryData(const std::shared_ptr<arrow::Array> &dictionary) {
+  return *dictionary->data();
+}
+
+/// @brief Return the data of a dictionary. Arrow versions differ in whether ArrayData holds it as Array or ArrayData.
+static inline const arrow::ArrayData &DictionaryData(const std::shared_ptr<arrow::ArrayData> &dictionary) {
+  return *dictionary;
+}
+
+/// @brief Fill buffer references for some array data, recursively. Advances \p cur, which may not pass \p end.
+static bool RefreshArray(const arrow::ArrayData &data, bool nullable, BufferRef **cur, BufferRef *end) {
+  if (nullable) {
+    if (*cur == end) return false;
+    if (data.GetNullCount() > 0) {
+      **cur = MakeRef(data.buffers, 0);
+    } else {
+      // There are no nulls; the validity bitmap is implicit.
+      **cur = BufferRef();
+      (*cur)->implicit_ = true;
+    }
+    (*cur)++;
+  }
+
+  const auto &type = *data.type;
+  switch (type.id()) {
+    case arrow::Type::BINARY:
+    case arrow::Type::STRING: {
+      if (end - *cur < 2) return false;
+      *(*cur)++ = MakeRef(data.buffers, 1);
+      *(*cur)++ = MakeRef(data.buffers, 2);
+      return true;
+    }
+    case arrow::Type::LIST: {
+      if ((*cur == end) || (data.child_data.size() != 1)) return false;
+      *(*cur)++ = MakeRef(data.buffers, 1);
+      return RefreshArray(*data.child_data[0], type.field(0)->nullable(), cur, end);
+    }
+    case arrow::Type::STRUCT: {
+      if (data.child_data.size() != static_cast<size_t>(type.num_fields())) return false;
+      for (int i = 0; i < type.num_fields(); i++) {
+        if (!RefreshArray(*data.child_data[i], type.field(i)->nullable(), cur, end)) {
+          return false;
+        }
+      }
+      return true;
+    }
+    case arrow::Type::DICTIONARY: {
+      if ((*cur == end) || (data.dictionary == nullptr)) return false;
+      *(*cur)++ = MakeRef(data.buffers, 1);
+      // The dictionary is described as a non-nullable field, so it may not contain nulls.
+      const auto &dict = DictionaryData(data.dictionary);
+      if (dict.GetNullCount() > 0) return false;
+      return RefreshArray(dict, false, cur, end);
+    }
+    default: {
+      if ((*cur == end) || !IsFixedWidth(type.id())) return false;
+      *(*cur)++ = MakeRef(data.buffers, 1);
+      return true;
+    }
+  }
+}
+
+bool RecordBatchLayout::Refresh(const arrow::RecordBatch &batch, BufferRef *out) const {
+  BufferRef *cur = out;
+  BufferRef *end = out + buffers.size();
+  for (int i = 0; i < batch.num_columns(); i++) {
+    if (!RefreshArray(*batch.column_data(i), batch.schema()->field(i)->nullable(), &cur, end)) {
+      return false;
+    }
+  }
+  return cur == end;
+}
+
+int64_t RecordBatchLayout::DictionaryLength(const arrow::RecordBatch &batch, size_t i) const {
+  return DictionaryData(batch.column_data(dictionaries[i])->dictionary).length;
+}
+
+std::vector<std::string> RecordBatchLayout::BufferDesc(size_t i) const {
+  std::vector<std::string> result;
+  result.push_back(::fletcher::ToString(buffers[i].role));
+  for (auto f = buffers[i].field; f >= 0; f = fields[f].parent) {
+    if (!fields[f].name.empty()) {
+      result.push_back(fields[f].name);
+    }
+  }
+  std::reverse(result.begin(), result.end());
+  return result;
+}
+
+std::string RecordBatchLayout::ToString() const {
+  std::stringstream str;
+  for (size_t i = 0; i < buffers.size(); i++) {
+    str << std::setfill(' ') << std::setw(2 * BufferLevel(i)) << ':'
+        << ::fletcher::ToString(BufferDesc(i)) << '\n';
+  }
+  return str.str();
+}
+
+/// @brief 64-bit FNV-1a hash.
+struct Fnv1a {
+  uint64_t value = 0xcbf29ce484222325ULL;
+
+  void Add(const void *data, size_t size) {
+    auto bytes = static_cast<const uint8_t *>(data);
+    for (size_t i = 0; i < size; i++) {
+      value ^= bytes[i];
+      value *= 0x100000001b3ULL;
+    }
+  }
+
+  void Add(int64_t x) { Add(&x, sizeof(x)); }
+
+  void Add(const std::string &str) {
+    Add(static_cast<int64_t>(str.size()));
+    Add(str.data(), str.size());
+  }
+};
+
+/// @brief Add the value of a metadata key to a hash, or a marker if the key does not exist.
+static void HashMeta(const arrow::KeyValueMetadata *meta, const std::string &key, Fnv1a *hash) {
+  auto idx = meta != nullptr ? meta->FindKey(key) : -1;
+  if (idx >= 0) {
+    hash->Add(meta->value(idx));
+  } else {
+    hash->Add(int64_t(-1));
+  }
+}
+
+/// @brief Add the layout-relevant properties of a type to a hash, recursively.
+static void HashType(const arrow::DataType &type, Fnv1a *hash) {
+  hash->Add(static_cast<int64_t>(type.id()));
+  auto fw = dynamic_cast<const arrow::FixedWidthType *>(&type);
+  if (fw != nullptr) {
+    hash->Add(static_cast<int64_t>(fw->bit_width()));
+  }
+  if (type.id() == arrow::Type::DICTIONARY) {
+    HashType(*static_cast<const arrow::DictionaryType &>(type).value_type(), hash);
+  }
+  hash->Add(static_cast<int64_t>(type.num_fields()));
+  for (const auto &child : type.children()) {
+    hash->Add(child->name());
+    hash->Add(static_cast<int64_t>(child->nullable()));
+    HashType(*child->type(), hash);
+  }
+}
+
+uint64_t GetLayoutFingerprint(const arrow::Schema &schema) {
+  Fnv1a hash;
+  HashMeta(schema.metadata().get(), meta::NAME, &hash);
+  HashMeta(schema.metadata().get(), meta::MODE, &hash);
+  hash.Add(static_cast<int64_t>(schema.num_fields()));
+  for (const auto &field : schema.fields()) {
+    hash.Add(field->name());
+    hash.Add(static_cast<int64_t>(field->nullable()));
+    HashType(*field->type(), &hash);
+  }
+  return hash.value;
+}
+
+/// @brief Add the hardware-relevant properties of a field to a hash, recursively, without its name.
+static void HashFieldStructure(const arrow::Field &field, Fnv1a *hash) {
+  hash->Add(static_cast<int64_t>(field.nullable()));
+  hash->Add(static_cast<int64_t>(GetUIntMeta(field, meta::VALUE_EPC, 1)));
+  hash->Add(static_cast<int64_t>(GetUIntMeta(field, meta::LIST_EPC, 1)));
+  hash->Add(static_cast<int64_t>(GetBoolMeta(field, meta::PROFILE)));
+  hash->Add(static_cast<int64_t>(GetBoolMeta(field, meta::PROFILE_HISTOGRAM)));
+  hash->Add(static_cast<int64_t>(GetBoolMeta(field, meta::IGNORE)));
+  const auto &type = *field.type();
+  hash->Add(static_cast<int64_t>(type.id()));
+  auto fw = dynamic_cast<const arrow::FixedWidthType *>(&type);
+  if (fw != nullptr) {
+    hash->Add(static_cast<int64_t>(fw->bit_width()));
+  }
+  hash->Add(static_cast<int64_t>(type.num_fields()));
+  for (const auto &child : type.children()) {
+    HashFieldStructure(*child, hash);
+  }
+}
+
+uint64_t GetSchemaSetFingerprint(const std::vector<std::shared_ptr<arrow::Schema>> &schema_set) {
+  // Order the schemas in the same way as fletchgen does, by name and then by mode.
+  std::vector<std::pair<std::string, Mode>> keys;
+  std::vector<size_t> order;
+  for (size_t i = 0; i < schema_set.size(); i++) {
+    keys.emplace_back(GetMeta(*schema_set[i], meta::NAME), GetMode(*schema_set[i]));
+    order.push_back(i);
+  }
+  std::stable_sort(order.begin(), order.end(), [&keys](size_t a, size_t b) { return keys[a] < keys[b]; });
+
+  Fnv1a hash;
+  hash.Add(static_cast<int64_t>(schema_set.size()));
+  for (auto i : order) {
+    // Dictionary-encoded fields are hashed as their indices and dictionary fields, like fletchgen sees them.
+    auto expanded = ExpandDictionaries(schema_set[i]);
+    const auto &schema = *expanded;
+    hash.Add(static_cast<int64_t>(keys[i].second));
+    hash.Add(static_cast<int64_t>(schema.num_fields()));
+    for (const auto &field : schema.fields()) {
+      HashFieldStructure(*field, &hash);
+    }
+  }
+  return hash.value;
+}
+
+bool RecordBatchLayoutCache::Matches(const Entry &entry, const arrow::Schema &schema) {
+  // Compare everything the fingerprint covers: the Fletcher name and mode, and the names, types and nullability of all
+  // fields.
+  return (entry.layout->name == GetMeta(schema, meta::NAME))
+      && (entry.layout->mode == GetMode(schema))
+      && entry.schema->Equals(schema, false);
+}
+
+std::shared_ptr<const RecordBatchLayout> RecordBatchLayoutCache::Get(const arrow::Schema &schema) {
+  auto fingerprint = GetLayoutFingerprint(schema);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto range = layouts_.equal_range(fingerprint);
+    for (auto it = range.first; it != range.second; it++) {
+      if (Matches(it->second, schema)) {
+        return it->second.layout;
+      }
+    }
+  }
+  // Create the layout outside of the lock. If another thread does the same, the first one to finish wins.
+  auto layout = std::make_shared<RecordBatchLayout>();
+  if (!RecordBatchLayout::Make(schema, layout.get())) {
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto range = layouts_.equal_range(fingerprint);
+  for (auto it = range.first; it != range.second; it++) {
+    if (Matches(it->second, schema)) {
+      return it->second.layout;
+    }
+  }
+  // Hold on to a copy of the fields only, such that the cache does not keep the metadata of the schema alive.
+  auto copy = arrow::schema(schema.fields());
+  return layouts_.emplace(fingerprint, Entry{copy, layout})->second.layout;
+}
+
+void RecordBatchLayoutCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  layouts_.clear();
+}
+
+size_t RecordBatchLayoutCache::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return layouts_.size();
+}
+
+RecordBatchLayoutCache *DefaultLayoutCache() {
+  static RecordBatchLayoutCache cache;
+  return &cache;
+}
+
+}  // namespace fletcher
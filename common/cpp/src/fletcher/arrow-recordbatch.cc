@@ -40,8 +40,7 @@ arrow::Status RecordBatchAnalyzer::VisitArray(const arrow::Array &arr) {
     if (arr.null_count() > 0) {
       out_->fields.back().buffers.emplace_back(arr.null_bitmap()->data(), arr.null_bitmap()->size(), desc, level);
     } else {
-      auto dummy = std::make_shared<arrow::Buffer>(nullptr, 0);
-      out_->fields.back().buffers.emplace_back(dummy->data(), dummy->size(), desc, level, true);
+      out_->fields.back().buffers.emplace_back(nullptr, 0, desc, level, true);
     }
   }
   return arr.Accept(this);
@@ -56,6 +55,7 @@ bool RecordBatchAnalyzer::Analyze(const arrow::RecordBatch &batch) {
     // Remember what field we are at
     field = batch.schema()->field(i);
     buf_name = {field->name()};
+    level = 0;
     out_->fields.emplace_back(arr->type(), arr->length(), arr->null_count());
     if (!VisitArray(*arr).ok()) {
       return false;
@@ -116,4 +116,26 @@ arrow::Status RecordBatchAnalyzer::Visit(const arrow::StructArray &array) {
   return arrow::Status::OK();
 }
 
+arrow::Status RecordBatchAnalyzer::Visit(const arrow::DictionaryArray &array) {
+  if (level > 0) {
+    return arrow::Status::NotImplemented("Dictionary-encoded fields are only supported at the top level of a schema.");
+  }
+  // The indices are the values of this field.
+  auto status = array.indices()->Accept(this);
+  if (!status.ok())
+    return status;
+  out_->fields.back().type_ = array.indices()->type();
+  // The dictionary is described as a separate field that follows this field, such that the kernel can load it
+  // independently of the indices.
+  auto dict = array.dictionary();
+  if (dict->null_count() > 0) {
+    return arrow::Status::Invalid("Dictionary of field " + field->name() + " contains nulls.");
+  }
+  field = GetDictionaryValuesField(*field);
+  buf_name = {field->name()};
+  out_->fields.emplace_back(dict->type(), dict->length(), 0);
+  out_->fields.back().dictionary = true;
+  return VisitArray(*dict);
+}
+
 }  // namespace fletcher
@@ -32,16 +32,28 @@ bool SchemaAnalyzer::Analyze(const arrow::Schema &schema) {
   // Set number of rows to 0
   out_->rows = 0;
 
-  // Analyze every field using a FieldAnalyzer.
+  // Analyze every field using a FieldAnalyzer. A dictionary-encoded field is analyzed as a field holding its indices,
+  // followed by a field holding its dictionary.
   for (int i = 0; i < schema.num_fields(); ++i) {
-    FieldMetadata field_meta;
-    FieldAnalyzer fa(&field_meta, {schema.field(i)->name()});
-    fa.Analyze(*schema.field(i));
-    out_->fields.push_back(field_meta);
+    auto field = schema.field(i);
+    if (field->type()->id() == arrow::Type::DICTIONARY) {
+      AnalyzeField(*GetDictionaryIndicesField(*field));
+      AnalyzeField(*GetDictionaryValuesField(*field));
+      out_->fields.back().dictionary = true;
+    } else {
+      AnalyzeField(*field);
+    }
   }
   return true;
 }
 
+void SchemaAnalyzer::AnalyzeField(const arrow::Field &field) {
+  FieldMetadata field_meta;
+  FieldAnalyzer fa(&field_meta, {field.name()});
+  fa.Analyze(field);
+  out_->fields.push_back(field_meta);
+}
+
 bool FieldAnalyzer::Analyze(const arrow::Field &field) {
   field_out_->null_count = 0;
   field_out_->length = 0;
@@ -128,4 +140,11 @@ arrow::Status FieldAnalyzer::Visit(const arrow::StructType &type) {
   return arrow::Status::OK();
 }
 
+arrow::Status FieldAnalyzer::Visit(const arrow::DictionaryType &type) {
+  // Suppress unused warning
+  (void) type;
+  // Top-level dictionary-encoded fields are split into their indices and dictionary by the SchemaAnalyzer.
+  return arrow::Status::NotImplemented("Dictionary-encoded fields are only supported at the top level of a schema.");
+}
+
 }  // namespace fletcher
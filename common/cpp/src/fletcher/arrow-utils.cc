@@ -20,7 +20,6 @@
 #include <memory>
 #include <vector>
 #include <iostream>
-#include <unordered_map>
 #include <sstream>
 
 #include "fletcher/arrow-utils.h"
@@ -29,31 +28,25 @@
 
 namespace fletcher {
 
-std::string GetMeta(const arrow::Schema &schema, const std::string &key) {
-  if (schema.metadata() != nullptr) {
-    std::unordered_map<std::string, std::string> meta;
-    schema.metadata()->ToUnorderedMap(&meta);
-
-    auto k = meta.find(key);
-    if (k != meta.end()) {
-      return k->second;
+/// @brief Return the value of a key in some metadata, or an empty string if the key does not exist.
+static std::string FindMeta(const arrow::KeyValueMetadata *meta, const std::string &key) {
+  if (meta != nullptr) {
+    // Look up the key directly rather than converting all metadata to a map.
+    auto idx = meta->FindKey(key);
+    if (idx >= 0) {
+      return meta->value(idx);
     }
   }
   // Return empty string if no metadata
   return "";
 }
 
+std::string GetMeta(const arrow::Schema &schema, const std::string &key) {
+  return FindMeta(schema.metadata().get(), key);
+}
+
 std::string GetMeta(const arrow::Field &field, const std::string &key) {
-  if (field.metadata() != nullptr) {
-    std::unordered_map<std::string, std::string> meta;
-    field.metadata()->ToUnorderedMap(&meta);
-    auto k = meta.find(key);
-    if (k != meta.end()) {
-      return k->second;
-    }
-  }
-  // Return empty string if no metadata
-  return "";
+  return FindMeta(field.metadata().get(), key);
 }
 
 Mode GetMode(const arrow::Schema &schema) {
@@ -108,25 +101,84 @@ std::shared_ptr<arrow::Schema> WithMetaRequired(const arrow::Schema &schema,
   return schema.WithMetadata(meta);
 }
 
+/// @brief Return a copy of a schema with a key added to its metadata, or its value replaced if the key exists.
+static std::shared_ptr<arrow::Schema> AppendMeta(const arrow::Schema &schema,
+                                                 const std::string &key,
+                                                 const std::string &value) {
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+  if (schema.metadata() != nullptr) {
+    for (int64_t i = 0; i < schema.metadata()->size(); i++) {
+      if (schema.metadata()->key(i) != key) {
+        keys.push_back(schema.metadata()->key(i));
+        values.push_back(schema.metadata()->value(i));
+      }
+    }
+  }
+  keys.push_back(key);
+  values.push_back(value);
+  return schema.WithMetadata(std::make_shared<arrow::KeyValueMetadata>(keys, values));
+}
+
 std::shared_ptr<arrow::Schema> WithMetaBusSpec(const arrow::Schema &schema,
                                                int aw,
                                                int dw,
-                                               int sw,
                                                int lw,
                                                int bs,
                                                int bm) {
   std::stringstream ss;
-  ss << aw << "," << aw << "," << dw << "," << sw << "," << lw << "," << bs << "," << bm;
-  auto meta = std::make_shared<arrow::KeyValueMetadata>(std::vector<std::string>({meta::BUS_SPEC}),
-                                                        std::vector<std::string>({ss.str()}));
-  return schema.WithMetadata(meta);
+  ss << aw << "," << dw << "," << lw << "," << bs << "," << bm;
+  return AppendMeta(schema, meta::BUS_SPEC, ss.str());
+}
+
+std::shared_ptr<arrow::Schema> WithMetaBusChannel(const arrow::Schema &schema, int channel) {
+  return AppendMeta(schema, meta::BUS_CHANNEL, std::to_string(channel));
+}
+
+std::shared_ptr<arrow::Schema> WithMetaBusWeight(const arrow::Schema &schema, int weight) {
+  return AppendMeta(schema, meta::BUS_WEIGHT, std::to_string(weight));
+}
+
+std::shared_ptr<arrow::Schema> WithMetaBusBufferDepth(const arrow::Schema &schema, int depth) {
+  return AppendMeta(schema, meta::BUS_BUFFER_DEPTH, std::to_string(depth));
+}
+
+/// @brief Return a copy of a field with a key added to its metadata, or its value replaced if the key exists.
+static std::shared_ptr<arrow::Field> AppendMeta(const arrow::Field &field,
+                                                const std::string &key,
+                                                const std::string &value) {
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+  if (field.metadata() != nullptr) {
+    for (int64_t i = 0; i < field.metadata()->size(); i++) {
+      if (field.metadata()->key(i) != key) {
+        keys.push_back(field.metadata()->key(i));
+        values.push_back(field.metadata()->value(i));
+      }
+    }
+  }
+  keys.push_back(key);
+  values.push_back(value);
+  return field.WithMetadata(std::make_shared<arrow::KeyValueMetadata>(keys, values));
 }
 
 std::shared_ptr<arrow::Field> WithMetaEPC(const arrow::Field &field, int epc) {
-  auto meta = std::make_shared<arrow::KeyValueMetadata>(
-      std::vector<std::string>({meta::VALUE_EPC}),
-      std::vector<std::string>({std::to_string(epc)}));
-  return field.WithMetadata(meta);
+  return AppendMeta(field, meta::VALUE_EPC, std::to_string(epc));
+}
+
+std::shared_ptr<arrow::Field> WithMetaBusFifoDepth(const arrow::Field &field, int depth) {
+  return AppendMeta(field, meta::BUS_FIFO_DEPTH, std::to_string(depth));
+}
+
+std::shared_ptr<arrow::Field> WithMetaArbiter(const arrow::Field &field,
+                                              int max_outstanding,
+                                              const std::string &method) {
+  auto result = AppendMeta(field, meta::MAX_OUTSTANDING, std::to_string(max_outstanding));
+  return AppendMeta(*result, meta::ARB_METHOD, method);
+}
+
+std::shared_ptr<arrow::Field> WithMetaConfig(const arrow::Field &field, const std::string &params) {
+  return AppendMeta(field, meta::CONFIG, params);
 }
 
 std::shared_ptr<arrow::Field> WithMetaIgnore(const arrow::Field &field) {
@@ -136,13 +188,59 @@ std::shared_ptr<arrow::Field> WithMetaIgnore(const arrow::Field &field) {
   return field.WithMetadata(meta);
 }
 
-std::shared_ptr<arrow::Field> WithMetaProfile(const arrow::Field &field) {
+std::shared_ptr<arrow::Field> WithMetaProfile(const arrow::Field &field, bool histogram) {
   std::vector<std::string> profile_key = {meta::PROFILE};
   std::vector<std::string> profile_value = {"true"};
+  if (histogram) {
+    profile_key.emplace_back(meta::PROFILE_HISTOGRAM);
+    profile_value.emplace_back("true");
+  }
   auto meta = std::make_shared<arrow::KeyValueMetadata>(profile_key, profile_value);
   return field.WithMetadata(meta);
 }
 
+std::shared_ptr<arrow::Field> GetDictionaryIndicesField(const arrow::Field &field) {
+  const auto &type = static_cast<const arrow::DictionaryType &>(*field.type());
+  return field.WithType(type.index_type());
+}
+
+std::shared_ptr<arrow::Field> GetDictionaryValuesField(const arrow::Field &field) {
+  const auto &type = static_cast<const arrow::DictionaryType &>(*field.type());
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+  if (field.metadata() != nullptr) {
+    for (int64_t i = 0; i < field.metadata()->size(); i++) {
+      const auto &key = field.metadata()->key(i);
+      if ((key != meta::VALUE_EPC) && (key != meta::LIST_EPC) && (key != meta::CONFIG)) {
+        keys.push_back(key);
+        values.push_back(field.metadata()->value(i));
+      }
+    }
+  }
+  return arrow::field(field.name() + DICTIONARY_SUFFIX,
+                      type.value_type(),
+                      false,
+                      std::make_shared<arrow::KeyValueMetadata>(keys, values));
+}
+
+std::shared_ptr<arrow::Schema> ExpandDictionaries(const std::shared_ptr<arrow::Schema> &schema) {
+  std::vector<std::shared_ptr<arrow::Field>> fields;
+  bool expanded = false;
+  for (const auto &field : schema->fields()) {
+    if (field->type()->id() == arrow::Type::DICTIONARY) {
+      fields.push_back(GetDictionaryIndicesField(*field));
+      fields.push_back(GetDictionaryValuesField(*field));
+      expanded = true;
+    } else {
+      fields.push_back(field);
+    }
+  }
+  if (!expanded) {
+    return schema;
+  }
+  return arrow::schema(fields, schema->metadata());
+}
+
 bool ReadSchemaFromFile(const std::string &file_name, std::shared_ptr<arrow::Schema> *out) {
   std::shared_ptr<arrow::Schema> schema;
   arrow::Result<std::shared_ptr<arrow::io::ReadableFile>> result = arrow::io::ReadableFile::Open(file_name);
@@ -152,9 +250,10 @@ bool ReadSchemaFromFile(const std::string &file_name, std::shared_ptr<arrow::Sch
   }
   std::shared_ptr<arrow::io::ReadableFile> fis = result.ValueOrDie();
 
-  // Dictionaries are not supported yet, hence nullptr.
+  // The dictionaries themselves are not part of the schema, but the memo is required to read dictionary-encoded fields.
+  arrow::ipc::DictionaryMemo dictionary_memo;
   arrow::Result<std::shared_ptr<arrow::Schema>> schema_result;
-    schema_result = arrow::ipc::ReadSchema(fis.get(), nullptr);
+    schema_result = arrow::ipc::ReadSchema(fis.get(), &dictionary_memo);
   if (schema_result.ok()) {
     *out = schema_result.ValueOrDie();
   } else {
@@ -176,9 +275,10 @@ void WriteSchemaToFile(const std::string &file_name, const arrow::Schema &schema
     throw std::runtime_error("Could not allocate resizable Arrow buffer.");
   }
   auto buffer = std::dynamic_pointer_cast<arrow::Buffer>(resizable_buffer);
-  // Dictionaries are not supported yet, hence nullptr.
+  // The dictionaries themselves are not part of the schema, but the memo is required to write dictionary-encoded fields.
+  arrow::ipc::DictionaryMemo dictionary_memo;
   arrow::Result<std::shared_ptr<arrow::Buffer>> ser_result;
-  ser_result = arrow::ipc::SerializeSchema(schema, nullptr, arrow::default_memory_pool());
+  ser_result = arrow::ipc::SerializeSchema(schema, &dictionary_memo, arrow::default_memory_pool());
   if (ser_result.ok()) {
     buffer = ser_result.ValueOrDie();
   } else {
@@ -33,6 +33,29 @@ TEST(Common, AppendMetaRequired) {
   ASSERT_EQ(map.at("fletcher_mode"), "read");
 }
 
+TEST(Common, AppendMetaBus) {
+  auto schema = fletcher::WithMetaBusChannel(*fletcher::WithMetaBusSpec(*fletcher::GetPrimReadSchema(), 64, 256), 2);
+  ASSERT_NE(schema->metadata(), nullptr);
+  std::unordered_map<std::string, std::string> map;
+  schema->metadata()->ToUnorderedMap(&map);
+  // Required metadata must be retained.
+  ASSERT_EQ(map.at("fletcher_name"), "PrimRead");
+  ASSERT_EQ(map.at("fletcher_mode"), "read");
+  ASSERT_EQ(map.at("fletcher_bus_spec"), "64,256,8,1,16");
+  ASSERT_EQ(map.at("fletcher_bus_channel"), "2");
+  // Existing keys must be replaced.
+  schema = fletcher::WithMetaBusChannel(*schema, 3);
+  ASSERT_EQ(schema->metadata()->size(), 4);
+  ASSERT_EQ(fletcher::GetMeta(*schema, "fletcher_bus_channel"), "3");
+}
+
+TEST(Common, AppendMetaBusArbitration) {
+  auto schema = fletcher::WithMetaBusBufferDepth(*fletcher::WithMetaBusWeight(*fletcher::GetPrimReadSchema(), 4), 32);
+  ASSERT_EQ(fletcher::GetMeta(*schema, "fletcher_name"), "PrimRead");
+  ASSERT_EQ(fletcher::GetMeta(*schema, "fletcher_bus_weight"), "4");
+  ASSERT_EQ(fletcher::GetMeta(*schema, "fletcher_bus_buffer_depth"), "32");
+}
+
 TEST(Common, RecordBatchFileRoundTrip) {
   auto rb_out = fletcher::GetStringRB();
   std::vector<std::shared_ptr<arrow::RecordBatch>> rbs_in;
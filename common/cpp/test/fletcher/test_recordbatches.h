@@ -234,6 +234,38 @@ inline std::shared_ptr<arrow::RecordBatch> GetFilterRB() {
   return record_batch;
 }
 
+inline std::shared_ptr<arrow::RecordBatch> GetBoolRB() {
+  std::vector<bool> flags = {true, false, false, true, true, true, false, true,
+                             false, false, true, false, true, true, false, false};
+  arrow::BooleanBuilder builder;
+  THROW_NOT_OK(builder.AppendValues(flags));
+  std::shared_ptr<arrow::Array> array;
+  THROW_NOT_OK(builder.Finish(&array));
+  // Create the Record Batch
+  auto record_batch = arrow::RecordBatch::Make(GetBoolReadSchema(), flags.size(), {array});
+  return record_batch;
+}
+
+inline std::shared_ptr<arrow::RecordBatch> GetDictionaryRB() {
+  std::vector<std::string> names = {"Alice", "Bob", "Carol"};
+  std::vector<int32_t> indices = {0, 1, 0, 2, 2, 1};
+  arrow::StringBuilder dict_builder;
+  arrow::Int32Builder index_builder;
+  THROW_NOT_OK(dict_builder.AppendValues(names));
+  THROW_NOT_OK(index_builder.AppendValues(indices));
+  std::shared_ptr<arrow::Array> dict_array;
+  std::shared_ptr<arrow::Array> index_array;
+  THROW_NOT_OK(dict_builder.Finish(&dict_array));
+  THROW_NOT_OK(index_builder.Finish(&index_array));
+  // Create the dictionary-encoded array around the indices and the dictionary
+  auto schema = GetDictionaryReadSchema();
+  auto result = arrow::DictionaryArray::FromArrays(schema->field(0)->type(), index_array, dict_array);
+  THROW_NOT_OK(result.status());
+  // Create the Record Batch
+  auto record_batch = arrow::RecordBatch::Make(schema, indices.size(), {result.ValueOrDie()});
+  return record_batch;
+}
+
 inline std::shared_ptr<arrow::RecordBatch> GetSodaBeerRB(
     const std::shared_ptr<arrow::Schema> &schema,
     const std::vector<std::string> &names,
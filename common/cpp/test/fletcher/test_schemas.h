@@ -69,6 +69,12 @@ inline std::shared_ptr<arrow::Schema> GetTwoPrimWriteSchema() {
   return WithMetaRequired(*schema, "W", Mode::WRITE);
 }
 
+inline std::shared_ptr<arrow::Schema> GetTwoPrimWriteChannelSchema() {
+  // The TwoPrimWrite schema, on another memory channel with a narrower bus.
+  auto schema = WithMetaBusSpec(*GetTwoPrimWriteSchema(), 64, 256, 8, 1, 16);
+  return WithMetaBusChannel(*schema, 1);
+}
+
 inline std::shared_ptr<arrow::Schema> GetNullablePrimReadSchema() {
   // Create a vector of fields that will form the schema.
   std::vector<std::shared_ptr<arrow::Field>> schema_fields = {
@@ -144,6 +150,22 @@ inline std::shared_ptr<arrow::Schema> GetListIntSchema() {
   return WithMetaRequired(*schema, "ListInt", Mode::READ);
 }
 
+inline std::shared_ptr<arrow::Schema> GetBoolReadSchema() {
+  std::vector<std::shared_ptr<arrow::Field>> schema_fields = {
+      arrow::field("flag", arrow::boolean(), false)
+  };
+  auto schema = std::make_shared<arrow::Schema>(schema_fields);
+  return WithMetaRequired(*schema, "BoolRead", Mode::READ);
+}
+
+inline std::shared_ptr<arrow::Schema> GetDictionaryReadSchema() {
+  std::vector<std::shared_ptr<arrow::Field>> schema_fields = {
+      arrow::field("Name", arrow::dictionary(arrow::int32(), arrow::utf8()), false)
+  };
+  auto schema = std::make_shared<arrow::Schema>(schema_fields);
+  return WithMetaRequired(*schema, "DictionaryRead", Mode::READ);
+}
+
 inline std::shared_ptr<arrow::Schema> GetFilterReadSchema() {
   std::vector<std::shared_ptr<arrow::Field>> schema_fields = {
       arrow::field("read_first_name", arrow::utf8(), false),
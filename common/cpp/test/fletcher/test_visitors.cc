@@ -98,6 +98,42 @@ TEST(RecordBatchAnalyzer, VisitStruct) {
   ASSERT_EQ(rbd.fields[0].buffers[1].size_, 4 * sizeof(uint32_t));
 }
 
+TEST(RecordBatchAnalyzer, VisitBool) {
+  auto rb = fletcher::GetBoolRB();
+  fletcher::RecordBatchDescription rbd;
+  fletcher::RecordBatchAnalyzer rba(&rbd);
+  ASSERT_TRUE(rba.Analyze(*rb));
+  ASSERT_EQ(rbd.name, "BoolRead");
+  ASSERT_EQ(rbd.fields[0].length, 16);
+  ASSERT_TRUE(rbd.fields[0].type_->Equals(arrow::boolean()));
+  ASSERT_EQ(rbd.fields[0].buffers.size(), 1);
+  ASSERT_EQ(rbd.fields[0].buffers[0].desc_, vs({"flag", "values"}));
+  // Booleans are bit-packed.
+  ASSERT_EQ(rbd.fields[0].buffers[0].size_, 2);
+}
+
+TEST(RecordBatchAnalyzer, VisitDictionary) {
+  auto rb = fletcher::GetDictionaryRB();
+  fletcher::RecordBatchDescription rbd;
+  fletcher::RecordBatchAnalyzer rba(&rbd);
+  ASSERT_TRUE(rba.Analyze(*rb));
+  ASSERT_EQ(rbd.name, "DictionaryRead");
+  ASSERT_EQ(rbd.fields.size(), 2);
+  ASSERT_FALSE(rbd.fields[0].dictionary);
+  ASSERT_EQ(rbd.fields[0].length, 6);
+  ASSERT_TRUE(rbd.fields[0].type_->Equals(arrow::int32()));
+  ASSERT_EQ(rbd.fields[0].buffers[0].desc_, vs({"Name", "values"}));
+  ASSERT_EQ(rbd.fields[0].buffers[0].size_, 6 * sizeof(int32_t));
+  ASSERT_TRUE(rbd.fields[1].dictionary);
+  ASSERT_EQ(rbd.fields[1].length, 3);
+  ASSERT_TRUE(rbd.fields[1].type_->Equals(arrow::utf8()));
+  ASSERT_EQ(rbd.fields[1].buffers[0].level_, 0);
+  ASSERT_EQ(rbd.fields[1].buffers[0].desc_, vs({"Name_dict", "offsets"}));
+  ASSERT_EQ(rbd.fields[1].buffers[0].size_, 4 * sizeof(int32_t));
+  ASSERT_EQ(rbd.fields[1].buffers[1].desc_, vs({"Name_dict", "values"}));
+  ASSERT_EQ(rbd.fields[1].buffers[1].size_, 13);
+}
+
 // TypeVisitor tests
 TEST(SchemaAnalyzer, VisitPrimitive) {
   auto schema = fletcher::GetPrimReadSchema();
@@ -156,3 +192,155 @@ TEST(SchemaAnalyzer, VisitStruct) {
   ASSERT_EQ(rbd.fields[0].buffers[1].desc_, vs({"S", "B", "values"}));
   ASSERT_EQ(rbd.fields[0].buffers[1].size_, 0);
 }
+
+TEST(SchemaAnalyzer, VisitBool) {
+  auto schema = fletcher::GetBoolReadSchema();
+  fletcher::RecordBatchDescription rbd;
+  fletcher::SchemaAnalyzer sa(&rbd);
+  ASSERT_TRUE(sa.Analyze(*schema));
+  ASSERT_TRUE(rbd.fields[0].type_->Equals(arrow::boolean()));
+  ASSERT_EQ(rbd.fields[0].buffers.size(), 1);
+  ASSERT_EQ(rbd.fields[0].buffers[0].desc_, vs({"flag", "values"}));
+}
+
+TEST(SchemaAnalyzer, VisitDictionary) {
+  auto schema = fletcher::GetDictionaryReadSchema();
+  fletcher::RecordBatchDescription rbd;
+  fletcher::SchemaAnalyzer sa(&rbd);
+  sa.Analyze(*schema);
+  ASSERT_TRUE(rbd.is_virtual);
+  ASSERT_EQ(rbd.fields.size(), 2);
+  ASSERT_FALSE(rbd.fields[0].dictionary);
+  ASSERT_TRUE(rbd.fields[0].type_->Equals(arrow::int32()));
+  ASSERT_EQ(rbd.fields[0].buffers[0].desc_, vs({"Name", "values"}));
+  ASSERT_TRUE(rbd.fields[1].dictionary);
+  ASSERT_TRUE(rbd.fields[1].type_->Equals(arrow::utf8()));
+  ASSERT_EQ(rbd.fields[1].buffers[0].desc_, vs({"Name_dict", "offsets"}));
+  ASSERT_EQ(rbd.fields[1].buffers[1].desc_, vs({"Name_dict", "values"}));
+}
+
+// RecordBatchLayout tests
+static void ExpectLayoutEqualsAnalyzer(const arrow::RecordBatch &rb) {
+  fletcher::RecordBatchDescription rbd;
+  fletcher::RecordBatchAnalyzer rba(&rbd);
+  ASSERT_TRUE(rba.Analyze(rb));
+
+  fletcher::RecordBatchLayout layout;
+  ASSERT_TRUE(fletcher::RecordBatchLayout::Make(*rb.schema(), &layout));
+  std::vector<fletcher::BufferRef> refs(layout.buffers.size());
+  ASSERT_TRUE(layout.Refresh(rb, refs.data()));
+
+  ASSERT_EQ(layout.name, rbd.name);
+  size_t i = 0;
+  for (const auto &f : rbd.fields) {
+    for (const auto &b : f.buffers) {
+      ASSERT_LT(i, layout.buffers.size());
+      ASSERT_EQ(layout.BufferDesc(i), b.desc_);
+      ASSERT_EQ(layout.BufferLevel(i), b.level_);
+      ASSERT_EQ(refs[i].raw_buffer_, b.raw_buffer_);
+      ASSERT_EQ(refs[i].size_, b.size_);
+      ASSERT_EQ(refs[i].implicit_, b.implicit_);
+      i++;
+    }
+  }
+  ASSERT_EQ(i, layout.buffers.size());
+}
+
+TEST(RecordBatchLayout, MatchesAnalyzer) {
+  ExpectLayoutEqualsAnalyzer(*fletcher::GetIntRB());
+  ExpectLayoutEqualsAnalyzer(*fletcher::GetBoolRB());
+  ExpectLayoutEqualsAnalyzer(*fletcher::GetStringRB());
+  ExpectLayoutEqualsAnalyzer(*fletcher::GetListUint8RB());
+  ExpectLayoutEqualsAnalyzer(*fletcher::GetStructRB());
+  ExpectLayoutEqualsAnalyzer(*fletcher::GetFilterRB());
+  ExpectLayoutEqualsAnalyzer(*fletcher::GetDictionaryRB());
+}
+
+TEST(RecordBatchLayout, Dictionary) {
+  auto rb = fletcher::GetDictionaryRB();
+  fletcher::RecordBatchLayout layout;
+  ASSERT_TRUE(fletcher::RecordBatchLayout::Make(*rb->schema(), &layout));
+  ASSERT_EQ(layout.fields.size(), 2);
+  ASSERT_EQ(layout.buffers.size(), 3);
+  ASSERT_EQ(layout.dictionaries, std::vector<int32_t>({0}));
+  std::vector<fletcher::BufferRef> refs(layout.buffers.size());
+  ASSERT_TRUE(layout.Refresh(*rb, refs.data()));
+  ASSERT_EQ(layout.DictionaryLength(*rb, 0), 3);
+
+  // The layout of a dictionary-encoded field depends on the type of its dictionary.
+  auto int_dict = arrow::schema({arrow::field("Name", arrow::dictionary(arrow::int32(), arrow::int64()), false)},
+                                rb->schema()->metadata());
+  ASSERT_NE(fletcher::GetLayoutFingerprint(*int_dict), fletcher::GetLayoutFingerprint(*rb->schema()));
+}
+
+TEST(RecordBatchLayout, Reuse) {
+  auto rb0 = fletcher::GetStringRB();
+  auto rb1 = fletcher::GetStringRB();
+  fletcher::RecordBatchLayout layout;
+  ASSERT_TRUE(fletcher::RecordBatchLayout::Make(*rb0->schema(), &layout));
+  ASSERT_EQ(layout.fields.size(), 1);
+  ASSERT_EQ(layout.buffers.size(), 2);
+
+  std::vector<fletcher::BufferRef> refs(layout.buffers.size());
+  ASSERT_TRUE(layout.Refresh(*rb0, refs.data()));
+  ASSERT_EQ(refs[1].raw_buffer_, std::static_pointer_cast<arrow::StringArray>(rb0->column(0))->value_data()->data());
+  ASSERT_TRUE(layout.Refresh(*rb1, refs.data()));
+  ASSERT_EQ(refs[1].raw_buffer_, std::static_pointer_cast<arrow::StringArray>(rb1->column(0))->value_data()->data());
+
+  // A RecordBatch with another schema should not match.
+  ASSERT_FALSE(layout.Refresh(*fletcher::GetStructRB(), refs.data()));
+}
+
+TEST(RecordBatchLayout, Cache) {
+  fletcher::RecordBatchLayoutCache cache;
+  // Different schema objects with equal contents must share a layout.
+  auto a = cache.Get(*fletcher::GetStringReadSchema());
+  auto b = cache.Get(*fletcher::GetStringReadSchema());
+  ASSERT_NE(a, nullptr);
+  ASSERT_EQ(a, b);
+  ASSERT_EQ(cache.size(), 1);
+  // Different schemas must not.
+  auto c = cache.Get(*fletcher::GetStructSchema());
+  ASSERT_NE(c, nullptr);
+  ASSERT_NE(a, c);
+  ASSERT_EQ(cache.size(), 2);
+  // The mode is part of the fingerprint.
+  ASSERT_NE(fletcher::GetLayoutFingerprint(*fletcher::GetSodaBeerSchema("SodaBeer", fletcher::Mode::READ)),
+            fletcher::GetLayoutFingerprint(*fletcher::GetSodaBeerSchema("SodaBeer", fletcher::Mode::WRITE)));
+  cache.Clear();
+  ASSERT_EQ(cache.size(), 0);
+}
+
+TEST(RecordBatchLayout, SchemaSetFingerprint) {
+  auto read = fletcher::GetTwoPrimReadSchema();
+  auto write = fletcher::GetTwoPrimWriteSchema();
+  // The order in which schemas are supplied does not matter.
+  ASSERT_EQ(fletcher::GetSchemaSetFingerprint({read, write}), fletcher::GetSchemaSetFingerprint({write, read}));
+  // Names do not matter.
+  std::vector<std::shared_ptr<arrow::Field>> renamed_fields = {
+      fletcher::WithMetaProfile(*arrow::field("X", arrow::int8(), false)),
+      fletcher::WithMetaProfile(*arrow::field("Y", arrow::int8(), false))
+  };
+  auto renamed = fletcher::WithMetaRequired(arrow::Schema(renamed_fields), "R", fletcher::Mode::READ);
+  ASSERT_EQ(fletcher::GetSchemaSetFingerprint({read}), fletcher::GetSchemaSetFingerprint({renamed}));
+  // The mode does.
+  ASSERT_NE(fletcher::GetSchemaSetFingerprint({fletcher::GetSodaBeerSchema("SodaBeer", fletcher::Mode::READ)}),
+            fletcher::GetSchemaSetFingerprint({fletcher::GetSodaBeerSchema("SodaBeer", fletcher::Mode::WRITE)}));
+  // Elements per cycle do.
+  auto epc = fletcher::WithMetaEPC(*arrow::field("Name", arrow::utf8(), false), 8);
+  auto other_epc = fletcher::WithMetaRequired(arrow::Schema({epc}), "StringRead", fletcher::Mode::READ);
+  ASSERT_NE(fletcher::GetSchemaSetFingerprint({fletcher::GetStringReadSchema()}),
+            fletcher::GetSchemaSetFingerprint({other_epc}));
+  // Profiling does.
+  auto unprofiled = fletcher::WithMetaRequired(arrow::Schema({arrow::field("A", arrow::int8(), false),
+                                                              arrow::field("B", arrow::int8(), false)}),
+                                               "R", fletcher::Mode::READ);
+  ASSERT_NE(fletcher::GetSchemaSetFingerprint({read}), fletcher::GetSchemaSetFingerprint({unprofiled}));
+  // Dictionary-encoded fields are fingerprinted like fletchgen sees them.
+  auto dict = fletcher::GetDictionaryReadSchema();
+  auto expanded = fletcher::ExpandDictionaries(dict);
+  ASSERT_EQ(expanded->num_fields(), 2);
+  ASSERT_EQ(expanded->field(1)->name(), "Name_dict");
+  ASSERT_EQ(fletcher::ExpandDictionaries(expanded), expanded);
+  ASSERT_EQ(fletcher::GetSchemaSetFingerprint({dict}), fletcher::GetSchemaSetFingerprint({expanded}));
+}
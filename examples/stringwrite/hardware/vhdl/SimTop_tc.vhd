@@ -303,19 +303,19 @@ begin
     mmio_write(REG_CONTROL, CONTROL_CLEAR, mmio_source, mmio_sink, bcd_clk, bcd_reset);
 
     -- 2. Write addresses of the arrow buffers in the SREC file.
-    mmio_write(4, X"00000000", mmio_source, mmio_sink, bcd_clk, bcd_reset); -- First idx
-    mmio_write(5, X"00000010", mmio_source, mmio_sink, bcd_clk, bcd_reset); -- Last idx
+    mmio_write(6, X"00000000", mmio_source, mmio_sink, bcd_clk, bcd_reset); -- First idx
+    mmio_write(7, X"00000010", mmio_source, mmio_sink, bcd_clk, bcd_reset); -- Last idx
     
-    mmio_write(6, X"00000000", mmio_source, mmio_sink, bcd_clk, bcd_reset); -- Offset buf lo
-    mmio_write(7, X"00000000", mmio_source, mmio_sink, bcd_clk, bcd_reset); -- Offset buf hi
-    mmio_write(8, X"00001000", mmio_source, mmio_sink, bcd_clk, bcd_reset); -- Values buf lo
-    mmio_write(9, X"00000000", mmio_source, mmio_sink, bcd_clk, bcd_reset); -- Values buf hi
+    mmio_write(8, X"00000000", mmio_source, mmio_sink, bcd_clk, bcd_reset); -- Offset buf lo
+    mmio_write(9, X"00000000", mmio_source, mmio_sink, bcd_clk, bcd_reset); -- Offset buf hi
+    mmio_write(10, X"00001000", mmio_source, mmio_sink, bcd_clk, bcd_reset); -- Values buf lo
+    mmio_write(11, X"00000000", mmio_source, mmio_sink, bcd_clk, bcd_reset); -- Values buf hi
 
     -- 3. Write recordbatch bounds.
 
     -- 4. Write any kernel-specific registers.
-    mmio_write(10, X"00000010", mmio_source, mmio_sink, bcd_clk, bcd_reset); -- Str len min
-    mmio_write(11, X"FFFFFFFF", mmio_source, mmio_sink, bcd_clk, bcd_reset); -- UTF8 PRNG mask
+    mmio_write(12, X"00000010", mmio_source, mmio_sink, bcd_clk, bcd_reset); -- Str len min
+    mmio_write(13, X"FFFFFFFF", mmio_source, mmio_sink, bcd_clk, bcd_reset); -- UTF8 PRNG mask
 
     -- 5. Start the user core.
     mmio_write(REG_CONTROL, CONTROL_START, mmio_source, mmio_sink, bcd_clk, bcd_reset);
@@ -43,10 +43,12 @@ package ArrayConfig_pkg is
   --         The data element.
   --
   -----------------------------------------------------------------------------
-  -- arb(<>)
+  -- arb(<>;method=ROUND-ROBIN,max_outstanding=2)
   -----------------------------------------------------------------------------
   -- Constructs an intermediate bus arbiter and registers all streams. This is
-  -- automatically instantiated at the top level by ArrayReader.
+  -- automatically instantiated at the top level by ArrayReader, unless the
+  -- top level of its configuration already is an arb command, such that the
+  -- arbiter parameters can be specified.
   --
   -- Control vector:
   --   - <>
@@ -156,6 +158,10 @@ package ArrayConfig_pkg is
   --
 
 
+  -- Returns the given configuration wrapped in an arb command, unless its
+  -- toplevel command already is arb.
+  function arcfg_withArb(cfg: string) return string;
+
   -- Returns the control vector width for the given configuration.
   function arcfg_ctrlWidth(cfg: string; BUS_ADDR_WIDTH: natural) return natural;
 
@@ -181,6 +187,16 @@ end ArrayConfig_pkg;
 
 package body ArrayConfig_pkg is
 
+  -- Returns the given configuration wrapped in an arb command, unless its
+  -- toplevel command already is arb.
+  function arcfg_withArb(cfg: string) return string is
+  begin
+    if parse_command(cfg) = "arb" then
+      return cfg;
+    end if;
+    return "arb(" & cfg & ")";
+  end function;
+
   -- Returns the control vector width for the given configuration.
   function arcfg_ctrlWidth(cfg: string; BUS_ADDR_WIDTH: natural) return natural is
     constant cmd  : string := parse_command(cfg);
@@ -0,0 +1,143 @@
+-- Copyright 2018 Delft University of Technology
+--
+-- Licensed under the Apache License, Version 2.0 (the "License");
+-- you may not use this file except in compliance with the License.
+-- You may obtain a copy of the License at
+--
+--     http://www.apache.org/licenses/LICENSE-2.0
+--
+-- Unless required by applicable law or agreed to in writing, software
+-- distributed under the License is distributed on an "AS IS" BASIS,
+-- WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+-- See the License for the specific language governing permissions and
+-- limitations under the License.
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+-- On-chip dictionary for dictionary-encoded fields.
+--
+-- Fletchgen presents a dictionary-encoded field to the kernel as a field
+-- holding the indices, and a field holding the dictionary. This unit first
+-- loads one entry per transfer of the dictionary stream into on-chip memory,
+-- until the last entry. It then looks up the entry of every transfer of the
+-- index stream. The dictionary stays loaded until reset.
+--
+-- The entries do not have to be the dictionary values themselves. For
+-- example, a kernel that filters a dictionary-encoded string field can
+-- evaluate its predicate once for every string of the dictionary, and load
+-- the one-bit results into this unit.
+entity ArrayDictionaryLookup is
+  generic (
+
+    -- Width of the indices. The dictionary holds up to 2**INDEX_WIDTH entries.
+    INDEX_WIDTH                 : natural := 10;
+
+    -- Width of a dictionary entry.
+    DATA_WIDTH                  : natural := 32
+
+  );
+  port (
+
+    -- Rising-edge sensitive clock and active-high synchronous reset.
+    clk                         : in  std_logic;
+    reset                       : in  std_logic;
+
+    -- Dictionary stream, one entry per transfer.
+    dict_valid                  : in  std_logic;
+    dict_ready                  : out std_logic;
+    dict_data                   : in  std_logic_vector(DATA_WIDTH-1 downto 0);
+    dict_last                   : in  std_logic;
+
+    -- Index stream. Only accepted after the dictionary is loaded.
+    idx_valid                   : in  std_logic;
+    idx_ready                   : out std_logic;
+    idx_index                   : in  std_logic_vector(INDEX_WIDTH-1 downto 0);
+    idx_last                    : in  std_logic := '0';
+
+    -- Looked up entries, in the order of the index stream. The last signal is
+    -- passed on from the index stream.
+    out_valid                   : out std_logic;
+    out_ready                   : in  std_logic;
+    out_data                    : out std_logic_vector(DATA_WIDTH-1 downto 0);
+    out_last                    : out std_logic
+
+  );
+end ArrayDictionaryLookup;
+
+architecture Behavioral of ArrayDictionaryLookup is
+
+  type ram_type is array (0 to 2**INDEX_WIDTH-1) of std_logic_vector(DATA_WIDTH-1 downto 0);
+
+  -- Dictionary memory.
+  signal ram                    : ram_type;
+
+  -- Whether the last dictionary entry was loaded.
+  signal loaded                 : std_logic;
+
+  -- Address of the next dictionary entry.
+  signal wr_addr                : unsigned(INDEX_WIDTH-1 downto 0);
+
+  -- Internal version of out_valid so we can read from it.
+  signal out_valid_int          : std_logic;
+
+  -- Whether an index is looked up in this cycle.
+  signal lookup                 : std_logic;
+
+begin
+
+  dict_ready <= not loaded;
+
+  -- The memory output is the output register, so a new index can only be
+  -- looked up if that register is empty or emptied in this cycle.
+  lookup <= loaded and idx_valid and (not out_valid_int or out_ready);
+  idx_ready <= loaded and (not out_valid_int or out_ready);
+
+  reg_proc: process (clk) is
+  begin
+    if rising_edge(clk) then
+
+      -- Load the dictionary.
+      if loaded = '0' and dict_valid = '1' then
+        ram(to_integer(wr_addr)) <= dict_data;
+        wr_addr <= wr_addr + 1;
+        if dict_last = '1' then
+          loaded <= '1';
+        end if;
+      end if;
+
+      -- Look up the indices.
+      if out_ready = '1' then
+        out_valid_int <= '0';
+      end if;
+      if lookup = '1' then
+        out_data      <= ram(to_integer(unsigned(idx_index)));
+        out_last      <= idx_last;
+        out_valid_int <= '1';
+      end if;
+
+      if reset = '1' then
+        loaded        <= '0';
+        wr_addr       <= (others => '0');
+        out_valid_int <= '0';
+      end if;
+    end if;
+  end process;
+
+  -- pragma translate_off
+  -- Give assertion errors when the dictionary does not fit in the memory.
+  size_proc: process (clk) is
+  begin
+    if rising_edge(clk) then
+      if reset = '0' and loaded = '0' and dict_valid = '1' and dict_last = '0' then
+        assert wr_addr /= 2**INDEX_WIDTH-1
+          report "Dictionary has more than 2**INDEX_WIDTH entries." severity FAILURE;
+      end if;
+    end if;
+  end process;
+  -- pragma translate_on
+
+  out_valid <= out_valid_int;
+
+end Behavioral;
@@ -154,7 +154,7 @@ begin
       BUS_BURST_MAX_LEN         => BUS_BURST_MAX_LEN,
       BUS_BURST_STEP_LEN        => BUS_BURST_STEP_LEN,
       INDEX_WIDTH               => INDEX_WIDTH,
-      CFG                       => "arb(" & CFG & ")",
+      CFG                       => arcfg_withArb(CFG),
       CMD_TAG_ENABLE            => CMD_TAG_ENABLE,
       CMD_TAG_WIDTH             => CMD_TAG_WIDTH
     )
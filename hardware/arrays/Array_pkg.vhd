@@ -611,4 +611,27 @@ package Array_pkg is
     );
   end component;
 
+  component ArrayDictionaryLookup is
+    generic (
+      INDEX_WIDTH               : natural := 10;
+      DATA_WIDTH                : natural := 32
+    );
+    port (
+      clk                       : in  std_logic;
+      reset                     : in  std_logic;
+      dict_valid                : in  std_logic;
+      dict_ready                : out std_logic;
+      dict_data                 : in  std_logic_vector(DATA_WIDTH-1 downto 0);
+      dict_last                 : in  std_logic;
+      idx_valid                 : in  std_logic;
+      idx_ready                 : out std_logic;
+      idx_index                 : in  std_logic_vector(INDEX_WIDTH-1 downto 0);
+      idx_last                  : in  std_logic := '0';
+      out_valid                 : out std_logic;
+      out_ready                 : in  std_logic;
+      out_data                  : out std_logic_vector(DATA_WIDTH-1 downto 0);
+      out_last                  : out std_logic
+    );
+  end component;
+
 end Array_pkg;
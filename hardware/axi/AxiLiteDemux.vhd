@@ -0,0 +1,272 @@
+-- Copyright 2018-2019 Delft University of Technology
+--
+-- Licensed under the Apache License, Version 2.0 (the "License");
+-- you may not use this file except in compliance with the License.
+-- You may obtain a copy of the License at
+--
+--     http://www.apache.org/licenses/LICENSE-2.0
+--
+-- Unless required by applicable law or agreed to in writing, software
+-- distributed under the License is distributed on an "AS IS" BASIS,
+-- WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+-- See the License for the specific language governing permissions and
+-- limitations under the License.
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.std_logic_misc.all;
+use ieee.numeric_std.all;
+
+library work;
+use work.Axi_pkg.all;
+use work.UtilInt_pkg.all;
+
+-- Demultiplexes an AXI4-lite slave port onto a number of AXI4-lite master
+-- ports, each occupying an equally sized window of the address space.
+--
+-- Master port i serves the byte addresses i * 2**WINDOW_WIDTH up to
+-- (i+1) * 2**WINDOW_WIDTH. The address presented on a master port is relative
+-- to the start of its window. Accesses beyond the window of the last master
+-- port are answered with a DECERR response.
+--
+-- At most one read and one write transaction are in flight, which is more
+-- than sufficient for register access.
+entity AxiLiteDemux is
+  generic (
+    ---------------------------------------------------------------------------
+    -- Bus metrics and configuration
+    ---------------------------------------------------------------------------
+    ADDR_WIDTH                  : natural := 32;
+    DATA_WIDTH                  : natural := 32;
+
+    -- Number of master ports.
+    NUM_MASTERS                 : natural;
+
+    -- Log2 of the size of the window of every master port, in bytes.
+    WINDOW_WIDTH                : natural
+  );
+  port (
+    bcd_clk                     : in  std_logic;
+    bcd_reset                   : in  std_logic;
+
+    -- Slave port.
+    slv_awvalid                 : in  std_logic;
+    slv_awready                 : out std_logic;
+    slv_awaddr                  : in  std_logic_vector(ADDR_WIDTH-1 downto 0);
+    slv_wvalid                  : in  std_logic;
+    slv_wready                  : out std_logic;
+    slv_wdata                   : in  std_logic_vector(DATA_WIDTH-1 downto 0);
+    slv_wstrb                   : in  std_logic_vector(DATA_WIDTH/8-1 downto 0);
+    slv_bvalid                  : out std_logic;
+    slv_bready                  : in  std_logic;
+    slv_bresp                   : out std_logic_vector(1 downto 0);
+    slv_arvalid                 : in  std_logic;
+    slv_arready                 : out std_logic;
+    slv_araddr                  : in  std_logic_vector(ADDR_WIDTH-1 downto 0);
+    slv_rvalid                  : out std_logic;
+    slv_rready                  : in  std_logic;
+    slv_rdata                   : out std_logic_vector(DATA_WIDTH-1 downto 0);
+    slv_rresp                   : out std_logic_vector(1 downto 0);
+
+    -- Concatenated master ports.
+    mst_awvalid                 : out std_logic_vector(NUM_MASTERS-1 downto 0);
+    mst_awready                 : in  std_logic_vector(NUM_MASTERS-1 downto 0);
+    mst_awaddr                  : out std_logic_vector(NUM_MASTERS*ADDR_WIDTH-1 downto 0);
+    mst_wvalid                  : out std_logic_vector(NUM_MASTERS-1 downto 0);
+    mst_wready                  : in  std_logic_vector(NUM_MASTERS-1 downto 0);
+    mst_wdata                   : out std_logic_vector(NUM_MASTERS*DATA_WIDTH-1 downto 0);
+    mst_wstrb                   : out std_logic_vector(NUM_MASTERS*DATA_WIDTH/8-1 downto 0);
+    mst_bvalid                  : in  std_logic_vector(NUM_MASTERS-1 downto 0);
+    mst_bready                  : out std_logic_vector(NUM_MASTERS-1 downto 0);
+    mst_bresp                   : in  std_logic_vector(NUM_MASTERS*2-1 downto 0);
+    mst_arvalid                 : out std_logic_vector(NUM_MASTERS-1 downto 0);
+    mst_arready                 : in  std_logic_vector(NUM_MASTERS-1 downto 0);
+    mst_araddr                  : out std_logic_vector(NUM_MASTERS*ADDR_WIDTH-1 downto 0);
+    mst_rvalid                  : in  std_logic_vector(NUM_MASTERS-1 downto 0);
+    mst_rready                  : out std_logic_vector(NUM_MASTERS-1 downto 0);
+    mst_rdata                   : in  std_logic_vector(NUM_MASTERS*DATA_WIDTH-1 downto 0);
+    mst_rresp                   : in  std_logic_vector(NUM_MASTERS*2-1 downto 0)
+  );
+end AxiLiteDemux;
+
+architecture Behavioral of AxiLiteDemux is
+
+  constant RESP_DECERR : std_logic_vector(1 downto 0) := "11";
+
+  -- Width of the master port index, with one extra bit such that it is never
+  -- zero.
+  constant SEL_WIDTH : natural := log2ceil(NUM_MASTERS) + 1;
+
+  type wr_state_type is (IDLE, AW, W, B, WERR, BERR);
+  type rd_state_type is (IDLE, AR, R, RERR);
+
+  type reg_type is record
+    wr_state : wr_state_type;
+    wr_sel   : natural range 0 to NUM_MASTERS-1;
+    wr_addr  : std_logic_vector(ADDR_WIDTH-1 downto 0);
+    rd_state : rd_state_type;
+    rd_sel   : natural range 0 to NUM_MASTERS-1;
+    rd_addr  : std_logic_vector(ADDR_WIDTH-1 downto 0);
+  end record;
+
+  signal r : reg_type;
+  signal d : reg_type;
+
+  -- Returns whether a slave address falls within the window of any master.
+  function in_range(addr : std_logic_vector) return boolean is
+  begin
+    return unsigned(addr(ADDR_WIDTH-1 downto WINDOW_WIDTH)) < NUM_MASTERS;
+  end function;
+
+  -- Returns the index of the master port that serves a slave address.
+  function select_master(addr : std_logic_vector) return natural is
+  begin
+    return to_integer(resize(unsigned(addr(ADDR_WIDTH-1 downto WINDOW_WIDTH)), SEL_WIDTH));
+  end function;
+
+  -- Returns a slave address relative to the window of its master port.
+  function window_address(addr : std_logic_vector) return std_logic_vector is
+    variable result : std_logic_vector(ADDR_WIDTH-1 downto 0) := (others => '0');
+  begin
+    result(WINDOW_WIDTH-1 downto 0) := addr(WINDOW_WIDTH-1 downto 0);
+    return result;
+  end function;
+
+begin
+
+  seq: process(bcd_clk) is
+  begin
+    if rising_edge(bcd_clk) then
+      r <= d;
+      if bcd_reset = '1' then
+        r.wr_state <= IDLE;
+        r.rd_state <= IDLE;
+      end if;
+    end if;
+  end process;
+
+  comb: process(r,
+    slv_awvalid, slv_awaddr, slv_wvalid, slv_wdata, slv_wstrb, slv_bready,
+    slv_arvalid, slv_araddr, slv_rready,
+    mst_awready, mst_wready, mst_bvalid, mst_bresp,
+    mst_arready, mst_rvalid, mst_rdata, mst_rresp
+  ) is
+    variable v : reg_type;
+  begin
+    v := r;
+
+    -- Default outputs. Data is broadcast to every master port; only the
+    -- selected one gets a valid signal.
+    slv_awready <= '0';
+    slv_wready  <= '0';
+    slv_bvalid  <= '0';
+    slv_bresp   <= (others => '0');
+    slv_arready <= '0';
+    slv_rvalid  <= '0';
+    slv_rdata   <= (others => '0');
+    slv_rresp   <= (others => '0');
+
+    mst_awvalid <= (others => '0');
+    mst_wvalid  <= (others => '0');
+    mst_bready  <= (others => '0');
+    mst_arvalid <= (others => '0');
+    mst_rready  <= (others => '0');
+
+    for I in 0 to NUM_MASTERS-1 loop
+      mst_awaddr((I+1)*ADDR_WIDTH-1 downto I*ADDR_WIDTH)     <= r.wr_addr;
+      mst_wdata((I+1)*DATA_WIDTH-1 downto I*DATA_WIDTH)      <= slv_wdata;
+      mst_wstrb((I+1)*DATA_WIDTH/8-1 downto I*DATA_WIDTH/8)  <= slv_wstrb;
+      mst_araddr((I+1)*ADDR_WIDTH-1 downto I*ADDR_WIDTH)     <= r.rd_addr;
+    end loop;
+
+    -- Write path.
+    case r.wr_state is
+      when IDLE =>
+        slv_awready <= '1';
+        if slv_awvalid = '1' then
+          v.wr_addr := window_address(slv_awaddr);
+          if in_range(slv_awaddr) then
+            v.wr_sel := select_master(slv_awaddr);
+            v.wr_state := AW;
+          else
+            v.wr_state := WERR;
+          end if;
+        end if;
+
+      when AW =>
+        mst_awvalid(r.wr_sel) <= '1';
+        if mst_awready(r.wr_sel) = '1' then
+          v.wr_state := W;
+        end if;
+
+      when W =>
+        mst_wvalid(r.wr_sel) <= slv_wvalid;
+        slv_wready <= mst_wready(r.wr_sel);
+        if slv_wvalid = '1' and mst_wready(r.wr_sel) = '1' then
+          v.wr_state := B;
+        end if;
+
+      when B =>
+        slv_bvalid <= mst_bvalid(r.wr_sel);
+        slv_bresp <= mst_bresp((r.wr_sel+1)*2-1 downto r.wr_sel*2);
+        mst_bready(r.wr_sel) <= slv_bready;
+        if mst_bvalid(r.wr_sel) = '1' and slv_bready = '1' then
+          v.wr_state := IDLE;
+        end if;
+
+      -- Swallow the write data of an out-of-range write.
+      when WERR =>
+        slv_wready <= '1';
+        if slv_wvalid = '1' then
+          v.wr_state := BERR;
+        end if;
+
+      when BERR =>
+        slv_bvalid <= '1';
+        slv_bresp <= RESP_DECERR;
+        if slv_bready = '1' then
+          v.wr_state := IDLE;
+        end if;
+    end case;
+
+    -- Read path.
+    case r.rd_state is
+      when IDLE =>
+        slv_arready <= '1';
+        if slv_arvalid = '1' then
+          v.rd_addr := window_address(slv_araddr);
+          if in_range(slv_araddr) then
+            v.rd_sel := select_master(slv_araddr);
+            v.rd_state := AR;
+          else
+            v.rd_state := RERR;
+          end if;
+        end if;
+
+      when AR =>
+        mst_arvalid(r.rd_sel) <= '1';
+        if mst_arready(r.rd_sel) = '1' then
+          v.rd_state := R;
+        end if;
+
+      when R =>
+        slv_rvalid <= mst_rvalid(r.rd_sel);
+        slv_rdata <= mst_rdata((r.rd_sel+1)*DATA_WIDTH-1 downto r.rd_sel*DATA_WIDTH);
+        slv_rresp <= mst_rresp((r.rd_sel+1)*2-1 downto r.rd_sel*2);
+        mst_rready(r.rd_sel) <= slv_rready;
+        if mst_rvalid(r.rd_sel) = '1' and slv_rready = '1' then
+          v.rd_state := IDLE;
+        end if;
+
+      when RERR =>
+        slv_rvalid <= '1';
+        slv_rresp <= RESP_DECERR;
+        if slv_rready = '1' then
+          v.rd_state := IDLE;
+        end if;
+    end case;
+
+    d <= v;
+  end process;
+
+end Behavioral;
@@ -187,4 +187,51 @@ package Axi_pkg is
     );
   end component;
 
+  component AxiLiteDemux is
+    generic (
+      ADDR_WIDTH                : natural := 32;
+      DATA_WIDTH                : natural := 32;
+      NUM_MASTERS               : natural;
+      WINDOW_WIDTH              : natural
+    );
+    port (
+      bcd_clk                   : in  std_logic;
+      bcd_reset                 : in  std_logic;
+      slv_awvalid               : in  std_logic;
+      slv_awready               : out std_logic;
+      slv_awaddr                : in  std_logic_vector(ADDR_WIDTH-1 downto 0);
+      slv_wvalid                : in  std_logic;
+      slv_wready                : out std_logic;
+      slv_wdata                 : in  std_logic_vector(DATA_WIDTH-1 downto 0);
+      slv_wstrb                 : in  std_logic_vector(DATA_WIDTH/8-1 downto 0);
+      slv_bvalid                : out std_logic;
+      slv_bready                : in  std_logic;
+      slv_bresp                 : out std_logic_vector(1 downto 0);
+      slv_arvalid               : in  std_logic;
+      slv_arready               : out std_logic;
+      slv_araddr                : in  std_logic_vector(ADDR_WIDTH-1 downto 0);
+      slv_rvalid                : out std_logic;
+      slv_rready                : in  std_logic;
+      slv_rdata                 : out std_logic_vector(DATA_WIDTH-1 downto 0);
+      slv_rresp                 : out std_logic_vector(1 downto 0);
+      mst_awvalid               : out std_logic_vector(NUM_MASTERS-1 downto 0);
+      mst_awready               : in  std_logic_vector(NUM_MASTERS-1 downto 0);
+      mst_awaddr                : out std_logic_vector(NUM_MASTERS*ADDR_WIDTH-1 downto 0);
+      mst_wvalid                : out std_logic_vector(NUM_MASTERS-1 downto 0);
+      mst_wready                : in  std_logic_vector(NUM_MASTERS-1 downto 0);
+      mst_wdata                 : out std_logic_vector(NUM_MASTERS*DATA_WIDTH-1 downto 0);
+      mst_wstrb                 : out std_logic_vector(NUM_MASTERS*DATA_WIDTH/8-1 downto 0);
+      mst_bvalid                : in  std_logic_vector(NUM_MASTERS-1 downto 0);
+      mst_bready                : out std_logic_vector(NUM_MASTERS-1 downto 0);
+      mst_bresp                 : in  std_logic_vector(NUM_MASTERS*2-1 downto 0);
+      mst_arvalid               : out std_logic_vector(NUM_MASTERS-1 downto 0);
+      mst_arready               : in  std_logic_vector(NUM_MASTERS-1 downto 0);
+      mst_araddr                : out std_logic_vector(NUM_MASTERS*ADDR_WIDTH-1 downto 0);
+      mst_rvalid                : in  std_logic_vector(NUM_MASTERS-1 downto 0);
+      mst_rready                : out std_logic_vector(NUM_MASTERS-1 downto 0);
+      mst_rdata                 : in  std_logic_vector(NUM_MASTERS*DATA_WIDTH-1 downto 0);
+      mst_rresp                 : in  std_logic_vector(NUM_MASTERS*2-1 downto 0)
+    );
+  end component;
+
 end Axi_pkg;
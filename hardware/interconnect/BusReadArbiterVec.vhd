@@ -40,8 +40,10 @@ entity BusReadArbiterVec is
     -- Number of bus masters to arbitrate between.
     NUM_SLAVE_PORTS             : natural := 2;
 
-    -- Arbitration method. Must be "ROUND-ROBIN" or "FIXED". If fixed,
-    -- lower-indexed masters take precedence.
+    -- Arbitration method. Must be "ROUND-ROBIN", "RR-STICKY", "FIXED" or
+    -- "WEIGHTED". If fixed, lower-indexed masters take precedence. If
+    -- weighted, every master may issue as many requests per round-robin round
+    -- as its weight in SLV_WEIGHTS.
     ARB_METHOD                  : string := "ROUND-ROBIN";
 
     -- Maximum number of outstanding requests. This is rounded upward to
@@ -61,7 +63,17 @@ entity BusReadArbiterVec is
     MST_DAT_SLICE               : boolean := false;
 
     -- Whether a register slice should be inserted into the slave data ports
-    SLV_DAT_SLICES              : boolean := true
+    SLV_DAT_SLICES              : boolean := true;
+
+    -- Comma-separated arbitration weights of the slave ports, used by the
+    -- "WEIGHTED" arbitration method. Unspecified weights default to 1.
+    SLV_WEIGHTS                 : string := "";
+
+    -- Comma-separated FIFO depths of BusReadBuffers to insert into the slave
+    -- ports. A buffer only issues a request when it can absorb the response,
+    -- such that a slow slave cannot stall the master port. Unspecified or zero
+    -- depths insert no buffer.
+    SLV_BUFFER_DEPTHS           : string := ""
 
   );
   port (
@@ -99,6 +111,18 @@ architecture Behavioral of BusReadArbiterVec is
   -- Width of the index stream.
   constant INDEX_WIDTH          : natural := imax(1, log2ceil(NUM_SLAVE_PORTS));
 
+  -- Returns the arbitration weight of every slave port.
+  function slv_weight_array return nat_array is
+    variable res : nat_array(0 to NUM_SLAVE_PORTS-1);
+  begin
+    for i in res'range loop
+      res(i) := imax(1, parse_csv_nat(SLV_WEIGHTS, i, 1));
+    end loop;
+    return res;
+  end function;
+
+  constant WEIGHTS              : nat_array(0 to NUM_SLAVE_PORTS-1) := slv_weight_array;
+
   -- Type declarations for busses.
   subtype bus_addr_type is std_logic_vector(BUS_ADDR_WIDTH-1 downto 0);
   subtype bus_len_type  is std_logic_vector(BUS_LEN_WIDTH-1  downto 0);
@@ -159,6 +183,9 @@ architecture Behavioral of BusReadArbiterVec is
   signal bms_rdat_data          : bus_data_type;
   signal bms_rdat_last          : std_logic;
 
+  -- Slave ports that may issue requests to the arbiter.
+  signal arb_eligible           : std_logic_vector(0 to NUM_SLAVE_PORTS-1);
+
   -- Serialized arbiter input signals.
   signal arb_in_valid           : std_logic_vector(NUM_SLAVE_PORTS-1 downto 0);
   signal arb_in_ready           : std_logic_vector(NUM_SLAVE_PORTS-1 downto 0);
@@ -186,18 +213,60 @@ architecture Behavioral of BusReadArbiterVec is
 begin
 
   -- Connect the serialized master ports to the internal arrays for
-  -- convenience.
+  -- convenience, through a BusReadBuffer if requested.
   serdes_gen: for i in 0 to NUM_SLAVE_PORTS-1 generate
+    constant BUFFER_DEPTH       : natural := parse_csv_nat(SLV_BUFFER_DEPTHS, i, 0);
   begin
-    bs_rreq_valid  (i) <= bsv_rreq_valid (i);
-    bsv_rreq_ready (i) <= bs_rreq_ready  (i);
-    bs_rreq_addr   (i) <= bsv_rreq_addr  ((i+1)*BUS_ADDR_WIDTH-1 downto i*BUS_ADDR_WIDTH);
-    bs_rreq_len    (i) <= bsv_rreq_len   ((i+1)*BUS_LEN_WIDTH-1  downto i*BUS_LEN_WIDTH);
-    bsv_rdat_valid(i) <= bm_resp_valid (i);
-    bm_resp_ready (i) <= bsv_rdat_ready(i);
-    bsv_rdat_data((i+1)*BUS_DATA_WIDTH-1 downto i*BUS_DATA_WIDTH)
-                      <= bm_resp_data  (i);
-    bsv_rdat_last (i) <= bm_resp_last  (i);
+    direct_gen: if BUFFER_DEPTH = 0 generate
+    begin
+      bs_rreq_valid  (i) <= bsv_rreq_valid (i);
+      bsv_rreq_ready (i) <= bs_rreq_ready  (i);
+      bs_rreq_addr   (i) <= bsv_rreq_addr  ((i+1)*BUS_ADDR_WIDTH-1 downto i*BUS_ADDR_WIDTH);
+      bs_rreq_len    (i) <= bsv_rreq_len   ((i+1)*BUS_LEN_WIDTH-1  downto i*BUS_LEN_WIDTH);
+      bsv_rdat_valid(i) <= bm_resp_valid (i);
+      bm_resp_ready (i) <= bsv_rdat_ready(i);
+      bsv_rdat_data((i+1)*BUS_DATA_WIDTH-1 downto i*BUS_DATA_WIDTH)
+                        <= bm_resp_data  (i);
+      bsv_rdat_last (i) <= bm_resp_last  (i);
+    end generate;
+
+    buffer_gen: if BUFFER_DEPTH > 0 generate
+    begin
+      buffer_inst: BusReadBuffer
+        generic map (
+          BUS_ADDR_WIDTH                => BUS_ADDR_WIDTH,
+          BUS_LEN_WIDTH                 => BUS_LEN_WIDTH,
+          BUS_DATA_WIDTH                => BUS_DATA_WIDTH,
+          FIFO_DEPTH                    => BUFFER_DEPTH,
+          RAM_CONFIG                    => RAM_CONFIG,
+          SLV_REQ_SLICE                 => false,
+          MST_REQ_SLICE                 => false,
+          MST_DAT_SLICE                 => false,
+          SLV_DAT_SLICE                 => false
+        )
+        port map (
+          clk                           => bcd_clk,
+          reset                         => bcd_reset,
+
+          slv_rreq_valid                => bsv_rreq_valid(i),
+          slv_rreq_ready                => bsv_rreq_ready(i),
+          slv_rreq_addr                 => bsv_rreq_addr((i+1)*BUS_ADDR_WIDTH-1 downto i*BUS_ADDR_WIDTH),
+          slv_rreq_len                  => bsv_rreq_len((i+1)*BUS_LEN_WIDTH-1 downto i*BUS_LEN_WIDTH),
+          slv_rdat_valid                => bsv_rdat_valid(i),
+          slv_rdat_ready                => bsv_rdat_ready(i),
+          slv_rdat_data                 => bsv_rdat_data((i+1)*BUS_DATA_WIDTH-1 downto i*BUS_DATA_WIDTH),
+          slv_rdat_last                 => bsv_rdat_last(i),
+
+          mst_rreq_valid                => bs_rreq_valid(i),
+          mst_rreq_ready                => bs_rreq_ready(i),
+          mst_rreq_addr                 => bs_rreq_addr(i),
+          mst_rreq_len                  => bs_rreq_len(i),
+          mst_rdat_valid                => bm_resp_valid(i),
+          mst_rdat_ready                => bm_resp_ready(i),
+          mst_rdat_data                 => bm_resp_data(i),
+          mst_rdat_last                 => bm_resp_last(i)
+        );
+    end generate;
   end generate;
 
   -- Instantiate register slices for the master ports.
@@ -310,11 +379,66 @@ begin
   bms_rdat_data                         <= srespo_sData(BPI(2)-1 downto BPI(1));
   bms_rdat_last                         <= srespo_sData(BPI(0));
 
+  -- Determine which slave ports may issue requests. With weighted
+  -- arbitration, every slave port has a number of credits equal to its weight
+  -- at the start of a round, and spends one credit per request. A new round
+  -- starts when no slave port with credits left has a request pending.
+  weighted_gen: if ARB_METHOD = "WEIGHTED" generate
+    signal credits              : nat_array(0 to NUM_SLAVE_PORTS-1);
+    signal round_done           : std_logic;
+  begin
+    round_done_proc: process (bss_rreq_valid, credits) is
+    begin
+      round_done <= '1';
+      for i in 0 to NUM_SLAVE_PORTS-1 loop
+        if bss_rreq_valid(i) = '1' and credits(i) > 0 then
+          round_done <= '0';
+        end if;
+      end loop;
+    end process;
+
+    eligible_proc: process (credits, round_done) is
+    begin
+      for i in 0 to NUM_SLAVE_PORTS-1 loop
+        if credits(i) > 0 or round_done = '1' then
+          arb_eligible(i) <= '1';
+        else
+          arb_eligible(i) <= '0';
+        end if;
+      end loop;
+    end process;
+
+    credit_proc: process (bcd_clk) is
+    begin
+      if rising_edge(bcd_clk) then
+        for i in 0 to NUM_SLAVE_PORTS-1 loop
+          if arb_in_valid(i) = '1' and arb_in_ready(i) = '1' then
+            if round_done = '1' then
+              credits(i) <= WEIGHTS(i) - 1;
+            else
+              credits(i) <= credits(i) - 1;
+            end if;
+          elsif round_done = '1' then
+            credits(i) <= WEIGHTS(i);
+          end if;
+        end loop;
+        if bcd_reset = '1' then
+          credits <= WEIGHTS;
+        end if;
+      end if;
+    end process;
+  end generate;
+
+  unweighted_gen: if ARB_METHOD /= "WEIGHTED" generate
+  begin
+    arb_eligible <= (others => '1');
+  end generate;
+
   -- Serialize/deserialize the arbiter input stream signals.
-  bms2arb_proc: process (bss_rreq_valid, bss_rreq_addr, bss_rreq_len) is
+  bms2arb_proc: process (bss_rreq_valid, bss_rreq_addr, bss_rreq_len, arb_eligible) is
   begin
     for i in 0 to NUM_SLAVE_PORTS-1 loop
-      arb_in_valid(i) <= bss_rreq_valid(i);
+      arb_in_valid(i) <= bss_rreq_valid(i) and arb_eligible(i);
       arb_in_data(i*BQI(BQI'high)+BQI(2)-1 downto i*BQI(BQI'high)+BQI(1)) <= bss_rreq_addr(i);
       arb_in_data(i*BQI(BQI'high)+BQI(1)-1 downto i*BQI(BQI'high)+BQI(0)) <= bss_rreq_len(i);
     end loop;
@@ -332,7 +456,7 @@ begin
       NUM_INPUTS                        => NUM_SLAVE_PORTS,
       INDEX_WIDTH                       => INDEX_WIDTH,
       DATA_WIDTH                        => BQI(BQI'high),
-      ARB_METHOD                        => ARB_METHOD
+      ARB_METHOD                        => stream_arb_method(ARB_METHOD)
     )
     port map (
       clk                               => bcd_clk,
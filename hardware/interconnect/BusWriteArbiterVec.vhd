@@ -40,8 +40,10 @@ entity BusWriteArbiterVec is
     -- Number of slaves ports to arbitrate between.
     NUM_SLAVE_PORTS             : natural := 2;
 
-    -- Arbitration method. Must be "ROUND-ROBIN" or "FIXED". If fixed,
-    -- lower-indexed masters take precedence.
+    -- Arbitration method. Must be "ROUND-ROBIN", "RR-STICKY", "FIXED" or
+    -- "WEIGHTED". If fixed, lower-indexed masters take precedence. If
+    -- weighted, every master may issue as many requests per round-robin round
+    -- as its weight in SLV_WEIGHTS.
     ARB_METHOD                  : string := "ROUND-ROBIN";
 
     -- Maximum number of outstanding requests. This is rounded upward to
@@ -61,7 +63,17 @@ entity BusWriteArbiterVec is
     MST_DAT_SLICE               : boolean := false;
 
     -- Whether a register slice should be inserted into the slave data ports
-    SLV_DAT_SLICES              : boolean := true
+    SLV_DAT_SLICES              : boolean := true;
+
+    -- Comma-separated arbitration weights of the slave ports, used by the
+    -- "WEIGHTED" arbitration method. Unspecified weights default to 1.
+    SLV_WEIGHTS                 : string := "";
+
+    -- Comma-separated FIFO depths of BusWriteBuffers to insert into the slave
+    -- ports. A buffer only issues a request when it holds the data of the
+    -- burst, such that a slow slave cannot stall the master port. Unspecified
+    -- or zero depths insert no buffer.
+    SLV_BUFFER_DEPTHS           : string := ""
 
   );
   port (
@@ -101,6 +113,18 @@ architecture Behavioral of BusWriteArbiterVec is
   -- Width of the index stream.
   constant INDEX_WIDTH          : natural := imax(1, log2ceil(NUM_SLAVE_PORTS));
 
+  -- Returns the arbitration weight of every slave port.
+  function slv_weight_array return nat_array is
+    variable res : nat_array(0 to NUM_SLAVE_PORTS-1);
+  begin
+    for i in res'range loop
+      res(i) := imax(1, parse_csv_nat(SLV_WEIGHTS, i, 1));
+    end loop;
+    return res;
+  end function;
+
+  constant WEIGHTS              : nat_array(0 to NUM_SLAVE_PORTS-1) := slv_weight_array;
+
   -- Type declarations for busses.
   subtype bus_addr_type   is std_logic_vector(BUS_ADDR_WIDTH-1   downto 0);
   subtype bus_len_type    is std_logic_vector(BUS_LEN_WIDTH-1    downto 0);
@@ -167,6 +191,9 @@ architecture Behavioral of BusWriteArbiterVec is
   signal bms_wdat_strobe        : bus_strobe_type;
   signal bms_wdat_last          : std_logic;
 
+  -- Slave ports that may issue requests to the arbiter.
+  signal arb_eligible           : std_logic_vector(0 to NUM_SLAVE_PORTS-1);
+
   -- Serialized arbiter input signals.
   signal arb_in_valid           : std_logic_vector(NUM_SLAVE_PORTS-1 downto 0);
   signal arb_in_ready           : std_logic_vector(NUM_SLAVE_PORTS-1 downto 0);
@@ -196,18 +223,67 @@ architecture Behavioral of BusWriteArbiterVec is
 
 begin
 
-  -- Connect the serialized slave ports to the internal arrays for convenience.
+  -- Connect the serialized slave ports to the internal arrays for convenience,
+  -- through a BusWriteBuffer if requested.
   serdes_gen: for i in 0 to NUM_SLAVE_PORTS-1 generate
+    constant BUFFER_DEPTH       : natural := parse_csv_nat(SLV_BUFFER_DEPTHS, i, 0);
   begin
-    bs_wreq_valid (i) <= bsv_wreq_valid(i);
-    bsv_wreq_ready(i) <= bs_wreq_ready (i);
-    bs_wreq_addr  (i) <= bsv_wreq_addr ((i+1)*BUS_ADDR_WIDTH-1 downto i*BUS_ADDR_WIDTH);
-    bs_wreq_len   (i) <= bsv_wreq_len  ((i+1)*BUS_LEN_WIDTH-1  downto i*BUS_LEN_WIDTH);
-    bs_wdat_valid (i) <= bsv_wdat_valid(i);
-    bsv_wdat_ready(i) <= bs_wdat_ready (i);
-    bs_wdat_data  (i) <= bsv_wdat_data((i+1)*BUS_DATA_WIDTH-1 downto i*BUS_DATA_WIDTH);
-    bs_wdat_strobe(i) <= bsv_wdat_strobe((i+1)*BUS_DATA_WIDTH/8-1 downto i*BUS_DATA_WIDTH/8);
-    bs_wdat_last  (i) <= bsv_wdat_last (i);
+    direct_gen: if BUFFER_DEPTH = 0 generate
+    begin
+      bs_wreq_valid (i) <= bsv_wreq_valid(i);
+      bsv_wreq_ready(i) <= bs_wreq_ready (i);
+      bs_wreq_addr  (i) <= bsv_wreq_addr ((i+1)*BUS_ADDR_WIDTH-1 downto i*BUS_ADDR_WIDTH);
+      bs_wreq_len   (i) <= bsv_wreq_len  ((i+1)*BUS_LEN_WIDTH-1  downto i*BUS_LEN_WIDTH);
+      bs_wdat_valid (i) <= bsv_wdat_valid(i);
+      bsv_wdat_ready(i) <= bs_wdat_ready (i);
+      bs_wdat_data  (i) <= bsv_wdat_data((i+1)*BUS_DATA_WIDTH-1 downto i*BUS_DATA_WIDTH);
+      bs_wdat_strobe(i) <= bsv_wdat_strobe((i+1)*BUS_DATA_WIDTH/8-1 downto i*BUS_DATA_WIDTH/8);
+      bs_wdat_last  (i) <= bsv_wdat_last (i);
+    end generate;
+
+    buffer_gen: if BUFFER_DEPTH > 0 generate
+    begin
+      buffer_inst: BusWriteBuffer
+        generic map (
+          BUS_ADDR_WIDTH                => BUS_ADDR_WIDTH,
+          BUS_LEN_WIDTH                 => BUS_LEN_WIDTH,
+          BUS_DATA_WIDTH                => BUS_DATA_WIDTH,
+          FIFO_DEPTH                    => BUFFER_DEPTH,
+          RAM_CONFIG                    => RAM_CONFIG,
+          SLV_REQ_SLICE                 => false,
+          MST_REQ_SLICE                 => false,
+          SLV_DAT_SLICE                 => false,
+          MST_DAT_SLICE                 => false
+        )
+        port map (
+          clk                           => bcd_clk,
+          reset                         => bcd_reset,
+          full                          => open,
+          empty                         => open,
+          count                         => open,
+
+          slv_wreq_valid                => bsv_wreq_valid(i),
+          slv_wreq_ready                => bsv_wreq_ready(i),
+          slv_wreq_addr                 => bsv_wreq_addr((i+1)*BUS_ADDR_WIDTH-1 downto i*BUS_ADDR_WIDTH),
+          slv_wreq_len                  => bsv_wreq_len((i+1)*BUS_LEN_WIDTH-1 downto i*BUS_LEN_WIDTH),
+          slv_wdat_valid                => bsv_wdat_valid(i),
+          slv_wdat_ready                => bsv_wdat_ready(i),
+          slv_wdat_data                 => bsv_wdat_data((i+1)*BUS_DATA_WIDTH-1 downto i*BUS_DATA_WIDTH),
+          slv_wdat_strobe               => bsv_wdat_strobe((i+1)*BUS_DATA_WIDTH/8-1 downto i*BUS_DATA_WIDTH/8),
+          slv_wdat_last                 => bsv_wdat_last(i),
+
+          mst_wreq_valid                => bs_wreq_valid(i),
+          mst_wreq_ready                => bs_wreq_ready(i),
+          mst_wreq_addr                 => bs_wreq_addr(i),
+          mst_wreq_len                  => bs_wreq_len(i),
+          mst_wdat_valid                => bs_wdat_valid(i),
+          mst_wdat_ready                => bs_wdat_ready(i),
+          mst_wdat_data                 => bs_wdat_data(i),
+          mst_wdat_strobe               => bs_wdat_strobe(i),
+          mst_wdat_ctrl                 => open,
+          mst_wdat_last                 => bs_wdat_last(i)
+        );
+    end generate;
   end generate;
 
   -- Instantiate register slices for the slave ports.
@@ -324,11 +400,66 @@ begin
   mst_wdat_data                         <= mwdato_sData(BPI(2)-1 downto BPI(1));
   mst_wdat_last                         <= mwdato_sData(BPI(0));
 
+  -- Determine which slave ports may issue requests. With weighted
+  -- arbitration, every slave port has a number of credits equal to its weight
+  -- at the start of a round, and spends one credit per request. A new round
+  -- starts when no slave port with credits left has a request pending.
+  weighted_gen: if ARB_METHOD = "WEIGHTED" generate
+    signal credits              : nat_array(0 to NUM_SLAVE_PORTS-1);
+    signal round_done           : std_logic;
+  begin
+    round_done_proc: process (bss_wreq_valid, credits) is
+    begin
+      round_done <= '1';
+      for i in 0 to NUM_SLAVE_PORTS-1 loop
+        if bss_wreq_valid(i) = '1' and credits(i) > 0 then
+          round_done <= '0';
+        end if;
+      end loop;
+    end process;
+
+    eligible_proc: process (credits, round_done) is
+    begin
+      for i in 0 to NUM_SLAVE_PORTS-1 loop
+        if credits(i) > 0 or round_done = '1' then
+          arb_eligible(i) <= '1';
+        else
+          arb_eligible(i) <= '0';
+        end if;
+      end loop;
+    end process;
+
+    credit_proc: process (bcd_clk) is
+    begin
+      if rising_edge(bcd_clk) then
+        for i in 0 to NUM_SLAVE_PORTS-1 loop
+          if arb_in_valid(i) = '1' and arb_in_ready(i) = '1' then
+            if round_done = '1' then
+              credits(i) <= WEIGHTS(i) - 1;
+            else
+              credits(i) <= credits(i) - 1;
+            end if;
+          elsif round_done = '1' then
+            credits(i) <= WEIGHTS(i);
+          end if;
+        end loop;
+        if bcd_reset = '1' then
+          credits <= WEIGHTS;
+        end if;
+      end if;
+    end process;
+  end generate;
+
+  unweighted_gen: if ARB_METHOD /= "WEIGHTED" generate
+  begin
+    arb_eligible <= (others => '1');
+  end generate;
+
   -- Concatenate the arbiter input stream signals.
-  bss2arb_proc: process (bss_wreq_valid, bss_wreq_addr, bss_wreq_len) is
+  bss2arb_proc: process (bss_wreq_valid, bss_wreq_addr, bss_wreq_len, arb_eligible) is
   begin
     for i in 0 to NUM_SLAVE_PORTS-1 loop
-      arb_in_valid(i) <= bss_wreq_valid(i);
+      arb_in_valid(i) <= bss_wreq_valid(i) and arb_eligible(i);
       arb_in_data(i*BQI(BQI'high)+BQI(2)-1 downto i*BQI(BQI'high)+BQI(1)) <= bss_wreq_addr(i);
       arb_in_data(i*BQI(BQI'high)+BQI(1)-1 downto i*BQI(BQI'high)+BQI(0)) <= bss_wreq_len(i);
     end loop;
@@ -346,7 +477,7 @@ begin
       NUM_INPUTS                        => NUM_SLAVE_PORTS,
       INDEX_WIDTH                       => INDEX_WIDTH,
       DATA_WIDTH                        => BQI(BQI'high),
-      ARB_METHOD                        => ARB_METHOD
+      ARB_METHOD                        => stream_arb_method(ARB_METHOD)
     )
     port map (
       clk                               => bcd_clk,
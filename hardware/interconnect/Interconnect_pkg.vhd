@@ -28,6 +28,19 @@ package Interconnect_pkg is
   -- This is currently set to the AXI4 specification of 4096 byte boundaries:
   constant BUS_BURST_BOUNDARY     : natural := 4096;
 
+  -----------------------------------------------------------------------------
+  -- Bus arbiter configuration
+  -----------------------------------------------------------------------------
+  -- Returns the idx'th natural of a comma-separated list of naturals, or
+  -- default_val if the list has no such element. This is used to configure
+  -- the slave ports of the bus arbiters individually, e.g. "4,1,1".
+  function parse_csv_nat(csv: string; idx: natural; default_val: natural) return natural;
+
+  -- Returns the method of the StreamArb of a bus arbiter with the given
+  -- arbitration method. The "WEIGHTED" method is implemented by the bus
+  -- arbiters on top of round-robin arbitration.
+  function stream_arb_method(method: string) return string;
+
   -- Bus write data bits covered by single write strobe bit.
   -- This is currently set to the AXI4 specification of 1 byte / strobe bit.
   -- There is no practical reason why this should ever change.
@@ -48,7 +61,9 @@ package Interconnect_pkg is
       SLV_REQ_SLICES            : boolean := true;
       MST_REQ_SLICE             : boolean := true;
       MST_DAT_SLICE             : boolean := true;
-      SLV_DAT_SLICES            : boolean := true
+      SLV_DAT_SLICES            : boolean := true;
+      SLV_WEIGHTS               : string  := "";
+      SLV_BUFFER_DEPTHS         : string  := ""
     );
     port (
       bcd_clk                   : in  std_logic;
@@ -86,7 +101,9 @@ package Interconnect_pkg is
       SLV_REQ_SLICES            : boolean := true;
       MST_REQ_SLICE             : boolean := true;
       MST_DAT_SLICE             : boolean := true;
-      SLV_DAT_SLICES            : boolean := true
+      SLV_DAT_SLICES            : boolean := true;
+      SLV_WEIGHTS               : string  := "";
+      SLV_BUFFER_DEPTHS         : string  := ""
     );
     port (
       bcd_clk                   : in  std_logic;
@@ -614,7 +631,11 @@ package Interconnect_pkg is
       SEED                      : positive := 1;
       RANDOM_REQUEST_TIMING     : boolean := true;
       RANDOM_RESPONSE_TIMING    : boolean := true;
-      SREC_FILE                 : string := ""
+      MEM_FORMAT                : string := "srec";
+      SREC_FILE                 : string := "";
+      LATENCY                   : natural := 0;
+      BEAT_CYCLES               : positive := 1;
+      MAX_OUTSTANDING           : positive := 1
     );
     port (
       clk                       : in  std_logic;
@@ -660,7 +681,9 @@ package Interconnect_pkg is
       SEED                      : positive;
       RANDOM_REQUEST_TIMING     : boolean := false;
       RANDOM_RESPONSE_TIMING    : boolean := false;
-      SREC_FILE                 : string  := ""
+      MEM_FORMAT                : string  := "srec";
+      SREC_FILE                 : string  := "";
+      BEAT_CYCLES               : positive := 1
     );
     port (
       clk                       : in  std_logic;
@@ -673,10 +696,48 @@ package Interconnect_pkg is
       wdat_ready                : out std_logic;
       wdat_data                 : in  std_logic_vector(BUS_DATA_WIDTH-1 downto 0);
       wdat_strobe               : in  std_logic_vector(BUS_DATA_WIDTH/8-1 downto 0);
-      wdat_last                 : in  std_logic
+      wdat_last                 : in  std_logic;
+      dump                      : in  std_logic := '0'
     );
   end component;
   
   -- pragma translate_on
   
 end Interconnect_pkg;
+
+package body Interconnect_pkg is
+
+  function parse_csv_nat(csv: string; idx: natural; default_val: natural) return natural is
+    variable cur    : natural := 0;
+    variable res    : natural := 0;
+    variable found  : boolean := false;
+  begin
+    for i in csv'range loop
+      if csv(i) = ',' then
+        cur := cur + 1;
+      elsif cur = idx then
+        if csv(i) >= '0' and csv(i) <= '9' then
+          res := res * 10 + character'pos(csv(i)) - character'pos('0');
+          found := true;
+        elsif csv(i) /= ' ' then
+          report "Cannot convert " & csv & " to a list of naturals" severity FAILURE;
+        end if;
+      end if;
+    end loop;
+    if found then
+      return res;
+    else
+      return default_val;
+    end if;
+  end function;
+
+  function stream_arb_method(method: string) return string is
+  begin
+    if method = "WEIGHTED" then
+      return "ROUND-ROBIN";
+    else
+      return method;
+    end if;
+  end function;
+
+end Interconnect_pkg;
@@ -0,0 +1,111 @@
+-- Copyright 2018-2019 Delft University of Technology
+--
+-- Licensed under the Apache License, Version 2.0 (the "License");
+-- you may not use this file except in compliance with the License.
+-- You may obtain a copy of the License at
+--
+--     http://www.apache.org/licenses/LICENSE-2.0
+--
+-- Unless required by applicable law or agreed to in writing, software
+-- distributed under the License is distributed on an "AS IS" BASIS,
+-- WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+-- See the License for the specific language governing permissions and
+-- limitations under the License.
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+library work;
+use work.UtilMem64_pkg.all;
+
+-- This simulation-only package loads and dumps the memory model of the bus
+-- slave mocks from and to raw binary memory images, as generated by Fletchgen
+-- with --sim_format bin. Byte i of the file corresponds to byte address i.
+
+package BusMemImage_pkg is
+
+  -- File of bytes.
+  type char_file_type is file of character;
+
+  -- Loads a raw binary memory image into the memory model, starting at
+  -- address 0.
+  procedure mem_loadBin(
+    mem   : inout mem_state_type;
+    fname : in    string
+  );
+
+  -- Dumps the first size bytes of the memory model to a raw binary memory
+  -- image. Undefined bytes are written as zero.
+  procedure mem_dumpBin(
+    mem   : inout mem_state_type;
+    fname : in    string;
+    size  : in    unsigned(63 downto 0)
+  );
+
+end package BusMemImage_pkg;
+
+package body BusMemImage_pkg is
+
+  procedure mem_loadBin(
+    mem   : inout mem_state_type;
+    fname : in    string
+  ) is
+    file     f    : char_file_type;
+    variable stat : file_open_status;
+    variable c    : character;
+    variable addr : unsigned(63 downto 0) := (others => '0');
+    variable data : std_logic_vector(63 downto 0);
+    variable idx  : natural;
+  begin
+    file_open(stat, f, fname, read_mode);
+    assert stat = open_ok
+      report "Could not open " & fname & " for reading."
+      severity failure;
+
+    -- Gather the bytes into little-endian 64-bit words.
+    while not endfile(f) loop
+      data := (others => '0');
+      idx := 0;
+      while idx < 8 and not endfile(f) loop
+        read(f, c);
+        data(idx*8+7 downto idx*8) := std_logic_vector(to_unsigned(character'pos(c), 8));
+        idx := idx + 1;
+      end loop;
+      mem_write(mem, std_logic_vector(addr), data);
+      addr := addr + 8;
+    end loop;
+
+    file_close(f);
+  end procedure;
+
+  procedure mem_dumpBin(
+    mem   : inout mem_state_type;
+    fname : in    string;
+    size  : in    unsigned(63 downto 0)
+  ) is
+    file     f    : char_file_type;
+    variable stat : file_open_status;
+    variable addr : unsigned(63 downto 0) := (others => '0');
+    variable data : std_logic_vector(63 downto 0);
+    variable byte : unsigned(7 downto 0);
+  begin
+    file_open(stat, f, fname, write_mode);
+    assert stat = open_ok
+      report "Could not open " & fname & " for writing."
+      severity failure;
+
+    while addr < size loop
+      mem_read(mem, std_logic_vector(addr), data);
+      for i in 0 to 7 loop
+        exit when addr + i >= size;
+        byte := to_01(unsigned(data(i*8+7 downto i*8)));
+        write(f, character'val(to_integer(byte)));
+      end loop;
+      addr := addr + 8;
+    end loop;
+
+    file_close(f);
+  end procedure;
+
+end package body BusMemImage_pkg;
@@ -21,10 +21,11 @@ library work;
 use work.Stream_pkg.all;
 use work.Interconnect_pkg.all;
 use work.UtilMem64_pkg.all;
+use work.BusMemImage_pkg.all;
 
 -- This simulation-only unit is a mockup of a bus slave that can either
--- respond based on an S-record file of the memory contents, or simply returns
--- the requested address as data. The handshake signals can be randomized.
+-- respond based on an S-record file or raw binary image of the memory
+-- contents, or simply returns the requested address as data. The handshake signals can be randomized.
 
 entity BusReadSlaveMock is
   generic (
@@ -48,9 +49,23 @@ entity BusReadSlaveMock is
     -- Whether to randomize the request stream handshake timing.
     RANDOM_RESPONSE_TIMING      : boolean := true;
 
-    -- S-record file to load into memory. If not specified, the unit reponds
-    -- with the requested address for each word.
-    SREC_FILE                   : string := ""
+    -- Format of SREC_FILE. Either "srec" for an S-record file, or "bin" for
+    -- a raw binary memory image.
+    MEM_FORMAT                  : string := "srec";
+
+    -- S-record file or binary image to load into memory. If not specified,
+    -- the unit reponds with the requested address for each word.
+    SREC_FILE                   : string := "";
+
+    -- Memory timing model. Requests are accepted while fewer than
+    -- MAX_OUTSTANDING bursts are outstanding. The first beat of a burst is
+    -- returned no earlier than LATENCY cycles after its request was accepted,
+    -- and a beat is returned at most once every BEAT_CYCLES cycles, such that
+    -- the bandwidth is BUS_DATA_WIDTH/8/BEAT_CYCLES bytes per cycle. The
+    -- defaults respond to one burst at a time, as fast as possible.
+    LATENCY                     : natural := 0;
+    BEAT_CYCLES                 : positive := 1;
+    MAX_OUTSTANDING             : positive := 1
 
   );
   port (
@@ -74,31 +89,52 @@ entity BusReadSlaveMock is
 end BusReadSlaveMock;
 
 architecture Behavioral of BusReadSlaveMock is
+
+  type addr_array is array (0 to MAX_OUTSTANDING-1) of unsigned(63 downto 0);
+  type natural_array is array (0 to MAX_OUTSTANDING-1) of natural;
+
+  -- Clock cycle counter, to time the responses.
+  signal cycle                  : natural := 0;
+
+  -- Circular buffer of accepted requests, with the cycle they were accepted
+  -- in. The head is written by the request handler, the tail by the response
+  -- handler. Both count up, such that head - tail requests are outstanding.
+  signal req_addr               : addr_array;
+  signal req_len                : natural_array;
+  signal req_cycle              : natural_array;
+  signal req_head               : natural := 0;
+  signal req_tail               : natural := 0;
+
 begin
 
-  -- Request handler. First accepts and ready's a command, then outputs the a
-  -- response burst as fast as possible.
-  process is
-    variable len    : natural;
-    variable addr   : unsigned(63 downto 0);
-    variable data   : std_logic_vector(BUS_DATA_WIDTH-1 downto 0);
-    variable mem    : mem_state_type;
+  cycle_proc: process (clk) is
+  begin
+    if rising_edge(clk) then
+      cycle <= cycle + 1;
+    end if;
+  end process;
+
+  -- Request handler. Accepts requests while there is room for them in the
+  -- buffer of outstanding requests.
+  req_proc: process is
+    variable head   : natural;
     variable seed1  : positive := SEED;
     variable seed2  : positive := 1;
     variable rand   : real;
   begin
-    if SREC_FILE /= "" then
-      mem_clear(mem);
-      mem_loadSRec(mem, SREC_FILE);
-    end if;
+    head := 0;
+    req_head <= 0;
 
     state: loop
 
       -- Reset state.
       rreq_ready <= '0';
-      rdat_valid <= '0';
-      rdat_data <= (others => '0');
-      rdat_last <= '0';
+
+      -- Wait until another request can be outstanding.
+      while head - req_tail >= MAX_OUTSTANDING loop
+        wait until rising_edge(clk);
+        exit state when reset = '1';
+      end loop;
 
       -- Delay randomly before accepting the next request, if enabled.
       if RANDOM_REQUEST_TIMING then
@@ -148,8 +184,61 @@ begin
 
       end if;
 
-      addr := resize(unsigned(rreq_addr), 64);
-      len := to_integer(unsigned(rreq_len));
+      -- Queue the request for the response handler.
+      req_addr(head mod MAX_OUTSTANDING) <= resize(unsigned(rreq_addr), 64);
+      req_len(head mod MAX_OUTSTANDING) <= to_integer(unsigned(rreq_len));
+      req_cycle(head mod MAX_OUTSTANDING) <= cycle;
+      head := head + 1;
+      req_head <= head;
+
+    end loop;
+  end process;
+
+  -- Response handler. Outputs the response bursts of the accepted requests in
+  -- order, according to the memory timing model.
+  rsp_proc: process is
+    variable tail   : natural;
+    variable len    : natural;
+    variable addr   : unsigned(63 downto 0);
+    variable data   : std_logic_vector(BUS_DATA_WIDTH-1 downto 0);
+    variable mem    : mem_state_type;
+    variable seed1  : positive := SEED + 1;
+    variable seed2  : positive := 1;
+    variable rand   : real;
+  begin
+    if SREC_FILE /= "" then
+      mem_clear(mem);
+      if MEM_FORMAT = "bin" then
+        mem_loadBin(mem, SREC_FILE);
+      else
+        mem_loadSRec(mem, SREC_FILE);
+      end if;
+    end if;
+    tail := 0;
+    req_tail <= 0;
+
+    state: loop
+
+      -- Reset state.
+      rdat_valid <= '0';
+      rdat_data <= (others => '0');
+      rdat_last <= '0';
+
+      -- Wait for an outstanding request.
+      loop
+        wait until rising_edge(clk);
+        exit state when reset = '1';
+        exit when req_head /= tail;
+      end loop;
+
+      addr := req_addr(tail mod MAX_OUTSTANDING);
+      len := req_len(tail mod MAX_OUTSTANDING);
+
+      -- Wait for the memory latency.
+      while cycle < req_cycle(tail mod MAX_OUTSTANDING) + LATENCY loop
+        wait until rising_edge(clk);
+        exit state when reset = '1';
+      end loop;
 
       for i in 0 to len-1 loop
 
@@ -187,10 +276,19 @@ begin
         end loop;
         rdat_valid <= '0';
 
+        -- Limit the bandwidth.
+        for c in 2 to BEAT_CYCLES loop
+          wait until rising_edge(clk);
+          exit state when reset = '1';
+        end loop;
+
         addr := addr + (BUS_DATA_WIDTH / 8);
 
       end loop;
 
+      tail := tail + 1;
+      req_tail <= tail;
+
     end loop;
   end process;
 
@@ -22,9 +22,10 @@ use work.Stream_pkg.all;
 use work.Interconnect_pkg.all;
 use work.UtilMem64_pkg.all;
 use work.UtilStr_pkg.all;
+use work.BusMemImage_pkg.all;
 
 -- This simulation-only unit is a mockup of a bus slave that can either write 
--- to an S-record file, or simply accept and print the written data on stdout.
+-- to an S-record file or raw binary memory image, or simply accept and print the written data on stdout.
 -- The handshake signals can be randomized.
 
 entity BusWriteSlaveMock is
@@ -49,9 +50,19 @@ entity BusWriteSlaveMock is
     -- Whether to randomize the request stream handshake timing.
     RANDOM_RESPONSE_TIMING      : boolean := true;
 
-    -- S-record file to dump writes. If not specified, the unit dumps the 
-    -- writes on stdout
-    SREC_FILE                   : string := ""
+    -- Format of SREC_FILE. Either "srec" for an S-record file, or "bin" for
+    -- a raw binary memory image. S-record files are rewritten after every
+    -- beat. Binary images are only written when dump is asserted.
+    MEM_FORMAT                  : string := "srec";
+
+    -- S-record file or binary image to dump writes. If not specified, the
+    -- unit dumps the writes on stdout
+    SREC_FILE                   : string := "";
+
+    -- Memory timing model. A beat is accepted at most once every BEAT_CYCLES
+    -- cycles, such that the bandwidth is BUS_DATA_WIDTH/8/BEAT_CYCLES bytes
+    -- per cycle.
+    BEAT_CYCLES                 : positive := 1
 
   );
   port (
@@ -70,7 +81,14 @@ entity BusWriteSlaveMock is
     wdat_ready                  : out std_logic;
     wdat_data                   : in  std_logic_vector(BUS_DATA_WIDTH-1 downto 0);
     wdat_strobe                 : in  std_logic_vector(BUS_DATA_WIDTH/8-1 downto 0);
-    wdat_last                   : in  std_logic
+    wdat_last                   : in  std_logic;
+
+    -- When MEM_FORMAT is "bin", the memory is dumped to SREC_FILE up to the
+    -- highest address written, on the first rising clock edge at which dump
+    -- is high and no burst is in progress, if anything was written since the
+    -- previous dump. Assert it once at the end of the simulation, and keep
+    -- the clock running for at least one more cycle.
+    dump                        : in  std_logic := '0'
 
   );
 end BusWriteSlaveMock;
@@ -98,6 +116,8 @@ begin
     variable addr   : unsigned(63 downto 0);
     variable data   : std_logic_vector(BUS_DATA_WIDTH-1 downto 0);
     variable mem    : mem_state_type;
+    variable top    : unsigned(63 downto 0) := (others => '0');
+    variable dirty  : boolean := false;
   begin
     if SREC_FILE /= "" then
       mem_clear(mem);
@@ -112,6 +132,10 @@ begin
       loop
         wait until rising_edge(clk);
         exit state when reset = '1';
+        if dirty and dump = '1' then
+          mem_dumpBin(mem, SREC_FILE, top);
+          dirty := false;
+        end if;
         exit when wreq_valid = '1';
       end loop;
 
@@ -141,7 +165,9 @@ begin
           println("Write > " & unsToHexNo0x(addr) & " > " & slvToHexNo0x(wdat_data));
         else
           mem_write(mem, std_logic_vector(addr), wdat_data);
-          mem_dumpSRec(mem, SREC_FILE);
+          if MEM_FORMAT /= "bin" then
+            mem_dumpSRec(mem, SREC_FILE);
+          end if;
         end if;
         
         -- Check the last signal
@@ -153,10 +179,28 @@ begin
 
         addr := addr + (BUS_DATA_WIDTH / 8);
 
+        -- Limit the bandwidth.
+        if BEAT_CYCLES > 1 then
+          wdat_ready <= '0';
+          for c in 2 to BEAT_CYCLES loop
+            wait until rising_edge(clk);
+            exit state when reset = '1';
+          end loop;
+        end if;
+
       end loop;
       
       -- Stop accepting data
       wdat_ready <= '0';
+
+      -- Binary images are dumped on request, up to the highest address
+      -- written so far.
+      if SREC_FILE /= "" and MEM_FORMAT = "bin" then
+        if addr > top then
+          top := addr;
+        end if;
+        dirty := true;
+      end if;
       
     end loop;
   end process;
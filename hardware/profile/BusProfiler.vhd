@@ -0,0 +1,223 @@
+-- Copyright 2018-2019 Delft University of Technology
+--
+-- Licensed under the Apache License, Version 2.0 (the "License");
+-- you may not use this file except in compliance with the License.
+-- You may obtain a copy of the License at
+--
+--     http://www.apache.org/licenses/LICENSE-2.0
+--
+-- Unless required by applicable law or agreed to in writing, software
+-- distributed under the License is distributed on an "AS IS" BASIS,
+-- WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+-- See the License for the specific language governing permissions and
+-- limitations under the License.
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+-- Profiles a bus read or write interface, as seen by a bus arbiter.
+--
+-- The probe consists of the handshake signals and burst length of the request
+-- channel, and the handshake signals and last flag of the data channel. The
+-- following is counted while the profiler is enabled:
+--
+--  - count_req_beats:       the number of beats requested, i.e. the sum of the
+--                           lengths of all accepted requests.
+--  - count_dat_beats:       the number of beats transferred on the data
+--                           channel.
+--  - count_req_stalls:      the number of cycles a request is valid, but not
+--                           accepted.
+--  - count_max_outstanding: the peak number of bursts that were requested,
+--                           but of which the last beat was not transferred yet.
+--  - count_cycles:          the number of cycles.
+--
+-- The number of outstanding bursts is tracked regardless of the enable signal,
+-- such that it is correct at any point in time. Clearing the profiler sets the
+-- peak to the current number of outstanding bursts.
+--
+-- The counters run in the clock domain of the probe (pcd), while the control
+-- inputs and count outputs are in the kernel clock domain (kcd). The enable
+-- level is synchronized into pcd, and the clear strobe is passed on through a
+-- toggle synchronizer. The counters are handed over to kcd with a handshake:
+-- kcd requests a copy, pcd latches the counters into holding registers and
+-- acknowledges, after which kcd copies the then stable holding registers to
+-- the count outputs.
+--
+-- A copy is requested on every kcd cycle in which snapshot is high, such that
+-- all counters are latched at the same time. A snapshot that arrives while a
+-- copy is in progress is requested once that copy completes. The outputs
+-- update a few cycles of both clocks after the snapshot. Snapshot defaults to
+-- high, in which case the outputs follow the counters with that delay. Busy is
+-- high from the kcd cycle after a snapshot until the count outputs hold it,
+-- such that the host can poll for the completion of a snapshot.
+entity BusProfiler is
+  generic (
+    BUS_LEN_WIDTH     : positive;
+    OUT_COUNT_WIDTH   : positive;
+
+    -- Number of synchronizer stages of the clock domain crossings.
+    XCLK_STAGES       : positive := 2
+  );
+  port (
+    pcd_clk               : in  std_logic;
+    pcd_reset             : in  std_logic;
+    kcd_clk               : in  std_logic;
+    kcd_reset             : in  std_logic;
+    probe_req_valid       : in  std_logic;
+    probe_req_ready       : in  std_logic;
+    probe_req_len         : in  std_logic_vector(BUS_LEN_WIDTH-1 downto 0);
+    probe_dat_valid       : in  std_logic;
+    probe_dat_ready       : in  std_logic;
+    probe_dat_last        : in  std_logic;
+    enable                : in  std_logic;
+    clear                 : in  std_logic;
+    snapshot              : in  std_logic := '1';
+    count_req_beats       : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+    count_dat_beats       : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+    count_req_stalls      : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+    count_max_outstanding : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+    count_cycles          : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+    busy                  : out std_logic
+  );
+end BusProfiler;
+
+architecture Behavioral of BusProfiler is
+
+  -- Holding registers in pcd, stable from an acknowledge until the next request.
+  signal hold_req_beats       : std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+  signal hold_dat_beats       : std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+  signal hold_req_stalls      : std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+  signal hold_max_outstanding : std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+  signal hold_cycles          : std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+
+  -- Clear toggle and handshake request in kcd, and their synchronizers in pcd.
+  -- The last stage of the clear synchronizer holds the previous value, to
+  -- detect the toggle.
+  signal kcd_clear_toggle     : std_logic := '0';
+  signal kcd_req              : std_logic := '0';
+  signal pcd_enable_sync      : std_logic_vector(XCLK_STAGES-1 downto 0) := (others => '0');
+  signal pcd_clear_sync       : std_logic_vector(XCLK_STAGES downto 0) := (others => '0');
+  signal pcd_req_sync         : std_logic_vector(XCLK_STAGES-1 downto 0) := (others => '0');
+
+  -- Handshake acknowledge in pcd, and its synchronizer in kcd. A request is
+  -- pending while the request and acknowledge differ.
+  signal pcd_ack              : std_logic := '0';
+  signal kcd_ack_sync         : std_logic_vector(XCLK_STAGES-1 downto 0) := (others => '0');
+
+begin
+
+pcd_proc: process(pcd_clk) is
+  constant ZERO_COUNT      : unsigned(OUT_COUNT_WIDTH-1 downto 0) := to_unsigned(0, OUT_COUNT_WIDTH);
+  variable req_beats       : unsigned(OUT_COUNT_WIDTH-1 downto 0) := ZERO_COUNT;
+  variable dat_beats       : unsigned(OUT_COUNT_WIDTH-1 downto 0) := ZERO_COUNT;
+  variable req_stalls      : unsigned(OUT_COUNT_WIDTH-1 downto 0) := ZERO_COUNT;
+  variable outstanding     : unsigned(OUT_COUNT_WIDTH-1 downto 0) := ZERO_COUNT;
+  variable max_outstanding : unsigned(OUT_COUNT_WIDTH-1 downto 0) := ZERO_COUNT;
+  variable cycles          : unsigned(OUT_COUNT_WIDTH-1 downto 0) := ZERO_COUNT;
+begin
+  if rising_edge(pcd_clk) then
+    if (probe_req_valid = '1') and (probe_req_ready = '1') then
+      outstanding := outstanding + 1;
+    end if;
+    if (probe_dat_valid = '1') and (probe_dat_ready = '1') and (probe_dat_last = '1') then
+      outstanding := outstanding - 1;
+    end if;
+
+    if (pcd_enable_sync(XCLK_STAGES-1) = '1') then
+      if (probe_req_valid = '1') and (probe_req_ready = '1') then
+        req_beats := req_beats + resize(unsigned(probe_req_len), OUT_COUNT_WIDTH);
+      end if;
+      if (probe_req_valid = '1') and (probe_req_ready = '0') then
+        req_stalls := req_stalls + 1;
+      end if;
+      if (probe_dat_valid = '1') and (probe_dat_ready = '1') then
+        dat_beats := dat_beats + 1;
+      end if;
+      if outstanding > max_outstanding then
+        max_outstanding := outstanding;
+      end if;
+
+      cycles := cycles + 1;
+    end if;
+
+    if (pcd_reset = '1') then
+      outstanding := ZERO_COUNT;
+    end if;
+
+    if (pcd_reset = '1') or (pcd_clear_sync(XCLK_STAGES) /= pcd_clear_sync(XCLK_STAGES-1)) then
+      req_beats       := ZERO_COUNT;
+      dat_beats       := ZERO_COUNT;
+      req_stalls      := ZERO_COUNT;
+      max_outstanding := outstanding;
+      cycles          := ZERO_COUNT;
+    end if;
+
+    -- Latch the counters on a request of kcd, and acknowledge it.
+    if (pcd_req_sync(XCLK_STAGES-1) /= pcd_ack) then
+      hold_req_beats       <= std_logic_vector(req_beats);
+      hold_dat_beats       <= std_logic_vector(dat_beats);
+      hold_req_stalls      <= std_logic_vector(req_stalls);
+      hold_max_outstanding <= std_logic_vector(max_outstanding);
+      hold_cycles          <= std_logic_vector(cycles);
+      pcd_ack <= pcd_req_sync(XCLK_STAGES-1);
+    end if;
+
+    pcd_enable_sync <= pcd_enable_sync(XCLK_STAGES-2 downto 0) & enable;
+    pcd_clear_sync  <= pcd_clear_sync(XCLK_STAGES-1 downto 0) & kcd_clear_toggle;
+    pcd_req_sync    <= pcd_req_sync(XCLK_STAGES-2 downto 0) & kcd_req;
+
+    if (pcd_reset = '1') then
+      pcd_ack <= '0';
+    end if;
+  end if;
+end process;
+
+kcd_proc: process(kcd_clk) is
+  variable waiting : boolean := false;
+  variable pending : boolean := false;
+begin
+  if rising_edge(kcd_clk) then
+    if (clear = '1') then
+      kcd_clear_toggle <= not kcd_clear_toggle;
+    end if;
+
+    if (snapshot = '1') then
+      pending := true;
+    end if;
+
+    -- Copy the holding registers once a request is acknowledged, and request
+    -- the next copy if a snapshot is pending.
+    if (kcd_ack_sync(XCLK_STAGES-1) = kcd_req) then
+      if waiting then
+        count_req_beats       <= hold_req_beats;
+        count_dat_beats       <= hold_dat_beats;
+        count_req_stalls      <= hold_req_stalls;
+        count_max_outstanding <= hold_max_outstanding;
+        count_cycles          <= hold_cycles;
+        waiting := false;
+      end if;
+      if pending then
+        kcd_req <= not kcd_req;
+        waiting := true;
+        pending := false;
+      end if;
+    end if;
+
+    kcd_ack_sync <= kcd_ack_sync(XCLK_STAGES-2 downto 0) & pcd_ack;
+
+    if (kcd_reset = '1') then
+      kcd_req <= '0';
+      waiting := false;
+      pending := false;
+    end if;
+
+    if waiting or pending then
+      busy <= '1';
+    else
+      busy <= '0';
+    end if;
+  end if;
+end process;
+
+end architecture;
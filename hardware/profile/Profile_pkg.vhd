@@ -21,7 +21,7 @@ package Profile_pkg is
   component Profiler is
     generic (
       PROBE_COUNT_WIDTH : positive := 1;
-      OUT_COUNT_WIDTH   : positive := 32
+      OUT_COUNT_WIDTH   : positive := 64
     );
     port (
       pcd_clk         : in  std_logic;
@@ -32,6 +32,7 @@ package Profile_pkg is
       probe_count     : in  std_logic_vector(PROBE_COUNT_WIDTH-1 downto 0) := std_logic_vector(to_unsigned(1, PROBE_COUNT_WIDTH));
       enable          : in  std_logic;
       clear           : in  std_logic;
+      snapshot        : in  std_logic := '1';
       count_elements  : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
       count_valids    : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
       count_readies   : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
@@ -41,4 +42,67 @@ package Profile_pkg is
     );
   end component;
 
+  component StallHistogram is
+    generic (
+      PROBE_COUNT_WIDTH : positive := 1;
+      OUT_COUNT_WIDTH   : positive := 64
+    );
+    port (
+      pcd_clk         : in  std_logic;
+      pcd_reset       : in  std_logic;
+      probe_valid     : in  std_logic;
+      probe_ready     : in  std_logic;
+      probe_last      : in  std_logic := '0';
+      probe_count     : in  std_logic_vector(PROBE_COUNT_WIDTH-1 downto 0) := (others => '0');
+      enable          : in  std_logic;
+      clear           : in  std_logic;
+      snapshot        : in  std_logic := '1';
+      count_stall_0   : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+      count_stall_1   : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+      count_stall_2   : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+      count_stall_3   : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+      count_stall_4   : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+      count_stall_5   : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+      count_stall_6   : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+      count_stall_7   : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+      count_starve_0  : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+      count_starve_1  : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+      count_starve_2  : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+      count_starve_3  : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+      count_starve_4  : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+      count_starve_5  : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+      count_starve_6  : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+      count_starve_7  : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0)
+    );
+  end component;
+
+  component BusProfiler is
+    generic (
+      BUS_LEN_WIDTH     : positive;
+      OUT_COUNT_WIDTH   : positive := 64;
+      XCLK_STAGES       : positive := 2
+    );
+    port (
+      pcd_clk               : in  std_logic;
+      pcd_reset             : in  std_logic;
+      kcd_clk               : in  std_logic;
+      kcd_reset             : in  std_logic;
+      probe_req_valid       : in  std_logic;
+      probe_req_ready       : in  std_logic;
+      probe_req_len         : in  std_logic_vector(BUS_LEN_WIDTH-1 downto 0);
+      probe_dat_valid       : in  std_logic;
+      probe_dat_ready       : in  std_logic;
+      probe_dat_last        : in  std_logic;
+      enable                : in  std_logic;
+      clear                 : in  std_logic;
+      snapshot              : in  std_logic := '1';
+      count_req_beats       : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+      count_dat_beats       : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+      count_req_stalls      : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+      count_max_outstanding : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+      count_cycles          : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+      busy                  : out std_logic
+    );
+  end component;
+
 end Profile_pkg;
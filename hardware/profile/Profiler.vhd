@@ -35,6 +35,7 @@ entity Profiler is
     probe_count     : in  std_logic_vector(PROBE_COUNT_WIDTH-1 downto 0) := std_logic_vector(to_unsigned(1, PROBE_COUNT_WIDTH));
     enable          : in  std_logic;
     clear           : in  std_logic;
+    snapshot        : in  std_logic := '1';
     count_elements  : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
     count_valids    : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
     count_readies   : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
@@ -65,6 +66,7 @@ begin
         readies := readies + 1;
       end if;
       if (probe_valid = '1') and (probe_ready = '1') then
+        elements  := elements + resize(unsigned(probe_count), OUT_COUNT_WIDTH);
         transfers := transfers + 1;
       end if;
       if (probe_valid = '1') and (probe_ready = '1') and (probe_last = '1') then
@@ -83,12 +85,16 @@ begin
       cycles    := ZERO_COUNT;
     end if;
 
-    count_elements  <= std_logic_vector(elements);
-    count_valids    <= std_logic_vector(valids);
-    count_readies   <= std_logic_vector(readies);
-    count_transfers <= std_logic_vector(transfers);
-    count_packets   <= std_logic_vector(packets);
-    count_cycles    <= std_logic_vector(cycles);
+    -- Latch all counters at the same time, such that they are consistent
+    -- with each other while they are read one register at a time.
+    if (snapshot = '1') then
+      count_elements  <= std_logic_vector(elements);
+      count_valids    <= std_logic_vector(valids);
+      count_readies   <= std_logic_vector(readies);
+      count_transfers <= std_logic_vector(transfers);
+      count_packets   <= std_logic_vector(packets);
+      count_cycles    <= std_logic_vector(cycles);
+    end if;
   end if;
 
 end process;
@@ -0,0 +1,161 @@
+-- Copyright 2018-2019 Delft University of Technology
+--
+-- Licensed under the Apache License, Version 2.0 (the "License");
+-- you may not use this file except in compliance with the License.
+-- You may obtain a copy of the License at
+--
+--     http://www.apache.org/licenses/LICENSE-2.0
+--
+-- Unless required by applicable law or agreed to in writing, software
+-- distributed under the License is distributed on an "AS IS" BASIS,
+-- WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+-- See the License for the specific language governing permissions and
+-- limitations under the License.
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+-- Builds histograms of the lengths of the stalls of a stream.
+--
+-- A stall is a run of consecutive cycles in which the stream is valid, but not
+-- ready, i.e. the sink applies backpressure. A starve is a run of consecutive
+-- cycles in which the stream is ready, but not valid, i.e. the sink waits for
+-- data. When a run ends, the bucket of its length is incremented:
+--
+--  - count_stall_<b>:  the number of stalls of 2**b up to 2**(b+1)-1 cycles.
+--  - count_starve_<b>: the number of starves of 2**b up to 2**(b+1)-1 cycles.
+--
+-- The last bucket also counts all longer runs. Runs are only tracked while the
+-- histogram is enabled.
+--
+-- The probe is the same as that of the Profiler, such that both can be
+-- attached to the same stream. The last and count signals are not used.
+--
+-- The count outputs are only updated while snapshot is high, such that all
+-- counters can be latched at the same time. It defaults to high, in which case
+-- the outputs follow the counters.
+entity StallHistogram is
+  generic (
+    PROBE_COUNT_WIDTH : positive;
+    OUT_COUNT_WIDTH   : positive
+  );
+  port (
+    pcd_clk         : in  std_logic;
+    pcd_reset       : in  std_logic;
+    probe_valid     : in  std_logic;
+    probe_ready     : in  std_logic;
+    probe_last      : in  std_logic := '0';
+    probe_count     : in  std_logic_vector(PROBE_COUNT_WIDTH-1 downto 0) := (others => '0');
+    enable          : in  std_logic;
+    clear           : in  std_logic;
+    snapshot        : in  std_logic := '1';
+    count_stall_0   : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+    count_stall_1   : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+    count_stall_2   : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+    count_stall_3   : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+    count_stall_4   : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+    count_stall_5   : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+    count_stall_6   : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+    count_stall_7   : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+    count_starve_0  : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+    count_starve_1  : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+    count_starve_2  : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+    count_starve_3  : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+    count_starve_4  : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+    count_starve_5  : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+    count_starve_6  : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0);
+    count_starve_7  : out std_logic_vector(OUT_COUNT_WIDTH-1 downto 0)
+  );
+end StallHistogram;
+
+architecture Behavioral of StallHistogram is
+
+  constant NUM_BUCKETS : natural := 8;
+
+  subtype count_type is unsigned(OUT_COUNT_WIDTH-1 downto 0);
+  type bucket_array is array (0 to NUM_BUCKETS-1) of count_type;
+
+  -- Run lengths saturate at the lower bound of the last bucket.
+  subtype run_type is unsigned(NUM_BUCKETS-1 downto 0);
+  constant RUN_MAX : run_type := to_unsigned(2**(NUM_BUCKETS-1), NUM_BUCKETS);
+
+  -- Returns the bucket of a non-zero run length, i.e. the index of its most
+  -- significant set bit.
+  function bucket(len : run_type) return natural is
+  begin
+    for i in NUM_BUCKETS-1 downto 1 loop
+      if len(i) = '1' then
+        return i;
+      end if;
+    end loop;
+    return 0;
+  end function;
+
+  signal stalls  : bucket_array;
+  signal starves : bucket_array;
+
+begin
+
+process(pcd_clk) is
+  constant ZERO_COUNT : count_type := to_unsigned(0, OUT_COUNT_WIDTH);
+  constant ZERO_RUN   : run_type := to_unsigned(0, NUM_BUCKETS);
+  variable stall_cnt  : bucket_array := (others => ZERO_COUNT);
+  variable starve_cnt : bucket_array := (others => ZERO_COUNT);
+  variable stall_len  : run_type := ZERO_RUN;
+  variable starve_len : run_type := ZERO_RUN;
+begin
+  if rising_edge(pcd_clk) then
+    if (enable = '1') then
+      if (probe_valid = '1') and (probe_ready = '0') then
+        if stall_len /= RUN_MAX then
+          stall_len := stall_len + 1;
+        end if;
+      elsif stall_len /= ZERO_RUN then
+        stall_cnt(bucket(stall_len)) := stall_cnt(bucket(stall_len)) + 1;
+        stall_len := ZERO_RUN;
+      end if;
+
+      if (probe_valid = '0') and (probe_ready = '1') then
+        if starve_len /= RUN_MAX then
+          starve_len := starve_len + 1;
+        end if;
+      elsif starve_len /= ZERO_RUN then
+        starve_cnt(bucket(starve_len)) := starve_cnt(bucket(starve_len)) + 1;
+        starve_len := ZERO_RUN;
+      end if;
+    end if;
+
+    if (pcd_reset = '1') or (clear = '1') then
+      stall_cnt  := (others => ZERO_COUNT);
+      starve_cnt := (others => ZERO_COUNT);
+      stall_len  := ZERO_RUN;
+      starve_len := ZERO_RUN;
+    end if;
+
+    if (snapshot = '1') then
+      stalls  <= stall_cnt;
+      starves <= starve_cnt;
+    end if;
+  end if;
+
+end process;
+
+count_stall_0  <= std_logic_vector(stalls(0));
+count_stall_1  <= std_logic_vector(stalls(1));
+count_stall_2  <= std_logic_vector(stalls(2));
+count_stall_3  <= std_logic_vector(stalls(3));
+count_stall_4  <= std_logic_vector(stalls(4));
+count_stall_5  <= std_logic_vector(stalls(5));
+count_stall_6  <= std_logic_vector(stalls(6));
+count_stall_7  <= std_logic_vector(stalls(7));
+count_starve_0 <= std_logic_vector(starves(0));
+count_starve_1 <= std_logic_vector(starves(1));
+count_starve_2 <= std_logic_vector(starves(2));
+count_starve_3 <= std_logic_vector(starves(3));
+count_starve_4 <= std_logic_vector(starves(4));
+count_starve_5 <= std_logic_vector(starves(5));
+count_starve_6 <= std_logic_vector(starves(6));
+count_starve_7 <= std_logic_vector(starves(7));
+
+end architecture;
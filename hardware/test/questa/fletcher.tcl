@@ -114,6 +114,7 @@ proc add_interconnect_tb {{source_dir ""}} {
   set source_dir [source_dir_or_default $source_dir]
   add_source $source_dir/interconnect/test/BusChecking_pkg.vhd
   add_source $source_dir/interconnect/test/BusProtocolChecker.vhd
+  add_source $source_dir/interconnect/test/BusMemImage_pkg.vhd
   add_source $source_dir/interconnect/test/BusReadSlaveMock.vhd
   add_source $source_dir/interconnect/test/BusReadMasterMock.vhd
   add_source $source_dir/interconnect/test/BusWriteSlaveMock.vhd
@@ -159,6 +160,7 @@ proc add_arrays {{source_dir ""}} {
   add_source $source_dir/arrays/ArrayWriterListPrim.vhd
   add_source $source_dir/arrays/ArrayWriterLevel.vhd
   add_source $source_dir/arrays/ArrayWriter.vhd
+  add_source $source_dir/arrays/ArrayDictionaryLookup.vhd
 }
 
 proc add_axi {{source_dir ""}} {
@@ -166,6 +168,7 @@ proc add_axi {{source_dir ""}} {
   set source_dir [source_dir_or_default $source_dir]
   add_source $source_dir/axi/Axi_pkg.vhd
   add_source $source_dir/axi/AxiMmio.vhd
+  add_source $source_dir/axi/AxiLiteDemux.vhd
   add_source $source_dir/axi/AxiWriteConverter.vhd
   add_source $source_dir/axi/AxiReadConverter.vhd
 }
@@ -29,6 +29,9 @@
 
 InitOptions options = {0};
 
+/// Register file used to echo written MMIO values back in non-interactive mode.
+static uint32_t registers[FLETCHER_ECHO_NUM_REGS] = {0};
+
 fstatus_t platformGetName(char *name, size_t size) {
   size_t len = strlen(FLETCHER_PLATFORM_NAME);
   if (len > size) {
@@ -49,6 +52,9 @@ fstatus_t platformInit(void *arg) {
 }
 
 fstatus_t platformWriteMMIO(uint64_t offset, uint32_t value) {
+  if (offset < FLETCHER_ECHO_NUM_REGS) {
+    registers[offset] = value;
+  }
   echo_print("[ECHO] Wrote MMIO register.       %04lu <= 0x%08X\n", offset, value);
   return FLETCHER_STATUS_OK;
 }
@@ -56,9 +62,15 @@ fstatus_t platformWriteMMIO(uint64_t offset, uint32_t value) {
 fstatus_t platformReadMMIO(uint64_t offset, uint32_t *value) {
   char buffer[256];
   unsigned long val = 0;
-  printf("[ECHO] Enter the value for MMIO register at offset %lu: 0x", offset);
-  fgets(buffer, 256, stdin);
-  val = strtoul(buffer, NULL, 16);
+  if (options.non_interactive) {
+    if (offset < FLETCHER_ECHO_NUM_REGS) {
+      val = registers[offset];
+    }
+  } else {
+    printf("[ECHO] Enter the value for MMIO register at offset %lu: 0x", offset);
+    fgets(buffer, 256, stdin);
+    val = strtoul(buffer, NULL, 16);
+  }
   *value = val;
   echo_print("[ECHO] Read MMIO register.       %04lu => 0x%08X\n", offset, *value);
   return FLETCHER_STATUS_OK;
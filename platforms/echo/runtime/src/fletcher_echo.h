@@ -22,9 +22,15 @@
 /// Alignment for allocations.
 #define FLETCHER_ECHO_ALIGNMENT 4096
 
+/// Number of MMIO registers that are remembered when the platform is not interactive.
+#define FLETCHER_ECHO_NUM_REGS 65536
+
 /// Platform options.
 typedef struct {
+  /// Suppress printing to stdout.
   int quiet;
+  /// Do not read MMIO values from stdin, but return the last value written to the register.
+  int non_interactive;
 } InitOptions;
 
 /// @brief Store the platform name in a buffer of size /p size pointed to by /p name.
@@ -37,7 +43,12 @@ fstatus_t platformInit(void *arg);
 /// @brief Write \p value to MMIO register \p offset.
 fstatus_t platformWriteMMIO(uint64_t offset, uint32_t value);
 
-/// @brief Read MMIO register \p offset into \p value. For the Echo platform, the value is taken from stdin.
+/**
+ * @brief Read MMIO register \p offset into \p value.
+ *
+ * For the Echo platform, the value is taken from stdin, unless the platform was initialized with the non_interactive
+ * option set. In that case, the last value written to the register is returned (or zero if it was never written).
+ */
 fstatus_t platformReadMMIO(uint64_t offset, uint32_t *value);
 
 /// @brief Copy \p size bytes from host address \p host_source to device address \p device_destination.
@@ -0,0 +1,89 @@
+-- Copyright 2018-2019 Delft University of Technology
+--
+-- Licensed under the Apache License, Version 2.0 (the "License");
+-- you may not use this file except in compliance with the License.
+-- You may obtain a copy of the License at
+--
+--     http://www.apache.org/licenses/LICENSE-2.0
+--
+-- Unless required by applicable law or agreed to in writing, software
+-- distributed under the License is distributed on an "AS IS" BASIS,
+-- WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+-- See the License for the specific language governing permissions and
+-- limitations under the License.
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+-- Foreign subprograms of the Sim platform simulator bridge.
+--
+-- These are implemented in C by fletcher_sim_bridge.c and called through
+-- GHDL's VHPIDIRECT interface. Elaborate the design with the bridge, e.g.:
+--
+--   ghdl -e --std=08 -Wl,-lfletcher_sim_bridge CosimTop
+--
+-- The bodies in this package are only called if the simulator does not
+-- support VHPIDIRECT.
+package SimBridge_pkg is
+
+  -- Request operations, see fletcher_sim_shm.h.
+  constant SIM_OP_NONE  : integer := 0;
+  constant SIM_OP_WRITE : integer := 1;
+  constant SIM_OP_READ  : integer := 2;
+  constant SIM_OP_STOP  : integer := 3;
+
+  -- Wait for the host to create the shared memory segment and attach to it.
+  impure function sim_attach return integer;
+  attribute foreign of sim_attach : function is "VHPIDIRECT fletcher_sim_attach";
+
+  -- Obtain the oldest pending MMIO request without completing it. op is
+  -- SIM_OP_NONE if there is none.
+  procedure sim_poll(op : out integer; offset : out integer; value : out integer);
+  attribute foreign of sim_poll : procedure is "VHPIDIRECT fletcher_sim_poll";
+
+  -- Complete the oldest pending MMIO request, returning value for reads.
+  procedure sim_complete(value : in integer);
+  attribute foreign of sim_complete : procedure is "VHPIDIRECT fletcher_sim_complete";
+
+  -- Read the 32-bit word of device memory at a byte address.
+  impure function sim_mem_read(addr_hi : integer; addr_lo : integer) return integer;
+  attribute foreign of sim_mem_read : function is "VHPIDIRECT fletcher_sim_mem_read";
+
+  -- Write the bytes of a 32-bit word of device memory at a byte address that
+  -- are enabled in the 4-bit strobe.
+  procedure sim_mem_write(addr_hi : in integer; addr_lo : in integer; data : in integer; strobe : in integer);
+  attribute foreign of sim_mem_write : procedure is "VHPIDIRECT fletcher_sim_mem_write";
+
+end package;
+
+package body SimBridge_pkg is
+
+  impure function sim_attach return integer is
+  begin
+    report "VHPIDIRECT fletcher_sim_attach" severity failure;
+    return -1;
+  end function;
+
+  procedure sim_poll(op : out integer; offset : out integer; value : out integer) is
+  begin
+    report "VHPIDIRECT fletcher_sim_poll" severity failure;
+  end procedure;
+
+  procedure sim_complete(value : in integer) is
+  begin
+    report "VHPIDIRECT fletcher_sim_complete" severity failure;
+  end procedure;
+
+  impure function sim_mem_read(addr_hi : integer; addr_lo : integer) return integer is
+  begin
+    report "VHPIDIRECT fletcher_sim_mem_read" severity failure;
+    return 0;
+  end function;
+
+  procedure sim_mem_write(addr_hi : in integer; addr_lo : in integer; data : in integer; strobe : in integer) is
+  begin
+    report "VHPIDIRECT fletcher_sim_mem_write" severity failure;
+  end procedure;
+
+end package body;
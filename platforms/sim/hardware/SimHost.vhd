@@ -0,0 +1,262 @@
+-- Copyright 2018-2019 Delft University of Technology
+--
+-- Licensed under the Apache License, Version 2.0 (the "License");
+-- you may not use this file except in compliance with the License.
+-- You may obtain a copy of the License at
+--
+--     http://www.apache.org/licenses/LICENSE-2.0
+--
+-- Unless required by applicable law or agreed to in writing, software
+-- distributed under the License is distributed on an "AS IS" BASIS,
+-- WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+-- See the License for the specific language governing permissions and
+-- limitations under the License.
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+library work;
+use work.SimBridge_pkg.all;
+
+-- Host model of the Sim platform.
+--
+-- Attaches to the shared memory segment of a host program that uses the Sim
+-- platform library. The MMIO requests of the host are performed in order as
+-- AXI4-lite transfers on the mmio master port. The read and write slave ports
+-- serve the bus requests of the design from the device memory of the segment,
+-- one burst at a time and one beat per cycle.
+--
+-- When the host terminates the platform, stop is asserted, after which the
+-- clocks of the simulation should be stopped.
+entity SimHost is
+  generic (
+    BUS_ADDR_WIDTH              : natural := 64;
+    BUS_LEN_WIDTH               : natural := 8;
+    BUS_DATA_WIDTH              : natural := 512
+  );
+  port (
+    clk                         : in  std_logic;
+    reset                       : in  std_logic;
+    stop                        : out std_logic;
+
+    mmio_awvalid                : out std_logic;
+    mmio_awready                : in  std_logic;
+    mmio_awaddr                 : out std_logic_vector(31 downto 0);
+    mmio_wvalid                 : out std_logic;
+    mmio_wready                 : in  std_logic;
+    mmio_wdata                  : out std_logic_vector(31 downto 0);
+    mmio_wstrb                  : out std_logic_vector(3 downto 0);
+    mmio_bvalid                 : in  std_logic;
+    mmio_bready                 : out std_logic;
+    mmio_bresp                  : in  std_logic_vector(1 downto 0);
+    mmio_arvalid                : out std_logic;
+    mmio_arready                : in  std_logic;
+    mmio_araddr                 : out std_logic_vector(31 downto 0);
+    mmio_rvalid                 : in  std_logic;
+    mmio_rready                 : out std_logic;
+    mmio_rdata                  : in  std_logic_vector(31 downto 0);
+    mmio_rresp                  : in  std_logic_vector(1 downto 0);
+
+    rreq_valid                  : in  std_logic := '0';
+    rreq_ready                  : out std_logic;
+    rreq_addr                   : in  std_logic_vector(BUS_ADDR_WIDTH-1 downto 0) := (others => '0');
+    rreq_len                    : in  std_logic_vector(BUS_LEN_WIDTH-1 downto 0) := (others => '0');
+    rdat_valid                  : out std_logic;
+    rdat_ready                  : in  std_logic := '1';
+    rdat_data                   : out std_logic_vector(BUS_DATA_WIDTH-1 downto 0);
+    rdat_last                   : out std_logic;
+
+    wreq_valid                  : in  std_logic := '0';
+    wreq_ready                  : out std_logic;
+    wreq_addr                   : in  std_logic_vector(BUS_ADDR_WIDTH-1 downto 0) := (others => '0');
+    wreq_len                    : in  std_logic_vector(BUS_LEN_WIDTH-1 downto 0) := (others => '0');
+    wdat_valid                  : in  std_logic := '0';
+    wdat_ready                  : out std_logic;
+    wdat_data                   : in  std_logic_vector(BUS_DATA_WIDTH-1 downto 0) := (others => '0');
+    wdat_strobe                 : in  std_logic_vector(BUS_DATA_WIDTH/8-1 downto 0) := (others => '0');
+    wdat_last                   : in  std_logic := '0'
+  );
+end SimHost;
+
+architecture Behavioral of SimHost is
+
+  constant WORDS : natural := BUS_DATA_WIDTH/32;
+
+  function hi(addr : unsigned(63 downto 0)) return integer is
+  begin
+    return to_integer(signed(addr(63 downto 32)));
+  end function;
+
+  function lo(addr : unsigned(63 downto 0)) return integer is
+  begin
+    return to_integer(signed(addr(31 downto 0)));
+  end function;
+
+begin
+
+  assert BUS_DATA_WIDTH mod 32 = 0
+    report "SimHost requires a bus data width that is a multiple of 32 bits."
+    severity failure;
+
+  mmio_proc: process is
+    variable attached : integer;
+    variable op       : integer;
+    variable offset   : integer;
+    variable value    : integer;
+  begin
+    stop         <= '0';
+    mmio_awvalid <= '0';
+    mmio_wvalid  <= '0';
+    mmio_bready  <= '0';
+    mmio_arvalid <= '0';
+    mmio_rready  <= '0';
+
+    attached := sim_attach;
+
+    loop
+      wait until rising_edge(clk);
+      if reset = '0' then
+        sim_poll(op, offset, value);
+        case op is
+          when SIM_OP_WRITE =>
+            -- Address write channel
+            mmio_awaddr  <= std_logic_vector(to_unsigned(4 * offset, 32));
+            mmio_awvalid <= '1';
+            loop
+              wait until rising_edge(clk);
+              exit when mmio_awready = '1';
+            end loop;
+            mmio_awvalid <= '0';
+            -- Write channel
+            mmio_wdata  <= std_logic_vector(to_signed(value, 32));
+            mmio_wstrb  <= X"F";
+            mmio_wvalid <= '1';
+            loop
+              wait until rising_edge(clk);
+              exit when mmio_wready = '1';
+            end loop;
+            mmio_wvalid <= '0';
+            -- Write response channel
+            mmio_bready <= '1';
+            loop
+              wait until rising_edge(clk);
+              exit when mmio_bvalid = '1';
+            end loop;
+            mmio_bready <= '0';
+            sim_complete(0);
+
+          when SIM_OP_READ =>
+            -- Address read channel
+            mmio_araddr  <= std_logic_vector(to_unsigned(4 * offset, 32));
+            mmio_arvalid <= '1';
+            loop
+              wait until rising_edge(clk);
+              exit when mmio_arready = '1';
+            end loop;
+            mmio_arvalid <= '0';
+            -- Read channel
+            mmio_rready <= '1';
+            loop
+              wait until rising_edge(clk);
+              exit when mmio_rvalid = '1';
+            end loop;
+            mmio_rready <= '0';
+            sim_complete(to_integer(signed(mmio_rdata)));
+
+          when SIM_OP_STOP =>
+            sim_complete(0);
+            report "Host terminated the platform.";
+            stop <= '1';
+            wait;
+
+          when others =>
+            null;
+        end case;
+      end if;
+    end loop;
+  end process;
+
+  rd_proc: process is
+    variable addr : unsigned(63 downto 0);
+    variable len  : natural;
+    variable data : std_logic_vector(BUS_DATA_WIDTH-1 downto 0);
+  begin
+    rreq_ready <= '0';
+    rdat_valid <= '0';
+    rdat_last  <= '0';
+
+    loop
+      -- Accept a request.
+      rreq_ready <= '1';
+      loop
+        wait until rising_edge(clk);
+        exit when (reset = '0') and (rreq_valid = '1');
+      end loop;
+      rreq_ready <= '0';
+      addr := resize(unsigned(rreq_addr), 64);
+      len  := to_integer(unsigned(rreq_len));
+
+      -- Return a beat of device memory per cycle.
+      for i in 0 to len-1 loop
+        for w in 0 to WORDS-1 loop
+          data(32*w+31 downto 32*w) := std_logic_vector(to_signed(sim_mem_read(hi(addr), lo(addr)), 32));
+          addr := addr + 4;
+        end loop;
+        rdat_data  <= data;
+        rdat_valid <= '1';
+        if i = len-1 then
+          rdat_last <= '1';
+        else
+          rdat_last <= '0';
+        end if;
+        loop
+          wait until rising_edge(clk);
+          exit when rdat_ready = '1';
+        end loop;
+      end loop;
+      rdat_valid <= '0';
+      rdat_last  <= '0';
+    end loop;
+  end process;
+
+  wr_proc: process is
+    variable addr : unsigned(63 downto 0);
+    variable len  : natural;
+  begin
+    wreq_ready <= '0';
+    wdat_ready <= '0';
+
+    loop
+      -- Accept a request.
+      wreq_ready <= '1';
+      loop
+        wait until rising_edge(clk);
+        exit when (reset = '0') and (wreq_valid = '1');
+      end loop;
+      wreq_ready <= '0';
+      addr := resize(unsigned(wreq_addr), 64);
+      len  := to_integer(unsigned(wreq_len));
+
+      -- Write a beat to device memory per cycle.
+      wdat_ready <= '1';
+      for i in 0 to len-1 loop
+        loop
+          wait until rising_edge(clk);
+          exit when wdat_valid = '1';
+        end loop;
+        for w in 0 to WORDS-1 loop
+          sim_mem_write(hi(addr), lo(addr),
+                        to_integer(signed(wdat_data(32*w+31 downto 32*w))),
+                        to_integer(unsigned(wdat_strobe(4*w+3 downto 4*w))));
+          addr := addr + 4;
+        end loop;
+        assert (i /= len-1) or (wdat_last = '1')
+          report "Last signal not asserted on the last beat of a write burst."
+          severity error;
+      end loop;
+      wdat_ready <= '0';
+    end loop;
+  end process;
+
+end architecture;
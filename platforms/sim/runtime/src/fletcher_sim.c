@@ -0,0 +1,365 @@
+// Copyright 2018-2019 Delft University of Technology
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <memory.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "fletcher/fletcher.h"
+
+#include "./fletcher_sim.h"
+#include "./fletcher_sim_shm.h"
+
+#define CHECK_STATUS(identifier) if (identifier != FLETCHER_STATUS_OK) { \
+                                   return status;                        \
+                                 }                                       \
+                                 (void)0
+
+#define sim_print(...) do { if (!options.quiet) fprintf(stdout, __VA_ARGS__); } while (0)
+#define sim_error(...) fprintf(stderr, __VA_ARGS__)
+
+InitOptions options = {0};
+
+/// Name of the shared memory segment.
+static char shm_name[256] = {0};
+
+/// The shared memory segment, or NULL if the platform is not initialized.
+static SimShm *shm = NULL;
+
+/// An allocation in device memory.
+typedef struct SimBlock {
+  /// Offset in device memory.
+  uint64_t offset;
+  /// Size in bytes, rounded up to the alignment.
+  uint64_t size;
+  /// Next allocation, in order of increasing offset.
+  struct SimBlock *next;
+} SimBlock;
+
+/// Device memory allocations, in order of increasing offset.
+static SimBlock *blocks = NULL;
+
+/// Host-side statistics of a session.
+static struct {
+  uint64_t writes;
+  uint64_t reads;
+  uint64_t bytes_to_device;
+  uint64_t bytes_to_host;
+  uint64_t wait_ns;
+} stats = {0};
+
+static uint64_t now_ns(void) {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (uint64_t) t.tv_sec * 1000000000ULL + (uint64_t) t.tv_nsec;
+}
+
+/// @brief Wait until \p flag is non-zero.
+static fstatus_t wait_flag(const uint32_t *flag, const char *what) {
+  uint64_t start = now_ns();
+  while (!fletcher_sim_load(flag)) {
+    if ((options.timeout != 0) && (now_ns() - start > options.timeout * 1000000000ULL)) {
+      sim_error("[SIM] Timeout while waiting for %s.\n", what);
+      return FLETCHER_STATUS_ERROR;
+    }
+    sched_yield();
+  }
+  return FLETCHER_STATUS_OK;
+}
+
+/// @brief Wait until the simulator has completed \p count requests.
+static fstatus_t wait_completed(uint64_t count) {
+  uint64_t start = now_ns();
+  fstatus_t status = FLETCHER_STATUS_OK;
+  while (fletcher_sim_load(&shm->tail) < count) {
+    if (fletcher_sim_load(&shm->stopped)) {
+      sim_error("[SIM] Simulator stopped with pending requests.\n");
+      status = FLETCHER_STATUS_ERROR;
+      break;
+    }
+    if ((options.timeout != 0) && (now_ns() - start > options.timeout * 1000000000ULL)) {
+      sim_error("[SIM] Timeout while waiting for the simulator.\n");
+      status = FLETCHER_STATUS_ERROR;
+      break;
+    }
+    sched_yield();
+  }
+  stats.wait_ns += now_ns() - start;
+  return status;
+}
+
+/// @brief Push a request into the ring and store its index in \p index.
+static fstatus_t push_request(uint32_t op, uint32_t offset, uint32_t value, uint64_t *index) {
+  fstatus_t status;
+  uint64_t head = shm->head;
+  SimRequest *req = &shm->ring[head % FLETCHER_SIM_RING_SIZE];
+
+  if (head >= FLETCHER_SIM_RING_SIZE) {
+    // Wait for the slot to be free.
+    status = wait_completed(head - FLETCHER_SIM_RING_SIZE + 1);
+    CHECK_STATUS(status);
+  }
+  req->op = op;
+  req->offset = offset;
+  req->value = value;
+  fletcher_sim_store(&shm->head, head + 1);
+  *index = head;
+  return FLETCHER_STATUS_OK;
+}
+
+/// @brief Return the offset in device memory of \p size bytes at \p address, or -1 if they are out of bounds.
+static int64_t mem_offset(da_t address, int64_t size) {
+  if ((address < FLETCHER_SIM_MEM_BASE) || (size < 0)
+      || (address - FLETCHER_SIM_MEM_BASE + (uint64_t) size > shm->mem_size)) {
+    sim_error("[SIM] Device address 0x%016lX (%ld bytes) is out of bounds.\n", (unsigned long) address, (long) size);
+    return -1;
+  }
+  return (int64_t) (address - FLETCHER_SIM_MEM_BASE);
+}
+
+fstatus_t platformGetName(char *name, size_t size) {
+  size_t len = strlen(FLETCHER_PLATFORM_NAME);
+  if (len > size) {
+    memcpy(name, FLETCHER_PLATFORM_NAME, size - 1);
+    name[size - 1] = '\0';
+  } else {
+    memcpy(name, FLETCHER_PLATFORM_NAME, len + 1);
+  }
+  return FLETCHER_STATUS_OK;
+}
+
+fstatus_t platformInit(void *arg) {
+  const char *env;
+  int fd;
+  void *addr;
+
+  if (arg != NULL) {
+    options = *(InitOptions *) arg;
+  }
+  if (options.shm_name == NULL) {
+    env = getenv("FLETCHER_SIM_SHM");
+    options.shm_name = env != NULL ? env : FLETCHER_SIM_DEFAULT_SHM;
+  }
+  if (options.mem_size == 0) {
+    env = getenv("FLETCHER_SIM_MEM_SIZE");
+    options.mem_size = env != NULL ? strtoull(env, NULL, 0) : FLETCHER_SIM_DEFAULT_MEM_SIZE;
+  }
+  strncpy(shm_name, options.shm_name, sizeof(shm_name) - 1);
+  options.shm_name = shm_name;
+
+  // Remove any segment left behind by a session that did not terminate, and create a new one.
+  shm_unlink(shm_name);
+  fd = shm_open(shm_name, O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+  if (fd < 0) {
+    sim_error("[SIM] Could not create shared memory segment %s.\n", shm_name);
+    return FLETCHER_STATUS_ERROR;
+  }
+  if (ftruncate(fd, (off_t) FLETCHER_SIM_SHM_SIZE(options.mem_size)) != 0) {
+    sim_error("[SIM] Could not size shared memory segment %s.\n", shm_name);
+    close(fd);
+    shm_unlink(shm_name);
+    return FLETCHER_STATUS_ERROR;
+  }
+  addr = mmap(NULL, FLETCHER_SIM_SHM_SIZE(options.mem_size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) {
+    sim_error("[SIM] Could not map shared memory segment %s.\n", shm_name);
+    shm_unlink(shm_name);
+    return FLETCHER_STATUS_ERROR;
+  }
+  shm = (SimShm *) addr;
+  shm->version = FLETCHER_SIM_VERSION;
+  shm->mem_size = options.mem_size;
+  fletcher_sim_store(&shm->magic, FLETCHER_SIM_MAGIC);
+
+  sim_print("[SIM] Initializing platform.       Waiting for simulator on %s (%lu bytes of device memory).\n",
+            shm_name,
+            (unsigned long) options.mem_size);
+  if (wait_flag(&shm->attached, "the simulator to attach") != FLETCHER_STATUS_OK) {
+    munmap(shm, FLETCHER_SIM_SHM_SIZE(options.mem_size));
+    shm = NULL;
+    shm_unlink(shm_name);
+    return FLETCHER_STATUS_ERROR;
+  }
+  sim_print("[SIM] Simulator attached.\n");
+  return FLETCHER_STATUS_OK;
+}
+
+fstatus_t platformWriteMMIO(uint64_t offset, uint32_t value) {
+  uint64_t index;
+  fstatus_t status = push_request(FLETCHER_SIM_OP_WRITE, (uint32_t) offset, value, &index);
+  CHECK_STATUS(status);
+  stats.writes++;
+  return FLETCHER_STATUS_OK;
+}
+
+fstatus_t platformReadMMIO(uint64_t offset, uint32_t *value) {
+  uint64_t index;
+  fstatus_t status = push_request(FLETCHER_SIM_OP_READ, (uint32_t) offset, 0, &index);
+  CHECK_STATUS(status);
+  status = wait_completed(index + 1);
+  CHECK_STATUS(status);
+  *value = shm->ring[index % FLETCHER_SIM_RING_SIZE].value;
+  stats.reads++;
+  return FLETCHER_STATUS_OK;
+}
+
+fstatus_t platformCopyHostToDevice(const uint8_t *host_source, da_t device_destination, int64_t size) {
+  int64_t offset = mem_offset(device_destination, size);
+  if (offset < 0) {
+    return FLETCHER_STATUS_ERROR;
+  }
+  memcpy(FLETCHER_SIM_MEM(shm) + offset, host_source, (size_t) size);
+  stats.bytes_to_device += size;
+  return FLETCHER_STATUS_OK;
+}
+
+fstatus_t platformCopyDeviceToHost(da_t device_source, uint8_t *host_destination, int64_t size) {
+  int64_t offset = mem_offset(device_source, size);
+  if (offset < 0) {
+    return FLETCHER_STATUS_ERROR;
+  }
+  memcpy(host_destination, FLETCHER_SIM_MEM(shm) + offset, (size_t) size);
+  stats.bytes_to_host += size;
+  return FLETCHER_STATUS_OK;
+}
+
+fstatus_t platformTerminate(void *arg) {
+  uint64_t index;
+  SimBlock *block;
+  fstatus_t status = FLETCHER_STATUS_OK;
+
+  (void) arg;
+  if (shm == NULL) {
+    return FLETCHER_STATUS_OK;
+  }
+  // Stop the simulator once it has completed all requests.
+  if (!fletcher_sim_load(&shm->stopped)) {
+    status = push_request(FLETCHER_SIM_OP_STOP, 0, 0, &index);
+    if (status == FLETCHER_STATUS_OK) {
+      status = wait_completed(index + 1);
+    }
+  }
+  sim_print("[SIM] Terminating platform.        %lu MMIO writes, %lu MMIO reads, %lu bytes to device, "
+            "%lu bytes to host, %.3f s waiting for the simulator.\n",
+            (unsigned long) stats.writes,
+            (unsigned long) stats.reads,
+            (unsigned long) stats.bytes_to_device,
+            (unsigned long) stats.bytes_to_host,
+            stats.wait_ns / 1E9);
+
+  while (blocks != NULL) {
+    block = blocks;
+    blocks = block->next;
+    free(block);
+  }
+  munmap(shm, FLETCHER_SIM_SHM_SIZE(options.mem_size));
+  shm = NULL;
+  shm_unlink(shm_name);
+  return status;
+}
+
+fstatus_t platformDeviceMalloc(da_t *device_address, int64_t size) {
+  uint64_t aligned = ((uint64_t) size + FLETCHER_SIM_ALIGNMENT - 1) & ~((uint64_t) FLETCHER_SIM_ALIGNMENT - 1);
+  uint64_t offset = 0;
+  SimBlock **link = &blocks;
+  SimBlock *block;
+
+  // First fit: find the first gap between allocations that is large enough.
+  while ((*link != NULL) && ((*link)->offset - offset < aligned)) {
+    offset = (*link)->offset + (*link)->size;
+    link = &(*link)->next;
+  }
+  if ((size < 0) || (offset + aligned > shm->mem_size)) {
+    sim_error("[SIM] Could not allocate %ld bytes of device memory.\n", (long) size);
+    return FLETCHER_STATUS_DEVICE_OUT_OF_MEMORY;
+  }
+  block = (SimBlock *) malloc(sizeof(SimBlock));
+  if (block == NULL) {
+    return FLETCHER_STATUS_ERROR;
+  }
+  block->offset = offset;
+  block->size = aligned;
+  block->next = *link;
+  *link = block;
+
+  *device_address = FLETCHER_SIM_MEM_BASE + offset;
+  sim_print("[SIM] Allocating device memory.    [device] 0x%016lX (%10lu bytes).\n",
+            (unsigned long) *device_address,
+            (unsigned long) size);
+  return FLETCHER_STATUS_OK;
+}
+
+fstatus_t platformDeviceFree(da_t device_address) {
+  SimBlock **link = &blocks;
+  SimBlock *block;
+
+  while ((*link != NULL) && (FLETCHER_SIM_MEM_BASE + (*link)->offset != device_address)) {
+    link = &(*link)->next;
+  }
+  if (*link == NULL) {
+    sim_error("[SIM] Device address 0x%016lX was not allocated.\n", (unsigned long) device_address);
+    return FLETCHER_STATUS_ERROR;
+  }
+  block = *link;
+  *link = block->next;
+  free(block);
+  sim_print("[SIM] Freeing device memory.       [device] 0x%016lX.\n", (unsigned long) device_address);
+  return FLETCHER_STATUS_OK;
+}
+
+fstatus_t platformPrepareHostBuffer(const uint8_t *host_source, da_t *device_destination, int64_t size, int *alloced) {
+  fstatus_t status;
+
+  // The simulator can only access the device memory, so allocate a copy there.
+  status = platformDeviceMalloc(device_destination, size);
+  CHECK_STATUS(status);
+  // We have newly allocated the buffer, signal this back to the caller.
+  *alloced = 1;
+
+  // Copy data
+  status = platformCopyHostToDevice(host_source, *device_destination, size);
+
+  sim_print("[SIM] Prepared buffer on device.   [host] 0x%016lX --> 0x%016lX (%10lu bytes).\n",
+            (unsigned long) host_source,
+            (unsigned long) *device_destination,
+            (unsigned long) size);
+
+  return status;
+}
+
+fstatus_t platformCacheHostBuffer(const uint8_t *host_source, da_t *device_destination, int64_t size) {
+  fstatus_t status;
+
+  // Allocate new memory.
+  status = platformDeviceMalloc(device_destination, size);
+  CHECK_STATUS(status);
+
+  // Copy data
+  status = platformCopyHostToDevice(host_source, *device_destination, size);
+
+  sim_print("[SIM] Cached buffer on device.     [host] 0x%016lX --> 0x%016lX (%10lu bytes).\n",
+            (unsigned long) host_source,
+            (unsigned long) *device_destination,
+            (unsigned long) size);
+
+  return status;
+}
@@ -0,0 +1,111 @@
+// Copyright 2018-2019 Delft University of Technology
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <unistd.h>
+
+#include "fletcher/fletcher.h"
+
+/// Platform name.
+#define FLETCHER_PLATFORM_NAME "sim"
+
+/// Alignment for allocations.
+#define FLETCHER_SIM_ALIGNMENT 4096
+
+/// Platform options.
+typedef struct {
+  /// Name of the shared memory segment, or NULL to use $FLETCHER_SIM_SHM or FLETCHER_SIM_DEFAULT_SHM.
+  const char *shm_name;
+  /// Size of the device memory in bytes, or zero to use $FLETCHER_SIM_MEM_SIZE or FLETCHER_SIM_DEFAULT_MEM_SIZE.
+  uint64_t mem_size;
+  /// Seconds to wait for the simulator to attach or to complete a request. Zero waits forever.
+  unsigned int timeout;
+  /// Suppress printing to stdout.
+  int quiet;
+} InitOptions;
+
+/// @brief Store the platform name in a buffer of size /p size pointed to by /p name.
+fstatus_t platformGetName(char *name, size_t size);
+
+/**
+ * @brief Initialize the platform. \p arg may point to a null pointer or an InitOptions structure.
+ *
+ * Creates the shared memory segment and waits for the simulator to attach to it.
+ */
+fstatus_t platformInit(void *arg);
+
+/**
+ * @brief Write \p value to MMIO register \p offset.
+ *
+ * Writes are posted; this only waits for the simulator if the request ring is full.
+ */
+fstatus_t platformWriteMMIO(uint64_t offset, uint32_t value);
+
+/**
+ * @brief Read MMIO register \p offset into \p value.
+ *
+ * Waits until the simulator has performed all preceding requests and the read itself.
+ */
+fstatus_t platformReadMMIO(uint64_t offset, uint32_t *value);
+
+/// @brief Copy \p size bytes from host address \p host_source to device address \p device_destination.
+fstatus_t platformCopyHostToDevice(const uint8_t *host_source, da_t device_destination, int64_t size);
+
+/// @brief Copy \p size bytes from device address \p device_source to host address \p host_destination.
+fstatus_t platformCopyDeviceToHost(da_t device_source, uint8_t *host_destination, int64_t size);
+
+/**
+ * @brief Allocate \p size bytes on the device.
+ *
+ * For the Sim platform, this allocates memory in the device memory of the shared memory segment, which the bus models
+ * of the simulator read from and write to.
+ */
+fstatus_t platformDeviceMalloc(da_t *device_address, int64_t size);
+
+/// @brief Free the memory allocated at \p device_address.
+fstatus_t platformDeviceFree(da_t device_address);
+
+/**
+ * @brief Ensure the device can read \p size bytes from a host buffer at \p host_source.
+ *
+ * The simulated device cannot access host memory, so this allocates device memory and copies the buffer to it.
+ *
+ * @param host_source           Host address of the source data.
+ * @param device_destination    Pointer to store the device destination address at.
+ * @param size                  Number of bytes to prepare.
+ * @param alloced               Whether the buffer caused a new allocation on the device, that should be freed after
+ *                              usage (0 = not alloced, 1 = alloced).
+ * @return                      FLETCHER_STATUS_OK if successful, FLETCHER_STATUS_ERROR otherwise.
+ */
+fstatus_t platformPrepareHostBuffer(const uint8_t *host_source, da_t *device_destination, int64_t size, int *alloced);
+
+/**
+ * @brief Explicitly cache \p size bytes from \p host_source on device on-board memory.
+ *
+ * @param host_source           Host address of the source data.
+ * @param device_destination    Pointer to store the device destination address at.
+ * @param size                  Number of bytes to prepare.
+ * @return                      FLETCHER_STATUS_OK if successful, FLETCHER_STATUS_ERROR otherwise.
+ */
+fstatus_t platformCacheHostBuffer(const uint8_t *host_source, da_t *device_destination, int64_t size);
+
+/**
+ * @brief Terminate the platform.
+ *
+ * Stops the simulator, prints the host-side statistics of the session unless quiet, and removes the shared memory
+ * segment.
+ *
+ * @param arg                   Arguments for termination.
+ * @return                      FLETCHER_STATUS_OK if successful, FLETCHER_STATUS_ERROR otherwise.
+ */
+fstatus_t platformTerminate(void *arg);
@@ -0,0 +1,160 @@
+// Copyright 2018-2019 Delft University of Technology
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Simulator side of the Sim platform.
+//
+// These functions are called from the SimHost VHDL model through GHDL's VHPIDIRECT interface (see SimBridge_pkg.vhd),
+// or from a Verilator design through DPI-C. All arguments are 32-bit integers, such that they map onto VHDL integers
+// and SystemVerilog ints. Byte addresses are split into a high and a low word.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "./fletcher_sim_shm.h"
+
+/// The shared memory segment.
+static SimShm *shm = NULL;
+
+/// Number of requests completed.
+static uint64_t tail = 0;
+
+/// @brief Return a pointer to the 32-bit word of device memory at a byte address, or NULL if it is out of bounds.
+static uint8_t *mem_word(int32_t addr_hi, int32_t addr_lo) {
+  uint64_t addr = ((uint64_t) (uint32_t) addr_hi << 32u) | (uint32_t) addr_lo;
+  if ((shm == NULL) || (addr < FLETCHER_SIM_MEM_BASE) || (addr - FLETCHER_SIM_MEM_BASE + 4 > shm->mem_size)) {
+    return NULL;
+  }
+  return FLETCHER_SIM_MEM(shm) + (addr - FLETCHER_SIM_MEM_BASE);
+}
+
+/// @brief Try to attach to the segment \p name. Return 1 if successful.
+static int try_attach(const char *name) {
+  SimShm *header;
+  uint64_t mem_size;
+  uint32_t expected = 0;
+  int fd = shm_open(name, O_RDWR, 0);
+  if (fd < 0) {
+    return 0;
+  }
+  // Check the header first; the host may still be initializing the segment.
+  header = (SimShm *) mmap(NULL, sizeof(SimShm), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (header == MAP_FAILED) {
+    close(fd);
+    return 0;
+  }
+  if ((fletcher_sim_load(&header->magic) != FLETCHER_SIM_MAGIC) || (header->version != FLETCHER_SIM_VERSION)) {
+    munmap(header, sizeof(SimShm));
+    close(fd);
+    return 0;
+  }
+  mem_size = header->mem_size;
+  munmap(header, sizeof(SimShm));
+
+  shm = (SimShm *) mmap(NULL, FLETCHER_SIM_SHM_SIZE(mem_size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (shm == MAP_FAILED) {
+    shm = NULL;
+    return 0;
+  }
+  // Only attach to a segment no other simulator is attached to.
+  if (!__atomic_compare_exchange_n(&shm->attached, &expected, 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+    munmap(shm, FLETCHER_SIM_SHM_SIZE(mem_size));
+    shm = NULL;
+    return 0;
+  }
+  tail = fletcher_sim_load(&shm->tail);
+  return 1;
+}
+
+/**
+ * @brief Attach to the shared memory segment of the host.
+ *
+ * The name of the segment is taken from $FLETCHER_SIM_SHM, or FLETCHER_SIM_DEFAULT_SHM if it is not set. Waits until
+ * the host has created the segment.
+ *
+ * @return 0 if successful, -1 otherwise.
+ */
+int32_t fletcher_sim_attach(void) {
+  const char *name = getenv("FLETCHER_SIM_SHM");
+  struct timespec delay = {0, 10000000};
+  if (name == NULL) {
+    name = FLETCHER_SIM_DEFAULT_SHM;
+  }
+  fprintf(stdout, "[SIM] Waiting for host on %s.\n", name);
+  while (!try_attach(name)) {
+    nanosleep(&delay, NULL);
+  }
+  fprintf(stdout, "[SIM] Attached to host.\n");
+  return 0;
+}
+
+/**
+ * @brief Obtain the oldest pending request, without completing it.
+ * @param op     FLETCHER_SIM_OP_NONE if there is no pending request, the operation otherwise.
+ * @param offset Register word offset.
+ * @param value  Value to write.
+ */
+void fletcher_sim_poll(int32_t *op, int32_t *offset, int32_t *value) {
+  const SimRequest *req;
+  if ((shm == NULL) || (fletcher_sim_load(&shm->head) == tail)) {
+    *op = FLETCHER_SIM_OP_NONE;
+    return;
+  }
+  req = &shm->ring[tail % FLETCHER_SIM_RING_SIZE];
+  *op = (int32_t) req->op;
+  *offset = (int32_t) req->offset;
+  *value = (int32_t) req->value;
+}
+
+/// @brief Complete the oldest pending request. For reads, \p value is returned to the host.
+void fletcher_sim_complete(int32_t value) {
+  SimRequest *req = &shm->ring[tail % FLETCHER_SIM_RING_SIZE];
+  if (req->op == FLETCHER_SIM_OP_STOP) {
+    fletcher_sim_store(&shm->stopped, 1);
+  }
+  req->value = (uint32_t) value;
+  tail++;
+  fletcher_sim_store(&shm->tail, tail);
+}
+
+/// @brief Read the 32-bit word of device memory at a byte address. Out of bounds words read as zero.
+int32_t fletcher_sim_mem_read(int32_t addr_hi, int32_t addr_lo) {
+  uint8_t *word = mem_word(addr_hi, addr_lo);
+  if (word == NULL) {
+    return 0;
+  }
+  return (int32_t) ((uint32_t) word[0] | (uint32_t) word[1] << 8u | (uint32_t) word[2] << 16u
+      | (uint32_t) word[3] << 24u);
+}
+
+/// @brief Write the bytes of a 32-bit word of device memory at a byte address that are enabled in \p strobe.
+void fletcher_sim_mem_write(int32_t addr_hi, int32_t addr_lo, int32_t data, int32_t strobe) {
+  uint8_t *word = mem_word(addr_hi, addr_lo);
+  int i;
+  if (word == NULL) {
+    return;
+  }
+  for (i = 0; i < 4; i++) {
+    if (strobe & (1 << i)) {
+      word[i] = (uint8_t) ((uint32_t) data >> (8u * i));
+    }
+  }
+}
@@ -0,0 +1,97 @@
+// Copyright 2018-2019 Delft University of Technology
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * Layout of the shared memory segment between the Sim platform library and the simulator bridge.
+ *
+ * The segment starts with a SimShm header, followed by the device memory at FLETCHER_SIM_MEM_OFFSET. The host pushes
+ * MMIO requests into the ring and advances head. The simulator performs them in order on the MMIO interface of the
+ * design, stores the value of reads in the request and advances tail. The device memory is accessed directly by the
+ * host for copies and by the bus models of the simulator.
+ *
+ * Both indices only ever increase; the slot of a request is its index modulo FLETCHER_SIM_RING_SIZE. Every index is
+ * written by one side only, with release semantics, and read by the other side with acquire semantics.
+ */
+
+/// Magic number at the start of an initialized segment.
+#define FLETCHER_SIM_MAGIC 0x464C5343u
+
+/// Version of the segment layout.
+#define FLETCHER_SIM_VERSION 1u
+
+/// Default name of the shared memory segment.
+#define FLETCHER_SIM_DEFAULT_SHM "/fletcher_sim"
+
+/// Default size of the device memory in bytes.
+#define FLETCHER_SIM_DEFAULT_MEM_SIZE (256ULL * 1024 * 1024)
+
+/// Number of request slots in the ring.
+#define FLETCHER_SIM_RING_SIZE 256
+
+/// Offset of the device memory in the segment.
+#define FLETCHER_SIM_MEM_OFFSET 65536
+
+/// Device address of the first byte of device memory. It is non-zero, such that no allocation is a null pointer.
+#define FLETCHER_SIM_MEM_BASE 0x10000000ULL
+
+/// Request operations.
+#define FLETCHER_SIM_OP_NONE  0u
+#define FLETCHER_SIM_OP_WRITE 1u
+#define FLETCHER_SIM_OP_READ  2u
+#define FLETCHER_SIM_OP_STOP  3u
+
+/// An MMIO request.
+typedef struct {
+  /// Operation.
+  uint32_t op;
+  /// Register word offset.
+  uint32_t offset;
+  /// Value to write, or the value read after completion.
+  uint32_t value;
+  /// Padding.
+  uint32_t reserved;
+} SimRequest;
+
+/// Shared memory segment header.
+typedef struct {
+  /// FLETCHER_SIM_MAGIC, written last by the host when the segment is initialized.
+  uint32_t magic;
+  /// FLETCHER_SIM_VERSION.
+  uint32_t version;
+  /// Size of the device memory in bytes.
+  uint64_t mem_size;
+  /// Set by the simulator when it has attached to the segment.
+  uint32_t attached;
+  /// Set by the simulator when it has stopped.
+  uint32_t stopped;
+  /// Number of requests pushed by the host.
+  uint64_t head;
+  /// Number of requests completed by the simulator.
+  uint64_t tail;
+  /// Request slots.
+  SimRequest ring[FLETCHER_SIM_RING_SIZE];
+} SimShm;
+
+/// Size of the whole segment for \p mem_size bytes of device memory.
+#define FLETCHER_SIM_SHM_SIZE(mem_size) (FLETCHER_SIM_MEM_OFFSET + (mem_size))
+
+/// Pointer to the device memory of the segment at \p shm.
+#define FLETCHER_SIM_MEM(shm) ((uint8_t *) (shm) + FLETCHER_SIM_MEM_OFFSET)
+
+#define fletcher_sim_load(ptr) __atomic_load_n(ptr, __ATOMIC_ACQUIRE)
+#define fletcher_sim_store(ptr, val) __atomic_store_n(ptr, val, __ATOMIC_RELEASE)
@@ -0,0 +1,223 @@
+// Copyright 2018 Delft University of Technology
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks for the host-side overhead of the Fletcher runtime.
+//
+// All benchmarks run against the echo platform in non-interactive mode, such that MMIO reads return the last value
+// written to a register. This allows the polling round trip to be measured without a device or user input.
+
+#include <fletcher/fletcher.h>
+#include <arrow/api.h>
+#include <fletcher_echo.h>
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "fletcher/api.h"
+
+namespace fletcher {
+
+/// Smallest and largest number of columns (and thereby buffers) to benchmark with.
+constexpr int64_t kMinColumns = 1;
+constexpr int64_t kMaxColumns = 10000;
+
+/// Smallest and largest RecordBatch size in bytes to benchmark with.
+constexpr int64_t kMinBytes = 1L << 10;
+constexpr int64_t kMaxBytes = 1L << 30;
+
+/// RecordBatch size in bytes used by benchmarks that scale with the number of columns.
+constexpr int64_t kColumnBenchBytes = 1L << 20;
+
+/// @brief Return a quiet, non-interactive echo platform.
+static std::shared_ptr<Platform> MakeEchoPlatform(benchmark::State *state) {
+  static InitOptions options;
+  options.quiet = 1;
+  options.non_interactive = 1;
+
+  std::shared_ptr<Platform> platform;
+  if (!Platform::Make("echo", &platform).ok()) {
+    state->SkipWithError("Could not create echo platform.");
+    return nullptr;
+  }
+  platform->init_data = &options;
+  if (!platform->Init().ok()) {
+    state->SkipWithError("Could not initialize echo platform.");
+    return nullptr;
+  }
+  return platform;
+}
+
+/**
+ * @brief Create a RecordBatch with non-nullable uint64 columns, resulting in exactly one buffer per column.
+ *
+ * All columns share the same values buffer of num_bytes / num_columns bytes, so the host memory footprint is only that
+ * one buffer. num_bytes is the logical size of the RecordBatch, as reported through SetBytesProcessed, and not the
+ * amount of host memory that is allocated or touched.
+ *
+ * @param num_columns The number of columns.
+ * @param num_bytes   The logical number of bytes to spread over the columns.
+ * @return            The RecordBatch.
+ */
+static std::shared_ptr<arrow::RecordBatch> MakeBatch(int64_t num_columns, int64_t num_bytes) {
+  int64_t num_rows = std::max<int64_t>(1, num_bytes / num_columns / static_cast<int64_t>(sizeof(uint64_t)));
+  std::shared_ptr<arrow::Buffer> values = arrow::AllocateBuffer(num_rows * sizeof(uint64_t)).ValueOrDie();
+  // Touch all pages, such that the first iteration does not pay for page faults.
+  std::memset(values->mutable_data(), 0, values->size());
+
+  std::vector<std::shared_ptr<arrow::Field>> fields;
+  std::vector<std::shared_ptr<arrow::Array>> columns;
+  auto column = std::make_shared<arrow::UInt64Array>(num_rows, values);
+  for (int64_t i = 0; i < num_columns; i++) {
+    fields.push_back(arrow::field("c" + std::to_string(i), arrow::uint64(), false));
+    columns.push_back(column);
+  }
+  return arrow::RecordBatch::Make(arrow::schema(fields), num_rows, columns);
+}
+
+/// @brief Set the benchmark counters that are common to all benchmarks in this file.
+static void SetCounters(benchmark::State *state, const Context &context, int64_t bytes) {
+  auto buffers = static_cast<double>(context.num_buffers());
+  state->counters["buffers"] = buffers;
+  state->counters["buffer_rate"] = benchmark::Counter(buffers, benchmark::Counter::kIsIterationInvariantRate);
+  state->SetBytesProcessed(state->iterations() * bytes);
+}
+
+/// @brief Measure analyzing and queueing a RecordBatch in a fresh Context.
+static void BM_QueueRecordBatch(benchmark::State &state) {
+  auto platform = MakeEchoPlatform(&state);
+  if (platform == nullptr) return;
+  auto batch = MakeBatch(state.range(0), state.range(1));
+  std::shared_ptr<Context> context;
+  for (auto _ : state) {
+    state.PauseTiming();
+    context.reset();
+    Context::Make(&context, platform);
+    state.ResumeTiming();
+    auto status = context->QueueRecordBatch(batch);
+    benchmark::DoNotOptimize(status);
+  }
+  SetCounters(&state, *context, 0);
+}
+
+/// @brief Measure making the buffers of a queued RecordBatch available to the device.
+static void BM_Enable(benchmark::State &state) {
+  auto platform = MakeEchoPlatform(&state);
+  if (platform == nullptr) return;
+  auto batch = MakeBatch(state.range(0), state.range(1));
+  std::shared_ptr<Context> context;
+  for (auto _ : state) {
+    state.PauseTiming();
+    // Destructing the context frees the device buffers of the previous iteration.
+    context.reset();
+    Context::Make(&context, platform);
+    context->QueueRecordBatch(batch);
+    state.ResumeTiming();
+    auto status = context->Enable();
+    benchmark::DoNotOptimize(status);
+  }
+  SetCounters(&state, *context, state.range(1));
+}
+
+/// @brief Measure writing the RecordBatch ranges and buffer addresses to the MMIO registers.
+static void BM_WriteMetaData(benchmark::State &state) {
+  auto platform = MakeEchoPlatform(&state);
+  if (platform == nullptr) return;
+  auto batch = MakeBatch(state.range(0), state.range(1));
+  std::shared_ptr<Context> context;
+  Context::Make(&context, platform);
+  context->QueueRecordBatch(batch);
+  context->Enable();
+  Kernel kernel(context);
+  for (auto _ : state) {
+    auto status = kernel.WriteMetaData();
+    benchmark::DoNotOptimize(status);
+  }
+  SetCounters(&state, *context, 0);
+}
+
+/// @brief Measure starting a kernel of which the metadata was already written.
+static void BM_Start(benchmark::State &state) {
+  auto platform = MakeEchoPlatform(&state);
+  if (platform == nullptr) return;
+  auto batch = MakeBatch(state.range(0), state.range(1));
+  std::shared_ptr<Context> context;
+  Context::Make(&context, platform);
+  context->QueueRecordBatch(batch);
+  context->Enable();
+  Kernel kernel(context);
+  kernel.WriteMetaData();
+  for (auto _ : state) {
+    auto status = kernel.Start();
+    benchmark::DoNotOptimize(status);
+  }
+  SetCounters(&state, *context, 0);
+}
+
+/// @brief Measure a complete launch: setting the range, starting, polling until done and reading the return value.
+static void BM_LaunchRoundTrip(benchmark::State &state) {
+  auto platform = MakeEchoPlatform(&state);
+  if (platform == nullptr) return;
+  auto batch = MakeBatch(state.range(0), state.range(1));
+  std::shared_ptr<Context> context;
+  Context::Make(&context, platform);
+  context->QueueRecordBatch(batch);
+  context->Enable();
+  Kernel kernel(context);
+  kernel.WriteMetaData();
+  uint32_t ret0 = 0;
+  uint32_t ret1 = 0;
+  for (auto _ : state) {
+    kernel.SetRange(0, 0, static_cast<int32_t>(batch->num_rows()));
+    kernel.Start();
+    // The echo platform returns the last value written, so act as if the kernel immediately finished.
+    platform->WriteMMIO(FLETCHER_REG_STATUS, kernel.done_status);
+    kernel.PollUntilDone();
+    kernel.GetReturn(&ret0, &ret1);
+    benchmark::DoNotOptimize(ret0);
+    benchmark::DoNotOptimize(ret1);
+  }
+  SetCounters(&state, *context, 0);
+}
+
+/// @brief Arguments for benchmarks that scale with the number of columns.
+static void ColumnArgs(benchmark::internal::Benchmark *b) {
+  b->ArgNames({"columns", "bytes"});
+  for (int64_t c = kMinColumns; c <= kMaxColumns; c *= 10) {
+    b->Args({c, kColumnBenchBytes});
+  }
+}
+
+/// @brief Arguments for benchmarks that scale with the number of bytes.
+static void ByteArgs(benchmark::internal::Benchmark *b) {
+  b->ArgNames({"columns", "bytes"});
+  for (int64_t s = kMinBytes; s <= kMaxBytes; s *= 32) {
+    b->Args({1, s});
+    b->Args({100, s});
+  }
+}
+
+BENCHMARK(BM_QueueRecordBatch)->Apply(ColumnArgs);
+BENCHMARK(BM_Enable)->Apply(ColumnArgs);
+BENCHMARK(BM_Enable)->Apply(ByteArgs)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_WriteMetaData)->Apply(ColumnArgs);
+BENCHMARK(BM_Start)->Apply(ColumnArgs);
+BENCHMARK(BM_LaunchRoundTrip)->Apply(ColumnArgs);
+
+}  // namespace fletcher
+
+BENCHMARK_MAIN();
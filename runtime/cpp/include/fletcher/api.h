@@ -29,6 +29,7 @@
 #include "fletcher/context.h"
 #include "fletcher/platform.h"
 #include "fletcher/kernel.h"
+#include "fletcher/profiler.h"
 
 /// Contains all Fletcher classes and functions for use in run-time applications.
 namespace fletcher {
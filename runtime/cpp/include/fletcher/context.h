@@ -131,6 +131,12 @@ class Context {
    */
   DeviceBuffer device_buffer(size_t i) const { return device_buffers_[i]; }
 
+  /// @brief Return the number of dictionary-encoded fields of all RecordBatches in this context.
+  uint64_t num_dictionaries() const { return host_dictionary_lengths_.size(); }
+
+  /// @brief Return the number of entries in the dictionary of the i-th dictionary-encoded field of this context.
+  int64_t dictionary_length(size_t i) const { return host_dictionary_lengths_[i]; }
+
   /// @brief Return the number of RecordBatches in this context.
   uint64_t num_recordbatches() const { return host_batches_.size(); }
 
@@ -146,10 +152,14 @@ class Context {
   std::shared_ptr<Platform> platform_;
   /// The RecordBatches on the host side.
   std::vector<std::shared_ptr<arrow::RecordBatch>> host_batches_;
-  /// The descriptions of the RecordBatches on the host side.
-  std::vector<RecordBatchDescription> host_batch_desc_;
+  /// The buffer layouts of the RecordBatches on the host side. RecordBatches with the same schema share a layout.
+  std::vector<std::shared_ptr<const RecordBatchLayout>> host_batch_layout_;
+  /// The buffers of all RecordBatches on the host side, in the order of their layouts.
+  std::vector<BufferRef> host_buffers_;
   /// Whether the RecordBatch must be prepared or cached for the device.
   std::vector<MemType> host_batch_memtype_;
+  /// The dictionary lengths of the dictionary-encoded fields of all RecordBatches, in the order of their layouts.
+  std::vector<int64_t> host_dictionary_lengths_;
   /// Prepared/cached buffers on the device.
   std::vector<DeviceBuffer> device_buffers_;
 };
@@ -25,7 +25,14 @@
 
 namespace fletcher {
 
-/// The Kernel class is used to manage the computational kernel of the accelerator.
+/**
+ * @brief The Kernel class is used to manage the computational kernel of the accelerator.
+ *
+ * A design may contain multiple replicas of the kernel that operate in parallel, each with its own copy of the
+ * register map in a separate window of the MMIO address space. The number of replicas and the window size are read from
+ * the status register. Commands and metadata are written to all replicas, and the range of rows to process of every
+ * read RecordBatch is divided over the replicas. Written RecordBatches are written by the first replica only.
+ */
 class Kernel {
  public:
   /**
@@ -35,7 +42,11 @@ class Kernel {
   explicit Kernel(std::shared_ptr<Context> context);
 
   /**
-   * @brief Returns true if the kernel implements an operation over a set of arrow::Schemas. Not implemented.
+   * @brief Returns true if the kernel implements an operation over a set of arrow::Schemas.
+   *
+   * Compares the fingerprint of the schema set with the fingerprint that fletchgen placed in the kernel's fingerprint
+   * register. Schema and field names are not taken into account. See GetSchemaSetFingerprint().
+   *
    * @param[in] schema_set A vector of shared pointers to arrow::Schemas to check.
    * @return Returns true if the kernel implements an operation over a set of arrow::Schemas.
    */
@@ -49,6 +60,13 @@ class Kernel {
 
   /**
    * @brief Set the first (inclusive) and last (exclusive) row to process of some RecordBatch.
+   *
+   * If the kernel is replicated, the range of a read RecordBatch is divided into contiguous parts of nearly equal
+   * size, one for every replica, in replica order. If the range has fewer rows than there are replicas, the last
+   * replicas get an empty range (first == last). Replicas cannot divide a written RecordBatch, as the offsets of their
+   * writers all start at zero. The first replica gets the whole range of a written RecordBatch, and the other replicas
+   * get an empty range at row zero.
+   *
    * @param[in] recordbatch_index The index of the RecordBatch to set the range for.
    * @param[in] first             The first index of the range (inclusive).
    * @param[in] last              The last index of the range (exclusive).
@@ -71,6 +89,10 @@ class Kernel {
 
   /**
    * @brief Read the status register of the Kernel.
+   *
+   * If the kernel is replicated, the idle and done bits are only set if they are set for all replicas, and the busy
+   * bit is set if any replica is busy.
+   *
    * @param[out] status_out A pointer to a value to store the status.
    * @return Status::OK() if successful, otherwise a descriptive error status.
    */
@@ -78,14 +100,15 @@ class Kernel {
 
   /**
    * @brief Read the return registers of the Kernel. If ret1 is nullptr, REG_RETURN1 is ignored.
-   * @param[out] ret0 A pointer to a value to store return value 0.
-   * @param[out] ret1 A pointer to a value to store return value 1.
+   * @param[out] ret0    A pointer to a value to store return value 0.
+   * @param[out] ret1    A pointer to a value to store return value 1.
+   * @param[in]  replica The replica of the kernel to read the return registers of.
    * @return Status::OK() if successful, otherwise a descriptive error status.
    */
-  Status GetReturn(uint32_t *ret0, uint32_t *ret1 = nullptr);
+  Status GetReturn(uint32_t *ret0, uint32_t *ret1 = nullptr, size_t replica = 0);
 
   /**
-   * @brief Poll (blocking) the done flag of the status register for assertion with an interval.
+   * @brief Poll (blocking) the done flag of the status register of all replicas for assertion with an interval.
    * @param[in] poll_interval_usec The interval at which to poll the Kernel.
    * @return Status::OK() when the kernel is finished, otherwise a descriptive error status.
    */
@@ -102,6 +125,12 @@ class Kernel {
   /// @brief Return the context of this Kernel.
   std::shared_ptr<Context> context();
 
+  /// @brief Return the number of replicas of the kernel.
+  size_t num_replicas();
+
+  /// @brief Return the number of 32-bit MMIO words between the register maps of successive replicas.
+  uint64_t replica_window();
+
   /**
    * @brief Write RecordBatch metadata from the Context to the Kernel MMIO registers.
    * @return Status::OK() if successful, otherwise a descriptive error status.
@@ -119,8 +148,21 @@ class Kernel {
   uint32_t done_status_mask = 1ul << FLETCHER_REG_STATUS_DONE;
 
  protected:
+  /// @brief Read the number of replicas and their register window size from the status register, if not done yet.
+  void DetectReplicas();
+  /// @brief Write a value to a register of every replica.
+  Status WriteAll(uint64_t offset, uint32_t value);
+  /// @brief Divide a range of rows of some RecordBatch over the replicas, and write it to their range registers.
+  Status WriteRange(size_t recordbatch_index, int32_t first, int32_t last);
+
   /// Whether RecordBatch metadata was written.
   bool metadata_written = false;
+  /// Whether the number of replicas and window size were read from the kernel.
+  bool replicas_detected = false;
+  /// The number of kernel replicas.
+  size_t num_replicas_ = 1;
+  /// The number of 32-bit words in the register window of every replica.
+  uint64_t replica_window_ = 0;
   /// The context that this kernel should operate on.
   std::shared_ptr<Context> context_;
 };
@@ -0,0 +1,234 @@
+// Copyright 2018-2019 Delft University of Technology
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "fletcher/platform.h"
+#include "fletcher/status.h"
+
+namespace fletcher {
+
+/// Word offsets of the counter registers of a profiled stream, in the order of the fletchgen profiler counters.
+struct ProfileStreamRegs {
+  /// Name of the stream.
+  std::string name;
+  /// Bit width of a single element of the stream, or zero if it is unknown.
+  uint32_t element_width = 0;
+  /// Element count register.
+  uint64_t elements = 0;
+  /// Valid count register.
+  uint64_t valids = 0;
+  /// Ready count register.
+  uint64_t readies = 0;
+  /// Transfer count register.
+  uint64_t transfers = 0;
+  /// Packet count register.
+  uint64_t packets = 0;
+  /// Cycle count register.
+  uint64_t cycles = 0;
+  /// Stall histogram bucket registers, or empty if the stream has no stall histogram.
+  std::vector<uint64_t> stall_histogram;
+  /// Starve histogram bucket registers, or empty if the stream has no stall histogram.
+  std::vector<uint64_t> starve_histogram;
+};
+
+/// Word offsets of the counter registers of a profiled bus, in the order of the fletchgen bus profiler counters.
+struct ProfileBusRegs {
+  /// Name of the bus.
+  std::string name;
+  /// Bit width of the data of the bus.
+  uint32_t data_width = 0;
+  /// Requested beats register.
+  uint64_t req_beats = 0;
+  /// Data beats register.
+  uint64_t dat_beats = 0;
+  /// Request stall count register.
+  uint64_t req_stalls = 0;
+  /// Peak outstanding bursts register.
+  uint64_t max_outstanding = 0;
+  /// Cycle count register.
+  uint64_t cycles = 0;
+  /// Busy register. Its least significant bit is high from a snapshot until the counter registers hold it.
+  uint64_t busy = 0;
+};
+
+/**
+ * @brief The profiling registers of a kernel.
+ *
+ * Fletchgen generates this map in the C++ host header of a kernel (see GetProfileMap() in the generated header) and as
+ * a JSON file for other tools. All offsets are 32-bit word offsets, as used by Platform::WriteMMIO and ReadMMIO.
+ */
+struct ProfileMap {
+  /// Profiler enable register.
+  uint64_t enable = 0;
+  /// Profiler clear register.
+  uint64_t clear = 0;
+  /// Profiler snapshot register. Writing it copies all counters to their registers at the same time.
+  uint64_t snapshot = 0;
+  /// Whether the kernel has a snapshot register. If not, the counter registers follow the counters directly.
+  bool has_snapshot = false;
+  /// Bit width of the counter registers. Counters wider than 32 bits span two words, least significant first.
+  uint32_t counter_width = 32;
+  /// The profiled streams.
+  std::vector<ProfileStreamRegs> streams;
+  /// Bus profiler enable register.
+  uint64_t bus_enable = 0;
+  /// Bus profiler clear register.
+  uint64_t bus_clear = 0;
+  /// Bus profiler snapshot register. Writing it copies all bus counters to their registers at the same time.
+  uint64_t bus_snapshot = 0;
+  /// The profiled buses, or empty if the kernel was generated without bus profilers.
+  std::vector<ProfileBusRegs> buses;
+};
+
+/// The counters of a profiled stream, and the metrics derived from them.
+struct StreamProfile {
+  /// Name of the stream.
+  std::string name;
+  /// Bit width of a single element of the stream, or zero if it is unknown.
+  uint32_t element_width = 0;
+  /// Number of elements transferred.
+  uint64_t elements = 0;
+  /// Number of cycles the stream was valid.
+  uint64_t valids = 0;
+  /// Number of cycles the stream was ready.
+  uint64_t readies = 0;
+  /// Number of handshakes.
+  uint64_t transfers = 0;
+  /// Number of handshakes with the last signal set.
+  uint64_t packets = 0;
+  /// Number of profiled cycles.
+  uint64_t cycles = 0;
+  /// Number of times the stream was valid but not ready for 2^b up to 2^(b+1)-1 cycles, for every bucket b. The last
+  /// bucket also holds all longer stalls.
+  std::vector<uint64_t> stall_histogram;
+  /// Number of times the stream was ready but not valid for 2^b up to 2^(b+1)-1 cycles, for every bucket b. The last
+  /// bucket also holds all longer starves.
+  std::vector<uint64_t> starve_histogram;
+
+  /// @brief Return the fraction of the profiled cycles in which a transfer took place.
+  double utilization() const;
+  /// @brief Return the fraction of the cycles in which the stream was valid that it was not ready.
+  double backpressure() const;
+  /// @brief Return the average number of elements transferred per profiled cycle.
+  double elements_per_cycle() const;
+  /// @brief Return the bandwidth in bytes per second at some kernel clock frequency, or zero if the width is unknown.
+  double bytes_per_second(double clock_hz) const;
+};
+
+/// The counters of a profiled bus, and the metrics derived from them. All cycles are bus clock cycles.
+struct BusProfile {
+  /// Name of the bus.
+  std::string name;
+  /// Bit width of the data of the bus.
+  uint32_t data_width = 0;
+  /// Sum of the burst lengths of all accepted requests.
+  uint64_t req_beats = 0;
+  /// Number of transferred data beats.
+  uint64_t dat_beats = 0;
+  /// Number of cycles a request was valid, but not accepted.
+  uint64_t req_stalls = 0;
+  /// Peak number of outstanding bursts.
+  uint64_t max_outstanding = 0;
+  /// Number of profiled cycles.
+  uint64_t cycles = 0;
+
+  /// @brief Return the fraction of the profiled cycles in which a data beat was transferred.
+  double utilization() const;
+  /// @brief Return the bandwidth in bytes per second at some bus clock frequency.
+  double bytes_per_second(double clock_hz) const;
+};
+
+/**
+ * @brief Reads the stream and bus profilers of a kernel.
+ *
+ * Typical usage is to call Start() before starting the kernel, Stop() after it is done and to obtain the results with
+ * Read(). Stop() disables the profilers, such that all counters are read from the same point in time. If the kernel
+ * has a snapshot register, Read() first takes a snapshot of all counters, such that they can also be read consistently
+ * while the profilers are enabled. The counters of the bus profilers, which count in the bus clock domain, are read
+ * separately with the BusProfile overload of Read().
+ */
+class Profiler {
+ public:
+  /**
+   * @brief Construct a new Profiler.
+   * @param[in] platform The platform to access the profiling registers through.
+   * @param[in] map      The profiling registers of the kernel.
+   * @param[in] base     Word offset of the register map, e.g. r * Kernel::replica_window() to profile replica r.
+   */
+  Profiler(std::shared_ptr<Platform> platform, ProfileMap map, uint64_t base = 0);
+
+  /**
+   * @brief Clear and enable the stream profilers, and the bus profilers if there are any.
+   * @return Status::OK() if successful, otherwise a descriptive error status.
+   */
+  Status Start();
+
+  /**
+   * @brief Disable the stream profilers, and the bus profilers if there are any.
+   * @return Status::OK() if successful, otherwise a descriptive error status.
+   */
+  Status Stop();
+
+  /**
+   * @brief Take a snapshot, if supported, and read the counters of all profiled streams.
+   * @param[out] profiles The profiles of all streams, in the order of the profile map.
+   * @return Status::OK() if successful, otherwise a descriptive error status.
+   */
+  Status Read(std::vector<StreamProfile> *profiles);
+
+  /**
+   * @brief Take a snapshot, wait until every bus profiler holds it, and read the counters of all profiled buses.
+   * @param[out] profiles The profiles of all buses, in the order of the profile map.
+   * @return Status::OK() if successful, otherwise a descriptive error status.
+   */
+  Status Read(std::vector<BusProfile> *profiles);
+
+  /**
+   * @brief Format stream profiles as a text table, followed by the histograms of the streams that have them.
+   * @param[in] profiles The stream profiles.
+   * @param[in] clock_hz The kernel clock frequency to calculate the bandwidth with. Zero omits the bandwidth.
+   * @return The table.
+   */
+  static std::string ToString(const std::vector<StreamProfile> &profiles, double clock_hz = 0.0);
+
+  /**
+   * @brief Format bus profiles as a text table.
+   * @param[in] profiles The bus profiles.
+   * @param[in] clock_hz The bus clock frequency to calculate the bandwidth with. Zero omits the bandwidth.
+   * @return The table.
+   */
+  static std::string ToString(const std::vector<BusProfile> &profiles, double clock_hz = 0.0);
+
+  /// @brief Return the profile map of this Profiler.
+  const ProfileMap &map() const { return map_; }
+
+ protected:
+  /// @brief Read a counter register.
+  Status ReadCounter(uint64_t offset, uint64_t *value);
+
+  /// The platform to access the profiling registers through.
+  std::shared_ptr<Platform> platform_;
+  /// The profiling registers.
+  ProfileMap map_;
+  /// Word offset of the register map.
+  uint64_t base_;
+};
+
+}  // namespace fletcher
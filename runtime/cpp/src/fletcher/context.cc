@@ -43,38 +43,40 @@ Context::~Context() {
 Status Context::Enable() {
   auto num_batches = host_batches_.size();
   // Sanity check
-  assert(num_batches == host_batch_desc_.size());
+  assert(num_batches == host_batch_layout_.size());
   assert(num_batches == host_batch_memtype_.size());
 
   FLETCHER_LOG(DEBUG, "Enabling context for " << num_batches << " queued RecordBatch(es)");
 
+  device_buffers_.reserve(device_buffers_.size() + host_buffers_.size());
+
   // Loop over all batches queued on host
+  size_t buf_idx = 0;
   for (size_t i = 0; i < num_batches; i++) {
-    auto rbd = host_batch_desc_[i];
+    const auto &layout = *host_batch_layout_[i];
     auto type = host_batch_memtype_[i];
-    for (const auto &f : rbd.fields) {
-      for (const auto &b : f.buffers) {
-        fletcher::Status status;
-        DeviceBuffer device_buf(b.raw_buffer_, b.size_, type, rbd.mode);
-        if (type == MemType::ANY) {
-          status = platform_->PrepareHostBuffer(device_buf.host_address,
-                                                &device_buf.device_address,
-                                                device_buf.size,
-                                                &device_buf.was_alloced);
-        } else if (type == MemType::CACHE) {
-          status = platform_->CacheHostBuffer(device_buf.host_address,
+    for (size_t b = 0; b < layout.buffers.size(); b++, buf_idx++) {
+      const auto &host_buf = host_buffers_[buf_idx];
+      fletcher::Status status;
+      DeviceBuffer device_buf(host_buf.raw_buffer_, host_buf.size_, type, layout.mode);
+      if (type == MemType::ANY) {
+        status = platform_->PrepareHostBuffer(device_buf.host_address,
                                               &device_buf.device_address,
-                                              device_buf.size);
-          // Cache always allocates on device.
-          device_buf.was_alloced = true;
-        } else {
-          status = Status::ERROR("Invalid / unsupported MemType.");
-        }
-        if (!status.ok()) {
-          return status;
-        }
-        device_buffers_.push_back(device_buf);
+                                              device_buf.size,
+                                              &device_buf.was_alloced);
+      } else if (type == MemType::CACHE) {
+        status = platform_->CacheHostBuffer(device_buf.host_address,
+                                            &device_buf.device_address,
+                                            device_buf.size);
+        // Cache always allocates on device.
+        device_buf.was_alloced = true;
+      } else {
+        status = Status::ERROR("Invalid / unsupported MemType.");
+      }
+      if (!status.ok()) {
+        return status;
       }
+      device_buffers_.push_back(device_buf);
     }
   }
 
@@ -88,13 +90,37 @@ Status Context::QueueRecordBatch(const std::shared_ptr<arrow::RecordBatch> &reco
     return Status::ERROR("RecordBatch is nullptr.");
   }
 
-  host_batches_.push_back(record_batch);
+  // Reuse the layout of a previously queued RecordBatch with the same schema object. Otherwise, obtain it from the
+  // layout cache, such that it is only created once for every distinct schema that passes through the runtime.
+  std::shared_ptr<const RecordBatchLayout> layout;
+  for (size_t i = host_batches_.size(); i-- > 0;) {
+    if (host_batches_[i]->schema() == record_batch->schema()) {
+      layout = host_batch_layout_[i];
+      break;
+    }
+  }
+  if (layout == nullptr) {
+    layout = DefaultLayoutCache()->Get(*record_batch->schema());
+    if (layout == nullptr) {
+      return Status::ERROR("Could not determine buffer layout of RecordBatch.");
+    }
+  }
 
-  // Create a description of the RecordBatch
-  RecordBatchDescription rbd;
-  RecordBatchAnalyzer rba(&rbd);
-  rba.Analyze(*record_batch);
-  host_batch_desc_.push_back(rbd);
+  // Obtain the buffer addresses and sizes of this RecordBatch.
+  auto offset = host_buffers_.size();
+  host_buffers_.resize(offset + layout->buffers.size());
+  if (!layout->Refresh(*record_batch, host_buffers_.data() + offset)) {
+    host_buffers_.resize(offset);
+    return Status::ERROR("RecordBatch does not match the buffer layout of its schema.");
+  }
+
+  // The kernel needs the number of entries in every dictionary to load it.
+  for (size_t i = 0; i < layout->dictionaries.size(); i++) {
+    host_dictionary_lengths_.push_back(layout->DictionaryLength(*record_batch, i));
+  }
+
+  host_batches_.push_back(record_batch);
+  host_batch_layout_.push_back(layout);
 
   // Put the desired memory type of the RecordBatch
   host_batch_memtype_.push_back(mem_type);
@@ -103,23 +129,13 @@ Status Context::QueueRecordBatch(const std::shared_ptr<arrow::RecordBatch> &reco
 }
 
 uint64_t Context::num_buffers() const {
-  uint64_t ret = 0;
-  for (const auto &rbd : host_batch_desc_) {
-    for (const auto &f : rbd.fields) {
-      ret += f.buffers.size();
-    }
-  }
-  return ret;
+  return host_buffers_.size();
 }
 
 size_t Context::GetQueueSize() const {
   size_t size = 0;
-  for (const auto &desc : host_batch_desc_) {
-    for (const auto &f : desc.fields) {
-      for (const auto &buf : f.buffers) {
-        size += buf.size_;
-      }
-    }
+  for (const auto &buf : host_buffers_) {
+    size += buf.size_;
   }
   return size;
 }
@@ -15,6 +15,7 @@
 #include "fletcher/kernel.h"
 
 #include <unistd.h>
+#include <string>
 #include <utility>
 
 #include "fletcher/context.h"
@@ -24,44 +25,107 @@ namespace fletcher {
 Kernel::Kernel(std::shared_ptr<Context> context) : context_(std::move(context)) {}
 
 bool Kernel::ImplementsSchemaSet(const std::vector<std::shared_ptr<arrow::Schema>> &schema_set) {
-  // TODO(johanpel): Implement checking if the kernel implements the same Schema, probably through some checksum
-  //  register. We need a hash function for Arrow Schema's for this, that doesn't take into account field names or
-  //  metadata, except the fletcher access mode.
-  FLETCHER_LOG(WARNING, "ImplementsSchemaSet is not implemented.");
-  return false;
+  uint64_t fingerprint = 0;
+  if (!context_->platform()->ReadMMIO64(FLETCHER_REG_FINGERPRINT, &fingerprint).ok()) {
+    FLETCHER_LOG(ERROR, "Could not read schema set fingerprint register.");
+    return false;
+  }
+  return fingerprint == GetSchemaSetFingerprint(schema_set);
+}
+
+void Kernel::DetectReplicas() {
+  if (replicas_detected) {
+    return;
+  }
+  uint32_t status = 0;
+  if (!context_->platform()->ReadMMIO(FLETCHER_REG_STATUS, &status).ok()) {
+    FLETCHER_LOG(ERROR, "Could not read status register to detect kernel replicas. Assuming a single replica.");
+    return;
+  }
+  // Designs that are not replicated leave the replica fields zero.
+  auto num_replicas = (status >> FLETCHER_REG_STATUS_REPLICAS) & 0xFFu;
+  auto window_width = (status >> FLETCHER_REG_STATUS_WINDOW) & 0xFFu;
+  if (num_replicas > 1) {
+    num_replicas_ = num_replicas;
+    replica_window_ = (1ull << window_width) / 4;
+    FLETCHER_LOG(DEBUG, "Kernel has " << num_replicas_ << " replicas with a register window of "
+        << replica_window_ << " words.");
+  }
+  replicas_detected = true;
+}
+
+size_t Kernel::num_replicas() {
+  DetectReplicas();
+  return num_replicas_;
+}
+
+uint64_t Kernel::replica_window() {
+  DetectReplicas();
+  return replica_window_;
+}
+
+Status Kernel::WriteAll(uint64_t offset, uint32_t value) {
+  for (size_t r = 0; r < num_replicas(); r++) {
+    auto status = context_->platform()->WriteMMIO(offset + r * replica_window(), value);
+    if (!status.ok()) {
+      return status;
+    }
+  }
+  return Status::OK();
 }
 
 Status Kernel::Reset() {
-  auto status = context_->platform()->WriteMMIO(FLETCHER_REG_CONTROL, ctrl_reset);
+  auto status = WriteAll(FLETCHER_REG_CONTROL, ctrl_reset);
   if (status.ok()) {
-    return context_->platform()->WriteMMIO(FLETCHER_REG_CONTROL, 0);
+    return WriteAll(FLETCHER_REG_CONTROL, 0);
   } else {
     return status;
   }
 }
 
+Status Kernel::WriteRange(size_t recordbatch_index, int32_t first, int32_t last) {
+  auto replicas = static_cast<int32_t>(num_replicas());
+  // Writers of every replica start their offsets at zero, so a written RecordBatch cannot be divided.
+  bool divide = true;
+  if (recordbatch_index < context_->num_recordbatches()) {
+    divide = GetMode(*context_->recordbatch(recordbatch_index)->schema()) == Mode::READ;
+  }
+  // Divide the range in contiguous parts, where the first (rows % replicas) replicas get one row extra.
+  int32_t rows = last - first;
+  int32_t part_first = first;
+  for (int32_t r = 0; r < replicas; r++) {
+    int32_t part_last = part_first + rows / replicas + (r < rows % replicas ? 1 : 0);
+    if (!divide) {
+      // The first replica writes the whole range, the others get an empty range at the start of the RecordBatch.
+      part_first = r == 0 ? first : 0;
+      part_last = r == 0 ? last : 0;
+    }
+    uint64_t offset = FLETCHER_REG_SCHEMA + 2 * recordbatch_index + r * replica_window();
+    auto status = context_->platform()->WriteMMIO(offset, static_cast<uint32_t>(part_first));
+    if (!status.ok()) {
+      return status;
+    }
+    status = context_->platform()->WriteMMIO(offset + 1, static_cast<uint32_t>(part_last));
+    if (!status.ok()) {
+      return status;
+    }
+    part_first = part_last;
+  }
+  return Status::OK();
+}
+
 Status Kernel::SetRange(size_t recordbatch_index, int32_t first, int32_t last) {
   if (first >= last) {
     FLETCHER_LOG(ERROR, "Row range invalid: [ " + std::to_string(first) + ", " + std::to_string(last) + " )");
     return Status::ERROR();
   }
-
-  Status ret;
-  if (!context_->platform()->WriteMMIO(FLETCHER_REG_SCHEMA + 2 * recordbatch_index,
-                                       static_cast<uint32_t>(first)).ok()) {
-    ret = Status::ERROR();
-  }
-  if (!context_->platform()->WriteMMIO(FLETCHER_REG_SCHEMA + 2 * recordbatch_index + 1,
-                                       static_cast<uint32_t>(last)).ok()) {
-    ret = Status::ERROR();
-  }
-  return Status::OK();
+  return WriteRange(recordbatch_index, first, last);
 }
 
 Status Kernel::SetArguments(const std::vector<uint32_t> &arguments) {
   for (int i = 0; (size_t) i < arguments.size(); i++) {
-    context_->platform()->WriteMMIO(
-        FLETCHER_REG_SCHEMA + 2 * context_->num_recordbatches() + 2 * context_->num_buffers() + i, arguments[i]);
+    WriteAll(FLETCHER_REG_SCHEMA + 2 * context_->num_recordbatches() + 2 * context_->num_buffers()
+                 + context_->num_dictionaries() + i, arguments[i]);
   }
 
   return Status::OK();
@@ -73,23 +137,35 @@ Status Kernel::Start() {
     WriteMetaData();
   }
   FLETCHER_LOG(DEBUG, "Starting kernel.");
-  status = context_->platform()->WriteMMIO(FLETCHER_REG_CONTROL, ctrl_start);
+  status = WriteAll(FLETCHER_REG_CONTROL, ctrl_start);
   if (!status.ok())
     return status;
-  return context_->platform()->WriteMMIO(FLETCHER_REG_CONTROL, 0);
+  return WriteAll(FLETCHER_REG_CONTROL, 0);
 }
 
 Status Kernel::GetStatus(uint32_t *status_out) {
-  return context_->platform()->ReadMMIO(FLETCHER_REG_STATUS, status_out);
+  auto status = context_->platform()->ReadMMIO(FLETCHER_REG_STATUS, status_out);
+  for (size_t r = 1; (r < num_replicas()) && status.ok(); r++) {
+    uint32_t replica_status = 0;
+    status = context_->platform()->ReadMMIO(FLETCHER_REG_STATUS + r * replica_window(), &replica_status);
+    // The kernel is only idle or done if all replicas are, but busy if any replica is.
+    uint32_t busy = (*status_out | replica_status) & (1ul << FLETCHER_REG_STATUS_BUSY);
+    *status_out = (*status_out & replica_status) | busy;
+  }
+  return status;
 }
 
-Status Kernel::GetReturn(uint32_t *ret0, uint32_t *ret1) {
+Status Kernel::GetReturn(uint32_t *ret0, uint32_t *ret1, size_t replica) {
   Status status;
-  status = context_->platform()->ReadMMIO(FLETCHER_REG_RETURN0, ret0);
+  if (replica >= num_replicas()) {
+    return Status::ERROR("Kernel has no replica " + std::to_string(replica) + ".");
+  }
+  uint64_t offset = replica * replica_window();
+  status = context_->platform()->ReadMMIO(offset + FLETCHER_REG_RETURN0, ret0);
   if ((ret1 == nullptr) || (!status.ok())) {
     return status;
   }
-  status = context_->platform()->ReadMMIO(FLETCHER_REG_RETURN1, ret1);
+  status = context_->platform()->ReadMMIO(offset + FLETCHER_REG_RETURN1, ret1);
   return status;
 }
 
@@ -98,20 +174,23 @@ Status Kernel::PollUntilDone() {
 }
 
 Status Kernel::PollUntilDoneInterval(unsigned int poll_interval_usec) {
-  bool done = false;
   uint32_t status = 0;
   FLETCHER_LOG(DEBUG, "Polling kernel for completion.");
-  if (poll_interval_usec == 0) {
-    while (!done) {
-      context_->platform()->ReadMMIO(FLETCHER_REG_STATUS, &status);
-      done = (status & done_status_mask) == this->done_status;
-    }
-  } else {
-    while (!done) {
-      context_->platform()->ReadMMIO(FLETCHER_REG_STATUS, &status);
-      done = (status & done_status_mask) == this->done_status;
-      if (done) break;
-      usleep(poll_interval_usec);
+  // Replicas finish in any order, but the kernel is only done when all of them are.
+  for (size_t r = 0; r < num_replicas(); r++) {
+    bool done = false;
+    if (poll_interval_usec == 0) {
+      while (!done) {
+        context_->platform()->ReadMMIO(FLETCHER_REG_STATUS + r * replica_window(), &status);
+        done = (status & done_status_mask) == this->done_status;
+      }
+    } else {
+      while (!done) {
+        context_->platform()->ReadMMIO(FLETCHER_REG_STATUS + r * replica_window(), &status);
+        done = (status & done_status_mask) == this->done_status;
+        if (done) break;
+        usleep(poll_interval_usec);
+      }
     }
   }
   FLETCHER_LOG(DEBUG, "Kernel status done bit asserted.");
@@ -126,34 +205,34 @@ Status Kernel::WriteMetaData() {
   Status status;
   FLETCHER_LOG(DEBUG, "Writing context metadata to kernel.");
 
-  // Set the starting offset to the first schema-derived register index.
-  uint64_t offset = FLETCHER_REG_SCHEMA;
-
-  // Get the platform pointer.
-  auto platform = context_->platform();
-
-  // Write RecordBatch ranges.
+  // Write RecordBatch ranges, divided over the replicas if they are read.
   for (size_t i = 0; i < context_->num_recordbatches(); i++) {
     auto rb = context_->recordbatch(i);
-    status = platform->WriteMMIO(offset, 0);               // First index
+    status = WriteRange(i, 0, static_cast<int32_t>(rb->num_rows()));
     if (!status.ok()) return status;
-    offset++;
-    status = platform->WriteMMIO(offset, rb->num_rows());  // Last index (exclusive)
-    if (!status.ok()) return status;
-    offset++;
   }
 
-  // Write buffer addresses
+  // Set the starting offset to the first buffer address register index.
+  uint64_t offset = FLETCHER_REG_SCHEMA + 2 * context_->num_recordbatches();
+
+  // Write buffer addresses to every replica.
   for (size_t i = 0; i < context_->num_buffers(); i++) {
     // Get the device address
     auto device_buf = context_->device_buffer(i);
     dau_t address;
     address.full = device_buf.device_address;
     // Write the address
-    platform->WriteMMIO(offset, address.lo);
+    status = WriteAll(offset, address.lo);
+    if (!status.ok()) return status;
+    offset++;
+    status = WriteAll(offset, address.hi);
     if (!status.ok()) return status;
     offset++;
-    platform->WriteMMIO(offset, address.hi);
+  }
+
+  // Write the dictionary lengths, which follow the buffer addresses, to every replica.
+  for (size_t i = 0; i < context_->num_dictionaries(); i++) {
+    status = WriteAll(offset, static_cast<uint32_t>(context_->dictionary_length(i)));
     if (!status.ok()) return status;
     offset++;
   }
@@ -0,0 +1,252 @@
+// Copyright 2018-2019 Delft University of Technology
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "fletcher/profiler.h"
+
+#include <fletcher/common.h>
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace fletcher {
+
+/// @brief Return a / b, or zero if b is zero.
+static double Ratio(uint64_t a, uint64_t b) {
+  return b == 0 ? 0.0 : static_cast<double>(a) / static_cast<double>(b);
+}
+
+double StreamProfile::utilization() const {
+  return Ratio(transfers, cycles);
+}
+
+double StreamProfile::backpressure() const {
+  return Ratio(valids - std::min(valids, transfers), valids);
+}
+
+double StreamProfile::elements_per_cycle() const {
+  return Ratio(elements, cycles);
+}
+
+double StreamProfile::bytes_per_second(double clock_hz) const {
+  return elements_per_cycle() * element_width / 8.0 * clock_hz;
+}
+
+double BusProfile::utilization() const {
+  return Ratio(dat_beats, cycles);
+}
+
+double BusProfile::bytes_per_second(double clock_hz) const {
+  return utilization() * data_width / 8.0 * clock_hz;
+}
+
+Profiler::Profiler(std::shared_ptr<Platform> platform, ProfileMap map, uint64_t base)
+    : platform_(std::move(platform)), map_(std::move(map)), base_(base) {}
+
+Status Profiler::Start() {
+  // Disable the profilers while they are cleared, such that all counters start at the same cycle.
+  auto status = platform_->WriteMMIO(base_ + map_.enable, 0);
+  if (!status.ok()) return status;
+  status = platform_->WriteMMIO(base_ + map_.clear, 1);
+  if (!status.ok()) return status;
+  if (!map_.buses.empty()) {
+    status = platform_->WriteMMIO(base_ + map_.bus_enable, 0);
+    if (!status.ok()) return status;
+    status = platform_->WriteMMIO(base_ + map_.bus_clear, 1);
+    if (!status.ok()) return status;
+    status = platform_->WriteMMIO(base_ + map_.bus_enable, 1);
+    if (!status.ok()) return status;
+  }
+  return platform_->WriteMMIO(base_ + map_.enable, 1);
+}
+
+Status Profiler::Stop() {
+  auto status = platform_->WriteMMIO(base_ + map_.enable, 0);
+  if (!status.ok()) return status;
+  if (!map_.buses.empty()) {
+    status = platform_->WriteMMIO(base_ + map_.bus_enable, 0);
+  }
+  return status;
+}
+
+Status Profiler::ReadCounter(uint64_t offset, uint64_t *value) {
+  if (map_.counter_width > 32) {
+    return platform_->ReadMMIO64(base_ + offset, value);
+  }
+  uint32_t value32 = 0;
+  auto status = platform_->ReadMMIO(base_ + offset, &value32);
+  *value = value32;
+  return status;
+}
+
+Status Profiler::Read(std::vector<StreamProfile> *profiles) {
+  profiles->clear();
+  if (map_.has_snapshot) {
+    auto status = platform_->WriteMMIO(base_ + map_.snapshot, 1);
+    if (!status.ok()) return status;
+  }
+  for (const auto &s : map_.streams) {
+    StreamProfile p;
+    p.name = s.name;
+    p.element_width = s.element_width;
+    const std::pair<uint64_t, uint64_t *> counters[] = {{s.elements, &p.elements},
+                                                        {s.valids, &p.valids},
+                                                        {s.readies, &p.readies},
+                                                        {s.transfers, &p.transfers},
+                                                        {s.packets, &p.packets},
+                                                        {s.cycles, &p.cycles}};
+    for (const auto &c : counters) {
+      auto status = ReadCounter(c.first, c.second);
+      if (!status.ok()) {
+        FLETCHER_LOG(ERROR, "Could not read profiling counters of stream " << s.name);
+        return status;
+      }
+    }
+    const std::pair<const std::vector<uint64_t> *, std::vector<uint64_t> *> histograms[] =
+        {{&s.stall_histogram, &p.stall_histogram}, {&s.starve_histogram, &p.starve_histogram}};
+    for (const auto &h : histograms) {
+      h.second->resize(h.first->size());
+      for (size_t b = 0; b < h.first->size(); b++) {
+        auto status = ReadCounter((*h.first)[b], &(*h.second)[b]);
+        if (!status.ok()) {
+          FLETCHER_LOG(ERROR, "Could not read stall histogram of stream " << s.name);
+          return status;
+        }
+      }
+    }
+    profiles->push_back(p);
+  }
+  return Status::OK();
+}
+
+Status Profiler::Read(std::vector<BusProfile> *profiles) {
+  profiles->clear();
+  if (map_.buses.empty()) {
+    return Status::OK();
+  }
+  auto status = platform_->WriteMMIO(base_ + map_.bus_snapshot, 1);
+  if (!status.ok()) return status;
+  // The bus profilers hand the snapshot over from the bus clock domain, which takes a few cycles of both clocks.
+  for (const auto &b : map_.buses) {
+    uint32_t busy = 1;
+    while (busy & 1u) {
+      status = platform_->ReadMMIO(base_ + b.busy, &busy);
+      if (!status.ok()) return status;
+    }
+  }
+  for (const auto &b : map_.buses) {
+    BusProfile p;
+    p.name = b.name;
+    p.data_width = b.data_width;
+    const std::pair<uint64_t, uint64_t *> counters[] = {{b.req_beats, &p.req_beats},
+                                                        {b.dat_beats, &p.dat_beats},
+                                                        {b.req_stalls, &p.req_stalls},
+                                                        {b.max_outstanding, &p.max_outstanding},
+                                                        {b.cycles, &p.cycles}};
+    for (const auto &c : counters) {
+      status = ReadCounter(c.first, c.second);
+      if (!status.ok()) {
+        FLETCHER_LOG(ERROR, "Could not read profiling counters of bus " << b.name);
+        return status;
+      }
+    }
+    profiles->push_back(p);
+  }
+  return Status::OK();
+}
+
+std::string Profiler::ToString(const std::vector<StreamProfile> &profiles, double clock_hz) {
+  size_t name_width = 6;
+  for (const auto &p : profiles) {
+    name_width = std::max(name_width, p.name.size());
+  }
+  std::stringstream str;
+  str << std::left << std::setw(static_cast<int>(name_width)) << "Stream" << std::right
+      << std::setw(14) << "Elements"
+      << std::setw(14) << "Cycles"
+      << std::setw(10) << "Util. %"
+      << std::setw(10) << "B.pr. %"
+      << std::setw(10) << "El./cyc.";
+  if (clock_hz > 0.0) {
+    str << std::setw(12) << "MB/s";
+  }
+  str << "\n";
+  str << std::fixed;
+  for (const auto &p : profiles) {
+    str << std::left << std::setw(static_cast<int>(name_width)) << p.name << std::right
+        << std::setw(14) << p.elements
+        << std::setw(14) << p.cycles
+        << std::setw(10) << std::setprecision(1) << 100.0 * p.utilization()
+        << std::setw(10) << std::setprecision(1) << 100.0 * p.backpressure()
+        << std::setw(10) << std::setprecision(3) << p.elements_per_cycle();
+    if (clock_hz > 0.0) {
+      str << std::setw(12) << std::setprecision(1) << p.bytes_per_second(clock_hz) / 1E6;
+    }
+    str << "\n";
+  }
+  for (const auto &p : profiles) {
+    if (p.stall_histogram.empty() && p.starve_histogram.empty()) {
+      continue;
+    }
+    str << "\n" << p.name << " stall lengths (cycles):\n";
+    str << std::left << std::setw(10) << "Length" << std::right << std::setw(14) << "Stalls" << std::setw(14)
+        << "Starves" << "\n";
+    auto buckets = std::max(p.stall_histogram.size(), p.starve_histogram.size());
+    for (size_t b = 0; b < buckets; b++) {
+      auto range = std::to_string(1ULL << b) + (b + 1 == buckets ? "+" : "-" + std::to_string((2ULL << b) - 1));
+      str << std::left << std::setw(10) << range << std::right
+          << std::setw(14) << (b < p.stall_histogram.size() ? p.stall_histogram[b] : 0)
+          << std::setw(14) << (b < p.starve_histogram.size() ? p.starve_histogram[b] : 0) << "\n";
+    }
+  }
+  return str.str();
+}
+
+std::string Profiler::ToString(const std::vector<BusProfile> &profiles, double clock_hz) {
+  size_t name_width = 3;
+  for (const auto &p : profiles) {
+    name_width = std::max(name_width, p.name.size());
+  }
+  std::stringstream str;
+  str << std::left << std::setw(static_cast<int>(name_width)) << "Bus" << std::right
+      << std::setw(14) << "Req. beats"
+      << std::setw(14) << "Data beats"
+      << std::setw(14) << "Req. stalls"
+      << std::setw(10) << "Max. out."
+      << std::setw(14) << "Cycles"
+      << std::setw(10) << "Util. %";
+  if (clock_hz > 0.0) {
+    str << std::setw(12) << "MB/s";
+  }
+  str << "\n";
+  str << std::fixed;
+  for (const auto &p : profiles) {
+    str << std::left << std::setw(static_cast<int>(name_width)) << p.name << std::right
+        << std::setw(14) << p.req_beats
+        << std::setw(14) << p.dat_beats
+        << std::setw(14) << p.req_stalls
+        << std::setw(10) << p.max_outstanding
+        << std::setw(14) << p.cycles
+        << std::setw(10) << std::setprecision(1) << 100.0 * p.utilization();
+    if (clock_hz > 0.0) {
+      str << std::setw(12) << std::setprecision(1) << p.bytes_per_second(clock_hz) / 1E6;
+    }
+    str << "\n";
+  }
+  return str.str();
+}
+
+}  // namespace fletcher
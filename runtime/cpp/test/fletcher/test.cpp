@@ -25,6 +25,8 @@
 
 #include "fletcher/platform.h"
 #include "fletcher/context.h"
+#include "fletcher/kernel.h"
+#include "fletcher/profiler.h"
 
 TEST(Platform, NoPlatform) {
   std::shared_ptr<fletcher::Platform> platform;
@@ -131,3 +133,207 @@ TEST(Context, ContextFunctions) {
   ASSERT_TRUE(context->Enable().ok());
   ASSERT_TRUE(platform->Terminate().ok());
 }
+
+TEST(Kernel, Replicas) {
+  std::shared_ptr<fletcher::Platform> platform;
+  ASSERT_TRUE(fletcher::Platform::Make("echo", &platform, false).ok());
+  auto opts = std::make_shared<InitOptions>();
+  opts->quiet = 1;
+  opts->non_interactive = 1;
+  platform->init_data = opts.get();
+  ASSERT_TRUE(platform->Init().ok());
+
+  // Pretend to be a kernel with three replicas, each with a register window of 64 bytes (16 words).
+  constexpr uint64_t window = 16;
+  uint32_t status = (3u << FLETCHER_REG_STATUS_REPLICAS) | (6u << FLETCHER_REG_STATUS_WINDOW);
+  ASSERT_TRUE(platform->WriteMMIO(FLETCHER_REG_STATUS, status).ok());
+
+  std::shared_ptr<fletcher::Context> context;
+  ASSERT_TRUE(fletcher::Context::Make(&context, platform).ok());
+  fletcher::Kernel kernel(context);
+  ASSERT_EQ(kernel.num_replicas(), 3);
+  ASSERT_EQ(kernel.replica_window(), window);
+
+  // The range must be divided over the replicas.
+  ASSERT_TRUE(kernel.SetRange(1, 10, 21).ok());
+  uint32_t expected[3][2] = {{10, 14}, {14, 18}, {18, 21}};
+  for (uint64_t r = 0; r < 3; r++) {
+    uint32_t first, last;
+    ASSERT_TRUE(platform->ReadMMIO(r * window + FLETCHER_REG_SCHEMA + 2, &first).ok());
+    ASSERT_TRUE(platform->ReadMMIO(r * window + FLETCHER_REG_SCHEMA + 3, &last).ok());
+    ASSERT_EQ(first, expected[r][0]);
+    ASSERT_EQ(last, expected[r][1]);
+  }
+
+  // Ranges with fewer rows than replicas leave the last replicas empty.
+  ASSERT_TRUE(kernel.SetRange(0, 0, 1).ok());
+  uint32_t first, last;
+  ASSERT_TRUE(platform->ReadMMIO(2 * window + FLETCHER_REG_SCHEMA, &first).ok());
+  ASSERT_TRUE(platform->ReadMMIO(2 * window + FLETCHER_REG_SCHEMA + 1, &last).ok());
+  ASSERT_EQ(first, last);
+
+  // Written RecordBatches are not divided, but written by the first replica only.
+  auto write_schema = fletcher::WithMetaRequired(
+      *arrow::schema({arrow::field("s", arrow::utf8(), false)}), "W", fletcher::Mode::WRITE);
+  arrow::StringBuilder sb;
+  ASSERT_TRUE(sb.AppendValues({"a", "b", "c", "d", "e"}).ok());
+  std::shared_ptr<arrow::Array> s;
+  ASSERT_TRUE(sb.Finish(&s).ok());
+  ASSERT_TRUE(context->QueueRecordBatch(arrow::RecordBatch::Make(write_schema, 5, {s})).ok());
+  ASSERT_TRUE(kernel.SetRange(0, 0, 5).ok());
+  uint32_t expected_write[3][2] = {{0, 5}, {0, 0}, {0, 0}};
+  for (uint64_t r = 0; r < 3; r++) {
+    ASSERT_TRUE(platform->ReadMMIO(r * window + FLETCHER_REG_SCHEMA, &first).ok());
+    ASSERT_TRUE(platform->ReadMMIO(r * window + FLETCHER_REG_SCHEMA + 1, &last).ok());
+    ASSERT_EQ(first, expected_write[r][0]);
+    ASSERT_EQ(last, expected_write[r][1]);
+  }
+
+  // The kernel is only done when all replicas are done.
+  uint32_t done = status | (1u << FLETCHER_REG_STATUS_DONE);
+  ASSERT_TRUE(platform->WriteMMIO(FLETCHER_REG_STATUS, done).ok());
+  ASSERT_TRUE(platform->WriteMMIO(window + FLETCHER_REG_STATUS, done).ok());
+  ASSERT_TRUE(platform->WriteMMIO(2 * window + FLETCHER_REG_STATUS, 1u << FLETCHER_REG_STATUS_BUSY).ok());
+  uint32_t kernel_status = 0;
+  ASSERT_TRUE(kernel.GetStatus(&kernel_status).ok());
+  ASSERT_EQ(kernel_status & (1u << FLETCHER_REG_STATUS_DONE), 0u);
+  ASSERT_NE(kernel_status & (1u << FLETCHER_REG_STATUS_BUSY), 0u);
+  ASSERT_TRUE(platform->WriteMMIO(2 * window + FLETCHER_REG_STATUS, done).ok());
+  ASSERT_TRUE(kernel.GetStatus(&kernel_status).ok());
+  ASSERT_NE(kernel_status & (1u << FLETCHER_REG_STATUS_DONE), 0u);
+
+  // Clean up, since the echo platform remembers its registers.
+  for (uint64_t r = 0; r < 3; r++) {
+    ASSERT_TRUE(platform->WriteMMIO(r * window + FLETCHER_REG_STATUS, 0).ok());
+  }
+  ASSERT_TRUE(platform->Terminate().ok());
+}
+
+TEST(Profiler, EchoPlatform) {
+  std::shared_ptr<fletcher::Platform> platform;
+  ASSERT_TRUE(fletcher::Platform::Make("echo", &platform, false).ok());
+  auto opts = std::make_shared<InitOptions>();
+  opts->quiet = 1;
+  opts->non_interactive = 1;
+  platform->init_data = opts.get();
+  ASSERT_TRUE(platform->Init().ok());
+
+  fletcher::ProfileMap map;
+  map.enable = 100;
+  map.clear = 101;
+  fletcher::ProfileStreamRegs regs;
+  regs.name = "Test_number";
+  regs.element_width = 64;
+  regs.elements = 102;
+  regs.valids = 103;
+  regs.readies = 104;
+  regs.transfers = 105;
+  regs.packets = 106;
+  regs.cycles = 107;
+  regs.stall_histogram = {109, 110};
+  regs.starve_histogram = {111, 112};
+  map.streams.push_back(regs);
+  map.snapshot = 108;
+  map.has_snapshot = true;
+
+  fletcher::Profiler profiler(platform, map);
+  ASSERT_TRUE(profiler.Start().ok());
+  uint32_t enable = 0;
+  ASSERT_TRUE(platform->ReadMMIO(map.enable, &enable).ok());
+  ASSERT_EQ(enable, 1u);
+  ASSERT_TRUE(profiler.Stop().ok());
+  ASSERT_TRUE(platform->ReadMMIO(map.enable, &enable).ok());
+  ASSERT_EQ(enable, 0u);
+
+  // Pretend the stream transferred 200 elements in 100 transfers, of which it was valid for 125 cycles, out of 250.
+  const uint32_t counters[] = {200, 125, 150, 100, 1, 250};
+  for (uint64_t i = 0; i < 6; i++) {
+    ASSERT_TRUE(platform->WriteMMIO(regs.elements + i, counters[i]).ok());
+  }
+  // And that it stalled three times for a single cycle and once for two or three cycles.
+  ASSERT_TRUE(platform->WriteMMIO(regs.stall_histogram[0], 3).ok());
+  ASSERT_TRUE(platform->WriteMMIO(regs.stall_histogram[1], 1).ok());
+  std::vector<fletcher::StreamProfile> profiles;
+  ASSERT_TRUE(profiler.Read(&profiles).ok());
+  ASSERT_EQ(profiles.size(), 1);
+  uint32_t snapshot = 0;
+  ASSERT_TRUE(platform->ReadMMIO(map.snapshot, &snapshot).ok());
+  ASSERT_EQ(snapshot, 1u);
+  ASSERT_EQ(profiles[0].elements, 200u);
+  ASSERT_EQ(profiles[0].cycles, 250u);
+  ASSERT_DOUBLE_EQ(profiles[0].utilization(), 0.4);
+  ASSERT_DOUBLE_EQ(profiles[0].backpressure(), 0.2);
+  ASSERT_DOUBLE_EQ(profiles[0].elements_per_cycle(), 0.8);
+  ASSERT_DOUBLE_EQ(profiles[0].bytes_per_second(100E6), 640E6);
+  ASSERT_EQ(profiles[0].stall_histogram, std::vector<uint64_t>({3, 1}));
+  ASSERT_EQ(profiles[0].starve_histogram, std::vector<uint64_t>({0, 0}));
+  auto table = fletcher::Profiler::ToString(profiles, 100E6);
+  ASSERT_NE(table.find("Test_number"), std::string::npos);
+  ASSERT_NE(table.find("2+"), std::string::npos);
+
+  // Clean up, since the echo platform remembers its registers.
+  for (uint64_t i = map.enable; i <= regs.starve_histogram.back(); i++) {
+    ASSERT_TRUE(platform->WriteMMIO(i, 0).ok());
+  }
+  ASSERT_TRUE(platform->Terminate().ok());
+}
+
+TEST(Profiler, EchoPlatformBuses) {
+  std::shared_ptr<fletcher::Platform> platform;
+  ASSERT_TRUE(fletcher::Platform::Make("echo", &platform, false).ok());
+  auto opts = std::make_shared<InitOptions>();
+  opts->quiet = 1;
+  opts->non_interactive = 1;
+  platform->init_data = opts.get();
+  ASSERT_TRUE(platform->Init().ok());
+
+  fletcher::ProfileMap map;
+  map.enable = 100;
+  map.clear = 101;
+  map.bus_enable = 102;
+  map.bus_clear = 103;
+  map.bus_snapshot = 104;
+  fletcher::ProfileBusRegs regs;
+  regs.name = "rd_mst";
+  regs.data_width = 512;
+  regs.req_beats = 105;
+  regs.dat_beats = 106;
+  regs.req_stalls = 107;
+  regs.max_outstanding = 108;
+  regs.cycles = 109;
+  regs.busy = 110;
+  map.buses.push_back(regs);
+
+  fletcher::Profiler profiler(platform, map);
+  ASSERT_TRUE(profiler.Start().ok());
+  uint32_t enable = 0;
+  ASSERT_TRUE(platform->ReadMMIO(map.bus_enable, &enable).ok());
+  ASSERT_EQ(enable, 1u);
+  ASSERT_TRUE(profiler.Stop().ok());
+  ASSERT_TRUE(platform->ReadMMIO(map.bus_enable, &enable).ok());
+  ASSERT_EQ(enable, 0u);
+
+  // Pretend the bus requested 64 beats, of which it transferred 48 in 96 cycles.
+  const uint32_t counters[] = {64, 48, 3, 2, 96};
+  for (uint64_t i = 0; i < 5; i++) {
+    ASSERT_TRUE(platform->WriteMMIO(regs.req_beats + i, counters[i]).ok());
+  }
+  std::vector<fletcher::BusProfile> profiles;
+  ASSERT_TRUE(profiler.Read(&profiles).ok());
+  ASSERT_EQ(profiles.size(), 1);
+  uint32_t snapshot = 0;
+  ASSERT_TRUE(platform->ReadMMIO(map.bus_snapshot, &snapshot).ok());
+  ASSERT_EQ(snapshot, 1u);
+  ASSERT_EQ(profiles[0].req_beats, 64u);
+  ASSERT_EQ(profiles[0].max_outstanding, 2u);
+  ASSERT_DOUBLE_EQ(profiles[0].utilization(), 0.5);
+  ASSERT_DOUBLE_EQ(profiles[0].bytes_per_second(100E6), 3.2E9);
+  auto table = fletcher::Profiler::ToString(profiles, 100E6);
+  ASSERT_NE(table.find("rd_mst"), std::string::npos);
+
+  // Clean up, since the echo platform remembers its registers.
+  for (uint64_t i = map.enable; i <= regs.busy; i++) {
+    ASSERT_TRUE(platform->WriteMMIO(i, 0).ok());
+  }
+  ASSERT_TRUE(platform->Terminate().ok());
+}